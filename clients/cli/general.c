@@ -290,7 +290,8 @@ usage_general(void)
                  "  status\n\n"
                  "  hostname [<hostname>]\n\n"
                  "  permissions\n\n"
-                 "  logging [level <log level>] [domains <log domains>]\n\n"));
+                 "  logging [level <log level>] [domains <log domains>]\n\n"
+                 "  logging dump\n\n"));
 }
 
 static void
@@ -359,14 +360,17 @@ usage_general_reload(void)
 static void
 usage_general_logging(void)
 {
-    g_printerr(_("Usage: nmcli general logging { ARGUMENTS | help }\n"
+    g_printerr(_("Usage: nmcli general logging { ARGUMENTS | dump | help }\n"
                  "\n"
                  "ARGUMENTS := [level <log level>] [domains <log domains>]\n"
                  "\n"
                  "Get or change NetworkManager logging level and domains.\n"
                  "Without any argument current logging level and domains are shown. In order to\n"
                  "change logging state, provide level and/or domain. Please refer to the man page\n"
-                 "for the list of possible logging domains.\n\n"));
+                 "for the list of possible logging domains.\n"
+                 "\n"
+                 "'dump' prints the debug and trace messages recorded by the flight recorder,\n"
+                 "regardless of the logging level.\n\n"));
 }
 
 static void
@@ -741,6 +745,28 @@ _set_logging_cb(GObject *object, GAsyncResult *result, gpointer user_data)
     quit();
 }
 
+static void
+_dump_logging_cb(GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    NmCli *          nmc           = user_data;
+    gs_unref_variant GVariant *res = NULL;
+    gs_free_error GError *error    = NULL;
+    const char *          messages;
+
+    res = nm_client_dbus_call_finish(NM_CLIENT(object), result, &error);
+    if (!res) {
+        g_dbus_error_strip_remote_error(error);
+        g_string_printf(nmc->return_text,
+                        _("Error: failed to dump logging: %s"),
+                        nmc_error_get_simple_message(error));
+        nmc->return_value = NMC_RESULT_ERROR_UNKNOWN;
+    } else {
+        g_variant_get(res, "(&s)", &messages);
+        g_print("%s", messages);
+    }
+    quit();
+}
+
 static void
 do_general_logging(const NMCCommand *cmd, NmCli *nmc, int argc, const char *const *argv)
 {
@@ -750,6 +776,27 @@ do_general_logging(const NMCCommand *cmd, NmCli *nmc, int argc, const char *cons
             return;
 
         show_general_logging(nmc);
+    } else if (matches(*argv, "dump") && !matches(*argv, "domains")) {
+        if (next_arg(nmc, &argc, &argv, NULL) == 0) {
+            g_string_printf(nmc->return_text, _("Error: too many arguments."));
+            nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+            return;
+        }
+
+        if (nmc->complete)
+            return;
+
+        nmc->should_wait++;
+        nm_client_dbus_call(nmc->client,
+                            NM_DBUS_PATH,
+                            NM_DBUS_INTERFACE,
+                            "DumpLogging",
+                            NULL,
+                            G_VARIANT_TYPE("(s)"),
+                            -1,
+                            NULL,
+                            _dump_logging_cb,
+                            nmc);
     } else {
         /* arguments provided -> set logging level and domains */
         const char *level   = NULL;
@@ -757,7 +804,7 @@ do_general_logging(const NMCCommand *cmd, NmCli *nmc, int argc, const char *cons
 
         do {
             if (argc == 1 && nmc->complete)
-                nmc_complete_strings(*argv, "level", "domains");
+                nmc_complete_strings(*argv, "level", "domains", "dump");
 
             if (matches(*argv, "level")) {
                 argc--;
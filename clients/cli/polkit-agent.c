@@ -47,7 +47,10 @@ nmc_polkit_agent_init(NmCli *nmc, gboolean for_session, GError **error)
 
     g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-    if (nmc->client && nm_client_get_dbus_connection(nmc->client)) {
+    if (nmc->client && nm_client_get_dbus_connection(nmc->client)
+        && g_dbus_connection_get_unique_name(nm_client_get_dbus_connection(nmc->client))) {
+        /* only a connection to the message bus will do. The client might
+         * also talk to NetworkManager via its private socket. */
         dbus_connection = nm_client_get_dbus_connection(nmc->client);
         listener        = nm_polkit_listener_new(dbus_connection, for_session);
     } else {
@@ -376,137 +376,237 @@ _config_data_get_num_valid(GHashTable *config_dict)
     return n;
 }
 
-static gboolean
-_config_one(GCancellable *                        sigterm_cancellable,
-            NMClient *                            nmc,
-            gboolean                              is_single_nic,
-            const char *                          hwaddr,
-            const NMCSProviderGetConfigIfaceData *config_data)
+/* How many devices we configure at the same time. Each of them does a few
+ * D-Bus round trips (GetAppliedConnection, Reapply), which we don't want to
+ * serialize on hosts with many interfaces. Can be overwritten via
+ * $NM_CLOUD_SETUP_MAX_PARALLEL. */
+#define CONFIG_MAX_PARALLEL_DEFAULT 8
+
+typedef struct {
+    GCancellable * sigterm_cancellable;
+    NMClient *     nmc;
+    GHashTable *   config_dict;
+    GHashTableIter h_iter;
+    bool           is_single_nic : 1;
+    bool           any_changes : 1;
+} ConfigAllData;
+
+typedef struct {
+    ConfigAllData *                       all_data;
+    NMCSUtilsParallel *                   parallel;
+    NMDevice *                            device;
+    NMConnection *                        applied_connection;
+    const char *                          hwaddr;
+    const NMCSProviderGetConfigIfaceData *config_data;
+    guint64                               applied_version_id;
+
+    /* Counts the retries after Reapply() failed due to a version-id mismatch.
+     * Once we called Reapply(), it counts as if we changed something. */
+    guint try_count;
+} ConfigOneData;
+
+static void _config_one_get_applied_connection_cb(GObject *     source,
+                                                  GAsyncResult *result,
+                                                  gpointer      user_data);
+
+static void
+_config_one_done(ConfigOneData *one_data, gboolean any_changes)
 {
-    gs_unref_object NMDevice *device                 = NULL;
-    gs_unref_object NMConnection *applied_connection = NULL;
-    guint64                       applied_version_id;
-    gs_free_error GError *error = NULL;
-    gboolean              changed;
-    gboolean              version_id_changed;
-    guint                 try_count;
-    gboolean              any_changes = FALSE;
+    NMCSUtilsParallel *parallel = one_data->parallel;
 
-    g_main_context_iteration(NULL, FALSE);
+    if (any_changes)
+        one_data->all_data->any_changes = TRUE;
 
-    if (g_cancellable_is_cancelled(sigterm_cancellable))
-        return FALSE;
+    g_object_unref(one_data->device);
+    nm_g_object_unref(one_data->applied_connection);
+    nm_g_slice_free(one_data);
 
-    device = nm_g_object_ref(_nmc_get_device_by_hwaddr(nmc, hwaddr));
-    if (!device) {
-        _LOGD("config device %s: skip because device not found", hwaddr);
-        return FALSE;
-    }
+    nmcs_utils_parallel_done(parallel);
+}
 
-    if (!nmcs_provider_get_config_iface_data_is_valid(config_data)) {
-        _LOGD("config device %s: skip because meta data not successfully fetched", hwaddr);
-        return FALSE;
+static void
+_config_one_get_applied_connection(ConfigOneData *one_data)
+{
+    g_clear_object(&one_data->applied_connection);
+    nm_device_get_applied_connection_async(one_data->device,
+                                           0,
+                                           one_data->all_data->sigterm_cancellable,
+                                           _config_one_get_applied_connection_cb,
+                                           one_data);
+}
+
+static void
+_config_one_reapply_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    ConfigOneData *one_data     = user_data;
+    const char *   hwaddr       = one_data->hwaddr;
+    gs_free_error GError *error = NULL;
+
+    if (!nm_device_reapply_finish(NM_DEVICE(source), result, &error)) {
+        if (g_error_matches(error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_VERSION_ID_MISMATCH)
+            && one_data->try_count < 5) {
+            _LOGD("config device %s: applied connection changed in the meantime. Retry...", hwaddr);
+            one_data->try_count++;
+            _config_one_get_applied_connection(one_data);
+            return;
+        }
+
+        if (!nm_utils_error_is_cancelled(error)) {
+            _LOGD("config device %s: failure to reapply connection \"%s\" (%s): %s",
+                  hwaddr,
+                  nm_connection_get_id(one_data->applied_connection),
+                  nm_connection_get_uuid(one_data->applied_connection),
+                  error->message);
+        }
+        /* we called Reapply(). Even if that failed, it counts as if we changed something. */
+        _config_one_done(one_data, TRUE);
+        return;
     }
 
-    _LOGD("config device %s: configuring \"%s\" (%s)...",
+    _LOGD("config device %s: connection \"%s\" (%s) reapplied",
           hwaddr,
-          nm_device_get_iface(device) ?: "/unknown/",
-          nm_object_get_path(NM_OBJECT(device)));
+          nm_connection_get_id(one_data->applied_connection),
+          nm_connection_get_uuid(one_data->applied_connection));
 
-    try_count = 0;
+    _config_one_done(one_data, TRUE);
+}
 
-try_again:
+static void
+_config_one_get_applied_connection_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    ConfigOneData *one_data     = user_data;
+    const char *   hwaddr       = one_data->hwaddr;
+    gs_free_error GError *error = NULL;
+    gboolean              changed;
 
-    applied_connection = nmcs_device_get_applied_connection(device,
-                                                            sigterm_cancellable,
-                                                            &applied_version_id,
-                                                            &error);
-    if (!applied_connection) {
+    one_data->applied_connection =
+        nm_device_get_applied_connection_finish(NM_DEVICE(source),
+                                                result,
+                                                &one_data->applied_version_id,
+                                                &error);
+    if (!one_data->applied_connection) {
         if (!nm_utils_error_is_cancelled(error))
             _LOGD("config device %s: device has no applied connection (%s). Skip",
                   hwaddr,
                   error->message);
-        return any_changes;
+        _config_one_done(one_data, one_data->try_count > 0);
+        return;
     }
 
-    if (_nmc_skip_connection(applied_connection)) {
+    if (_nmc_skip_connection(one_data->applied_connection)) {
         _LOGD("config device %s: skip applied connection due to user data %s",
               hwaddr,
               USER_TAG_SKIP);
-        return any_changes;
+        _config_one_done(one_data, one_data->try_count > 0);
+        return;
     }
 
-    if (!_nmc_mangle_connection(device, applied_connection, config_data, &changed)) {
+    if (!_nmc_mangle_connection(one_data->device,
+                                one_data->applied_connection,
+                                one_data->config_data,
+                                &changed)) {
         _LOGD("config device %s: device has no suitable applied connection. Skip", hwaddr);
-        return any_changes;
+        _config_one_done(one_data, one_data->try_count > 0);
+        return;
     }
 
     if (!changed) {
         _LOGD("config device %s: device needs no update to applied connection \"%s\" (%s). Skip",
               hwaddr,
-              nm_connection_get_id(applied_connection),
-              nm_connection_get_uuid(applied_connection));
-        return any_changes;
+              nm_connection_get_id(one_data->applied_connection),
+              nm_connection_get_uuid(one_data->applied_connection));
+        _config_one_done(one_data, one_data->try_count > 0);
+        return;
     }
 
     _LOGD("config device %s: reapply connection \"%s\" (%s)",
           hwaddr,
-          nm_connection_get_id(applied_connection),
-          nm_connection_get_uuid(applied_connection));
+          nm_connection_get_id(one_data->applied_connection),
+          nm_connection_get_uuid(one_data->applied_connection));
+
+    nm_device_reapply_async(one_data->device,
+                            one_data->applied_connection,
+                            one_data->applied_version_id,
+                            0,
+                            one_data->all_data->sigterm_cancellable,
+                            _config_one_reapply_cb,
+                            one_data);
+}
 
-    /* we are about to call Reapply(). If if that fails, it counts as if we changed something. */
-    any_changes = TRUE;
+static gboolean
+_config_one_start(ConfigAllData *                       all_data,
+                  NMCSUtilsParallel *                   parallel,
+                  const char *                          hwaddr,
+                  const NMCSProviderGetConfigIfaceData *config_data)
+{
+    ConfigOneData *one_data;
+    NMDevice *     device;
 
-    if (!nmcs_device_reapply(device,
-                             sigterm_cancellable,
-                             applied_connection,
-                             applied_version_id,
-                             &version_id_changed,
-                             &error)) {
-        if (version_id_changed && try_count < 5) {
-            _LOGD("config device %s: applied connection changed in the meantime. Retry...", hwaddr);
-            g_clear_object(&applied_connection);
-            g_clear_error(&error);
-            try_count++;
-            goto try_again;
-        }
+    device = _nmc_get_device_by_hwaddr(all_data->nmc, hwaddr);
+    if (!device) {
+        _LOGD("config device %s: skip because device not found", hwaddr);
+        return FALSE;
+    }
 
-        if (!nm_utils_error_is_cancelled(error)) {
-            _LOGD("config device %s: failure to reapply connection \"%s\" (%s): %s",
-                  hwaddr,
-                  nm_connection_get_id(applied_connection),
-                  nm_connection_get_uuid(applied_connection),
-                  error->message);
-        }
-        return any_changes;
+    if (!nmcs_provider_get_config_iface_data_is_valid(config_data)) {
+        _LOGD("config device %s: skip because meta data not successfully fetched", hwaddr);
+        return FALSE;
     }
 
-    _LOGD("config device %s: connection \"%s\" (%s) reapplied",
+    _LOGD("config device %s: configuring \"%s\" (%s)...",
           hwaddr,
-          nm_connection_get_id(applied_connection),
-          nm_connection_get_uuid(applied_connection));
+          nm_device_get_iface(device) ?: "/unknown/",
+          nm_object_get_path(NM_OBJECT(device)));
 
-    return any_changes;
+    one_data  = g_slice_new(ConfigOneData);
+    *one_data = (ConfigOneData){
+        .all_data    = all_data,
+        .parallel    = parallel,
+        .device      = g_object_ref(device),
+        .hwaddr      = hwaddr,
+        .config_data = config_data,
+    };
+    _config_one_get_applied_connection(one_data);
+    return TRUE;
 }
 
 static gboolean
-_config_all(GCancellable *sigterm_cancellable, NMClient *nmc, GHashTable *config_dict)
+_config_all_start_next(NMCSUtilsParallel *parallel, gpointer user_data)
 {
-    GHashTableIter                        h_iter;
+    ConfigAllData *                       all_data = user_data;
     const NMCSProviderGetConfigIfaceData *c_config_data;
     const char *                          c_hwaddr;
-    gboolean                              is_single_nic;
-    gboolean                              any_changes = FALSE;
 
-    is_single_nic = (_config_data_get_num_valid(config_dict) <= 1);
-
-    g_hash_table_iter_init(&h_iter, config_dict);
-    while (g_hash_table_iter_next(&h_iter, (gpointer *) &c_hwaddr, (gpointer *) &c_config_data)) {
-        if (_config_one(sigterm_cancellable, nmc, is_single_nic, c_hwaddr, c_config_data))
-            any_changes = TRUE;
+    while (g_hash_table_iter_next(&all_data->h_iter,
+                                  (gpointer *) &c_hwaddr,
+                                  (gpointer *) &c_config_data)) {
+        if (_config_one_start(all_data, parallel, c_hwaddr, c_config_data))
+            return TRUE;
     }
+    return FALSE;
+}
+
+static gboolean
+_config_all(GCancellable *sigterm_cancellable, NMClient *nmc, GHashTable *config_dict)
+{
+    ConfigAllData all_data = {
+        .sigterm_cancellable = sigterm_cancellable,
+        .nmc                 = nmc,
+        .config_dict         = config_dict,
+    };
+
+    all_data.is_single_nic = (_config_data_get_num_valid(config_dict) <= 1);
+
+    g_hash_table_iter_init(&all_data.h_iter, config_dict);
+
+    /* Configure the devices concurrently, but with a bounded number of devices
+     * in flight. Whenever one device is done, the next one gets started. */
+    nmcs_utils_parallel_run(nmcs_utils_parallel_get_max(CONFIG_MAX_PARALLEL_DEFAULT),
+                            sigterm_cancellable,
+                            _config_all_start_next,
+                            &all_data);
 
-    return any_changes;
+    return all_data.any_changes;
 }
 
 /*****************************************************************************/
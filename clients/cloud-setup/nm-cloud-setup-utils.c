@@ -229,6 +229,109 @@ nmcs_wait_for_objects_iterate_until_done(GMainContext *context, int timeout_msec
 
 /*****************************************************************************/
 
+struct _NMCSUtilsParallel {
+    GMainLoop *               main_loop;
+    GCancellable *            cancellable;
+    NMCSUtilsParallelStartFcn start_fcn;
+    gpointer                  user_data;
+    guint                     max_parallel;
+    guint                     n_pending;
+    bool                      iter_done : 1;
+    bool                      in_start : 1;
+};
+
+guint
+nmcs_utils_parallel_get_max(guint default_val)
+{
+    return _nm_utils_ascii_str_to_int64(g_getenv(NMCS_ENV_VARIABLE("NM_CLOUD_SETUP_MAX_PARALLEL")),
+                                        10,
+                                        1,
+                                        G_MAXINT,
+                                        default_val);
+}
+
+static void
+_parallel_start_next(NMCSUtilsParallel *parallel)
+{
+    /* a job that completes right away calls nmcs_utils_parallel_done() from
+     * within start_fcn(). The loop below picks up the free slot. */
+    if (parallel->in_start)
+        return;
+
+    parallel->in_start = TRUE;
+    while (!parallel->iter_done && parallel->n_pending < parallel->max_parallel) {
+        if (g_cancellable_is_cancelled(parallel->cancellable)) {
+            parallel->iter_done = TRUE;
+            break;
+        }
+        parallel->n_pending++;
+        if (!parallel->start_fcn(parallel, parallel->user_data)) {
+            parallel->n_pending--;
+            parallel->iter_done = TRUE;
+        }
+    }
+    parallel->in_start = FALSE;
+
+    if (parallel->iter_done && parallel->n_pending == 0)
+        g_main_loop_quit(parallel->main_loop);
+}
+
+/**
+ * nmcs_utils_parallel_done:
+ * @parallel: the #NMCSUtilsParallel instance, as passed to the start function.
+ *
+ * Must be called exactly once for each job that the start function
+ * started, after the job completed (successfully or not).
+ */
+void
+nmcs_utils_parallel_done(NMCSUtilsParallel *parallel)
+{
+    nm_assert(parallel);
+    nm_assert(parallel->n_pending > 0);
+
+    parallel->n_pending--;
+    _parallel_start_next(parallel);
+}
+
+/**
+ * nmcs_utils_parallel_run:
+ * @max_parallel: the maximum number of jobs that run at the same time.
+ * @cancellable: once cancelled, no more jobs get started.
+ * @start_fcn: starts the next job. Returns %FALSE if there are no more
+ *   jobs.
+ * @user_data: the user data for @start_fcn.
+ *
+ * Iterates the main context until all jobs completed. Whenever one job
+ * completes, the next one gets started. After @cancellable got cancelled, this
+ * still waits for the pending jobs. They should complete (or fail) quickly,
+ * as they are expected to honor @cancellable too.
+ */
+void
+nmcs_utils_parallel_run(guint                     max_parallel,
+                        GCancellable *            cancellable,
+                        NMCSUtilsParallelStartFcn start_fcn,
+                        gpointer                  user_data)
+{
+    nm_auto_unref_gmainloop GMainLoop *main_loop = g_main_loop_new(NULL, FALSE);
+    NMCSUtilsParallel                  parallel  = {
+        .main_loop    = main_loop,
+        .cancellable  = cancellable,
+        .start_fcn    = start_fcn,
+        .user_data    = user_data,
+        .max_parallel = NM_MAX(max_parallel, 1u),
+    };
+
+    _parallel_start_next(&parallel);
+
+    if (!parallel.iter_done || parallel.n_pending > 0)
+        g_main_loop_run(main_loop);
+
+    nm_assert(parallel.iter_done);
+    nm_assert(parallel.n_pending == 0);
+}
+
+/*****************************************************************************/
+
 typedef struct {
     GTask *                     task;
     GSource *                   source_timeout;
@@ -803,100 +906,3 @@ nmcs_setting_ip_replace_ipv4_rules(NMSettingIPConfig *s_ip,
 
     return any_changes;
 }
-
-/*****************************************************************************/
-
-typedef struct {
-    GMainLoop *   main_loop;
-    NMConnection *connection;
-    GError *      error;
-    guint64       version_id;
-} DeviceGetAppliedConnectionData;
-
-static void
-_nmcs_device_get_applied_connection_cb(GObject *source, GAsyncResult *result, gpointer user_data)
-{
-    DeviceGetAppliedConnectionData *data = user_data;
-
-    data->connection = nm_device_get_applied_connection_finish(NM_DEVICE(source),
-                                                               result,
-                                                               &data->version_id,
-                                                               &data->error);
-    g_main_loop_quit(data->main_loop);
-}
-
-NMConnection *
-nmcs_device_get_applied_connection(NMDevice *    device,
-                                   GCancellable *cancellable,
-                                   guint64 *     version_id,
-                                   GError **     error)
-{
-    nm_auto_unref_gmainloop GMainLoop *main_loop = g_main_loop_new(NULL, FALSE);
-    DeviceGetAppliedConnectionData     data      = {
-        .main_loop = main_loop,
-    };
-
-    nm_device_get_applied_connection_async(device,
-                                           0,
-                                           cancellable,
-                                           _nmcs_device_get_applied_connection_cb,
-                                           &data);
-
-    g_main_loop_run(main_loop);
-
-    if (data.error)
-        g_propagate_error(error, data.error);
-    NM_SET_OUT(version_id, data.version_id);
-    return data.connection;
-}
-
-/*****************************************************************************/
-
-typedef struct {
-    GMainLoop *main_loop;
-    GError *   error;
-} DeviceReapplyData;
-
-static void
-_nmcs_device_reapply_cb(GObject *source, GAsyncResult *result, gpointer user_data)
-{
-    DeviceReapplyData *data = user_data;
-
-    nm_device_reapply_finish(NM_DEVICE(source), result, &data->error);
-    g_main_loop_quit(data->main_loop);
-}
-
-gboolean
-nmcs_device_reapply(NMDevice *    device,
-                    GCancellable *sigterm_cancellable,
-                    NMConnection *connection,
-                    guint64       version_id,
-                    gboolean *    out_version_id_changed,
-                    GError **     error)
-{
-    nm_auto_unref_gmainloop GMainLoop *main_loop = g_main_loop_new(NULL, FALSE);
-    DeviceReapplyData                  data      = {
-        .main_loop = main_loop,
-    };
-
-    nm_device_reapply_async(device,
-                            connection,
-                            version_id,
-                            0,
-                            sigterm_cancellable,
-                            _nmcs_device_reapply_cb,
-                            &data);
-
-    g_main_loop_run(main_loop);
-
-    if (data.error) {
-        NM_SET_OUT(
-            out_version_id_changed,
-            g_error_matches(data.error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_VERSION_ID_MISMATCH));
-        g_propagate_error(error, data.error);
-        return FALSE;
-    }
-
-    NM_SET_OUT(out_version_id_changed, FALSE);
-    return TRUE;
-}
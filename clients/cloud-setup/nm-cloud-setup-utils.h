@@ -52,6 +52,21 @@ gboolean nmcs_wait_for_objects_iterate_until_done(GMainContext *context, int tim
 
 /*****************************************************************************/
 
+typedef struct _NMCSUtilsParallel NMCSUtilsParallel;
+
+typedef gboolean (*NMCSUtilsParallelStartFcn)(NMCSUtilsParallel *parallel, gpointer user_data);
+
+guint nmcs_utils_parallel_get_max(guint default_val);
+
+void nmcs_utils_parallel_run(guint                     max_parallel,
+                             GCancellable *            cancellable,
+                             NMCSUtilsParallelStartFcn start_fcn,
+                             gpointer                  user_data);
+
+void nmcs_utils_parallel_done(NMCSUtilsParallel *parallel);
+
+/*****************************************************************************/
+
 typedef void (*NMCSUtilsPollProbeStartFcn)(GCancellable *      cancellable,
                                            gpointer            probe_user_data,
                                            GAsyncReadyCallback callback,
@@ -135,18 +150,4 @@ gboolean nmcs_setting_ip_replace_ipv4_rules(NMSettingIPConfig *s_ip,
                                             NMIPRoutingRule ** entries_arr,
                                             guint              entries_len);
 
-/*****************************************************************************/
-
-NMConnection *nmcs_device_get_applied_connection(NMDevice *    device,
-                                                 GCancellable *cancellable,
-                                                 guint64 *     version_id,
-                                                 GError **     error);
-
-gboolean nmcs_device_reapply(NMDevice *    device,
-                             GCancellable *sigterm_cancellable,
-                             NMConnection *connection,
-                             guint64       version_id,
-                             gboolean *    out_version_id_changed,
-                             GError **     error);
-
 #endif /* __NM_CLOUD_SETUP_UTILS_H__ */
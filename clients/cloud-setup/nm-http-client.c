@@ -11,6 +11,8 @@
 
 #define NM_CURL_DEBUG 0
 
+#define MAX_HOST_CONNECTIONS 8
+
 /*****************************************************************************/
 
 typedef struct {
@@ -750,6 +752,14 @@ constructed(GObject *object)
         curl_multi_setopt(priv->mhandle, CURLMOPT_SOCKETDATA, self);
         curl_multi_setopt(priv->mhandle, CURLMOPT_TIMERFUNCTION, _mhandle_timerfunction_cb);
         curl_multi_setopt(priv->mhandle, CURLMOPT_TIMERDATA, self);
+#if LIBCURL_VERSION_NUM >= 0x071e00 /* 7.30.0 */
+        /* The providers issue all their requests in parallel, and they all go to
+         * the same metadata server. Limit the number of connections to it. Additional
+         * requests get queued by curl and reuse the kept-alive connections. */
+        curl_multi_setopt(priv->mhandle,
+                          CURLMOPT_MAX_HOST_CONNECTIONS,
+                          (long) MAX_HOST_CONNECTIONS);
+#endif
     }
 
     G_OBJECT_CLASS(nm_http_client_parent_class)->constructed(object);
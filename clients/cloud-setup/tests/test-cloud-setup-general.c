@@ -3,6 +3,7 @@
 #include "libnm/nm-default-client.h"
 
 #include "nm-cloud-setup-utils.h"
+#include "nmcs-provider-ec2.h"
 #include "nm-libnm-core-intern/nm-libnm-core-utils.h"
 
 #include "nm-utils/nm-test-utils.h"
@@ -104,6 +105,358 @@ test_replace_ipv4_addresses(void)
 
 /*****************************************************************************/
 
+#define MOCK_EC2_N_IFACES 6
+
+typedef struct {
+    GMainLoop * main_loop;
+    GHashTable *config_dict;
+    int         n_requests;
+} MockEC2Data;
+
+static const char *
+_mock_ec2_response(const char *path, int *out_status)
+{
+    static const char *const MACS =
+        "0a:00:00:00:00:01/\n0a:00:00:00:00:02/\n0a:00:00:00:00:03/\n"
+        "0a:00:00:00:00:04/\n0a:00:00:00:00:05/\n0a:00:00:00:00:06/\n";
+    const char *rest;
+
+    *out_status = 200;
+
+    if (nm_streq(path, "/latest/meta-data/"))
+        return "ami-id\n";
+
+    rest = NM_STR_HAS_PREFIX(path, "/2018-09-24/meta-data/network/interfaces/macs/")
+               ? &path[NM_STRLEN("/2018-09-24/meta-data/network/interfaces/macs/")]
+               : NULL;
+    if (rest) {
+        if (rest[0] == '\0')
+            return MACS;
+        if (NM_STR_HAS_SUFFIX(rest, "/subnet-ipv4-cidr-block"))
+            return "172.31.16.0/20";
+        if (NM_STR_HAS_SUFFIX(rest, "/local-ipv4s"))
+            return "172.31.16.5\n172.31.16.6\n";
+    }
+
+    *out_status = 404;
+    return "not found";
+}
+
+static gboolean
+_mock_ec2_run_cb(GThreadedSocketService *service,
+                 GSocketConnection *     connection,
+                 GObject *               source_object,
+                 gpointer                user_data)
+{
+    MockEC2Data *                     data = user_data;
+    gs_unref_object GDataInputStream *in   = NULL;
+    GOutputStream *                   out;
+
+    in  = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+    out = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+
+    /* Serve requests on this connection until the client closes it. curl
+     * keeps the connection alive and reuses it for further requests. */
+    while (TRUE) {
+        gs_free char *       request_line = NULL;
+        gs_free char *       response     = NULL;
+        gs_free const char **tokens       = NULL;
+        const char *         body;
+        int                  status;
+
+        request_line = g_data_input_stream_read_line_utf8(in, NULL, NULL, NULL);
+        if (!request_line)
+            break;
+
+        while (TRUE) {
+            gs_free char *header = NULL;
+
+            header = g_data_input_stream_read_line_utf8(in, NULL, NULL, NULL);
+            if (!header || NM_IN_STRSET(header, "", "\r"))
+                break;
+        }
+
+        tokens = nm_utils_strsplit_set(request_line, " ");
+        g_assert(tokens && tokens[0] && tokens[1]);
+        g_assert_cmpstr(tokens[0], ==, "GET");
+
+        g_atomic_int_inc(&data->n_requests);
+
+        body     = _mock_ec2_response(tokens[1], &status);
+        response = g_strdup_printf("HTTP/1.1 %d %s\r\n"
+                                   "Content-Length: %zu\r\n"
+                                   "Content-Type: text/plain\r\n"
+                                   "\r\n"
+                                   "%s",
+                                   status,
+                                   status == 200 ? "OK" : "Not Found",
+                                   strlen(body),
+                                   body);
+        if (!g_output_stream_write_all(out, response, strlen(response), NULL, NULL, NULL))
+            break;
+    }
+
+    return TRUE;
+}
+
+static void
+_mock_ec2_get_config_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    MockEC2Data *data           = user_data;
+    gs_free_error GError *error = NULL;
+
+    data->config_dict = nmcs_provider_get_config_finish(NMCS_PROVIDER(source), result, &error);
+    nmtst_assert_success(data->config_dict, error);
+    g_main_loop_quit(data->main_loop);
+}
+
+static void
+test_provider_ec2_mock_server(void)
+{
+    nm_auto_unref_gmainloop GMainLoop *main_loop = g_main_loop_new(NULL, FALSE);
+    gs_unref_object GSocketService *service      = NULL;
+    gs_unref_object GSocketAddress *addr         = NULL;
+    gs_unref_object GSocketAddress *addr_bound   = NULL;
+    gs_unref_object GInetAddress *inet_addr      = NULL;
+    gs_unref_object NMHttpClient *http_client    = NULL;
+    gs_unref_object NMCSProvider *provider       = NULL;
+    gs_free_error GError *error                  = NULL;
+    gs_free char *        host                   = NULL;
+    gs_strfreev char **hwaddrs                   = NULL;
+    MockEC2Data        data                      = {
+        .main_loop = main_loop,
+    };
+    int i;
+
+    service = g_threaded_socket_service_new(MOCK_EC2_N_IFACES * 2);
+    g_signal_connect(service, "run", G_CALLBACK(_mock_ec2_run_cb), &data);
+
+    inet_addr = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+    addr      = g_inet_socket_address_new(inet_addr, 0);
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service),
+                                       addr,
+                                       G_SOCKET_TYPE_STREAM,
+                                       G_SOCKET_PROTOCOL_TCP,
+                                       NULL,
+                                       &addr_bound,
+                                       &error)) {
+        g_test_skip("cannot listen on loopback");
+        return;
+    }
+    g_socket_service_start(service);
+
+    /* The EC2 provider caches the host on first use. This is the only test
+     * that uses it. */
+    host = g_strdup_printf("127.0.0.1:%u",
+                           g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(addr_bound)));
+    g_setenv("NM_CLOUD_SETUP_EC2_HOST", host, TRUE);
+
+    /* Only request some of the interfaces. The others are reported by the
+     * server and fetched too (any=TRUE). */
+    hwaddrs = g_new0(char *, MOCK_EC2_N_IFACES);
+    for (i = 0; i < MOCK_EC2_N_IFACES - 2; i++)
+        hwaddrs[i] = g_strdup_printf("0A:00:00:00:00:%02X", i + 1);
+
+    http_client = nm_http_client_new();
+    provider    = g_object_new(NMCS_TYPE_PROVIDER_EC2,
+                            NMCS_PROVIDER_HTTP_CLIENT,
+                            http_client,
+                            NULL);
+
+    nmcs_provider_get_config(provider,
+                             TRUE,
+                             (const char *const *) hwaddrs,
+                             NULL,
+                             _mock_ec2_get_config_cb,
+                             &data);
+
+    nmtst_main_loop_run_assert(main_loop, 10000);
+
+    g_assert(data.config_dict);
+    g_assert_cmpint(g_hash_table_size(data.config_dict), ==, MOCK_EC2_N_IFACES);
+
+    for (i = 0; i < MOCK_EC2_N_IFACES; i++) {
+        gs_free char *                        hwaddr = NULL;
+        const NMCSProviderGetConfigIfaceData *config_data;
+
+        hwaddr      = g_strdup_printf("0A:00:00:00:00:%02X", i + 1);
+        config_data = g_hash_table_lookup(data.config_dict, hwaddr);
+
+        g_assert(config_data);
+        g_assert(nmcs_provider_get_config_iface_data_is_valid(config_data));
+        g_assert_cmpint(config_data->iface_idx, >=, 0);
+        g_assert_cmpint(config_data->was_requested, ==, i < MOCK_EC2_N_IFACES - 2);
+        g_assert_cmpint(config_data->cidr_prefix, ==, 20);
+        nmtst_assert_ip4_address(config_data->cidr_addr, "172.31.16.0");
+        g_assert_cmpint(config_data->ipv4s_len, ==, 2);
+        nmtst_assert_ip4_address(config_data->ipv4s_arr[0], "172.31.16.5");
+        nmtst_assert_ip4_address(config_data->ipv4s_arr[1], "172.31.16.6");
+    }
+
+    /* the MAC list, plus two requests per interface. */
+    g_assert_cmpint(g_atomic_int_get(&data.n_requests), ==, 1 + 2 * MOCK_EC2_N_IFACES);
+
+    g_socket_service_stop(service);
+    g_socket_listener_close(G_SOCKET_LISTENER(service));
+    nm_clear_pointer(&data.config_dict, g_hash_table_unref);
+    g_clear_object(&provider);
+    g_clear_object(&http_client);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GCancellable *cancellable;
+    guint         n_jobs;
+    guint         fail_idx;
+    guint         sync_idx;
+    guint         cancel_idx;
+    guint         n_started;
+    guint         n_running;
+    guint         n_running_max;
+    guint         n_succeeded;
+    guint         n_failed;
+} ParallelData;
+
+typedef struct {
+    ParallelData *     data;
+    NMCSUtilsParallel *parallel;
+    bool               fail;
+} ParallelJob;
+
+static gboolean
+_parallel_job_cb(gpointer user_data)
+{
+    ParallelJob *      job      = user_data;
+    ParallelData *     data     = job->data;
+    NMCSUtilsParallel *parallel = job->parallel;
+
+    g_assert_cmpint(data->n_running, >, 0);
+    data->n_running--;
+    if (job->fail)
+        data->n_failed++;
+    else
+        data->n_succeeded++;
+    nm_g_slice_free(job);
+
+    nmcs_utils_parallel_done(parallel);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+_parallel_start_cb(NMCSUtilsParallel *parallel, gpointer user_data)
+{
+    ParallelData *data = user_data;
+    ParallelJob * job;
+    guint         idx;
+
+    g_assert(!g_cancellable_is_cancelled(data->cancellable));
+
+    if (data->n_started >= data->n_jobs)
+        return FALSE;
+
+    idx = data->n_started++;
+
+    if (idx == data->cancel_idx)
+        g_cancellable_cancel(data->cancellable);
+
+    if (idx == data->sync_idx) {
+        /* a job that has nothing to do, and completes right away. */
+        data->n_succeeded++;
+        nmcs_utils_parallel_done(parallel);
+        return TRUE;
+    }
+
+    data->n_running++;
+    data->n_running_max = NM_MAX(data->n_running_max, data->n_running);
+
+    job  = g_slice_new(ParallelJob);
+    *job = (ParallelJob){
+        .data     = data,
+        .parallel = parallel,
+        .fail     = (idx == data->fail_idx),
+    };
+
+    /* the failing job completes first, while the others are still running. */
+    g_timeout_add(job->fail ? 1 : 10 + (nmtst_get_rand_uint32() % 10), _parallel_job_cb, job);
+    return TRUE;
+}
+
+static void
+_test_parallel(guint max_parallel, guint n_jobs, guint fail_idx, guint sync_idx, guint cancel_idx)
+{
+    gs_unref_object GCancellable *cancellable = g_cancellable_new();
+    ParallelData                  data        = {
+        .cancellable = cancellable,
+        .n_jobs      = n_jobs,
+        .fail_idx    = fail_idx,
+        .sync_idx    = sync_idx,
+        .cancel_idx  = cancel_idx,
+    };
+
+    nmcs_utils_parallel_run(max_parallel, cancellable, _parallel_start_cb, &data);
+
+    g_assert_cmpint(data.n_running, ==, 0);
+    g_assert_cmpint(data.n_running_max, <=, max_parallel);
+    g_assert_cmpint(data.n_succeeded + data.n_failed, ==, data.n_started);
+
+    if (cancel_idx < n_jobs) {
+        /* the jobs that were already started complete, but no further jobs get started. */
+        g_assert_cmpint(data.n_started, ==, cancel_idx + 1);
+        return;
+    }
+
+    g_assert_cmpint(data.n_started, ==, n_jobs);
+    g_assert_cmpint(data.n_failed, ==, fail_idx < n_jobs ? 1 : 0);
+    if (n_jobs >= max_parallel + (sync_idx < n_jobs ? 1 : 0))
+        g_assert_cmpint(data.n_running_max, ==, max_parallel);
+}
+
+static void
+test_parallel(void)
+{
+    _test_parallel(1, 0, G_MAXUINT, G_MAXUINT, G_MAXUINT);
+    _test_parallel(1, 5, G_MAXUINT, G_MAXUINT, G_MAXUINT);
+    _test_parallel(3, 10, G_MAXUINT, G_MAXUINT, G_MAXUINT);
+    _test_parallel(8, 3, G_MAXUINT, G_MAXUINT, G_MAXUINT);
+
+    /* one job fails, while the others are still running. */
+    _test_parallel(3, 10, 1, G_MAXUINT, G_MAXUINT);
+
+    /* a job completes synchronously from within the start function. */
+    _test_parallel(3, 10, G_MAXUINT, 0, G_MAXUINT);
+    _test_parallel(3, 10, 4, 5, G_MAXUINT);
+
+    /* cancellation stops starting new jobs. */
+    _test_parallel(2, 10, G_MAXUINT, G_MAXUINT, 0);
+    _test_parallel(2, 10, G_MAXUINT, G_MAXUINT, 4);
+    _test_parallel(2, 10, 3, G_MAXUINT, 4);
+}
+
+static void
+test_parallel_get_max(void)
+{
+    g_unsetenv("NM_CLOUD_SETUP_MAX_PARALLEL");
+    g_assert_cmpint(nmcs_utils_parallel_get_max(8), ==, 8);
+
+    g_setenv("NM_CLOUD_SETUP_MAX_PARALLEL", "3", TRUE);
+    g_assert_cmpint(nmcs_utils_parallel_get_max(8), ==, 3);
+    _test_parallel(nmcs_utils_parallel_get_max(8), 10, G_MAXUINT, G_MAXUINT, G_MAXUINT);
+
+    g_setenv("NM_CLOUD_SETUP_MAX_PARALLEL", "1", TRUE);
+    g_assert_cmpint(nmcs_utils_parallel_get_max(8), ==, 1);
+
+    /* invalid values are ignored. */
+    g_setenv("NM_CLOUD_SETUP_MAX_PARALLEL", "0", TRUE);
+    g_assert_cmpint(nmcs_utils_parallel_get_max(8), ==, 8);
+    g_setenv("NM_CLOUD_SETUP_MAX_PARALLEL", "many", TRUE);
+    g_assert_cmpint(nmcs_utils_parallel_get_max(8), ==, 8);
+
+    g_unsetenv("NM_CLOUD_SETUP_MAX_PARALLEL");
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -112,6 +465,9 @@ main(int argc, char **argv)
     nmtst_init(&argc, &argv, TRUE);
 
     g_test_add_func("/cloud-setup/general/replace-ipv4-addresses", test_replace_ipv4_addresses);
+    g_test_add_func("/cloud-setup/general/provider-ec2-mock-server", test_provider_ec2_mock_server);
+    g_test_add_func("/cloud-setup/general/parallel", test_parallel);
+    g_test_add_func("/cloud-setup/general/parallel-get-max", test_parallel_get_max);
 
     return g_test_run();
 }
@@ -7,6 +7,10 @@
 
 #include "nm-dispatcher-utils.h"
 
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "nm-dbus-interface.h"
 #include "nm-connection.h"
 #include "nm-setting-ip4-config.h"
@@ -579,3 +583,454 @@ done:
     g_ptr_array_add(items, NULL);
     return (char **) g_ptr_array_free(g_steal_pointer(&items), FALSE);
 }
+
+/*****************************************************************************/
+
+struct _NMDispatcherScriptCache {
+    /* the NMLIBDIR and NMCONFDIR directories that contain the scripts. A
+     * script in the second directory takes precedence over a script with
+     * the same name in the first one. */
+    char *dirnames[2];
+
+    /* the sorted list of NMDispatcherScript found in @dirnames, and the
+     * warnings about them. %NULL, if the directories must be scanned. */
+    GPtrArray *scripts;
+    GPtrArray *warnings;
+
+    /* watches the directories and the directories of the link targets,
+     * or -1. Any event invalidates @scripts. */
+    int inotify_fd;
+};
+
+#define SCRIPT_CACHE_WATCH_MASK                                                                   \
+    (IN_ATTRIB | IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO \
+     | IN_DELETE_SELF | IN_MOVE_SELF)
+
+static gboolean
+_script_check_permissions(const struct stat *s, const char **out_error_msg)
+{
+    /* Only accept files owned by root */
+    if (s->st_uid != 0) {
+        *out_error_msg = "not owned by root.";
+        return FALSE;
+    }
+
+    /* Only accept files not writable by group or other, and not SUID */
+    if (s->st_mode & (S_IWGRP | S_IWOTH | S_ISUID)) {
+        *out_error_msg = "writable by group or other, or set-UID.";
+        return FALSE;
+    }
+
+    /* Only accept files executable by the owner */
+    if (!(s->st_mode & S_IXUSR)) {
+        *out_error_msg = "not executable by owner.";
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+_script_check_filename(const char *file_name)
+{
+    static const char *bad_suffixes[] = {
+        "~",
+        ".rpmsave",
+        ".rpmorig",
+        ".rpmnew",
+        ".swp",
+    };
+    char *tmp;
+    guint i;
+
+    /* File must not be a backup file, package management file, or start with '.' */
+
+    if (file_name[0] == '.')
+        return FALSE;
+    for (i = 0; i < G_N_ELEMENTS(bad_suffixes); i++) {
+        if (g_str_has_suffix(file_name, bad_suffixes[i]))
+            return FALSE;
+    }
+    tmp = g_strrstr(file_name, ".dpkg-");
+    if (tmp && !strchr(&tmp[1], '.'))
+        return FALSE;
+    return TRUE;
+}
+
+static int
+_script_cmp(gconstpointer a, gconstpointer b)
+{
+    const NMDispatcherScript *script_a = *((const NMDispatcherScript *const *) a);
+    const NMDispatcherScript *script_b = *((const NMDispatcherScript *const *) b);
+    const char *              basename_a;
+    const char *              basename_b;
+
+    basename_a = strrchr(script_a->path, '/');
+    basename_b = strrchr(script_b->path, '/');
+    nm_assert(basename_a);
+    nm_assert(basename_b);
+
+    return strcmp(++basename_a, ++basename_b);
+}
+
+static void
+_script_free(gpointer ptr)
+{
+    NMDispatcherScript *script = ptr;
+
+    g_free(script->path);
+    g_slice_free(NMDispatcherScript, script);
+}
+
+static void
+_script_cache_watch(NMDispatcherScriptCache *cache, const char *dirname)
+{
+    gs_free char *path = g_strdup(dirname);
+
+    if (cache->inotify_fd < 0)
+        return;
+
+    /* if the directory does not exist, watch the first parent directory that
+     * exists, to notice when it gets created. */
+    while (inotify_add_watch(cache->inotify_fd, path, SCRIPT_CACHE_WATCH_MASK) < 0) {
+        char *parent;
+
+        if (errno != ENOENT || nm_streq(path, "/")) {
+            /* without the watch, changes would go unnoticed. Don't cache. */
+            nm_close(cache->inotify_fd);
+            cache->inotify_fd = -1;
+            return;
+        }
+
+        parent = g_path_get_dirname(path);
+        g_free(path);
+        path = parent;
+    }
+}
+
+static gboolean
+_script_cache_changed(NMDispatcherScriptCache *cache)
+{
+    char   buf[sizeof(struct inotify_event) + NAME_MAX + 1];
+    gssize n;
+
+    if (cache->inotify_fd < 0)
+        return TRUE;
+
+    /* we don't care which file changed, only whether anything did. */
+    n = read(cache->inotify_fd, buf, sizeof(buf));
+    if (n < 0 && NM_IN_SET(errno, EAGAIN, EINTR))
+        return FALSE;
+
+    nm_close(cache->inotify_fd);
+    cache->inotify_fd = -1;
+    return TRUE;
+}
+
+static void
+_script_cache_check(NMDispatcherScriptCache *cache, NMDispatcherScript *script)
+{
+    gs_free char *link = NULL;
+    gboolean      wait = TRUE;
+    struct stat   st;
+    const char *  err_msg = NULL;
+
+    link = g_file_read_link(script->path, NULL);
+    if (link) {
+        gs_free char *     dir  = NULL;
+        nm_auto_free char *real = NULL;
+
+        /* the script is masked. */
+        if (nm_streq(link, "/dev/null"))
+            return;
+
+        if (!g_path_is_absolute(link)) {
+            char *tmp;
+
+            dir = g_path_get_dirname(script->path);
+            tmp = g_build_path("/", dir, link, NULL);
+            g_free(link);
+            g_free(dir);
+            link = tmp;
+        }
+
+        /* the script can change without touching the link. */
+        dir = g_path_get_dirname(link);
+        _script_cache_watch(cache, dir);
+
+        real = realpath(dir, NULL);
+        if (NM_STR_HAS_SUFFIX(real, "/no-wait.d"))
+            wait = FALSE;
+    }
+
+    if (stat(script->path, &st) != 0) {
+        int errsv = errno;
+
+        g_ptr_array_add(
+            cache->warnings,
+            g_strdup_printf("Failed to stat '%s': %s", script->path, nm_strerror_native(errsv)));
+    } else if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        /* silently skip. */
+    } else if (!_script_check_permissions(&st, &err_msg)) {
+        g_ptr_array_add(cache->warnings,
+                        g_strdup_printf("Cannot execute '%s': %s", script->path, err_msg));
+    } else {
+        script->valid = TRUE;
+        script->wait  = wait;
+    }
+}
+
+static void
+_script_cache_scan(NMDispatcherScriptCache *cache)
+{
+    gs_unref_hashtable GHashTable *paths = NULL;
+    GHashTableIter                 iter;
+    const char *                   path;
+    guint                          i;
+
+    nm_assert(cache->inotify_fd < 0);
+
+    cache->scripts  = g_ptr_array_new_with_free_func(_script_free);
+    cache->warnings = g_ptr_array_new_with_free_func(g_free);
+
+    /* watch first, so that changes during the scan invalidate the result. */
+    cache->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    for (i = 0; i < G_N_ELEMENTS(cache->dirnames); i++)
+        _script_cache_watch(cache, cache->dirnames[i]);
+
+    paths = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, g_free);
+
+    for (i = 0; i < G_N_ELEMENTS(cache->dirnames); i++) {
+        gs_free_error GError *error = NULL;
+        const char *          filename;
+        GDir *                dir;
+
+        if (!(dir = g_dir_open(cache->dirnames[i], 0, &error))) {
+            if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+                g_ptr_array_add(cache->warnings,
+                                g_strdup_printf("Failed to open dispatcher directory '%s': %s",
+                                                cache->dirnames[i],
+                                                error->message));
+            }
+            continue;
+        }
+
+        while ((filename = g_dir_read_name(dir))) {
+            if (!_script_check_filename(filename))
+                continue;
+
+            g_hash_table_insert(paths,
+                                g_strdup(filename),
+                                g_build_filename(cache->dirnames[i], filename, NULL));
+        }
+
+        g_dir_close(dir);
+    }
+
+    g_hash_table_iter_init(&iter, paths);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &path)) {
+        NMDispatcherScript *script;
+
+        script  = g_slice_new(NMDispatcherScript);
+        *script = (NMDispatcherScript){
+            .path  = g_strdup(path),
+            .valid = FALSE,
+            .wait  = TRUE,
+        };
+        g_ptr_array_add(cache->scripts, script);
+    }
+
+    g_ptr_array_sort(cache->scripts, _script_cmp);
+
+    for (i = 0; i < cache->scripts->len; i++)
+        _script_cache_check(cache, cache->scripts->pdata[i]);
+
+    g_ptr_array_add(cache->warnings, NULL);
+}
+
+NMDispatcherScriptCache *
+nm_dispatcher_script_cache_new(const char *dirname_lib, const char *dirname_conf)
+{
+    NMDispatcherScriptCache *cache;
+
+    cache  = g_slice_new(NMDispatcherScriptCache);
+    *cache = (NMDispatcherScriptCache){
+        .dirnames   = {g_strdup(dirname_lib), g_strdup(dirname_conf)},
+        .inotify_fd = -1,
+    };
+    return cache;
+}
+
+void
+nm_dispatcher_script_cache_free(NMDispatcherScriptCache *cache)
+{
+    if (!cache)
+        return;
+
+    nm_clear_pointer(&cache->scripts, g_ptr_array_unref);
+    nm_clear_pointer(&cache->warnings, g_ptr_array_unref);
+    if (cache->inotify_fd >= 0)
+        nm_close(cache->inotify_fd);
+    g_free(cache->dirnames[0]);
+    g_free(cache->dirnames[1]);
+    g_slice_free(NMDispatcherScriptCache, cache);
+}
+
+/**
+ * nm_dispatcher_script_cache_get:
+ * @cache: the script cache
+ * @out_warnings: (out) (allow-none) (transfer none): %NULL terminated list
+ *   of the problems with the directories and the scripts, to be logged.
+ * @out_cached: (out) (allow-none): whether the result was taken from the cache.
+ *
+ * The scripts are only searched again if the directories, the scripts or
+ * the targets of links changed since the last call. That is detected via
+ * inotify, so the cost of the call does not depend on the number of scripts.
+ *
+ * Returns: (transfer none) (element-type NMDispatcherScript): the scripts,
+ *   sorted by their name. Only the scripts that are valid may be run. The
+ *   list stays valid until the next call.
+ */
+const GPtrArray *
+nm_dispatcher_script_cache_get(NMDispatcherScriptCache *cache,
+                               const char *const **     out_warnings,
+                               gboolean *               out_cached)
+{
+    gboolean cached = TRUE;
+
+    g_return_val_if_fail(cache, NULL);
+
+    if (!cache->scripts || _script_cache_changed(cache)) {
+        nm_clear_pointer(&cache->scripts, g_ptr_array_unref);
+        nm_clear_pointer(&cache->warnings, g_ptr_array_unref);
+        _script_cache_scan(cache);
+        cached = FALSE;
+    }
+
+    NM_SET_OUT(out_warnings, (const char *const *) cache->warnings->pdata);
+    NM_SET_OUT(out_cached, cached);
+    return cache->scripts;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    const char *key;
+    gpointer    request;
+} RequestQueueEntry;
+
+struct _NMDispatcherRequestQueue {
+    /* the RequestQueueEntry of the requests that wait to be started, in the
+     * order in which they were pushed. */
+    GQueue waiting;
+
+    /* maps the key to the running request. */
+    GHashTable *running;
+};
+
+NMDispatcherRequestQueue *
+nm_dispatcher_request_queue_new(void)
+{
+    NMDispatcherRequestQueue *queue;
+
+    queue  = g_slice_new(NMDispatcherRequestQueue);
+    *queue = (NMDispatcherRequestQueue){
+        .waiting = G_QUEUE_INIT,
+        .running = g_hash_table_new(nm_str_hash, g_str_equal),
+    };
+    return queue;
+}
+
+void
+nm_dispatcher_request_queue_free(NMDispatcherRequestQueue *queue)
+{
+    nm_assert(nm_dispatcher_request_queue_is_empty(queue));
+
+    g_hash_table_unref(queue->running);
+    g_slice_free(NMDispatcherRequestQueue, queue);
+}
+
+gboolean
+nm_dispatcher_request_queue_is_empty(const NMDispatcherRequestQueue *queue)
+{
+    return g_queue_is_empty(&queue->waiting) && g_hash_table_size(queue->running) == 0;
+}
+
+/**
+ * nm_dispatcher_request_queue_push:
+ * @queue: the queue
+ * @key: the key of the request. The string must stay valid until
+ *   nm_dispatcher_request_queue_done() is called for the request.
+ * @request: the request
+ *
+ * Enqueues @request. It gets started by nm_dispatcher_request_queue_start_next().
+ */
+void
+nm_dispatcher_request_queue_push(NMDispatcherRequestQueue *queue,
+                                 const char *              key,
+                                 gpointer                  request)
+{
+    RequestQueueEntry *entry;
+
+    entry  = g_slice_new(RequestQueueEntry);
+    *entry = (RequestQueueEntry){
+        .key     = key,
+        .request = request,
+    };
+    g_queue_push_tail(&queue->waiting, entry);
+}
+
+/**
+ * nm_dispatcher_request_queue_start_next:
+ * @queue: the queue
+ * @max_parallel: up to how many requests may run at the same time
+ *
+ * Looks for the first waiting request, for whose key no request is running,
+ * and marks it as running. Later requests may overtake waiting requests
+ * with a different key, but never those with the same key.
+ *
+ * Returns: the request to start, or %NULL if there is none or if already
+ *   @max_parallel requests are running.
+ */
+gpointer
+nm_dispatcher_request_queue_start_next(NMDispatcherRequestQueue *queue, guint max_parallel)
+{
+    GList *iter;
+
+    if (g_hash_table_size(queue->running) >= max_parallel)
+        return NULL;
+
+    for (iter = queue->waiting.head; iter; iter = iter->next) {
+        RequestQueueEntry *entry = iter->data;
+        gpointer           request;
+
+        if (g_hash_table_contains(queue->running, entry->key))
+            continue;
+
+        request = entry->request;
+        g_hash_table_insert(queue->running, (gpointer) entry->key, request);
+        g_queue_delete_link(&queue->waiting, iter);
+        g_slice_free(RequestQueueEntry, entry);
+        return request;
+    }
+    return NULL;
+}
+
+/**
+ * nm_dispatcher_request_queue_done:
+ * @queue: the queue
+ * @key: the key of the request
+ * @request: the running request that completed
+ *
+ * Marks @request as no longer running. The next request with the same key
+ * may start now.
+ */
+void
+nm_dispatcher_request_queue_done(NMDispatcherRequestQueue *queue,
+                                 const char *              key,
+                                 gpointer                  request)
+{
+    nm_assert(g_hash_table_lookup(queue->running, key) == request);
+
+    g_hash_table_remove(queue->running, key);
+}
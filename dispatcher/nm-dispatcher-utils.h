@@ -23,4 +23,52 @@ char **nm_dispatcher_utils_construct_envp(const char * action,
                                           char **      out_iface,
                                           const char **out_error_message);
 
+/*****************************************************************************/
+
+typedef struct {
+    char *path;
+
+    /* whether @path is a script that we may execute. */
+    bool valid : 1;
+
+    /* whether the script is run ordered (not linked into no-wait.d). */
+    bool wait : 1;
+} NMDispatcherScript;
+
+typedef struct _NMDispatcherScriptCache NMDispatcherScriptCache;
+
+NMDispatcherScriptCache *nm_dispatcher_script_cache_new(const char *dirname_lib,
+                                                        const char *dirname_conf);
+
+void nm_dispatcher_script_cache_free(NMDispatcherScriptCache *cache);
+
+const GPtrArray *nm_dispatcher_script_cache_get(NMDispatcherScriptCache *cache,
+                                                const char *const **     out_warnings,
+                                                gboolean *               out_cached);
+
+/*****************************************************************************/
+
+/* Ordered requests are started in the order in which they were received. But
+ * only one request per key (the interface) runs at a time, and the number of
+ * running requests is limited. */
+
+typedef struct _NMDispatcherRequestQueue NMDispatcherRequestQueue;
+
+NMDispatcherRequestQueue *nm_dispatcher_request_queue_new(void);
+
+void nm_dispatcher_request_queue_free(NMDispatcherRequestQueue *queue);
+
+gboolean nm_dispatcher_request_queue_is_empty(const NMDispatcherRequestQueue *queue);
+
+void nm_dispatcher_request_queue_push(NMDispatcherRequestQueue *queue,
+                                      const char *              key,
+                                      gpointer                  request);
+
+gpointer nm_dispatcher_request_queue_start_next(NMDispatcherRequestQueue *queue,
+                                                guint                     max_parallel);
+
+void nm_dispatcher_request_queue_done(NMDispatcherRequestQueue *queue,
+                                      const char *              key,
+                                      gpointer                  request);
+
 #endif /* __NETWORKMANAGER_DISPATCHER_UTILS_H__ */
@@ -33,9 +33,16 @@ static struct {
     gboolean         ever_acquired_name;
     bool             exit_with_failure;
 
-    Request *current_request;
-    GQueue * requests_waiting;
-    int      num_requests_pending;
+    /* Requests that have "wait" scripts are ordered. They get queued in
+     * @requests_queue and are started in order, but only one request per
+     * interface runs at a time (see _request_get_key()). At most @max_parallel
+     * requests run at the same time. */
+    NMDispatcherRequestQueue *requests_queue;
+    int                       num_requests_pending;
+    int                       max_parallel;
+
+    /* cached scripts, for the regular actions, for pre-up and for pre-down. */
+    NMDispatcherScriptCache *script_cache[3];
 } gl;
 
 typedef struct {
@@ -49,6 +56,8 @@ typedef struct {
     gboolean       dispatched;
     guint          watch_id;
     guint          timeout_id;
+    gint64         start_time_usec;
+    gint64         duration_msec;
 } ScriptInfo;
 
 struct Request {
@@ -59,6 +68,9 @@ struct Request {
     char *                 iface;
     char **                envp;
     gboolean               debug;
+    gint64                 start_time_usec;
+    gboolean               running;
+    gboolean               action2;
 
     GPtrArray *scripts; /* list of ScriptInfo */
     guint      idx;
@@ -158,6 +170,7 @@ struct Request {
 /*****************************************************************************/
 
 static gboolean dispatch_one_script(Request *request);
+static void     complete_request(Request *request);
 
 /*****************************************************************************/
 
@@ -202,44 +215,45 @@ quit_timeout_reschedule(void)
     }
 }
 
+static const char *
+_request_get_key(const Request *request)
+{
+    /* ordered requests for the same interface are run one after the other.
+     * Requests without interface (like "hostname") are ordered among
+     * themselves. */
+    return request->iface ?: "";
+}
+
 /**
- * next_request:
- *
- * @request: (allow-none): the request to set as next. If %NULL, dequeue the next
- * waiting request. Otherwise, try to set the given request.
+ * schedule_requests:
  *
- * Sets the currently active request (@current_request). The current request
- * is a request that has at least on "wait" script, because requests that only
- * consist of "no-wait" scripts are handled right away and not enqueued to
- * @requests_waiting nor set as @current_request.
+ * Starts waiting requests in the order in which they were received. A request
+ * is started, if there is no other request for the same interface running
+ * and if less than @max_parallel requests are running.
  *
- * Returns: %TRUE, if there was currently not request in process and it set
- * a new request as current.
+ * Only requests that have at least one "wait" script are enqueued to
+ * @requests_queue. Requests that only consist of "no-wait" scripts are handled
+ * right away.
  */
-static gboolean
-next_request(Request *request)
+static void
+schedule_requests(void)
 {
-    if (request) {
-        if (gl.current_request) {
-            g_queue_push_tail(gl.requests_waiting, request);
-            return FALSE;
-        }
-    } else {
-        /* when calling next_request() without explicit @request, we always
-         * forcefully clear @current_request. That one is certainly
-         * handled already. */
-        gl.current_request = NULL;
-
-        request = g_queue_pop_head(gl.requests_waiting);
-        if (!request)
-            return FALSE;
-    }
+    Request *request;
 
-    _LOG_R_D(request, "start running ordered scripts...");
+    while ((request = nm_dispatcher_request_queue_start_next(gl.requests_queue,
+                                                             gl.max_parallel))) {
+        _LOG_R_D(request,
+                 "start running ordered scripts (waited %" G_GINT64_FORMAT " msec)...",
+                 (g_get_monotonic_time() - request->start_time_usec) / 1000);
 
-    gl.current_request = request;
+        request->running = TRUE;
 
-    return TRUE;
+        if (!dispatch_one_script(request)) {
+            /* Nothing to wait for. Try to complete the request. It will be either
+             * completed now, or when all pending "no-wait" scripts return. */
+            complete_request(request);
+        }
+    }
 }
 
 /**
@@ -264,30 +278,58 @@ complete_request(Request *request)
     if (request->num_scripts_done < request->scripts->len)
         return;
 
-    g_variant_builder_init(&results, G_VARIANT_TYPE("a(sus)"));
-    for (i = 0; i < request->scripts->len; i++) {
-        ScriptInfo *script = g_ptr_array_index(request->scripts, i);
-
-        g_variant_builder_add(&results,
-                              "(sus)",
-                              script->script,
-                              script->result,
-                              script->error ?: "");
+    if (request->action2) {
+        /* "Action2" also returns details about each script, like how long it ran. */
+        g_variant_builder_init(&results, G_VARIANT_TYPE("a(susa{sv})"));
+        for (i = 0; i < request->scripts->len; i++) {
+            ScriptInfo *    script = g_ptr_array_index(request->scripts, i);
+            GVariantBuilder details;
+
+            g_variant_builder_init(&details, G_VARIANT_TYPE_VARDICT);
+            if (script->duration_msec >= 0) {
+                g_variant_builder_add(
+                    &details,
+                    "{sv}",
+                    "duration-msec",
+                    g_variant_new_uint32(MIN(script->duration_msec, (gint64) G_MAXUINT32)));
+            }
+            g_variant_builder_add(&results,
+                                  "(susa{sv})",
+                                  script->script,
+                                  script->result,
+                                  script->error ?: "",
+                                  &details);
+        }
+        ret = g_variant_new("(a(susa{sv}))", &results);
+    } else {
+        g_variant_builder_init(&results, G_VARIANT_TYPE("a(sus)"));
+        for (i = 0; i < request->scripts->len; i++) {
+            ScriptInfo *script = g_ptr_array_index(request->scripts, i);
+
+            g_variant_builder_add(&results,
+                                  "(sus)",
+                                  script->script,
+                                  script->result,
+                                  script->error ?: "");
+        }
+        ret = g_variant_new("(a(sus))", &results);
     }
 
-    ret = g_variant_new("(a(sus))", &results);
     g_dbus_method_invocation_return_value(request->context, ret);
 
-    _LOG_R_T(request, "completed (%u scripts)", request->scripts->len);
+    _LOG_R_T(request,
+             "completed (%u scripts) after %" G_GINT64_FORMAT " msec",
+             request->scripts->len,
+             (g_get_monotonic_time() - request->start_time_usec) / 1000);
 
-    if (gl.current_request == request)
-        gl.current_request = NULL;
+    if (request->running)
+        nm_dispatcher_request_queue_done(gl.requests_queue, _request_get_key(request), request);
 
     request_free(request);
 
     g_assert_cmpuint(gl.num_requests_pending, >, 0);
     if (--gl.num_requests_pending <= 0) {
-        nm_assert(!gl.current_request && !g_queue_peek_head(gl.requests_waiting));
+        nm_assert(nm_dispatcher_request_queue_is_empty(gl.requests_queue));
         quit_timeout_reschedule();
     }
 }
@@ -295,65 +337,32 @@ complete_request(Request *request)
 static void
 complete_script(ScriptInfo *script)
 {
-    Request *request;
-    gboolean wait = script->wait;
+    Request *request = script->request;
 
-    request = script->request;
+    script->duration_msec = (g_get_monotonic_time() - script->start_time_usec) / 1000;
+
+    _LOG_S_T(script, "finished after %" G_GINT64_FORMAT " msec", script->duration_msec);
+
+    if (script->wait) {
+        nm_assert(request->running);
 
-    if (wait) {
         /* for "wait" scripts, try to schedule the next blocking script.
          * If that is successful, return (as we must wait for its completion). */
         if (dispatch_one_script(request))
             return;
+    } else if (request->running && request->num_scripts_nowait == 0) {
+        /* this was the last "no-wait" script of a running request. The
+         * "wait" scripts were waiting for it, launch them now. */
+        if (dispatch_one_script(request))
+            return;
     }
 
-    nm_assert(!wait || gl.current_request == request);
-
     /* Try to complete the request. @request will be possibly free'd,
-     * making @script and @request a dangling pointer. */
+     * making @script and @request a dangling pointer. If it was running,
+     * that makes room for the next requests. */
     complete_request(request);
 
-    if (!wait) {
-        /* this was a "no-wait" script. We either completed the request,
-         * or there is nothing to do. Especially, there is no need to
-         * queue the next_request() -- because no-wait scripts don't block
-         * requests. However, if this was the last "no-wait" script and
-         * there are "wait" scripts ready to run, launch them.
-         */
-        if (gl.current_request == request && gl.current_request->num_scripts_nowait == 0) {
-            if (dispatch_one_script(gl.current_request))
-                return;
-
-            complete_request(gl.current_request);
-        } else
-            return;
-    } else {
-        /* if the script is a "wait" script, we already tried above to
-         * dispatch the next script. As we didn't do that, it means we
-         * just completed the last script of @request and we can continue
-         * with the next request...
-         *
-         * Also, it cannot be that there is another request currently being
-         * processed because only requests with "wait" scripts can become
-         * @current_request. As there can only be one "wait" script running
-         * at any time, it means complete_request() above completed @request. */
-        nm_assert(!gl.current_request);
-    }
-
-    while (next_request(NULL)) {
-        request = gl.current_request;
-
-        if (dispatch_one_script(request))
-            return;
-
-        /* Try to complete the request. It will be either completed
-         * now, or when all pending "no-wait" scripts return. */
-        complete_request(request);
-
-        /* We can immediately start next_request(), because our current
-         * @request has obviously no more "wait" scripts either.
-         * Repeat... */
-    }
+    schedule_requests();
 }
 
 static void
@@ -431,61 +440,6 @@ again:
     return FALSE;
 }
 
-static gboolean
-check_permissions(struct stat *s, const char **out_error_msg)
-{
-    g_return_val_if_fail(s != NULL, FALSE);
-    g_return_val_if_fail(out_error_msg != NULL, FALSE);
-    g_return_val_if_fail(*out_error_msg == NULL, FALSE);
-
-    /* Only accept files owned by root */
-    if (s->st_uid != 0) {
-        *out_error_msg = "not owned by root.";
-        return FALSE;
-    }
-
-    /* Only accept files not writable by group or other, and not SUID */
-    if (s->st_mode & (S_IWGRP | S_IWOTH | S_ISUID)) {
-        *out_error_msg = "writable by group or other, or set-UID.";
-        return FALSE;
-    }
-
-    /* Only accept files executable by the owner */
-    if (!(s->st_mode & S_IXUSR)) {
-        *out_error_msg = "not executable by owner.";
-        return FALSE;
-    }
-
-    return TRUE;
-}
-
-static gboolean
-check_filename(const char *file_name)
-{
-    static const char *bad_suffixes[] = {
-        "~",
-        ".rpmsave",
-        ".rpmorig",
-        ".rpmnew",
-        ".swp",
-    };
-    char *tmp;
-    guint i;
-
-    /* File must not be a backup file, package management file, or start with '.' */
-
-    if (file_name[0] == '.')
-        return FALSE;
-    for (i = 0; i < G_N_ELEMENTS(bad_suffixes); i++) {
-        if (g_str_has_suffix(file_name, bad_suffixes[i]))
-            return FALSE;
-    }
-    tmp = g_strrstr(file_name, ".dpkg-");
-    if (tmp && !strchr(&tmp[1], '.'))
-        return FALSE;
-    return TRUE;
-}
-
 #define SCRIPT_TIMEOUT 600 /* 10 minutes */
 
 static gboolean
@@ -525,6 +479,8 @@ script_dispatch(ScriptInfo *script)
         return FALSE;
     }
 
+    script->start_time_usec = g_get_monotonic_time();
+
     script->watch_id   = g_child_watch_add(script->pid, (GChildWatchFunc) script_watch_cb, script);
     script->timeout_id = g_timeout_add_seconds(SCRIPT_TIMEOUT, script_timeout_cb, script);
     if (!script->wait)
@@ -548,132 +504,49 @@ dispatch_one_script(Request *request)
     return FALSE;
 }
 
-static int
-_compare_basenames(gconstpointer a, gconstpointer b)
-{
-    const char *basename_a = strrchr(a, '/');
-    const char *basename_b = strrchr(b, '/');
-    int         ret;
-
-    nm_assert(basename_a);
-    nm_assert(basename_b);
-
-    ret = strcmp(++basename_a, ++basename_b);
-    if (ret)
-        return ret;
-
-    nm_assert_not_reached();
-    return 0;
-}
-
-static void
-_find_scripts(Request *request, GHashTable *scripts, const char *base, const char *subdir)
-{
-    const char *  filename;
-    gs_free char *dirname = NULL;
-    GError *      error   = NULL;
-    GDir *        dir;
-
-    dirname = g_build_filename(base, "dispatcher.d", subdir, NULL);
-
-    if (!(dir = g_dir_open(dirname, 0, &error))) {
-        if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
-            _LOG_R_W(request,
-                     "find-scripts: Failed to open dispatcher directory '%s': %s",
-                     dirname,
-                     error->message);
-        }
-        g_error_free(error);
-        return;
-    }
-
-    while ((filename = g_dir_read_name(dir))) {
-        if (!check_filename(filename))
-            continue;
-
-        g_hash_table_insert(scripts, g_strdup(filename), g_build_filename(dirname, filename, NULL));
-    }
-
-    g_dir_close(dir);
-}
-
-static GSList *
+/**
+ * find_scripts:
+ * @request: the request
+ *
+ * Returns: (transfer none) (element-type NMDispatcherScript): the sorted
+ *   list of scripts for the action of @request. Only the entries that are
+ *   valid may be run.
+ */
+static const GPtrArray *
 find_scripts(Request *request)
 {
-    gs_unref_hashtable GHashTable *scripts     = NULL;
-    GSList *                       script_list = NULL;
-    GHashTableIter                 iter;
-    const char *                   subdir;
-    char *                         path;
-    char *                         filename;
-
-    if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_UP, NMD_ACTION_VPN_PRE_UP))
-        subdir = "pre-up.d";
-    else if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_DOWN, NMD_ACTION_VPN_PRE_DOWN))
-        subdir = "pre-down.d";
-    else
-        subdir = NULL;
-
-    scripts = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, g_free);
-
-    _find_scripts(request, scripts, NMLIBDIR, subdir);
-    _find_scripts(request, scripts, NMCONFDIR, subdir);
-
-    g_hash_table_iter_init(&iter, scripts);
-    while (g_hash_table_iter_next(&iter, (gpointer *) &filename, (gpointer *) &path)) {
-        gs_free char *link_target = NULL;
-        const char *  err_msg     = NULL;
-        struct stat   st;
-        int           err;
-
-        link_target = g_file_read_link(path, NULL);
-        if (nm_streq0(link_target, "/dev/null"))
-            continue;
-
-        err = stat(path, &st);
-        if (err)
-            _LOG_R_W(request, "find-scripts: Failed to stat '%s': %d", path, err);
-        else if (!S_ISREG(st.st_mode) || st.st_size == 0) {
-            /* silently skip. */
-        } else if (!check_permissions(&st, &err_msg))
-            _LOG_R_W(request, "find-scripts: Cannot execute '%s': %s", path, err_msg);
-        else {
-            /* success */
-            script_list = g_slist_prepend(script_list, g_strdup(path));
-            continue;
-        }
+    NMDispatcherScriptCache **p_cache;
+    const char *const *       warnings;
+    const GPtrArray *         scripts;
+    const char *              subdir;
+    gboolean                  cached;
+    guint                     i;
+
+    if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_UP, NMD_ACTION_VPN_PRE_UP)) {
+        subdir  = "pre-up.d";
+        p_cache = &gl.script_cache[1];
+    } else if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_DOWN, NMD_ACTION_VPN_PRE_DOWN)) {
+        subdir  = "pre-down.d";
+        p_cache = &gl.script_cache[2];
+    } else {
+        subdir  = NULL;
+        p_cache = &gl.script_cache[0];
     }
 
-    return g_slist_sort(script_list, _compare_basenames);
-}
-
-static gboolean
-script_must_wait(const char *path)
-{
-    gs_free char *link = NULL;
-
-    link = g_file_read_link(path, NULL);
-    if (link) {
-        gs_free char *     dir  = NULL;
-        nm_auto_free char *real = NULL;
+    if (!*p_cache) {
+        gs_free char *dirname_lib  = g_build_filename(NMLIBDIR, "dispatcher.d", subdir, NULL);
+        gs_free char *dirname_conf = g_build_filename(NMCONFDIR, "dispatcher.d", subdir, NULL);
 
-        if (!g_path_is_absolute(link)) {
-            char *tmp;
-
-            dir = g_path_get_dirname(path);
-            tmp = g_build_path("/", dir, link, NULL);
-            g_free(link);
-            g_free(dir);
-            link = tmp;
-        }
-
-        dir  = g_path_get_dirname(link);
-        real = realpath(dir, NULL);
-        if (NM_STR_HAS_SUFFIX(real, "/no-wait.d"))
-            return FALSE;
+        *p_cache = nm_dispatcher_script_cache_new(dirname_lib, dirname_conf);
     }
 
-    return TRUE;
+    scripts = nm_dispatcher_script_cache_get(*p_cache, &warnings, &cached);
+    if (cached)
+        _LOG_R_T(request, "find-scripts: use cached list of %u scripts", scripts->len);
+    for (i = 0; warnings[i]; i++)
+        _LOG_R_W(request, "find-scripts: %s", warnings[i]);
+
+    return scripts;
 }
 
 static void
@@ -693,9 +566,10 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
     gs_unref_variant GVariant *vpn_proxy_properties = NULL;
     gs_unref_variant GVariant *vpn_ip4_config       = NULL;
     gs_unref_variant GVariant *vpn_ip6_config       = NULL;
-    gboolean                   debug;
-    GSList *                   sorted_scripts = NULL;
-    GSList *                   iter;
+    gs_unref_variant GVariant *options = NULL;
+    gboolean                   debug   = FALSE;
+    guint32                    max_parallel;
+    const GPtrArray *          sorted_scripts;
     Request *                  request;
     char **                    p;
     guint                      i, num_nowait = 0;
@@ -717,7 +591,7 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
                   "@a{sv}"     /* vpn_proxy_properties */
                   "@a{sv}"     /* vpn_ip4_config */
                   "@a{sv}"     /* vpn_ip6_config */
-                  "b"          /* debug */
+                  "@*"         /* debug (Action) or options (Action2) */
                   ")",
                   &action,
                   &connection,
@@ -733,13 +607,27 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
                   &vpn_proxy_properties,
                   &vpn_ip4_config,
                   &vpn_ip6_config,
-                  &debug);
+                  &options);
+
+    if (g_variant_is_of_type(options, G_VARIANT_TYPE_BOOLEAN))
+        debug = g_variant_get_boolean(options);
+    else {
+        g_variant_lookup(options, "debug", "b", &debug);
+
+        /* the daemon sends its configured "main.dispatcher-max-parallel" with
+         * each request. The latest value applies. */
+        if (g_variant_lookup(options, "max-parallel", "u", &max_parallel))
+            gl.max_parallel = NM_CLAMP(max_parallel, 1u, (guint32) G_MAXINT);
+    }
 
     request             = g_slice_new0(Request);
     request->request_id = ++gl.request_id_counter;
     request->debug      = debug || gl.debug;
     request->context    = invocation;
     request->action     = g_strdup(action);
+    request->action2    = !g_variant_is_of_type(options, G_VARIANT_TYPE_BOOLEAN);
+
+    request->start_time_usec = g_get_monotonic_time();
 
     request->envp = nm_dispatcher_utils_construct_envp(action,
                                                        connection,
@@ -761,16 +649,20 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
     request->scripts = g_ptr_array_new_full(5, script_info_free);
 
     sorted_scripts = find_scripts(request);
-    for (iter = sorted_scripts; iter; iter = g_slist_next(iter)) {
-        ScriptInfo *s;
+    for (i = 0; i < sorted_scripts->len; i++) {
+        const NMDispatcherScript *entry = sorted_scripts->pdata[i];
+        ScriptInfo *              s;
+
+        if (!entry->valid)
+            continue;
 
-        s          = g_slice_new0(ScriptInfo);
-        s->request = request;
-        s->script  = iter->data;
-        s->wait    = script_must_wait(s->script);
+        s                = g_slice_new0(ScriptInfo);
+        s->request       = request;
+        s->script        = g_strdup(entry->path);
+        s->wait          = entry->wait;
+        s->duration_msec = -1;
         g_ptr_array_add(request->scripts, s);
     }
-    g_slist_free(sorted_scripts);
 
     _LOG_R_D(request, "new request (%u scripts)", request->scripts->len);
     if (_LOG_R_T_enabled(request) && request->envp) {
@@ -786,8 +678,15 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
         else
             _LOG_R_D(request, "completed: no scripts");
 
-        results = g_variant_new_array(G_VARIANT_TYPE("(sus)"), NULL, 0);
-        g_dbus_method_invocation_return_value(invocation, g_variant_new("(@a(sus))", results));
+        if (request->action2) {
+            results = g_variant_new_array(G_VARIANT_TYPE("(susa{sv})"), NULL, 0);
+            g_dbus_method_invocation_return_value(invocation,
+                                                  g_variant_new("(@a(susa{sv}))", results));
+        } else {
+            results = g_variant_new_array(G_VARIANT_TYPE("(sus)"), NULL, 0);
+            g_dbus_method_invocation_return_value(invocation,
+                                                  g_variant_new("(@a(sus))", results));
+        }
         request->num_scripts_done = request->scripts->len;
         request_free(request);
         return;
@@ -807,35 +706,18 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
     }
 
     if (num_nowait < request->scripts->len) {
-        /* The request has at least one wait script.
-         * Try next_request() to schedule the request for
-         * execution. This either enqueues the request or
-         * sets it as gl.current_request. */
-        if (next_request(request)) {
-            /* @request is now @current_request. Go ahead and
-             * schedule the first wait script. */
-            if (!dispatch_one_script(request)) {
-                /* If that fails, we might be already finished with the
-                 * request. Try complete_request(). */
-                complete_request(request);
-
-                if (next_request(NULL)) {
-                    /* As @request was successfully scheduled as next_request(), there is no
-                     * other request in queue that can be scheduled afterwards. Assert against
-                     * that, but call next_request() to clear current_request. */
-                    g_assert_not_reached();
-                }
-            }
-        }
+        /* The request has at least one wait script. Enqueue it, and
+         * start it right away if there is nothing else running for
+         * the same interface. */
+        nm_dispatcher_request_queue_push(gl.requests_queue, _request_get_key(request), request);
+        schedule_requests();
     } else {
         /* The request contains only no-wait scripts. Try to complete
          * the request right away (we might have failed to schedule any
          * of the scripts). It will be either completed now, or later
          * when the pending scripts return.
-         * We don't enqueue it to gl.requests_waiting.
-         * There is no need to handle next_request(), because @request is
-         * not the current request anyway and does not interfere with requests
-         * that have any "wait" scripts. */
+         * We don't enqueue it to gl.requests_queue, it does not
+         * interfere with requests that have any "wait" scripts. */
         complete_request(request);
     }
 }
@@ -876,7 +758,7 @@ _method_call(GDBusConnection *      connection,
              gpointer               user_data)
 {
     if (nm_streq(interface_name, NM_DISPATCHER_DBUS_INTERFACE)) {
-        if (nm_streq(method_name, "Action")) {
+        if (NM_IN_STRSET(method_name, "Action", "Action2")) {
             _method_call_action(invocation, parameters);
             return;
         }
@@ -910,7 +792,27 @@ static GDBusInterfaceInfo *const interface_info = NM_DEFINE_GDBUS_INTERFACE_INFO
                 NM_DEFINE_GDBUS_ARG_INFO("vpn_ip6_config", "a{sv}"),
                 NM_DEFINE_GDBUS_ARG_INFO("debug", "b"), ),
             .out_args =
-                NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("results", "a(sus)"), ), ), ), );
+                NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("results", "a(sus)"), ), ),
+        NM_DEFINE_GDBUS_METHOD_INFO(
+            "Action2",
+            .in_args = NM_DEFINE_GDBUS_ARG_INFOS(
+                NM_DEFINE_GDBUS_ARG_INFO("action", "s"),
+                NM_DEFINE_GDBUS_ARG_INFO("connection", "a{sa{sv}}"),
+                NM_DEFINE_GDBUS_ARG_INFO("connection_properties", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("device_properties", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("device_proxy_properties", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("device_ip4_config", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("device_ip6_config", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("device_dhcp4_config", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("device_dhcp6_config", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("connectivity_state", "s"),
+                NM_DEFINE_GDBUS_ARG_INFO("vpn_ip_iface", "s"),
+                NM_DEFINE_GDBUS_ARG_INFO("vpn_proxy_properties", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("vpn_ip4_config", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("vpn_ip6_config", "a{sv}"),
+                NM_DEFINE_GDBUS_ARG_INFO("options", "a{sv}"), ),
+            .out_args = NM_DEFINE_GDBUS_ARG_INFOS(
+                NM_DEFINE_GDBUS_ARG_INFO("results", "a(susa{sv})"), ), ), ), );
 
 static const GDBusInterfaceVTable interface_vtable = {
     .method_call = _method_call,
@@ -1004,6 +906,7 @@ main(int argc, char **argv)
     guint                 signal_id_int    = 0;
     guint                 dbus_regist_id   = 0;
     guint                 dbus_own_name_id = 0;
+    guint                 i;
 
     if (!parse_command_line(&argc, &argv, &error)) {
         _LOG_X_W("Error parsing command line arguments: %s", error->message);
@@ -1035,7 +938,9 @@ main(int argc, char **argv)
         goto done;
     }
 
-    gl.requests_waiting = g_queue_new();
+    gl.max_parallel = 1;
+
+    gl.requests_queue = nm_dispatcher_request_queue_new();
 
     dbus_regist_id =
         g_dbus_connection_register_object(gl.dbus_connection,
@@ -1086,7 +991,10 @@ done:
     if (dbus_regist_id != 0)
         g_dbus_connection_unregister_object(gl.dbus_connection, nm_steal_int(&dbus_regist_id));
 
-    nm_clear_pointer(&gl.requests_waiting, g_queue_free);
+    nm_clear_pointer(&gl.requests_queue, nm_dispatcher_request_queue_free);
+
+    for (i = 0; i < G_N_ELEMENTS(gl.script_cache); i++)
+        nm_clear_pointer(&gl.script_cache[i], nm_dispatcher_script_cache_free);
 
     nm_clear_g_source(&signal_id_term);
     nm_clear_g_source(&signal_id_int);
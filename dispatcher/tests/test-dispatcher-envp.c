@@ -7,6 +7,8 @@
 
 #include <arpa/inet.h>
 #include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "nm-dispatcher-utils.h"
 #include "nm-libnm-core-aux/nm-dispatcher-api.h"
@@ -615,6 +617,260 @@ test_gdbus_codegen(void)
 
 /*****************************************************************************/
 
+static void
+_script_write(const char *dirname, const char *name, mode_t mode)
+{
+    gs_free char *path = g_build_filename(dirname, name, NULL);
+
+    if (!g_file_set_contents(path, "#!/bin/sh\n", -1, NULL))
+        g_assert_not_reached();
+    g_assert_cmpint(chmod(path, mode), ==, 0);
+}
+
+static void
+_script_chmod(const char *dirname, const char *name, mode_t mode)
+{
+    gs_free char *path = g_build_filename(dirname, name, NULL);
+
+    g_assert_cmpint(chmod(path, mode), ==, 0);
+}
+
+static void
+_script_symlink(const char *target, const char *dirname, const char *name)
+{
+    gs_free char *path = g_build_filename(dirname, name, NULL);
+
+    g_assert_cmpint(symlink(target, path), ==, 0);
+}
+
+static void
+_script_unlink(const char *dirname, const char *name)
+{
+    gs_free char *path = g_build_filename(dirname, name, NULL);
+
+    g_assert_cmpint(unlink(path), ==, 0);
+}
+
+/* gets the scripts of @cache, and checks whether they were cached and
+ * whether they have the space separated names @expected. */
+static const GPtrArray *
+_script_cache_get(NMDispatcherScriptCache *cache, gboolean expect_cached, const char *expected)
+{
+    nm_auto_free_gstring GString *names = g_string_new(NULL);
+    const GPtrArray *             scripts;
+    const char *const *           warnings = NULL;
+    gboolean                      cached;
+    guint                         i;
+
+    scripts = nm_dispatcher_script_cache_get(cache, &warnings, &cached);
+    g_assert(scripts);
+    g_assert(warnings);
+    g_assert_cmpint(cached, ==, expect_cached);
+
+    for (i = 0; i < scripts->len; i++) {
+        const NMDispatcherScript *script = scripts->pdata[i];
+
+        if (i > 0)
+            g_string_append_c(names, ' ');
+        g_string_append(names, strrchr(script->path, '/') + 1);
+    }
+    g_assert_cmpstr(names->str, ==, expected);
+    return scripts;
+}
+
+static void
+test_script_cache(void)
+{
+    gs_free_error GError *    error   = NULL;
+    gs_free char *            dir     = NULL;
+    gs_free char *            lib     = NULL;
+    gs_free char *            conf    = NULL;
+    gs_free char *            nowait  = NULL;
+    const gboolean            is_root = (geteuid() == 0);
+    NMDispatcherScriptCache * cache;
+    const GPtrArray *         scripts;
+    const NMDispatcherScript *script;
+
+    dir = g_dir_make_tmp("nm-test-dispatcher-XXXXXX", &error);
+    nmtst_assert_success(dir, error);
+    lib    = g_build_filename(dir, "lib", NULL);
+    conf   = g_build_filename(dir, "conf", NULL);
+    nowait = g_build_filename(lib, "no-wait.d", NULL);
+
+    g_assert_cmpint(mkdir(lib, 0755), ==, 0);
+    _script_write(lib, "10-a", 0755);
+    _script_write(lib, "20-b", 0755);
+    _script_write(lib, "20-b~", 0755);
+
+    /* backup files are ignored, and the second directory does not exist yet. */
+    cache = nm_dispatcher_script_cache_new(lib, conf);
+    _script_cache_get(cache, FALSE, "10-a 20-b");
+    scripts = _script_cache_get(cache, TRUE, "10-a 20-b");
+    script  = scripts->pdata[0];
+    g_assert_cmpint(script->valid, ==, is_root);
+
+    /* the second directory gets created, with a script that takes precedence. */
+    g_assert_cmpint(mkdir(conf, 0755), ==, 0);
+    _script_cache_get(cache, FALSE, "10-a 20-b");
+    _script_cache_get(cache, TRUE, "10-a 20-b");
+
+    _script_write(conf, "20-b", 0755);
+    scripts = _script_cache_get(cache, FALSE, "10-a 20-b");
+    script  = scripts->pdata[1];
+    g_assert(g_str_has_prefix(script->path, conf));
+    _script_cache_get(cache, TRUE, "10-a 20-b");
+
+    /* the mode or the content of a script changes. */
+    _script_chmod(lib, "10-a", 0644);
+    scripts = _script_cache_get(cache, FALSE, "10-a 20-b");
+    script  = scripts->pdata[0];
+    g_assert(!script->valid);
+    _script_cache_get(cache, TRUE, "10-a 20-b");
+
+    _script_write(conf, "20-b", 0755);
+    _script_cache_get(cache, FALSE, "10-a 20-b");
+    _script_cache_get(cache, TRUE, "10-a 20-b");
+
+    /* a script linked into no-wait.d. The directory of the target is watched too. */
+    g_assert_cmpint(mkdir(nowait, 0755), ==, 0);
+    _script_write(nowait, "30-c", 0755);
+    _script_symlink("no-wait.d/30-c", lib, "30-c");
+    scripts = _script_cache_get(cache, FALSE, "10-a 20-b 30-c");
+    script  = scripts->pdata[2];
+    g_assert_cmpint(script->valid, ==, is_root);
+    g_assert_cmpint(script->wait, ==, !is_root);
+    _script_cache_get(cache, TRUE, "10-a 20-b 30-c");
+
+    _script_chmod(nowait, "30-c", 0644);
+    scripts = _script_cache_get(cache, FALSE, "10-a 20-b 30-c");
+    script  = scripts->pdata[2];
+    g_assert(!script->valid);
+    _script_cache_get(cache, TRUE, "10-a 20-b 30-c");
+
+    /* a link to /dev/null masks the script. */
+    _script_symlink("/dev/null", conf, "10-a");
+    scripts = _script_cache_get(cache, FALSE, "10-a 20-b 30-c");
+    script  = scripts->pdata[0];
+    g_assert(g_str_has_prefix(script->path, conf));
+    g_assert(!script->valid);
+
+    /* removing scripts. */
+    _script_unlink(conf, "20-b");
+    scripts = _script_cache_get(cache, FALSE, "10-a 20-b 30-c");
+    script  = scripts->pdata[1];
+    g_assert(g_str_has_prefix(script->path, lib));
+    _script_unlink(lib, "20-b");
+    _script_cache_get(cache, FALSE, "10-a 30-c");
+    _script_cache_get(cache, TRUE, "10-a 30-c");
+
+    nm_dispatcher_script_cache_free(cache);
+
+    _script_unlink(conf, "10-a");
+    _script_unlink(lib, "10-a");
+    _script_unlink(lib, "20-b~");
+    _script_unlink(lib, "30-c");
+    _script_unlink(nowait, "30-c");
+    g_assert_cmpint(rmdir(nowait), ==, 0);
+    g_assert_cmpint(rmdir(lib), ==, 0);
+    g_assert_cmpint(rmdir(conf), ==, 0);
+    g_assert_cmpint(rmdir(dir), ==, 0);
+}
+
+/*****************************************************************************/
+
+/* the requests are strings that name the interface and the action. */
+static void
+_queue_push(NMDispatcherRequestQueue *queue, const char *key, const char *request)
+{
+    nm_dispatcher_request_queue_push(queue, key, (gpointer) request);
+}
+
+static void
+_queue_start_next(NMDispatcherRequestQueue *queue, guint max_parallel, const char *expected)
+{
+    g_assert_cmpstr(nm_dispatcher_request_queue_start_next(queue, max_parallel), ==, expected);
+}
+
+static void
+test_request_queue(void)
+{
+    NMDispatcherRequestQueue *queue;
+
+    queue = nm_dispatcher_request_queue_new();
+    g_assert(nm_dispatcher_request_queue_is_empty(queue));
+    _queue_start_next(queue, 1, NULL);
+
+    /* with one request at a time, the requests run strictly one after the other. */
+    _queue_push(queue, "eth0", "eth0 up");
+    _queue_push(queue, "eth1", "eth1 up");
+    _queue_push(queue, "", "hostname");
+    _queue_start_next(queue, 1, "eth0 up");
+    _queue_start_next(queue, 1, NULL);
+    nm_dispatcher_request_queue_done(queue, "eth0", "eth0 up");
+    _queue_start_next(queue, 1, "eth1 up");
+    _queue_start_next(queue, 1, NULL);
+    nm_dispatcher_request_queue_done(queue, "eth1", "eth1 up");
+    _queue_start_next(queue, 1, "hostname");
+    nm_dispatcher_request_queue_done(queue, "", "hostname");
+    g_assert(nm_dispatcher_request_queue_is_empty(queue));
+
+    /* requests of different interfaces run in parallel, but those of the same
+     * interface keep their order. A later request does not overtake waiting
+     * requests of its interface. */
+    _queue_push(queue, "eth0", "eth0 pre-up");
+    _queue_push(queue, "eth0", "eth0 up");
+    _queue_push(queue, "eth1", "eth1 up");
+    _queue_push(queue, "eth0", "eth0 dhcp4-change");
+    _queue_push(queue, "eth2", "eth2 up");
+    _queue_push(queue, "eth1", "eth1 dhcp4-change");
+    _queue_start_next(queue, 10, "eth0 pre-up");
+    _queue_start_next(queue, 10, "eth1 up");
+    _queue_start_next(queue, 10, "eth2 up");
+    _queue_start_next(queue, 10, NULL);
+
+    nm_dispatcher_request_queue_done(queue, "eth1", "eth1 up");
+    _queue_start_next(queue, 10, "eth1 dhcp4-change");
+    _queue_start_next(queue, 10, NULL);
+
+    nm_dispatcher_request_queue_done(queue, "eth0", "eth0 pre-up");
+    _queue_start_next(queue, 10, "eth0 up");
+    _queue_start_next(queue, 10, NULL);
+    nm_dispatcher_request_queue_done(queue, "eth0", "eth0 up");
+    _queue_start_next(queue, 10, "eth0 dhcp4-change");
+    _queue_start_next(queue, 10, NULL);
+
+    nm_dispatcher_request_queue_done(queue, "eth0", "eth0 dhcp4-change");
+    nm_dispatcher_request_queue_done(queue, "eth1", "eth1 dhcp4-change");
+    nm_dispatcher_request_queue_done(queue, "eth2", "eth2 up");
+    g_assert(nm_dispatcher_request_queue_is_empty(queue));
+
+    /* the number of running requests is limited. When there is room again, the
+     * oldest request that can run starts next. */
+    _queue_push(queue, "eth0", "eth0 up");
+    _queue_push(queue, "eth0", "eth0 down");
+    _queue_push(queue, "eth1", "eth1 up");
+    _queue_push(queue, "eth2", "eth2 up");
+    _queue_start_next(queue, 2, "eth0 up");
+    _queue_start_next(queue, 2, "eth1 up");
+    _queue_start_next(queue, 2, NULL);
+
+    nm_dispatcher_request_queue_done(queue, "eth1", "eth1 up");
+    _queue_start_next(queue, 2, "eth2 up");
+    _queue_start_next(queue, 2, NULL);
+
+    /* the limit can change while requests run. */
+    nm_dispatcher_request_queue_done(queue, "eth0", "eth0 up");
+    _queue_start_next(queue, 1, NULL);
+    nm_dispatcher_request_queue_done(queue, "eth2", "eth2 up");
+    _queue_start_next(queue, 1, "eth0 down");
+    nm_dispatcher_request_queue_done(queue, "eth0", "eth0 down");
+    g_assert(nm_dispatcher_request_queue_is_empty(queue));
+
+    nm_dispatcher_request_queue_free(queue);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -633,5 +889,8 @@ main(int argc, char **argv)
 
     g_test_add_func("/dispatcher/gdbus-codegen", test_gdbus_codegen);
 
+    g_test_add_func("/dispatcher/script-cache", test_script_cache);
+    g_test_add_func("/dispatcher/request-queue", test_request_queue);
+
     return g_test_run();
 }
@@ -47,6 +47,13 @@ typedef struct {
 
     /* D-Bus path of the connection, if any */
     char *path;
+
+    /* Digests of the content, with and without secrets. They are only kept
+     * for connections that don't change in place, see
+     * _nm_connection_cache_content_hash(). */
+    guint8 content_hash[2][NM_CONNECTION_CONTENT_HASH_LEN];
+    bool   content_hash_valid[2];
+    bool   content_hash_cached;
 } NMConnectionPrivate;
 
 G_DEFINE_INTERFACE(NMConnection, nm_connection, G_TYPE_OBJECT)
@@ -73,11 +80,22 @@ _gtype_to_hash_key(GType gtype)
 /*****************************************************************************/
 
 static void
-setting_changed_cb(NMSetting *setting, GParamSpec *pspec, NMConnection *self)
+_signal_emit_changed(NMConnection *self)
 {
+    NMConnectionPrivate *priv = NM_CONNECTION_GET_PRIVATE(self);
+
+    priv->content_hash_valid[0] = FALSE;
+    priv->content_hash_valid[1] = FALSE;
+
     g_signal_emit(self, signals[CHANGED], 0);
 }
 
+static void
+setting_changed_cb(NMSetting *setting, GParamSpec *pspec, NMConnection *self)
+{
+    _signal_emit_changed(self);
+}
+
 static void
 _setting_release(NMConnection *connection, NMSetting *setting)
 {
@@ -129,7 +147,7 @@ nm_connection_add_setting(NMConnection *connection, NMSetting *setting)
     g_return_if_fail(NM_IS_SETTING(setting));
 
     _nm_connection_add_setting(connection, setting);
-    g_signal_emit(connection, signals[CHANGED], 0);
+    _signal_emit_changed(connection);
 }
 
 gboolean
@@ -146,7 +164,7 @@ _nm_connection_remove_setting(NMConnection *connection, GType setting_type)
     if (setting) {
         g_signal_handlers_disconnect_by_func(setting, setting_changed_cb, connection);
         g_hash_table_remove(priv->settings, _gtype_to_hash_key(setting_type));
-        g_signal_emit(connection, signals[CHANGED], 0);
+        _signal_emit_changed(connection);
         return TRUE;
     }
     return FALSE;
@@ -434,7 +452,7 @@ _nm_connection_replace_settings(NMConnection *      connection,
         success = TRUE;
 
     if (changed)
-        g_signal_emit(connection, signals[CHANGED], 0);
+        _signal_emit_changed(connection);
     return success;
 }
 
@@ -504,7 +522,7 @@ nm_connection_replace_settings_from_connection(NMConnection *connection,
     }
 
     if (changed)
-        g_signal_emit(connection, signals[CHANGED], 0);
+        _signal_emit_changed(connection);
 }
 
 /**
@@ -524,8 +542,115 @@ nm_connection_clear_settings(NMConnection *connection)
 
     if (g_hash_table_size(priv->settings) > 0) {
         g_hash_table_foreach_remove(priv->settings, _setting_release_hfr, connection);
-        g_signal_emit(connection, signals[CHANGED], 0);
+        _signal_emit_changed(connection);
+    }
+}
+
+/**
+ * _nm_connection_get_content_hash:
+ * @connection: the #NMConnection
+ * @with_secrets: whether secret properties are part of the hash
+ *
+ * Returns a digest of the content of @connection. It is only cached if
+ * _nm_connection_cache_content_hash() was called for @connection.
+ *
+ * If the hashes of two connections are equal, they also compare equal with
+ * nm_connection_compare(). Different hashes do not mean that the
+ * connections differ, as some settings treat different values as equal.
+ *
+ * Returns: (transfer none): the digest of length
+ *   %NM_CONNECTION_CONTENT_HASH_LEN. Unless it is cached, it is only valid
+ *   until the next call.
+ */
+const guint8 *
+_nm_connection_get_content_hash(NMConnection *connection, gboolean with_secrets)
+{
+    NMConnectionPrivate *priv;
+    const guint          idx = with_secrets ? 0u : 1u;
+
+    g_return_val_if_fail(NM_IS_CONNECTION(connection), NULL);
+
+    priv = NM_CONNECTION_GET_PRIVATE(connection);
+
+    if (!priv->content_hash_valid[idx]) {
+        nm_auto_free_checksum GChecksum *sum      = NULL;
+        gs_free NMSetting **             settings = NULL;
+        guint8                           digest[NM_UTILS_CHECKSUM_LENGTH_SHA256];
+        guint                            settings_len;
+        guint                            i;
+
+        G_STATIC_ASSERT_EXPR(NM_CONNECTION_CONTENT_HASH_LEN <= sizeof(digest));
+
+        sum = g_checksum_new(G_CHECKSUM_SHA256);
+
+        settings = nm_connection_get_settings(connection, &settings_len);
+        for (i = 0; i < settings_len; i++)
+            _nm_setting_hash_update(settings[i], connection, with_secrets, sum);
+
+        nm_utils_checksum_get_digest(sum, digest);
+        memcpy(priv->content_hash[idx], digest, NM_CONNECTION_CONTENT_HASH_LEN);
+        priv->content_hash_valid[idx] = priv->content_hash_cached;
     }
+
+    return priv->content_hash[idx];
+}
+
+/**
+ * _nm_connection_cache_content_hash:
+ * @connection: the #NMConnection
+ *
+ * Keeps the content hash of @connection, until the connection emits
+ * #NMConnection::changed.
+ *
+ * Boxed values like #NMIPAddress and #NMIPRoute can be modified in place,
+ * without the connection noticing it. Only call this for connections that
+ * don't change in place, like the profile of a settings connection.
+ */
+void
+_nm_connection_cache_content_hash(NMConnection *connection)
+{
+    g_return_if_fail(NM_IS_CONNECTION(connection));
+
+    NM_CONNECTION_GET_PRIVATE(connection)->content_hash_cached = TRUE;
+}
+
+/* The compare flags for which equal content hashes imply that the
+ * connections compare equal. Each of them only skips properties (or,
+ * for the DIFF_RESULT flags, only affects the result of a diff). Other
+ * flags, also those that get added in the future, always get the full
+ * comparison. */
+#define _CONTENT_HASH_COMPARE_FLAGS                       \
+    (NM_SETTING_COMPARE_FLAG_FUZZY                        \
+     | NM_SETTING_COMPARE_FLAG_IGNORE_ID                  \
+     | NM_SETTING_COMPARE_FLAG_IGNORE_SECRETS             \
+     | NM_SETTING_COMPARE_FLAG_IGNORE_AGENT_OWNED_SECRETS \
+     | NM_SETTING_COMPARE_FLAG_IGNORE_NOT_SAVED_SECRETS   \
+     | NM_SETTING_COMPARE_FLAG_DIFF_RESULT_WITH_DEFAULT   \
+     | NM_SETTING_COMPARE_FLAG_DIFF_RESULT_NO_DEFAULT     \
+     | NM_SETTING_COMPARE_FLAG_IGNORE_TIMESTAMP           \
+     | NM_SETTING_COMPARE_FLAG_INFERRABLE                 \
+     | NM_SETTING_COMPARE_FLAG_IGNORE_REAPPLY_IMMEDIATELY)
+
+static gboolean
+_content_hash_equal(NMConnection *a, NMConnection *b, NMSettingCompareFlags flags)
+{
+    gboolean    with_secrets = !NM_FLAGS_HAS(flags, NM_SETTING_COMPARE_FLAG_IGNORE_SECRETS);
+    const guint idx          = with_secrets ? 0u : 1u;
+
+    if (NM_FLAGS_ANY(flags, ~_CONTENT_HASH_COMPARE_FLAGS))
+        return FALSE;
+
+    /* Hashing both connections from scratch costs about as much as comparing
+     * them. Only take the shortcut if one of them already has the digest
+     * (commonly the long-lived profile that gets compared repeatedly). */
+    if (!NM_CONNECTION_GET_PRIVATE(a)->content_hash_valid[idx]
+        && !NM_CONNECTION_GET_PRIVATE(b)->content_hash_valid[idx])
+        return FALSE;
+
+    return memcmp(_nm_connection_get_content_hash(a, with_secrets),
+                  _nm_connection_get_content_hash(b, with_secrets),
+                  NM_CONNECTION_CONTENT_HASH_LEN)
+           == 0;
 }
 
 /**
@@ -551,6 +676,9 @@ nm_connection_compare(NMConnection *a, NMConnection *b, NMSettingCompareFlags fl
     if (!a || !b)
         return FALSE;
 
+    if (_content_hash_equal(a, b, flags))
+        return TRUE;
+
     /* B / A: ensure settings in B that are not in A make the comparison fail */
     if (g_hash_table_size(NM_CONNECTION_GET_PRIVATE(a)->settings)
         != g_hash_table_size(NM_CONNECTION_GET_PRIVATE(b)->settings))
@@ -639,6 +767,11 @@ nm_connection_diff(NMConnection *        a,
     if (a == b)
         return TRUE;
 
+    if (b && _content_hash_equal(a, b, flags)) {
+        NM_SET_OUT(out_settings, NULL);
+        return TRUE;
+    }
+
     diffs = g_hash_table_new_full(nm_str_hash,
                                   g_str_equal,
                                   g_free,
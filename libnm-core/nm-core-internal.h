@@ -21,6 +21,7 @@
 #endif
 
 #include "nm-base/nm-base.h"
+#include "nm-glib-aux/nm-value-type.h"
 #include "nm-connection.h"
 #include "nm-core-enum-types.h"
 #include "nm-core-types-internal.h"
@@ -327,6 +328,12 @@ gboolean _nm_connection_ensure_normalized(NMConnection * connection,
 
 gboolean _nm_connection_remove_setting(NMConnection *connection, GType setting_type);
 
+#define NM_CONNECTION_CONTENT_HASH_LEN 16
+
+const guint8 *_nm_connection_get_content_hash(NMConnection *connection, gboolean with_secrets);
+
+void _nm_connection_cache_content_hash(NMConnection *connection);
+
 #if NM_MORE_ASSERTS
 extern const char _nmtst_connection_unchanging_user_data;
 void              nmtst_connection_assert_unchanging(NMConnection *connection);
@@ -766,6 +773,14 @@ typedef struct {
      * on the GValue value of the GObject property. */
     NMSettInfoPropGPropToDBusFcn   gprop_to_dbus_fcn;
     NMSettInfoPropGPropFromDBusFcn gprop_from_dbus_fcn;
+
+    /* If set, the GObject property is backed by a plain field of this type,
+     * located at NMSettInfoProperty.direct_offset. Serializing, comparing
+     * and duplicating the setting then accesses the field directly, instead
+     * of going through g_object_get_property() and a GValue. This requires
+     * that the getter and setter of the property do nothing beyond reading
+     * and writing the field. */
+    NMValueType direct_type;
 } NMSettInfoPropertType;
 
 struct _NMSettInfoProperty {
@@ -774,8 +789,16 @@ struct _NMSettInfoProperty {
     GParamSpec *param_spec;
 
     const NMSettInfoPropertType *property_type;
+
+    /* For properties with a @direct_type, the offset of the field relative
+     * to the NMSetting instance pointer. Private data registered with
+     * g_type_class_add_private() is before the instance, so this offset can
+     * be negative. */
+    int direct_offset;
 };
 
+void nmtst_setting_direct_set_enabled(gboolean enabled);
+
 typedef struct {
     const GVariantType *(*get_variant_type)(const struct _NMSettInfoSetting *sett_info,
                                             const char *                     name,
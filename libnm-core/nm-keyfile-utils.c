@@ -106,6 +106,25 @@ nm_keyfile_plugin_get_setting_name_for_alias(const char *alias)
 
 /*****************************************************************************/
 
+/* Returns the group in @kf to read @group's keys from. That is @group itself
+ * if it exists, or otherwise its alias (if any).
+ *
+ * This is the same fallback as retrying the lookup on
+ * %G_KEY_FILE_ERROR_GROUP_NOT_FOUND, but it avoids allocating and
+ * formatting a GError for every key that gets looked up in an aliased
+ * group (like "[ethernet]" or "[wifi]"). */
+static const char *
+_kf_read_group(GKeyFile *kf, const char *group)
+{
+    const char *alias;
+
+    if (g_key_file_has_group(kf, group))
+        return group;
+
+    alias = nm_keyfile_plugin_get_alias_for_setting_name(group);
+    return alias ?: group;
+}
+
 char **
 nm_keyfile_plugin_kf_get_string_list(GKeyFile *  kf,
                                      const char *group,
@@ -113,21 +132,10 @@ nm_keyfile_plugin_kf_get_string_list(GKeyFile *  kf,
                                      gsize *     out_length,
                                      GError **   error)
 {
-    char **     list;
-    const char *alias;
-    GError *    local = NULL;
-    gsize       l;
-
-    list = g_key_file_get_string_list(kf, group, key, &l, &local);
-    if (nm_g_error_matches(local, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND)) {
-        alias = nm_keyfile_plugin_get_alias_for_setting_name(group);
-        if (alias) {
-            g_clear_error(&local);
-            list = g_key_file_get_string_list(kf, alias, key, &l, &local);
-        }
-    }
-    if (local)
-        g_propagate_error(error, local);
+    char **list;
+    gsize  l;
+
+    list = g_key_file_get_string_list(kf, _kf_read_group(kf, group), key, &l, error);
     if (!list)
         l = 0;
     NM_SET_OUT(out_length, l);
@@ -237,24 +245,10 @@ nm_keyfile_plugin_kf_set_integer_list_uint8(GKeyFile *    kf,
     nm_keyfile_plugin_kf_set_value(kf, group, key, nm_str_buf_get_str(&strbuf));
 }
 
-#define DEFINE_KF_WRAPPER_GET(fcn_name, get_ctype, key_file_get_fcn)                         \
-    get_ctype fcn_name(GKeyFile *kf, const char *group, const char *key, GError **error)     \
-    {                                                                                        \
-        get_ctype   val;                                                                     \
-        const char *alias;                                                                   \
-        GError *    local = NULL;                                                            \
-                                                                                             \
-        val = key_file_get_fcn(kf, group, key, &local);                                      \
-        if (nm_g_error_matches(local, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND)) { \
-            alias = nm_keyfile_plugin_get_alias_for_setting_name(group);                     \
-            if (alias) {                                                                     \
-                g_clear_error(&local);                                                       \
-                val = key_file_get_fcn(kf, alias, key, &local);                              \
-            }                                                                                \
-        }                                                                                    \
-        if (local)                                                                           \
-            g_propagate_error(error, local);                                                 \
-        return val;                                                                          \
+#define DEFINE_KF_WRAPPER_GET(fcn_name, get_ctype, key_file_get_fcn)                     \
+    get_ctype fcn_name(GKeyFile *kf, const char *group, const char *key, GError **error) \
+    {                                                                                    \
+        return key_file_get_fcn(kf, _kf_read_group(kf, group), key, error);              \
     }
 
 DEFINE_KF_WRAPPER_GET(nm_keyfile_plugin_kf_get_string, char *, g_key_file_get_string);
@@ -311,47 +305,21 @@ nm_keyfile_plugin_kf_get_int64(GKeyFile *  kf,
 char **
 nm_keyfile_plugin_kf_get_keys(GKeyFile *kf, const char *group, gsize *out_length, GError **error)
 {
-    char **     keys;
-    const char *alias;
-    GError *    local = NULL;
-    gsize       l;
-
-    keys = g_key_file_get_keys(kf, group, &l, &local);
-    if (nm_g_error_matches(local, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND)) {
-        alias = nm_keyfile_plugin_get_alias_for_setting_name(group);
-        if (alias) {
-            g_clear_error(&local);
-            keys = g_key_file_get_keys(kf, alias, &l, error ? &local : NULL);
-        }
-    }
-    nm_assert((!local) != (!keys));
+    char **keys;
+    gsize  l;
+
+    keys = g_key_file_get_keys(kf, _kf_read_group(kf, group), &l, error);
     if (!keys)
         l = 0;
     nm_assert(l == NM_PTRARRAY_LEN(keys));
     NM_SET_OUT(out_length, l);
-    if (local)
-        g_propagate_error(error, local);
     return keys;
 }
 
 gboolean
 nm_keyfile_plugin_kf_has_key(GKeyFile *kf, const char *group, const char *key, GError **error)
 {
-    gboolean    has;
-    const char *alias;
-    GError *    local = NULL;
-
-    has = g_key_file_has_key(kf, group, key, &local);
-    if (nm_g_error_matches(local, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND)) {
-        alias = nm_keyfile_plugin_get_alias_for_setting_name(group);
-        if (alias) {
-            g_clear_error(&local);
-            has = g_key_file_has_key(kf, alias, key, &local);
-        }
-    }
-    if (local)
-        g_propagate_error(error, local);
-    return has;
+    return g_key_file_has_key(kf, _kf_read_group(kf, group), key, error);
 }
 
 /*****************************************************************************/
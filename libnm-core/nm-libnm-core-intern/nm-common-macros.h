@@ -34,6 +34,10 @@
     "org.freedesktop.NetworkManager.enable-disable-connectivity-check"
 #define NM_AUTH_PERMISSION_WIFI_SCAN "org.freedesktop.NetworkManager.wifi.scan"
 
+/* the unix socket on which NetworkManager optionally exports its D-Bus API
+ * to root clients directly, without going through the D-Bus broker. */
+#define NM_PRIVATE_CLIENT_SOCKET_PATH NMRUNDIR "/private-client"
+
 #define NM_CLONED_MAC_PRESERVE  "preserve"
 #define NM_CLONED_MAC_PERMANENT "permanent"
 #define NM_CLONED_MAC_RANDOM    "random"
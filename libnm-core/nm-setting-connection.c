@@ -81,19 +81,19 @@ typedef struct {
     char *  zone;
     char *  mud_url;
     guint64 timestamp;
-    int     autoconnect_priority;
-    int     autoconnect_retries;
-    int     multi_connect;
-    int     auth_retries;
-    int     mdns;
-    int     llmnr;
-    int     wait_device_timeout;
-    guint   gateway_ping_timeout;
+    gint32  autoconnect_priority;
+    gint32  autoconnect_retries;
+    gint32  multi_connect;
+    gint32  auth_retries;
+    gint32  mdns;
+    gint32  llmnr;
+    gint32  wait_device_timeout;
+    guint32 gateway_ping_timeout;
     NMSettingConnectionAutoconnectSlaves autoconnect_slaves;
     NMMetered                            metered;
     NMSettingConnectionLldp              lldp;
-    bool                                 read_only : 1;
-    bool                                 autoconnect : 1;
+    bool                                 read_only;
+    bool                                 autoconnect;
 } NMSettingConnectionPrivate;
 
 G_DEFINE_TYPE(NMSettingConnection, nm_setting_connection, NM_TYPE_SETTING)
@@ -1839,6 +1839,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                                                   NULL,
                                                   G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE
                                                       | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_ID],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, id));
 
     /**
      * NMSettingConnection:uuid:
@@ -1869,6 +1874,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         "",
         NULL,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_UUID],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, uuid));
 
     /**
      * NMSettingConnection:stable-id:
@@ -1923,6 +1933,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         "",
         NULL,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_STABLE_ID],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, stable_id));
 
     /**
      * NMSettingConnection:interface-name:
@@ -1984,6 +1999,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                                                     NULL,
                                                     G_PARAM_READWRITE | NM_SETTING_PARAM_INFERRABLE
                                                         | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_TYPE],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, type));
 
     /**
      * NMSettingConnection:permissions:
@@ -2042,6 +2062,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         "",
         TRUE,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_AUTOCONNECT],
+        &nm_sett_info_propert_type_direct_boolean,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, autoconnect));
 
     /**
      * NMSettingConnection:autoconnect-priority:
@@ -2068,6 +2093,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         NM_SETTING_CONNECTION_AUTOCONNECT_PRIORITY_MAX,
         NM_SETTING_CONNECTION_AUTOCONNECT_PRIORITY_DEFAULT,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_AUTOCONNECT_PRIORITY],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, autoconnect_priority));
 
     /**
      * NMSettingConnection:autoconnect-retries:
@@ -2095,6 +2125,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         G_MAXINT32,
         -1,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_AUTOCONNECT_RETRIES],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, autoconnect_retries));
 
     /**
      * NMSettingConnection:multi-connect:
@@ -2120,6 +2155,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         G_MAXINT32,
         NM_CONNECTION_MULTI_CONNECT_DEFAULT,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_MULTI_CONNECT],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, multi_connect));
 
     /**
      * NMSettingConnection:timestamp:
@@ -2159,6 +2199,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         "",
         FALSE,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_READ_ONLY],
+        &nm_sett_info_propert_type_direct_boolean,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, read_only));
 
     /**
      * NMSettingConnection:zone:
@@ -2186,6 +2231,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                             NULL,
                             G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE
                                 | NM_SETTING_PARAM_REAPPLY_IMMEDIATELY | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_ZONE],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, zone));
 
     /**
      * NMSettingConnection:master:
@@ -2208,6 +2258,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                             NULL,
                             G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE
                                 | NM_SETTING_PARAM_INFERRABLE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_MASTER],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, master));
 
     /**
      * NMSettingConnection:slave-type:
@@ -2233,6 +2288,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                             NULL,
                             G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE
                                 | NM_SETTING_PARAM_INFERRABLE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_SLAVE_TYPE],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, slave_type));
 
     /**
      * NMSettingConnection:autoconnect-slaves:
@@ -2309,6 +2369,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                           600,
                           0,
                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_GATEWAY_PING_TIMEOUT],
+        &nm_sett_info_propert_type_direct_uint32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, gateway_ping_timeout));
 
     /**
      * NMSettingConnection:metered:
@@ -2387,6 +2452,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
         G_MAXINT32,
         -1,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_AUTH_RETRIES],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, auth_retries));
 
     /**
      * NMSettingConnection:mdns:
@@ -2421,6 +2491,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                                                  G_MAXINT32,
                                                  NM_SETTING_CONNECTION_MDNS_DEFAULT,
                                                  G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_MDNS],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, mdns));
 
     /**
      * NMSettingConnection:llmnr:
@@ -2457,6 +2532,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                                                   G_MAXINT32,
                                                   NM_SETTING_CONNECTION_LLMNR_DEFAULT,
                                                   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_LLMNR],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, llmnr));
 
     /**
      * NMSettingConnection:wait-device-timeout:
@@ -2491,6 +2571,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                          G_MAXINT32,
                          -1,
                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_WAIT_DEVICE_TIMEOUT],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, wait_device_timeout));
 
     /**
      * NMSettingConnection:mud-url:
@@ -2519,6 +2604,11 @@ nm_setting_connection_class_init(NMSettingConnectionClass *klass)
                                                        "",
                                                        NULL,
                                                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_MUD_URL],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingConnectionPrivate, mud_url));
 
     g_object_class_install_properties(object_class, _PROPERTY_ENUMS_LAST, obj_properties);
 
@@ -3695,16 +3695,16 @@ typedef struct {
     char *     dhcp_hostname;
     char *     dhcp_iaid;
     gint64     route_metric;
-    guint      dhcp_hostname_flags;
-    int        dns_priority;
-    int        dad_timeout;
-    int        dhcp_timeout;
+    guint32    dhcp_hostname_flags;
+    gint32     dns_priority;
+    gint32     dad_timeout;
+    gint32     dhcp_timeout;
     guint32    route_table;
-    bool       ignore_auto_routes : 1;
-    bool       ignore_auto_dns : 1;
-    bool       dhcp_send_hostname : 1;
-    bool       never_default : 1;
-    bool       may_fail : 1;
+    bool       ignore_auto_routes;
+    bool       ignore_auto_dns;
+    bool       dhcp_send_hostname;
+    bool       never_default;
+    bool       may_fail;
 } NMSettingIPConfigPrivate;
 
 G_DEFINE_ABSTRACT_TYPE(NMSettingIPConfig, nm_setting_ip_config, NM_TYPE_SETTING)
@@ -5534,11 +5534,84 @@ GArray *
 _nm_sett_info_property_override_create_array_ip_config(void)
 {
     GArray *properties_override = _nm_sett_info_property_override_create_array();
+    /* called from the class_init of the subclasses. At that point, the base
+     * class is already initialized and has its private data registered. */
+    gpointer klass = g_type_class_peek(NM_TYPE_SETTING_IP_CONFIG);
 
-    _nm_properties_override_gobj(properties_override,
-                                 obj_properties[PROP_GATEWAY],
-                                 NM_SETT_INFO_PROPERT_TYPE(.dbus_type     = G_VARIANT_TYPE_STRING,
-                                                           .from_dbus_fcn = ip_gateway_set, ));
+    nm_assert(klass);
+
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_GATEWAY],
+        NM_SETT_INFO_PROPERT_TYPE(.dbus_type     = G_VARIANT_TYPE_STRING,
+                                  .direct_type   = NM_VALUE_TYPE_STRING,
+                                  .from_dbus_fcn = ip_gateway_set, ),
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, gateway));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_METHOD],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, method));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DNS_PRIORITY],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, dns_priority));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_ROUTE_TABLE],
+        &nm_sett_info_propert_type_direct_uint32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, route_table));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_IGNORE_AUTO_ROUTES],
+        &nm_sett_info_propert_type_direct_boolean,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, ignore_auto_routes));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_IGNORE_AUTO_DNS],
+        &nm_sett_info_propert_type_direct_boolean,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, ignore_auto_dns));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DHCP_HOSTNAME],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, dhcp_hostname));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DHCP_HOSTNAME_FLAGS],
+        &nm_sett_info_propert_type_direct_uint32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, dhcp_hostname_flags));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DHCP_SEND_HOSTNAME],
+        &nm_sett_info_propert_type_direct_boolean,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, dhcp_send_hostname));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_NEVER_DEFAULT],
+        &nm_sett_info_propert_type_direct_boolean,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, never_default));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_MAY_FAIL],
+        &nm_sett_info_propert_type_direct_boolean,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, may_fail));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DAD_TIMEOUT],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, dad_timeout));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DHCP_TIMEOUT],
+        &nm_sett_info_propert_type_direct_int32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, dhcp_timeout));
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DHCP_IAID],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingIPConfigPrivate, dhcp_iaid));
 
     /* ---dbus---
      * property: routing-rules
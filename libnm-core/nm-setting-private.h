@@ -76,6 +76,12 @@ extern const NMSettInfoPropertType nm_sett_info_propert_type_deprecated_ignore_u
 extern const NMSettInfoPropertType nm_sett_info_propert_type_plain_i;
 extern const NMSettInfoPropertType nm_sett_info_propert_type_plain_u;
 
+extern const NMSettInfoPropertType nm_sett_info_propert_type_direct_boolean;
+extern const NMSettInfoPropertType nm_sett_info_propert_type_direct_int32;
+extern const NMSettInfoPropertType nm_sett_info_propert_type_direct_uint32;
+extern const NMSettInfoPropertType nm_sett_info_propert_type_direct_string;
+extern const NMSettInfoPropertType nm_sett_info_propert_type_direct_strv;
+
 NMSettingVerifyResult
 _nm_setting_verify(NMSetting *setting, NMConnection *connection, GError **error);
 
@@ -93,6 +99,11 @@ GVariant *_nm_setting_to_dbus(NMSetting *                             setting,
                               NMConnectionSerializationFlags          flags,
                               const NMConnectionSerializationOptions *options);
 
+void _nm_setting_hash_update(NMSetting *   setting,
+                             NMConnection *connection,
+                             gboolean      with_secrets,
+                             GChecksum *   sum);
+
 NMSetting *_nm_setting_new_from_dbus(GType               setting_type,
                                      GVariant *          setting_dict,
                                      GVariant *          connection_dict,
@@ -157,6 +168,22 @@ _nm_properties_override(GArray *properties_override, const NMSettInfoProperty *p
         (properties_override),                                                           \
         NM_SETT_INFO_PROPERTY(.param_spec = (p_param_spec), .property_type = (p_property_type), ))
 
+/* The offset of @field in the private data of a setting that registered it
+ * with g_type_class_add_private(), relative to the instance pointer. Must be
+ * called from class_init after g_type_class_add_private(). */
+#define NM_SETT_INFO_PRIVATE_OFFSET(setting_class, private_type, field) \
+    (g_type_class_get_instance_private_offset(setting_class)            \
+     + ((int) G_STRUCT_OFFSET(private_type, field)))
+
+#define _nm_properties_override_gobj_direct(properties_override,                      \
+                                            p_param_spec,                             \
+                                            p_property_type,                          \
+                                            p_direct_offset)                          \
+    _nm_properties_override((properties_override),                                    \
+                            NM_SETT_INFO_PROPERTY(.param_spec    = (p_param_spec),    \
+                                                  .property_type = (p_property_type), \
+                                                  .direct_offset = (p_direct_offset), ))
+
 #define _nm_properties_override_dbus(properties_override, p_name, p_property_type) \
     _nm_properties_override(                                                       \
         (properties_override),                                                     \
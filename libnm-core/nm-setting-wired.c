@@ -61,7 +61,7 @@ typedef struct {
     char *                  generate_mac_address_mask;
     char *                  s390_nettype;
     char *                  wol_password;
-    NMSettingWiredWakeOnLan wol;
+    guint32                 wol;
     guint32                 speed;
     guint32                 mtu;
     bool                    auto_negotiate : 1;
@@ -1236,6 +1236,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
                                                     "",
                                                     NULL,
                                                     G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_PORT],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, port));
 
     /**
      * NMSettingWired:speed:
@@ -1268,6 +1273,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
                                                    G_MAXUINT32,
                                                    0,
                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_SPEED],
+        &nm_sett_info_propert_type_direct_uint32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, speed));
 
     /**
      * NMSettingWired:duplex:
@@ -1297,6 +1307,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
                                                       "",
                                                       NULL,
                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_DUPLEX],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, duplex));
 
     /**
      * NMSettingWired:auto-negotiate:
@@ -1477,6 +1492,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
         "",
         NULL,
         G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_GENERATE_MAC_ADDRESS_MASK],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, generate_mac_address_mask));
 
     /**
      * NMSettingWired:mac-address-blacklist:
@@ -1527,6 +1547,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
                                                  0,
                                                  G_PARAM_READWRITE | NM_SETTING_PARAM_FUZZY_IGNORE
                                                      | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_MTU],
+        &nm_sett_info_propert_type_direct_uint32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, mtu));
 
     /**
      * NMSettingWired:s390-subchannels:
@@ -1552,6 +1577,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
         "",
         G_TYPE_STRV,
         G_PARAM_READWRITE | NM_SETTING_PARAM_INFERRABLE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_S390_SUBCHANNELS],
+        &nm_sett_info_propert_type_direct_strv,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, s390_subchannels));
 
     /**
      * NMSettingWired:s390-nettype:
@@ -1573,6 +1603,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
         "",
         NULL,
         G_PARAM_READWRITE | NM_SETTING_PARAM_INFERRABLE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_S390_NETTYPE],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, s390_nettype));
 
     /**
      * NMSettingWired:s390-options: (type GHashTable(utf8,utf8)):
@@ -1621,6 +1656,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
                           G_MAXUINT32,
                           NM_SETTING_WIRED_WAKE_ON_LAN_DEFAULT,
                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_WAKE_ON_LAN],
+        &nm_sett_info_propert_type_direct_uint32,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, wol));
 
     /**
      * NMSettingWired:wake-on-lan-password:
@@ -1637,6 +1677,11 @@ nm_setting_wired_class_init(NMSettingWiredClass *klass)
                             "",
                             NULL,
                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    _nm_properties_override_gobj_direct(
+        properties_override,
+        obj_properties[PROP_WAKE_ON_LAN_PASSWORD],
+        &nm_sett_info_propert_type_direct_string,
+        NM_SETT_INFO_PRIVATE_OFFSET(klass, NMSettingWiredPrivate, wol_password));
 
     g_object_class_install_properties(object_class, _PROPERTY_ENUMS_LAST, obj_properties);
 
@@ -4,6 +4,8 @@
  * Copyright (C) 2007 - 2008 Novell, Inc.
  */
 
+#define NM_VALUE_TYPE_DEFINE_FUNCTIONS
+
 #include "libnm-core/nm-default-libnm-core.h"
 
 #include "nm-setting.h"
@@ -175,6 +177,34 @@ _gprop_to_dbus_fcn_flags(const GValue *val)
     return g_variant_new_uint32(g_value_get_flags(val));
 }
 
+static gboolean
+_property_direct_type_is_valid(const NMSettInfoProperty *prop_info)
+{
+    GType vtype;
+
+    if (!prop_info->param_spec || prop_info->direct_offset == 0)
+        return FALSE;
+
+    vtype = prop_info->param_spec->value_type;
+
+    switch (prop_info->property_type->direct_type) {
+    case NM_VALUE_TYPE_BOOL:
+        return vtype == G_TYPE_BOOLEAN;
+    case NM_VALUE_TYPE_INT32:
+        return vtype == G_TYPE_INT;
+    case NM_VALUE_TYPE_UINT32:
+        return vtype == G_TYPE_UINT;
+    case NM_VALUE_TYPE_STRING:
+        return vtype == G_TYPE_STRING;
+    case NM_VALUE_TYPE_STRV:
+        return vtype == G_TYPE_STRV;
+    case NM_VALUE_TYPE_INT:
+    case NM_VALUE_TYPE_UNSPEC:
+        break;
+    }
+    return FALSE;
+}
+
 gboolean
 _nm_properties_override_assert(const NMSettInfoProperty *prop_info)
 {
@@ -203,6 +233,12 @@ _nm_properties_override_assert(const NMSettInfoProperty *prop_info)
     nm_assert(!_PROPERT_EXTRA(prop_info, gprop_to_dbus_fcn) || prop_info->param_spec);
     nm_assert(!_PROPERT_EXTRA(prop_info, gprop_from_dbus_fcn) || prop_info->param_spec);
 
+    nm_assert(!_PROPERT_EXTRA(prop_info, direct_type) || _property_direct_type_is_valid(prop_info));
+    nm_assert(!_PROPERT_EXTRA(prop_info, direct_type)
+              || (!_PROPERT_EXTRA(prop_info, to_dbus_fcn)
+                  && !_PROPERT_EXTRA(prop_info, gprop_to_dbus_fcn)));
+    nm_assert(_PROPERT_EXTRA(prop_info, direct_type) || prop_info->direct_offset == 0);
+
 #undef _PROPERT_EXTRA
 
     return TRUE;
@@ -553,6 +589,66 @@ _nm_setting_use_legacy_property(NMSetting * setting,
 
 /*****************************************************************************/
 
+static bool _direct_disabled;
+
+/**
+ * nmtst_setting_direct_set_enabled:
+ * @enabled: whether to access properties with a direct type directly
+ *
+ * For tests. When disabled, all properties go through GValue, like
+ * properties without a direct type. That allows to compare both.
+ */
+void
+nmtst_setting_direct_set_enabled(gboolean enabled)
+{
+    _direct_disabled = !enabled;
+}
+
+static inline NMValueType
+_property_direct_type(const NMSettInfoProperty *property_info)
+{
+    if (G_UNLIKELY(_direct_disabled))
+        return 0;
+    return property_info->property_type->direct_type;
+}
+
+static inline gpointer
+_property_direct_get_field(NMSetting *setting, const NMSettInfoProperty *property_info)
+{
+    nm_assert(property_info->property_type->direct_type);
+    nm_assert(property_info->direct_offset != 0);
+
+    return ((char *) setting) + property_info->direct_offset;
+}
+
+static gboolean
+_property_direct_is_default(const NMSettInfoProperty *property_info, gconstpointer p_field)
+{
+    const GParamSpec *pspec = property_info->param_spec;
+
+    switch (property_info->property_type->direct_type) {
+    case NM_VALUE_TYPE_BOOL:
+        return (!!*((const bool *) p_field))
+               == (!!((const GParamSpecBoolean *) pspec)->default_value);
+    case NM_VALUE_TYPE_INT32:
+        return *((const gint32 *) p_field) == ((const GParamSpecInt *) pspec)->default_value;
+    case NM_VALUE_TYPE_UINT32:
+        return *((const guint32 *) p_field) == ((const GParamSpecUInt *) pspec)->default_value;
+    case NM_VALUE_TYPE_STRING:
+        return nm_streq0(*((const char *const *) p_field),
+                         ((const GParamSpecString *) pspec)->default_value);
+    case NM_VALUE_TYPE_STRV:
+        /* like g_param_value_defaults() for boxed types. An empty array is
+         * not the default. */
+        return !*((const char *const *const *) p_field);
+    case NM_VALUE_TYPE_INT:
+    case NM_VALUE_TYPE_UNSPEC:
+        break;
+    }
+    nm_assert_not_reached();
+    return FALSE;
+}
+
 static GVariant *
 property_to_dbus(const NMSettInfoSetting *               sett_info,
                  guint                                   property_idx,
@@ -600,7 +696,15 @@ property_to_dbus(const NMSettInfoSetting *               sett_info,
         }
     }
 
-    if (property->property_type->to_dbus_fcn) {
+    if (_property_direct_type(property)) {
+        gconstpointer p_field = _property_direct_get_field(setting, property);
+
+        if (ignore_default && _property_direct_is_default(property, p_field))
+            return NULL;
+
+        variant = nm_value_type_to_variant(property->property_type->direct_type, p_field);
+        nm_g_variant_take_ref(variant);
+    } else if (property->property_type->to_dbus_fcn) {
         variant = property->property_type
                       ->to_dbus_fcn(sett_info, property_idx, connection, setting, flags, options);
         nm_g_variant_take_ref(variant);
@@ -721,6 +825,135 @@ _nm_setting_to_dbus(NMSetting *                             setting,
     return g_variant_builder_end(&builder);
 }
 
+static void
+_hash_update_variant(GChecksum *sum, const char *name, GVariant *variant)
+{
+    const char *type_string = g_variant_get_type_string(variant);
+    guint64     size        = g_variant_get_size(variant);
+
+    g_checksum_update(sum, (const guchar *) name, strlen(name) + 1);
+    g_checksum_update(sum, (const guchar *) type_string, strlen(type_string) + 1);
+    g_checksum_update(sum, (const guchar *) &size, sizeof(size));
+    if (size > 0)
+        g_checksum_update(sum, g_variant_get_data(variant), size);
+}
+
+static void
+_hash_update_direct(GChecksum *sum, const NMSettInfoProperty *property_info, gconstpointer p_field)
+{
+    const NMValueType  value_type = property_info->property_type->direct_type;
+    const char *const *strv;
+    const char *       str;
+    guint64            n;
+
+    /* like property_to_dbus(), default values are not hashed. */
+    if (_property_direct_is_default(property_info, p_field))
+        return;
+
+    g_checksum_update(sum, (const guchar *) property_info->name, strlen(property_info->name) + 1);
+    g_checksum_update(sum, (const guchar *) &value_type, sizeof(value_type));
+
+    switch (value_type) {
+    case NM_VALUE_TYPE_BOOL:
+        g_checksum_update(sum, (const guchar *) p_field, sizeof(bool));
+        return;
+    case NM_VALUE_TYPE_INT32:
+    case NM_VALUE_TYPE_UINT32:
+        g_checksum_update(sum, (const guchar *) p_field, sizeof(guint32));
+        return;
+    case NM_VALUE_TYPE_STRING:
+        /* a %NULL string that is not the default hashes no data, unlike "". */
+        str = *((const char *const *) p_field);
+        if (str)
+            g_checksum_update(sum, (const guchar *) str, strlen(str) + 1);
+        return;
+    case NM_VALUE_TYPE_STRV:
+        strv = *((const char *const *const *) p_field);
+        n    = NM_PTRARRAY_LEN(strv);
+        g_checksum_update(sum, (const guchar *) &n, sizeof(n));
+        for (; *strv; strv++)
+            g_checksum_update(sum, (const guchar *) *strv, strlen(*strv) + 1);
+        return;
+    case NM_VALUE_TYPE_INT:
+    case NM_VALUE_TYPE_UNSPEC:
+        break;
+    }
+    nm_assert_not_reached();
+}
+
+/**
+ * _nm_setting_hash_update:
+ * @setting: the #NMSetting
+ * @connection: (allow-none): the #NMConnection containing @setting
+ * @with_secrets: whether to include secrets
+ * @sum: the checksum to update
+ *
+ * Feeds the content of @setting into @sum. This covers the same values
+ * that _nm_setting_compare() looks at, serialized like to_dbus() (that is,
+ * ignoring properties that have their default value). Two settings that
+ * hash to the same value also compare equal. The reverse is not true,
+ * because some settings implement a custom compare_property() that
+ * considers different serializations as equal.
+ */
+void
+_nm_setting_hash_update(NMSetting *   setting,
+                        NMConnection *connection,
+                        gboolean      with_secrets,
+                        GChecksum *   sum)
+{
+    const NMSettInfoSetting *sett_info;
+    const char *             setting_name;
+    const char *const *      gendata_keys;
+    guint                    n_gendata;
+    guint                    i;
+
+    nm_assert(NM_IS_SETTING(setting));
+    nm_assert(sum);
+
+    setting_name = nm_setting_get_name(setting);
+    g_checksum_update(sum, (const guchar *) setting_name, strlen(setting_name) + 1);
+
+    n_gendata = _nm_setting_option_get_all(setting, &gendata_keys, NULL);
+    for (i = 0; i < n_gendata; i++) {
+        _hash_update_variant(sum,
+                             gendata_keys[i],
+                             g_hash_table_lookup(NM_SETTING_GET_PRIVATE(setting)->gendata->hash,
+                                                 gendata_keys[i]));
+    }
+
+    sett_info = _nm_setting_class_get_sett_info(NM_SETTING_GET_CLASS(setting));
+    for (i = 0; i < sett_info->property_infos_len; i++) {
+        const NMSettInfoProperty * property_info = &sett_info->property_infos[i];
+        gs_unref_variant GVariant *dbus_value    = NULL;
+
+        if (!with_secrets && property_info->param_spec
+            && NM_FLAGS_HAS(property_info->param_spec->flags, NM_SETTING_PARAM_SECRET))
+            continue;
+
+        if (_property_direct_type(property_info)) {
+            _hash_update_direct(sum,
+                                property_info,
+                                _property_direct_get_field(setting, property_info));
+            continue;
+        }
+
+        dbus_value = property_to_dbus(sett_info,
+                                      i,
+                                      connection,
+                                      setting,
+                                      with_secrets ? NM_CONNECTION_SERIALIZE_ALL
+                                                   : NM_CONNECTION_SERIALIZE_NO_SECRETS,
+                                      NULL,
+                                      TRUE,
+                                      TRUE);
+        if (dbus_value)
+            _hash_update_variant(sum, property_info->name, dbus_value);
+    }
+
+    /* mark the end of the setting. */
+    g_checksum_update(sum, (const guchar *) "", 1);
+}
+
 /**
  * _nm_setting_new_from_dbus:
  * @setting_type: the #NMSetting type which the hash contains properties for
@@ -1091,6 +1324,15 @@ duplicate_copy_properties(const NMSettInfoSetting *sett_info, NMSetting *src, NM
                     != G_PARAM_WRITABLE)
                     continue;
 
+                if (_property_direct_type(property_info)) {
+                    /* @dst was just created, nobody can be subscribed to
+                     * notifications yet. Copy the field directly. */
+                    nm_value_type_copy(property_info->property_type->direct_type,
+                                       _property_direct_get_field(dst, property_info),
+                                       _property_direct_get_field(src, property_info));
+                    continue;
+                }
+
                 if (!frozen) {
                     g_object_freeze_notify(G_OBJECT(dst));
                     frozen = TRUE;
@@ -1342,6 +1584,14 @@ compare_property(const NMSettInfoSetting *sett_info,
         gs_unref_variant GVariant *value1 = NULL;
         gs_unref_variant GVariant *value2 = NULL;
 
+        if (_property_direct_type(property_info)) {
+            if (!nm_value_type_equal(property_info->property_type->direct_type,
+                                     _property_direct_get_field(set_a, property_info),
+                                     _property_direct_get_field(set_b, property_info)))
+                return NM_TERNARY_FALSE;
+            return NM_TERNARY_TRUE;
+        }
+
         value1 = property_to_dbus(sett_info,
                                   property_idx,
                                   con_a,
@@ -2345,6 +2595,31 @@ const NMSettInfoPropertType nm_sett_info_propert_type_plain_u = {
     .dbus_type = G_VARIANT_TYPE_UINT32,
 };
 
+const NMSettInfoPropertType nm_sett_info_propert_type_direct_boolean = {
+    .dbus_type   = G_VARIANT_TYPE_BOOLEAN,
+    .direct_type = NM_VALUE_TYPE_BOOL,
+};
+
+const NMSettInfoPropertType nm_sett_info_propert_type_direct_int32 = {
+    .dbus_type   = G_VARIANT_TYPE_INT32,
+    .direct_type = NM_VALUE_TYPE_INT32,
+};
+
+const NMSettInfoPropertType nm_sett_info_propert_type_direct_uint32 = {
+    .dbus_type   = G_VARIANT_TYPE_UINT32,
+    .direct_type = NM_VALUE_TYPE_UINT32,
+};
+
+const NMSettInfoPropertType nm_sett_info_propert_type_direct_string = {
+    .dbus_type   = G_VARIANT_TYPE_STRING,
+    .direct_type = NM_VALUE_TYPE_STRING,
+};
+
+const NMSettInfoPropertType nm_sett_info_propert_type_direct_strv = {
+    .dbus_type   = G_VARIANT_TYPE_STRING_ARRAY,
+    .direct_type = NM_VALUE_TYPE_STRV,
+};
+
 /*****************************************************************************/
 
 static GenData *
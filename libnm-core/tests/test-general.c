@@ -3551,6 +3551,187 @@ test_connection_compare_setting_only_in_b(void)
     g_object_unref(b);
 }
 
+static void
+test_connection_compare_content_hash(void)
+{
+    gs_unref_object NMConnection *a = NULL;
+    gs_unref_object NMConnection *b = NULL;
+    NMSettingConnection *         s_con;
+    NMSettingWired *              s_wired;
+    guint8                        hash_a[NM_CONNECTION_CONTENT_HASH_LEN];
+
+    a = new_test_connection();
+    b = nm_simple_connection_new_clone(a);
+
+    /* only @a keeps its hash, like the profile of a settings connection. */
+    _nm_connection_cache_content_hash(a);
+
+    memcpy(hash_a, _nm_connection_get_content_hash(a, TRUE), sizeof(hash_a));
+    g_assert(memcmp(hash_a, _nm_connection_get_content_hash(b, TRUE), sizeof(hash_a)) == 0);
+    g_assert(memcmp(_nm_connection_get_content_hash(a, FALSE),
+                    _nm_connection_get_content_hash(b, FALSE),
+                    sizeof(hash_a))
+             == 0);
+    g_assert(nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+    g_assert(nm_connection_diff(a, b, NM_SETTING_COMPARE_FLAG_EXACT, NULL));
+
+    /* modifying a setting must invalidate the cached hash. */
+    s_con = nm_connection_get_setting_connection(b);
+    g_object_set(s_con, NM_SETTING_CONNECTION_ID, "foobar2", NULL);
+    g_assert(memcmp(hash_a, _nm_connection_get_content_hash(b, TRUE), sizeof(hash_a)) != 0);
+    g_assert(!nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+    g_assert(nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_IGNORE_ID));
+
+    g_object_set(s_con, NM_SETTING_CONNECTION_ID, "foobar", NULL);
+    g_assert(memcmp(hash_a, _nm_connection_get_content_hash(b, TRUE), sizeof(hash_a)) == 0);
+    g_assert(nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+
+    s_wired = nm_connection_get_setting_wired(a);
+    g_object_set(s_wired, NM_SETTING_WIRED_MTU, 1500, NULL);
+    g_assert(memcmp(hash_a, _nm_connection_get_content_hash(a, TRUE), sizeof(hash_a)) != 0);
+    g_assert(!nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+
+    /* adding and removing settings too. */
+    g_object_set(s_wired, NM_SETTING_WIRED_MTU, 1592, NULL);
+    g_assert(nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+    nm_connection_remove_setting(b, NM_TYPE_SETTING_IP4_CONFIG);
+    g_assert(memcmp(hash_a, _nm_connection_get_content_hash(b, TRUE), sizeof(hash_a)) != 0);
+    g_assert(!nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+}
+
+static void
+test_connection_compare_content_hash_in_place(void)
+{
+    gs_unref_object NMConnection *a = NULL;
+    gs_unref_object NMConnection *b = NULL;
+    NMSettingIPConfig *           s_ip4;
+    NMIPAddress *                 address;
+    NMIPRoute *                   route;
+
+    a     = new_test_connection();
+    s_ip4 = NM_SETTING_IP_CONFIG(nm_connection_get_setting_ip4_config(a));
+    address = nm_ip_address_new(AF_INET, "192.168.1.5", 24, NULL);
+    nm_setting_ip_config_add_address(s_ip4, address);
+    nm_ip_address_unref(address);
+    route = nm_ip_route_new(AF_INET, "10.0.0.0", 8, "192.168.1.1", 100, NULL);
+    nm_setting_ip_config_add_route(s_ip4, route);
+    nm_ip_route_unref(route);
+
+    b = nm_simple_connection_new_clone(a);
+    _nm_connection_cache_content_hash(a);
+    g_assert(nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+
+    /* the addresses and routes of @b get modified in place, which does not
+     * emit a "changed" signal. As @b does not cache its hash, it is noticed. */
+    s_ip4   = NM_SETTING_IP_CONFIG(nm_connection_get_setting_ip4_config(b));
+    address = nm_setting_ip_config_get_address(s_ip4, 0);
+    nm_ip_address_set_attribute(address, NM_IP_ADDRESS_ATTRIBUTE_LABEL, g_variant_new_string("x"));
+    g_assert(!nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+    g_assert(!nm_connection_diff(a, b, NM_SETTING_COMPARE_FLAG_EXACT, NULL));
+
+    nm_ip_address_set_attribute(address, NM_IP_ADDRESS_ATTRIBUTE_LABEL, NULL);
+    g_assert(nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+
+    route = nm_setting_ip_config_get_route(s_ip4, 0);
+    nm_ip_route_set_metric(route, 200);
+    g_assert(!nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+    nm_ip_route_set_metric(route, 100);
+    nm_ip_route_set_attribute(route, NM_IP_ROUTE_ATTRIBUTE_MTU, g_variant_new_uint32(1280));
+    g_assert(!nm_connection_compare(a, b, NM_SETTING_COMPARE_FLAG_EXACT));
+    g_assert(!nm_connection_compare(b, a, NM_SETTING_COMPARE_FLAG_EXACT));
+}
+
+/* compares @a and @b setting by setting, without the content hash. */
+static gboolean
+_connection_compare_full(NMConnection *a, NMConnection *b, NMSettingCompareFlags flags)
+{
+    gs_free NMSetting **settings_a = NULL;
+    gs_free NMSetting **settings_b = NULL;
+    guint               len_a;
+    guint               len_b;
+    guint               i;
+
+    settings_a = nm_connection_get_settings(a, &len_a);
+    settings_b = nm_connection_get_settings(b, &len_b);
+    if (len_a != len_b)
+        return FALSE;
+
+    for (i = 0; i < len_a; i++) {
+        NMSetting *setting_b = nm_connection_get_setting(b, G_OBJECT_TYPE(settings_a[i]));
+
+        if (!setting_b || !_nm_setting_compare(a, settings_a[i], b, setting_b, flags))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+test_connection_compare_content_hash_flags(void)
+{
+    static const NMSettingCompareFlags all_flags[] = {
+        NM_SETTING_COMPARE_FLAG_FUZZY,
+        NM_SETTING_COMPARE_FLAG_IGNORE_ID,
+        NM_SETTING_COMPARE_FLAG_IGNORE_SECRETS,
+        NM_SETTING_COMPARE_FLAG_IGNORE_AGENT_OWNED_SECRETS,
+        NM_SETTING_COMPARE_FLAG_IGNORE_NOT_SAVED_SECRETS,
+        NM_SETTING_COMPARE_FLAG_DIFF_RESULT_WITH_DEFAULT,
+        NM_SETTING_COMPARE_FLAG_DIFF_RESULT_NO_DEFAULT,
+        NM_SETTING_COMPARE_FLAG_IGNORE_TIMESTAMP,
+        NM_SETTING_COMPARE_FLAG_INFERRABLE,
+        NM_SETTING_COMPARE_FLAG_IGNORE_REAPPLY_IMMEDIATELY,
+    };
+    gs_unref_object NMConnection *a = NULL;
+    gs_unref_object NMConnection *b = NULL;
+    NMSetting *                   s_8021x;
+    guint                         mask;
+    guint                         i;
+
+    /* a profile with secrets that have different flags. */
+    a       = new_test_connection();
+    s_8021x = nm_setting_802_1x_new();
+    g_object_set(s_8021x,
+                 NM_SETTING_802_1X_EAP,
+                 NM_MAKE_STRV("peap"),
+                 NM_SETTING_802_1X_IDENTITY,
+                 "user",
+                 NM_SETTING_802_1X_PHASE2_AUTH,
+                 "mschapv2",
+                 NM_SETTING_802_1X_PASSWORD,
+                 "secret",
+                 NM_SETTING_802_1X_PASSWORD_FLAGS,
+                 NM_SETTING_SECRET_FLAG_AGENT_OWNED,
+                 NM_SETTING_802_1X_PIN,
+                 "1234",
+                 NM_SETTING_802_1X_PIN_FLAGS,
+                 NM_SETTING_SECRET_FLAG_NOT_SAVED,
+                 NULL);
+    nm_connection_add_setting(a, s_8021x);
+
+    b = nm_simple_connection_new_clone(a);
+    _nm_connection_cache_content_hash(a);
+
+    g_assert(memcmp(_nm_connection_get_content_hash(a, TRUE),
+                    _nm_connection_get_content_hash(b, TRUE),
+                    NM_CONNECTION_CONTENT_HASH_LEN)
+             == 0);
+
+    /* the content hash short-cuts the comparison for these flags. For each
+     * combination of them, the full comparison must agree that connections
+     * with the same content are equal. That is, the flags only relax the
+     * comparison. */
+    for (mask = 0; mask < (1u << G_N_ELEMENTS(all_flags)); mask++) {
+        NMSettingCompareFlags flags = NM_SETTING_COMPARE_FLAG_EXACT;
+
+        for (i = 0; i < G_N_ELEMENTS(all_flags); i++) {
+            if (NM_FLAGS_HAS(mask, 1u << i))
+                flags |= all_flags[i];
+        }
+
+        g_assert(_connection_compare_full(a, b, flags));
+        g_assert(nm_connection_compare(a, b, flags));
+    }
+}
+
 typedef struct {
     const char *key_name;
     guint32     result;
@@ -10552,6 +10733,12 @@ main(int argc, char **argv)
                     test_connection_compare_key_only_in_b);
     g_test_add_func("/core/general/test_connection_compare_setting_only_in_b",
                     test_connection_compare_setting_only_in_b);
+    g_test_add_func("/core/general/test_connection_compare_content_hash",
+                    test_connection_compare_content_hash);
+    g_test_add_func("/core/general/test_connection_compare_content_hash_in_place",
+                    test_connection_compare_content_hash_in_place);
+    g_test_add_func("/core/general/test_connection_compare_content_hash_flags",
+                    test_connection_compare_content_hash_flags);
 
     g_test_add_func("/core/general/test_connection_diff_a_only", test_connection_diff_a_only);
     g_test_add_func("/core/general/test_connection_diff_same", test_connection_diff_same);
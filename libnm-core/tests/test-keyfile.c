@@ -887,6 +887,44 @@ test_bridge_port_vlans(void)
 
 /*****************************************************************************/
 
+static void
+test_read_alias_group(void)
+{
+    gs_unref_object NMConnection *con_alias = NULL;
+    gs_unref_object NMConnection *con_full  = NULL;
+    NMSettingWired *              s_wired;
+
+    con_alias = nmtst_create_connection_from_keyfile("[connection]\n"
+                                                     "id=t\n"
+                                                     "uuid=8b2b29b8-7e6b-4f5b-8a3d-9e1b6f7d2c01\n"
+                                                     "type=ethernet\n"
+                                                     "\n"
+                                                     "[ethernet]\n"
+                                                     "mtu=1400\n"
+                                                     "mac-address=00:11:22:33:44:55\n"
+                                                     "",
+                                                     "/test_read_alias_group/alias");
+    con_full  = nmtst_create_connection_from_keyfile("[connection]\n"
+                                                    "id=t\n"
+                                                    "uuid=8b2b29b8-7e6b-4f5b-8a3d-9e1b6f7d2c01\n"
+                                                    "type=802-3-ethernet\n"
+                                                    "\n"
+                                                    "[802-3-ethernet]\n"
+                                                    "mtu=1400\n"
+                                                    "mac-address=00:11:22:33:44:55\n"
+                                                    "",
+                                                    "/test_read_alias_group/full");
+
+    s_wired = nm_connection_get_setting_wired(con_alias);
+    g_assert(s_wired);
+    g_assert_cmpint(nm_setting_wired_get_mtu(s_wired), ==, 1400);
+    g_assert_cmpstr(nm_setting_wired_get_mac_address(s_wired), ==, "00:11:22:33:44:55");
+
+    nmtst_assert_connection_equals(con_alias, FALSE, con_full, FALSE);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -904,6 +942,7 @@ main(int argc, char **argv)
     g_test_add_func("/core/keyfile/test_vpn/1", test_vpn_1);
     g_test_add_func("/core/keyfile/bridge/vlans", test_bridge_vlans);
     g_test_add_func("/core/keyfile/bridge-port/vlans", test_bridge_port_vlans);
+    g_test_add_func("/core/keyfile/test_read_alias_group", test_read_alias_group);
 
     return g_test_run();
 }
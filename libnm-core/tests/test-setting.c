@@ -4145,6 +4145,46 @@ test_setting_metadata(void)
 
                 if (NM_FLAGS_HAS(sip->param_spec->flags, NM_SETTING_PARAM_TO_DBUS_IGNORE_FLAGS))
                     g_assert(sip->property_type->to_dbus_fcn);
+
+                if (sip->property_type->direct_type) {
+                    gconstpointer p_field = ((const char *) setting) + sip->direct_offset;
+
+                    g_assert_cmpint(sip->direct_offset, !=, 0);
+                    g_assert(!sip->property_type->to_dbus_fcn);
+                    g_assert(!sip->property_type->gprop_to_dbus_fcn);
+
+                    /* the direct field must agree with the GObject property getter. */
+                    switch (sip->property_type->direct_type) {
+                    case NM_VALUE_TYPE_BOOL:
+                        g_assert(G_VALUE_HOLDS_BOOLEAN(&val));
+                        g_assert_cmpint(*((const bool *) p_field), ==, g_value_get_boolean(&val));
+                        break;
+                    case NM_VALUE_TYPE_INT32:
+                        g_assert(G_VALUE_HOLDS_INT(&val));
+                        g_assert_cmpint(*((const gint32 *) p_field), ==, g_value_get_int(&val));
+                        break;
+                    case NM_VALUE_TYPE_UINT32:
+                        g_assert(G_VALUE_HOLDS_UINT(&val));
+                        g_assert_cmpint(*((const guint32 *) p_field), ==, g_value_get_uint(&val));
+                        break;
+                    case NM_VALUE_TYPE_STRING:
+                        g_assert(G_VALUE_HOLDS_STRING(&val));
+                        g_assert_cmpstr(*((const char *const *) p_field),
+                                        ==,
+                                        g_value_get_string(&val));
+                        break;
+                    case NM_VALUE_TYPE_STRV:
+                        g_assert(G_VALUE_HOLDS(&val, G_TYPE_STRV));
+                        g_assert(!*((const char *const *const *) p_field)
+                                 == !g_value_get_boxed(&val));
+                        g_assert(nm_utils_strv_equal(*((const char *const *const *) p_field),
+                                                     g_value_get_boxed(&val)));
+                        break;
+                    default:
+                        g_assert_not_reached();
+                    }
+                } else
+                    g_assert_cmpint(sip->direct_offset, ==, 0);
             }
         }
 
@@ -4215,7 +4255,8 @@ test_setting_metadata(void)
                     || pt->from_dbus_fcn != pt_2->from_dbus_fcn
                     || pt->missing_from_dbus_fcn != pt_2->missing_from_dbus_fcn
                     || pt->gprop_to_dbus_fcn != pt_2->gprop_to_dbus_fcn
-                    || pt->gprop_from_dbus_fcn != pt_2->gprop_from_dbus_fcn)
+                    || pt->gprop_from_dbus_fcn != pt_2->gprop_from_dbus_fcn
+                    || pt->direct_type != pt_2->direct_type)
                     continue;
 
                 if ((pt == &nm_sett_info_propert_type_plain_i
@@ -4248,6 +4289,259 @@ test_setting_metadata(void)
 
 /*****************************************************************************/
 
+static void
+test_setting_direct_properties(void)
+{
+    gs_unref_object NMConnection *con   = NULL;
+    gs_unref_object NMConnection *con2  = NULL;
+    gs_unref_variant GVariant *variant  = NULL;
+    gs_unref_variant GVariant *variant2 = NULL;
+    NMSettingConnection *      s_con;
+    NMSettingConnection *      s_con2;
+
+    con = nmtst_create_minimal_connection("direct-1", NULL, NM_SETTING_WIRED_SETTING_NAME, &s_con);
+    g_object_set(s_con,
+                 NM_SETTING_CONNECTION_AUTOCONNECT,
+                 FALSE,
+                 NM_SETTING_CONNECTION_AUTOCONNECT_PRIORITY,
+                 -55,
+                 NM_SETTING_CONNECTION_GATEWAY_PING_TIMEOUT,
+                 (guint) 600,
+                 NM_SETTING_CONNECTION_ZONE,
+                 "",
+                 NM_SETTING_CONNECTION_MUD_URL,
+                 "https://example.com/mud.json",
+                 NULL);
+
+    g_assert(!nm_setting_connection_get_autoconnect(s_con));
+    g_assert_cmpint(nm_setting_connection_get_autoconnect_priority(s_con), ==, -55);
+    g_assert_cmpint(nm_setting_connection_get_gateway_ping_timeout(s_con), ==, 600);
+    g_assert_cmpstr(nm_setting_connection_get_zone(s_con), ==, "");
+
+    variant = nm_connection_to_dbus(con, NM_CONNECTION_SERIALIZE_ALL);
+    g_assert(variant);
+    {
+        gs_unref_variant GVariant *s_con_dict = NULL;
+        gboolean                   v_b;
+        gint32                     v_i;
+        guint32                    v_u;
+        const char *               v_s;
+
+        s_con_dict = g_variant_lookup_value(variant,
+                                            NM_SETTING_CONNECTION_SETTING_NAME,
+                                            NM_VARIANT_TYPE_SETTING);
+        g_assert(s_con_dict);
+        g_assert(g_variant_lookup(s_con_dict, NM_SETTING_CONNECTION_AUTOCONNECT, "b", &v_b));
+        g_assert(!v_b);
+        g_assert(
+            g_variant_lookup(s_con_dict, NM_SETTING_CONNECTION_AUTOCONNECT_PRIORITY, "i", &v_i));
+        g_assert_cmpint(v_i, ==, -55);
+        g_assert(
+            g_variant_lookup(s_con_dict, NM_SETTING_CONNECTION_GATEWAY_PING_TIMEOUT, "u", &v_u));
+        g_assert_cmpint(v_u, ==, 600);
+        g_assert(g_variant_lookup(s_con_dict, NM_SETTING_CONNECTION_ZONE, "&s", &v_s));
+        g_assert_cmpstr(v_s, ==, "");
+
+        /* properties at their default value are omitted. */
+        g_assert(!g_variant_lookup(s_con_dict, NM_SETTING_CONNECTION_MASTER, "&s", &v_s));
+        g_assert(!g_variant_lookup(s_con_dict, NM_SETTING_CONNECTION_READ_ONLY, "b", &v_b));
+        g_assert(!g_variant_lookup(s_con_dict, NM_SETTING_CONNECTION_MDNS, "i", &v_i));
+    }
+
+    con2   = nmtst_connection_duplicate_and_normalize(con);
+    s_con2 = nm_connection_get_setting_connection(con2);
+    g_assert(s_con2);
+    g_assert(!nm_setting_connection_get_autoconnect(s_con2));
+    g_assert_cmpint(nm_setting_connection_get_autoconnect_priority(s_con2), ==, -55);
+    g_assert_cmpstr(nm_setting_connection_get_mud_url(s_con2),
+                    ==,
+                    "https://example.com/mud.json");
+    nmtst_assert_connection_equals(con, FALSE, con2, FALSE);
+
+    variant2 = nm_connection_to_dbus(con2, NM_CONNECTION_SERIALIZE_ALL);
+    g_assert(g_variant_equal(variant, variant2));
+
+    g_object_set(s_con2, NM_SETTING_CONNECTION_ZONE, NULL, NULL);
+    g_assert(!nm_connection_compare(con, con2, NM_SETTING_COMPARE_FLAG_EXACT));
+    g_object_set(s_con2, NM_SETTING_CONNECTION_ZONE, "", NULL);
+    g_assert(nm_connection_compare(con, con2, NM_SETTING_COMPARE_FLAG_EXACT));
+
+    g_object_set(s_con2, NM_SETTING_CONNECTION_AUTOCONNECT_RETRIES, 5, NULL);
+    g_assert(!nm_connection_compare(con, con2, NM_SETTING_COMPARE_FLAG_EXACT));
+    g_object_set(s_con2, NM_SETTING_CONNECTION_AUTOCONNECT_RETRIES, -1, NULL);
+    g_assert(nm_connection_compare(con, con2, NM_SETTING_COMPARE_FLAG_EXACT));
+}
+
+static NMConnection *
+_direct_connection_new(guint i)
+{
+    NMConnection *       con;
+    NMSettingConnection *s_con;
+    NMSetting *          s_ip4;
+    NMSetting *          s_ip6;
+    gs_free char *       id              = g_strdup_printf("direct-%u", i);
+    const char *const    subchannels[]   = {"0.0.8000", "0.0.8001", "0.0.8002", NULL};
+    const char *const    subchannels_0[] = {NULL};
+
+    con = nmtst_create_minimal_connection(id, NULL, NM_SETTING_WIRED_SETTING_NAME, &s_con);
+    g_object_set(s_con,
+                 NM_SETTING_CONNECTION_AUTOCONNECT,
+                 (gboolean)(i % 2),
+                 NM_SETTING_CONNECTION_AUTOCONNECT_PRIORITY,
+                 (int) (i % 7) - 3,
+                 NM_SETTING_CONNECTION_ZONE,
+                 (i % 3) ? NULL : "",
+                 NULL);
+
+    /* s390-subchannels alternates between %NULL, empty and set, which
+     * serialize differently. */
+    g_object_set(nm_connection_get_setting_wired(con),
+                 NM_SETTING_WIRED_MTU,
+                 (guint)((i % 5) ? 0 : 1500 + i),
+                 NM_SETTING_WIRED_PORT,
+                 (i % 4) ? NULL : "tp",
+                 NM_SETTING_WIRED_S390_SUBCHANNELS,
+                 (i % 3) == 0 ? NULL : ((i % 3) == 1 ? subchannels_0 : subchannels),
+                 NM_SETTING_WIRED_WAKE_ON_LAN,
+                 (guint)((i % 2) ? NM_SETTING_WIRED_WAKE_ON_LAN_DEFAULT
+                                 : NM_SETTING_WIRED_WAKE_ON_LAN_MAGIC),
+                 NULL);
+
+    s_ip4 = nm_setting_ip4_config_new();
+    g_object_set(s_ip4,
+                 NM_SETTING_IP_CONFIG_METHOD,
+                 (i % 2) ? NM_SETTING_IP4_CONFIG_METHOD_AUTO : NM_SETTING_IP4_CONFIG_METHOD_MANUAL,
+                 NM_SETTING_IP_CONFIG_DHCP_HOSTNAME,
+                 (i % 3) ? "host" : NULL,
+                 NM_SETTING_IP_CONFIG_NEVER_DEFAULT,
+                 (gboolean)((i % 5) == 0),
+                 NM_SETTING_IP_CONFIG_DAD_TIMEOUT,
+                 (int) (i % 4) - 1,
+                 NM_SETTING_IP_CONFIG_ROUTE_TABLE,
+                 (guint)(i % 3),
+                 NM_SETTING_IP_CONFIG_GATEWAY,
+                 (i % 2) ? NULL : "192.168.1.1",
+                 NULL);
+    nm_connection_add_setting(con, s_ip4);
+
+    s_ip6 = nm_setting_ip6_config_new();
+    g_object_set(s_ip6,
+                 NM_SETTING_IP_CONFIG_METHOD,
+                 NM_SETTING_IP6_CONFIG_METHOD_AUTO,
+                 NM_SETTING_IP_CONFIG_MAY_FAIL,
+                 (gboolean)(i % 2),
+                 NM_SETTING_IP_CONFIG_DNS_PRIORITY,
+                 (int) (i % 3) * 50,
+                 NULL);
+    nm_connection_add_setting(con, s_ip6);
+
+    return con;
+}
+
+static void
+test_setting_direct_properties_gvalue(void)
+{
+    guint i;
+
+    /* the direct access must give the same results as going through GValue. */
+    for (i = 0; i < 30; i++) {
+        gs_unref_object NMConnection *con          = _direct_connection_new(i);
+        gs_unref_object NMConnection *other        = _direct_connection_new(i + 1);
+        gs_unref_object NMConnection *clone_direct = NULL;
+        gs_unref_object NMConnection *clone_gvalue = NULL;
+        gs_unref_variant GVariant *v_direct        = NULL;
+        gs_unref_variant GVariant *v_gvalue        = NULL;
+        gboolean                   equal_direct;
+        gboolean                   equal_gvalue;
+
+        nmtst_setting_direct_set_enabled(FALSE);
+        v_gvalue     = nm_connection_to_dbus(con, NM_CONNECTION_SERIALIZE_ALL);
+        clone_gvalue = nm_simple_connection_new_clone(con);
+        equal_gvalue = nm_connection_compare(con, other, NM_SETTING_COMPARE_FLAG_EXACT);
+
+        nmtst_setting_direct_set_enabled(TRUE);
+        v_direct     = nm_connection_to_dbus(con, NM_CONNECTION_SERIALIZE_ALL);
+        clone_direct = nm_simple_connection_new_clone(con);
+        equal_direct = nm_connection_compare(con, other, NM_SETTING_COMPARE_FLAG_EXACT);
+
+        g_assert(g_variant_equal(v_direct, v_gvalue));
+        g_assert(!equal_direct);
+        g_assert(!equal_gvalue);
+        g_assert(nm_connection_compare(clone_direct, clone_gvalue, NM_SETTING_COMPARE_FLAG_EXACT));
+        nmtst_assert_connection_equals(con, FALSE, clone_direct, FALSE);
+
+        /* the content hash uses the direct fields too. */
+        g_assert(memcmp(_nm_connection_get_content_hash(con, TRUE),
+                        _nm_connection_get_content_hash(clone_direct, TRUE),
+                        NM_CONNECTION_CONTENT_HASH_LEN)
+                 == 0);
+        g_assert(memcmp(_nm_connection_get_content_hash(con, TRUE),
+                        _nm_connection_get_content_hash(other, TRUE),
+                        NM_CONNECTION_CONTENT_HASH_LEN)
+                 != 0);
+    }
+}
+
+static void
+test_setting_direct_properties_bench(void)
+{
+    static const char *const     op_names[] = {"duplicate", "to-dbus", "compare"};
+    gs_unref_ptrarray GPtrArray *cons = g_ptr_array_new_with_free_func(g_object_unref);
+    const guint                  n    = 10000;
+    gint64                       t_usec[2][G_N_ELEMENTS(op_names)];
+    guint                        mode;
+    guint                        op;
+    guint                        i;
+
+    for (i = 0; i < n; i++)
+        g_ptr_array_add(cons, _direct_connection_new(i));
+
+    /* run the same operations with the direct access (mode 0) and with the
+     * GValue based one (mode 1). The clones are created per mode, so that
+     * neither mode benefits from a content hash cached by the other. */
+    for (mode = 0; mode < 2; mode++) {
+        gs_unref_ptrarray GPtrArray *clones = g_ptr_array_new_with_free_func(g_object_unref);
+        gint64                       t_start;
+
+        nmtst_setting_direct_set_enabled(mode == 0);
+
+        t_start = g_get_monotonic_time();
+        for (i = 0; i < n; i++)
+            g_ptr_array_add(clones, nm_simple_connection_new_clone(cons->pdata[i]));
+        t_usec[mode][0] = g_get_monotonic_time() - t_start;
+
+        t_start = g_get_monotonic_time();
+        for (i = 0; i < n; i++) {
+            gs_unref_variant GVariant *v = NULL;
+
+            v = nm_connection_to_dbus(clones->pdata[i], NM_CONNECTION_SERIALIZE_ALL);
+            g_assert(v);
+        }
+        t_usec[mode][1] = g_get_monotonic_time() - t_start;
+
+        t_start = g_get_monotonic_time();
+        for (i = 1; i < n; i++) {
+            g_assert(!nm_connection_compare(clones->pdata[i - 1],
+                                            clones->pdata[i],
+                                            NM_SETTING_COMPARE_FLAG_EXACT));
+        }
+        t_usec[mode][2] = g_get_monotonic_time() - t_start;
+    }
+    nmtst_setting_direct_set_enabled(TRUE);
+
+    for (op = 0; op < G_N_ELEMENTS(op_names); op++) {
+        g_test_message("%u profiles, %s: direct %" G_GINT64_FORMAT " usec, GValue %" G_GINT64_FORMAT
+                       " usec (%.2fx)",
+                       n,
+                       op_names[op],
+                       t_usec[0][op],
+                       t_usec[1][op],
+                       (double) t_usec[1][op] / (double) NM_MAX(t_usec[0][op], 1));
+    }
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -4351,6 +4645,13 @@ main(int argc, char **argv)
     g_test_add_func("/libnm/test_empty_setting", test_empty_setting);
 
     g_test_add_func("/libnm/test_setting_metadata", test_setting_metadata);
+    g_test_add_func("/libnm/test_setting_direct_properties", test_setting_direct_properties);
+    g_test_add_func("/libnm/test_setting_direct_properties_gvalue",
+                    test_setting_direct_properties_gvalue);
+    if (g_test_perf()) {
+        g_test_add_func("/libnm/test_setting_direct_properties_bench",
+                        test_setting_direct_properties_bench);
+    }
 
     return g_test_run();
 }
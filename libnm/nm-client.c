@@ -9,6 +9,7 @@
 #include "nm-client.h"
 
 #include <libudev.h>
+#include <unistd.h>
 
 #include "nm-std-aux/c-list-util.h"
 #include "nm-glib-aux/nm-c-list.h"
@@ -260,6 +261,11 @@ typedef struct {
     GCancellable *   name_owner_get_cancellable;
     GCancellable *   get_managed_objects_cancellable;
 
+    /* during the initial GetManagedObjects(), the GetSettings() calls for the
+     * connections are collected here and issued as one GetAllSettings() call. */
+    GArray *      get_settings_batch;
+    GCancellable *get_all_settings_cancellable;
+
     CList queue_notify_lst_head;
     CList notify_event_lst_head;
 
@@ -277,16 +283,19 @@ typedef struct {
     guint8 *      permissions;
     GCancellable *permissions_cancellable;
 
-    char *name_owner;
-    guint name_owner_changed_id;
-    guint dbsid_nm_object_manager;
-    guint dbsid_dbus_properties_properties_changed;
-    guint dbsid_nm_settings_connection_updated;
-    guint dbsid_nm_connection_active_state_changed;
-    guint dbsid_nm_vpn_connection_state_changed;
-    guint dbsid_nm_check_permissions;
+    char * name_owner;
+    guint  name_owner_changed_id;
+    guint  dbsid_nm_object_manager;
+    guint  dbsid_dbus_properties_properties_changed;
+    guint *dbsids_dbus_properties_properties_changed;
+    guint  dbsid_nm_settings_connection_updated;
+    guint  dbsid_nm_connection_active_state_changed;
+    guint  dbsid_nm_vpn_connection_state_changed;
+    guint  dbsid_nm_check_permissions;
+
+    gulong dbus_peer_closed_id;
 
-    NMClientInstanceFlags instance_flags : 3;
+    NMClientInstanceFlags instance_flags : 5;
 
     NMTernary permissions_state : 3;
 
@@ -294,6 +303,13 @@ typedef struct {
 
     bool udev_inited : 1;
     bool notify_event_lst_changed : 1;
+
+    /* whether @dbus_connection is a peer-to-peer connection to NetworkManager's
+     * private socket (without message bus), and whether we created it ourselves. */
+    bool dbus_peer : 1;
+    bool dbus_peer_auto : 1;
+
+    bool get_all_settings_unsupported : 1;
     bool check_dbobj_visible_all : 1;
     bool nm_running : 1;
 
@@ -376,6 +392,16 @@ static void _set_nm_running(NMClient *self);
 
 /*****************************************************************************/
 
+/* On a peer-to-peer connection there is no message bus. D-Bus calls and signal
+ * subscriptions then must not specify a bus name. */
+static const char *
+_dbus_bus_name(NMClientPrivate *priv)
+{
+    return priv->dbus_peer ? NULL : priv->name_owner;
+}
+
+/*****************************************************************************/
+
 static NMRefString *_dbus_path_nm          = NULL;
 static NMRefString *_dbus_path_settings    = NULL;
 static NMRefString *_dbus_path_dns_manager = NULL;
@@ -547,7 +573,7 @@ _nm_client_dbus_call_simple(NMClient *          self,
                        parameters ? (log_str = g_variant_print(parameters, TRUE)) : "NULL");
 
     g_dbus_connection_call(priv->dbus_connection,
-                           priv->name_owner,
+                           _dbus_bus_name(priv),
                            object_path,
                            interface_name,
                            method_name,
@@ -659,7 +685,7 @@ _nm_client_dbus_call_sync(NMClient *          self,
     }
 
     ret = g_dbus_connection_call_sync(priv->dbus_connection,
-                                      priv->name_owner,
+                                      _dbus_bus_name(priv),
                                       object_path,
                                       interface_name,
                                       method_name,
@@ -740,7 +766,7 @@ _nm_client_set_property_sync_legacy(NMClient *  self,
     /* A synchronous D-Bus call that is not cancellable an ignores the return value.
      * This function only exists for backward compatibility. */
     ret = g_dbus_connection_call_sync(priv->dbus_connection,
-                                      priv->name_owner,
+                                      _dbus_bus_name(priv),
                                       object_path,
                                       DBUS_INTERFACE_PROPERTIES,
                                       "Set",
@@ -1617,6 +1643,64 @@ _dbobjs_obj_watcher_unregister(NMClient *self, gpointer obj_watcher_base)
 
 /*****************************************************************************/
 
+#define _INSTANCE_FLAGS_FILTER_MASK                                                \
+    (NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS                              \
+     | NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS | NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS)
+
+static gboolean
+_dbus_iface_is_filtered(NMClient *self, const char *interface_name)
+{
+    NMClientInstanceFlags flags = NM_CLIENT_GET_PRIVATE(self)->instance_flags;
+
+    if (G_LIKELY(!NM_FLAGS_ANY(flags, _INSTANCE_FLAGS_FILTER_MASK)))
+        return FALSE;
+
+    if (NM_FLAGS_HAS(flags, NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS)
+        && nm_streq(interface_name, NM_DBUS_INTERFACE_SETTINGS_CONNECTION))
+        return TRUE;
+
+    if (NM_FLAGS_HAS(flags, NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS)
+        && NM_IN_STRSET(interface_name,
+                        NM_DBUS_INTERFACE_ACCESS_POINT,
+                        NM_DBUS_INTERFACE_WIFI_P2P_PEER))
+        return TRUE;
+
+    if (NM_FLAGS_HAS(flags, NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS)
+        && NM_IN_STRSET(interface_name,
+                        NM_DBUS_INTERFACE_IP4_CONFIG,
+                        NM_DBUS_INTERFACE_IP6_CONFIG,
+                        NM_DBUS_INTERFACE_DHCP4_CONFIG,
+                        NM_DBUS_INTERFACE_DHCP6_CONFIG))
+        return TRUE;
+
+    return FALSE;
+}
+
+static gboolean
+_dbus_gtype_is_filtered(NMClient *self, GType gtype)
+{
+    NMClientInstanceFlags flags = NM_CLIENT_GET_PRIVATE(self)->instance_flags;
+
+    if (G_LIKELY(!NM_FLAGS_ANY(flags, _INSTANCE_FLAGS_FILTER_MASK)))
+        return FALSE;
+
+    if (NM_FLAGS_HAS(flags, NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS)
+        && g_type_is_a(gtype, NM_TYPE_REMOTE_CONNECTION))
+        return TRUE;
+
+    if (NM_FLAGS_HAS(flags, NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS)
+        && (g_type_is_a(gtype, NM_TYPE_ACCESS_POINT) || g_type_is_a(gtype, NM_TYPE_WIFI_P2P_PEER)))
+        return TRUE;
+
+    if (NM_FLAGS_HAS(flags, NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS)
+        && (g_type_is_a(gtype, NM_TYPE_IP_CONFIG) || g_type_is_a(gtype, NM_TYPE_DHCP_CONFIG)))
+        return TRUE;
+
+    return FALSE;
+}
+
+/*****************************************************************************/
+
 typedef struct {
     NMLDBusObjWatcher parent;
     NMLDBusPropertyO *pr_o;
@@ -1675,7 +1759,10 @@ nml_dbus_property_o_notify_changed(NMLDBusPropertyO *pr_o, NMClient *self)
                 pr_o->owner_dbobj->dbus_path->str,
                 pr_o->meta_iface->dbus_properties[pr_o->dbus_property_idx].dbus_property_name,
                 pr_o->obj_watcher->dbobj->dbus_path->str);
-        } else {
+        } else if (!_dbus_gtype_is_filtered(
+                       self,
+                       pr_o->meta_iface->dbus_properties[pr_o->dbus_property_idx]
+                           .extra.property_vtable_o->get_o_type_fcn())) {
             NML_NMCLIENT_LOG_E(
                 self,
                 "[%s]: property %s references %s but object is not present on D-Bus",
@@ -1988,7 +2075,10 @@ nml_dbus_property_ao_notify_changed(NMLDBusPropertyAO *pr_ao, NMClient *self)
                     pr_ao->owner_dbobj->dbus_path->str,
                     pr_ao->meta_iface->dbus_properties[pr_ao->dbus_property_idx].dbus_property_name,
                     pr_ao_data->obj_watcher.dbobj->dbus_path->str);
-            } else {
+            } else if (!_dbus_gtype_is_filtered(
+                           self,
+                           pr_ao->meta_iface->dbus_properties[pr_ao->dbus_property_idx]
+                               .extra.property_vtable_ao->get_o_type_fcn())) {
                 NML_NMCLIENT_LOG_E(
                     self,
                     "[%s]: property %s references %s but object is not present on D-Bus",
@@ -3050,6 +3140,9 @@ _dbus_handle_interface_added(NMClient *  self,
     while (g_variant_iter_next(&iter_ifaces, "{&s@a{sv}}", &interface_name, &changed_properties)) {
         _nm_unused gs_unref_variant GVariant *changed_properties_free = changed_properties;
 
+        if (_dbus_iface_is_filtered(self, interface_name))
+            continue;
+
         if (_dbus_handle_properties_changed(self,
                                             log_context,
                                             object_path,
@@ -3080,6 +3173,14 @@ _dbus_handle_interface_removed(NMClient *         self,
     } else {
         dbobj = _dbobjs_dbobj_get_s(self, object_path);
         if (!dbobj) {
+            for (i = 0; removed_interfaces[i]; i++) {
+                if (!_dbus_iface_is_filtered(self, removed_interfaces[i]))
+                    break;
+            }
+            if (i > 0 && !removed_interfaces[i]) {
+                /* all interfaces are filtered. We don't track the object. */
+                return FALSE;
+            }
             NML_NMCLIENT_LOG_E(self,
                                "%s: [%s]: receive interface removed event for non existing object",
                                log_context,
@@ -3093,6 +3194,9 @@ _dbus_handle_interface_removed(NMClient *         self,
         NMLDBusObjIfaceData *db_iface_data;
         const char *         interface_name = removed_interfaces[i];
 
+        if (_dbus_iface_is_filtered(self, interface_name))
+            continue;
+
         db_iface_data = nml_dbus_object_iface_data_get(dbobj, interface_name, FALSE);
         if (!db_iface_data) {
             NML_NMCLIENT_LOG_E(
@@ -3206,6 +3310,9 @@ _dbus_properties_changed_cb(GDBusConnection *connection,
                   &changed_properties,
                   &invalidated_properties);
 
+    if (_dbus_iface_is_filtered(self, interface_name))
+        return;
+
     if (invalidated_properties && invalidated_properties[0]) {
         NML_NMCLIENT_LOG_W(self,
                            "%s: [%s] ignore invalidated properties on interface %s",
@@ -3224,6 +3331,20 @@ _dbus_properties_changed_cb(GDBusConnection *connection,
         _dbus_handle_changes(self, log_context, TRUE);
 }
 
+typedef struct {
+    NMRemoteConnection *remote_connection;
+    GCancellable *      cancellable;
+} GetSettingsBatchEntry;
+
+static void
+_get_settings_batch_entry_clear(GetSettingsBatchEntry *entry)
+{
+    g_object_unref(entry->remote_connection);
+    g_object_unref(entry->cancellable);
+}
+
+static void _nm_client_get_all_settings_call(NMClient *self);
+
 static void
 _dbus_get_managed_objects_cb(GObject *source, GAsyncResult *result, gpointer user_data)
 {
@@ -3272,9 +3393,16 @@ _dbus_get_managed_objects_cb(GObject *source, GAsyncResult *result, gpointer use
         }
     }
 
+    nm_assert(!priv->get_settings_batch);
+    priv->get_settings_batch = g_array_new(FALSE, FALSE, sizeof(GetSettingsBatchEntry));
+    g_array_set_clear_func(priv->get_settings_batch,
+                           (GDestroyNotify) _get_settings_batch_entry_clear);
+
     /* always call _dbus_handle_changes(), even if nothing changed. We need this to complete
      * initialization. */
     _dbus_handle_changes(self, "get-managed-objects", TRUE);
+
+    _nm_client_get_all_settings_call(self);
 }
 
 /*****************************************************************************/
@@ -3318,16 +3446,14 @@ _nm_client_get_settings_call_cb(GObject *source, GAsyncResult *result, gpointer
     _dbus_handle_changes_commit(self, TRUE);
 }
 
-void
-_nm_client_get_settings_call(NMClient *self, NMLDBusObject *dbobj)
+static void
+_nm_client_get_settings_call_one(NMClient *          self,
+                                 NMRemoteConnection *remote_connection,
+                                 GCancellable *      cancellable)
 {
-    GCancellable *cancellable;
-
-    cancellable = _nm_remote_settings_get_settings_prepare(NM_REMOTE_CONNECTION(dbobj->nmobj));
-
     _nm_client_dbus_call_simple(self,
                                 cancellable,
-                                dbobj->dbus_path->str,
+                                _nm_object_get_path(remote_connection),
                                 NM_DBUS_INTERFACE_SETTINGS_CONNECTION,
                                 "GetSettings",
                                 g_variant_new("()"),
@@ -3335,7 +3461,146 @@ _nm_client_get_settings_call(NMClient *self, NMLDBusObject *dbobj)
                                 G_DBUS_CALL_FLAGS_NONE,
                                 NM_DBUS_DEFAULT_TIMEOUT_MSEC,
                                 _nm_client_get_settings_call_cb,
-                                dbobj->nmobj);
+                                remote_connection);
+}
+
+void
+_nm_client_get_settings_call(NMClient *self, NMLDBusObject *dbobj)
+{
+    NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE(self);
+    GCancellable *   cancellable;
+
+    cancellable = _nm_remote_settings_get_settings_prepare(NM_REMOTE_CONNECTION(dbobj->nmobj));
+
+    if (priv->get_settings_batch) {
+        GetSettingsBatchEntry entry = {
+            .remote_connection = g_object_ref(NM_REMOTE_CONNECTION(dbobj->nmobj)),
+            .cancellable       = g_object_ref(cancellable),
+        };
+
+        g_array_append_val(priv->get_settings_batch, entry);
+        return;
+    }
+
+    _nm_client_get_settings_call_one(self, NM_REMOTE_CONNECTION(dbobj->nmobj), cancellable);
+}
+
+static void
+_nm_client_get_all_settings_call_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    NMClient *       self;
+    NMClientPrivate *priv;
+    gs_unref_array GArray *entries          = NULL;
+    gs_unref_variant GVariant *ret          = NULL;
+    gs_unref_variant GVariant *settings_all = NULL;
+    gs_unref_hashtable GHashTable *settings_by_path = NULL;
+    gs_free_error GError *error                     = NULL;
+    GVariantIter          iter;
+    const char *          path;
+    GVariant *            settings;
+    guint                 i;
+
+    nm_utils_user_data_unpack(user_data, &self, &entries);
+
+    ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), result, &error);
+    if (!ret && nm_utils_error_is_cancelled(error))
+        return;
+
+    priv = NM_CLIENT_GET_PRIVATE(self);
+
+    g_clear_object(&priv->get_all_settings_cancellable);
+
+    if (!ret) {
+        if (g_error_matches(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD))
+            priv->get_all_settings_unsupported = TRUE;
+
+        NML_NMCLIENT_LOG_D(self,
+                           "GetAllSettings() failed, fall back to GetSettings(): %s",
+                           error->message);
+
+        for (i = 0; i < entries->len; i++) {
+            const GetSettingsBatchEntry *entry =
+                &g_array_index(entries, GetSettingsBatchEntry, i);
+
+            if (g_cancellable_is_cancelled(entry->cancellable))
+                continue;
+            _nm_client_get_settings_call_one(self, entry->remote_connection, entry->cancellable);
+        }
+        return;
+    }
+
+    NML_NMCLIENT_LOG_T(self, "GetAllSettings() completed for %u connections", entries->len);
+
+    g_variant_get(ret, "(@a{oa{sa{sv}}})", &settings_all);
+
+    settings_by_path =
+        g_hash_table_new_full(nm_str_hash, g_str_equal, NULL, (GDestroyNotify) g_variant_unref);
+    g_variant_iter_init(&iter, settings_all);
+    while (g_variant_iter_next(&iter, "{&o@a{sa{sv}}}", &path, &settings))
+        g_hash_table_insert(settings_by_path, (gpointer) path, settings);
+
+    for (i = 0; i < entries->len; i++) {
+        const GetSettingsBatchEntry *entry = &g_array_index(entries, GetSettingsBatchEntry, i);
+
+        /* the cancellable is cancelled if the connection was removed in the
+         * meantime, or if a newer GetSettings() call is pending. */
+        if (g_cancellable_is_cancelled(entry->cancellable))
+            continue;
+
+        /* connections that are not visible to us are omitted from the
+         * result. That is the same as a failed GetSettings() call. */
+        _nm_remote_settings_get_settings_commit(
+            entry->remote_connection,
+            g_hash_table_lookup(settings_by_path, _nm_object_get_path(entry->remote_connection)));
+    }
+
+    _dbus_handle_changes_commit(self, TRUE);
+}
+
+static void
+_nm_client_get_all_settings_call(NMClient *self)
+{
+    NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE(self);
+    gs_unref_array GArray *entries = NULL;
+    gs_free const char **  paths   = NULL;
+    guint                  i;
+
+    entries = g_steal_pointer(&priv->get_settings_batch);
+
+    if (!entries || entries->len == 0)
+        return;
+
+    if (priv->get_all_settings_unsupported || entries->len == 1) {
+        for (i = 0; i < entries->len; i++) {
+            const GetSettingsBatchEntry *entry =
+                &g_array_index(entries, GetSettingsBatchEntry, i);
+
+            _nm_client_get_settings_call_one(self, entry->remote_connection, entry->cancellable);
+        }
+        return;
+    }
+
+    paths = g_new(const char *, entries->len + 1u);
+    for (i = 0; i < entries->len; i++) {
+        paths[i] =
+            _nm_object_get_path(g_array_index(entries, GetSettingsBatchEntry, i).remote_connection);
+    }
+    paths[i] = NULL;
+
+    nm_clear_g_cancellable(&priv->get_all_settings_cancellable);
+    priv->get_all_settings_cancellable = g_cancellable_new();
+
+    _nm_client_dbus_call_simple(self,
+                                priv->get_all_settings_cancellable,
+                                NM_DBUS_PATH_SETTINGS,
+                                NM_DBUS_INTERFACE_SETTINGS,
+                                "GetAllSettings",
+                                g_variant_new("(^ao)", paths),
+                                G_VARIANT_TYPE("(a{oa{sa{sv}}})"),
+                                G_DBUS_CALL_FLAGS_NONE,
+                                NM_DBUS_DEFAULT_TIMEOUT_MSEC,
+                                _nm_client_get_all_settings_call_cb,
+                                nm_utils_user_data_pack(self, g_steal_pointer(&entries)));
 }
 
 static void
@@ -3965,6 +4230,13 @@ nm_client_get_instance_flags(NMClient *self)
  * constructing the instance (as "dbus-connection" property), or it will be
  * automatically initialized during async/sync init.
  *
+ * Note that with %NM_CLIENT_INSTANCE_FLAGS_USE_PRIVATE_SOCKET, the automatically
+ * chosen connection can be a peer-to-peer connection to NetworkManager instead
+ * of a message bus connection. Such a connection has no unique name and cannot
+ * reach other D-Bus services (like polkit). If NetworkManager quits, the client
+ * changes to the message bus and the connection changes (with a notification
+ * for #NMClient:dbus-connection).
+ *
  * Returns: (transfer none): the D-Bus connection of the client, or %NULL if none is set.
  *
  * Since: 1.22
@@ -3982,6 +4254,8 @@ nm_client_get_dbus_connection(NMClient *client)
  * @client: a #NMClient
  *
  * Returns: (transfer none): the current name owner of the D-Bus service of NetworkManager.
+ *   If the client talks to NetworkManager via the private socket (without message
+ *   bus), this is the well-known name "org.freedesktop.NetworkManager".
  *
  * Since: 1.22
  **/
@@ -5638,6 +5912,26 @@ _add_connection_call(NMClient *                    self,
     g_return_if_fail(!settings || g_variant_is_of_type(settings, G_VARIANT_TYPE("a{sa{sv}}")));
     g_return_if_fail(!args || g_variant_is_of_type(args, G_VARIANT_TYPE("a{sv}")));
 
+    if (NM_FLAGS_HAS((NMClientInstanceFlags) NM_CLIENT_GET_PRIVATE(self)->instance_flags,
+                     NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS)) {
+        gs_unref_object GTask *task = NULL;
+
+        /* The result is a #NMRemoteConnection, which this instance does not
+         * cache. Refuse right away, instead of adding the profile and failing
+         * afterwards. */
+        if (settings)
+            nm_g_variant_unref_floating(settings);
+        if (args)
+            nm_g_variant_unref_floating(args);
+        task = nm_g_task_new(self, cancellable, source_tag, callback, user_data);
+        g_task_return_new_error(task,
+                                NM_CLIENT_ERROR,
+                                NM_CLIENT_ERROR_FAILED,
+                                _("cannot add a connection profile because the client does "
+                                  "not cache connection profiles"));
+        return;
+    }
+
     NML_NMCLIENT_LOG_D(self, "AddConnection() started...");
 
     if (!settings)
@@ -5723,6 +6017,9 @@ _add_connection_call(NMClient *                    self,
  * Note that the #NMRemoteConnection returned in @callback may not contain
  * identical settings to @connection as NetworkManager may perform automatic
  * completion and/or normalization of connection properties.
+ *
+ * This fails without adding the profile if @client was created with
+ * %NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS.
  **/
 void
 nm_client_add_connection_async(NMClient *          client,
@@ -5784,6 +6081,9 @@ nm_client_add_connection_finish(NMClient *client, GAsyncResult *result, GError *
  *
  * Call AddConnection2() D-Bus API asynchronously.
  *
+ * Like nm_client_add_connection_async(), this fails without adding the profile
+ * if @client was created with %NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS.
+ *
  * Since: 1.20
  **/
 void
@@ -6825,6 +7125,71 @@ nm_client_dbus_set_property_finish(NMClient *client, GAsyncResult *result, GErro
 
 /*****************************************************************************/
 
+static void
+_init_subscribe_properties_changed(NMClient *self)
+{
+    NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE(self);
+    guint            n    = 0;
+    guint            i;
+
+    nm_assert(!priv->dbsids_dbus_properties_properties_changed);
+
+    if (!NM_FLAGS_ANY((NMClientInstanceFlags) priv->instance_flags, _INSTANCE_FLAGS_FILTER_MASK)) {
+        priv->dbsid_dbus_properties_properties_changed =
+            nm_dbus_connection_signal_subscribe_properties_changed(priv->dbus_connection,
+                                                                   _dbus_bus_name(priv),
+                                                                   NULL,
+                                                                   NULL,
+                                                                   _dbus_properties_changed_cb,
+                                                                   self,
+                                                                   NULL);
+        return;
+    }
+
+    /* A match rule cannot exclude an interface. Instead, match the interface
+     * name (arg0) of each interface that we don't filter, so that the bus does
+     * not even send us the property changes of the objects that we don't cache.
+     *
+     * That doesn't work for InterfacesAdded/InterfacesRemoved, which carry
+     * the object path as arg0. Those are still filtered on our side. */
+    priv->dbsids_dbus_properties_properties_changed =
+        g_new0(guint, G_N_ELEMENTS(_nml_dbus_meta_ifaces) + 1);
+    for (i = 0; i < G_N_ELEMENTS(_nml_dbus_meta_ifaces); i++) {
+        const char *dbus_iface_name = _nml_dbus_meta_ifaces[i]->dbus_iface_name;
+
+        if (_dbus_iface_is_filtered(self, dbus_iface_name))
+            continue;
+
+        priv->dbsids_dbus_properties_properties_changed[n++] =
+            nm_dbus_connection_signal_subscribe_properties_changed(priv->dbus_connection,
+                                                                   _dbus_bus_name(priv),
+                                                                   NULL,
+                                                                   dbus_iface_name,
+                                                                   _dbus_properties_changed_cb,
+                                                                   self,
+                                                                   NULL);
+    }
+}
+
+static void
+_init_unsubscribe_properties_changed(NMClient *self)
+{
+    NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE(self);
+    guint            i;
+
+    nm_clear_g_dbus_connection_signal(priv->dbus_connection,
+                                      &priv->dbsid_dbus_properties_properties_changed);
+
+    if (!priv->dbsids_dbus_properties_properties_changed)
+        return;
+
+    for (i = 0; priv->dbsids_dbus_properties_properties_changed[i] != 0; i++) {
+        g_dbus_connection_signal_unsubscribe(priv->dbus_connection,
+                                             priv->dbsids_dbus_properties_properties_changed[i]);
+    }
+    nm_clear_g_free(&priv->dbsids_dbus_properties_properties_changed);
+}
+
 static void
 _init_fetch_all(NMClient *self)
 {
@@ -6841,37 +7206,33 @@ _init_fetch_all(NMClient *self)
 
     priv->dbsid_nm_object_manager =
         nm_dbus_connection_signal_subscribe_object_manager(priv->dbus_connection,
-                                                           priv->name_owner,
+                                                           _dbus_bus_name(priv),
                                                            "/org/freedesktop",
                                                            NULL,
                                                            _dbus_managed_objects_changed_cb,
                                                            self,
                                                            NULL);
 
-    priv->dbsid_dbus_properties_properties_changed =
-        nm_dbus_connection_signal_subscribe_properties_changed(priv->dbus_connection,
-                                                               priv->name_owner,
-                                                               NULL,
-                                                               NULL,
-                                                               _dbus_properties_changed_cb,
-                                                               self,
-                                                               NULL);
+    _init_subscribe_properties_changed(self);
 
-    priv->dbsid_nm_settings_connection_updated =
-        g_dbus_connection_signal_subscribe(priv->dbus_connection,
-                                           priv->name_owner,
-                                           NM_DBUS_INTERFACE_SETTINGS_CONNECTION,
-                                           "Updated",
-                                           NULL,
-                                           NULL,
-                                           G_DBUS_SIGNAL_FLAGS_NONE,
-                                           _dbus_settings_updated_cb,
-                                           self,
-                                           NULL);
+    if (!NM_FLAGS_HAS((NMClientInstanceFlags) priv->instance_flags,
+                      NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS)) {
+        priv->dbsid_nm_settings_connection_updated =
+            g_dbus_connection_signal_subscribe(priv->dbus_connection,
+                                               _dbus_bus_name(priv),
+                                               NM_DBUS_INTERFACE_SETTINGS_CONNECTION,
+                                               "Updated",
+                                               NULL,
+                                               NULL,
+                                               G_DBUS_SIGNAL_FLAGS_NONE,
+                                               _dbus_settings_updated_cb,
+                                               self,
+                                               NULL);
+    }
 
     priv->dbsid_nm_connection_active_state_changed =
         g_dbus_connection_signal_subscribe(priv->dbus_connection,
-                                           priv->name_owner,
+                                           _dbus_bus_name(priv),
                                            NM_DBUS_INTERFACE_ACTIVE_CONNECTION,
                                            "StateChanged",
                                            NULL,
@@ -6883,7 +7244,7 @@ _init_fetch_all(NMClient *self)
 
     priv->dbsid_nm_vpn_connection_state_changed =
         g_dbus_connection_signal_subscribe(priv->dbus_connection,
-                                           priv->name_owner,
+                                           _dbus_bus_name(priv),
                                            NM_DBUS_INTERFACE_VPN_CONNECTION,
                                            "VpnStateChanged",
                                            NULL,
@@ -6895,7 +7256,7 @@ _init_fetch_all(NMClient *self)
 
     priv->dbsid_nm_check_permissions =
         g_dbus_connection_signal_subscribe(priv->dbus_connection,
-                                           priv->name_owner,
+                                           _dbus_bus_name(priv),
                                            NM_DBUS_INTERFACE,
                                            "CheckPermissions",
                                            NULL,
@@ -6906,7 +7267,7 @@ _init_fetch_all(NMClient *self)
                                            NULL);
 
     g_dbus_connection_call(priv->dbus_connection,
-                           priv->name_owner,
+                           _dbus_bus_name(priv),
                            "/org/freedesktop",
                            DBUS_INTERFACE_OBJECT_MANAGER,
                            "GetManagedObjects",
@@ -6934,10 +7295,10 @@ _init_release_all(NMClient *self)
 
     nm_clear_g_cancellable(&priv->permissions_cancellable);
     nm_clear_g_cancellable(&priv->get_managed_objects_cancellable);
+    nm_clear_g_cancellable(&priv->get_all_settings_cancellable);
 
     nm_clear_g_dbus_connection_signal(priv->dbus_connection, &priv->dbsid_nm_object_manager);
-    nm_clear_g_dbus_connection_signal(priv->dbus_connection,
-                                      &priv->dbsid_dbus_properties_properties_changed);
+    _init_unsubscribe_properties_changed(self);
     nm_clear_g_dbus_connection_signal(priv->dbus_connection,
                                       &priv->dbsid_nm_settings_connection_updated);
     nm_clear_g_dbus_connection_signal(priv->dbus_connection,
@@ -7033,13 +7394,15 @@ name_owner_changed(NMClient *self, const char *name_owner)
 
         _assert_main_context_is_current_thread_default(self, dbus_context);
 
-        priv->name_owner_changed_id =
-            nm_dbus_connection_signal_subscribe_name_owner_changed(priv->dbus_connection,
-                                                                   NM_DBUS_SERVICE,
-                                                                   name_owner_changed_cb,
-                                                                   self,
-                                                                   NULL);
-        name_owner_get_call(self);
+        if (!priv->dbus_peer) {
+            priv->name_owner_changed_id =
+                nm_dbus_connection_signal_subscribe_name_owner_changed(priv->dbus_connection,
+                                                                       NM_DBUS_SERVICE,
+                                                                       name_owner_changed_cb,
+                                                                       self,
+                                                                       NULL);
+            name_owner_get_call(self);
+        }
     } else
         dbus_context = nm_g_main_context_push_thread_default_if_necessary(priv->dbus_context);
 
@@ -7285,6 +7648,64 @@ _init_start_cancel_on_idle_cb(gpointer user_data)
     return G_SOURCE_CONTINUE;
 }
 
+static void
+_dbus_peer_bus_get_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    gs_unref_object NMClient *self = user_data;
+    NMClientPrivate *         priv = NM_CLIENT_GET_PRIVATE(self);
+    nm_auto_pop_gmaincontext GMainContext *dbus_context = NULL;
+    gs_free_error GError *error                         = NULL;
+    GDBusConnection *     dbus_connection;
+
+    dbus_connection = g_bus_get_finish(result, &error);
+    if (!dbus_connection) {
+        NML_NMCLIENT_LOG_W(self, "cannot connect to D-Bus: %s", error->message);
+        return;
+    }
+
+    dbus_context = nm_g_main_context_push_thread_default_if_necessary(priv->dbus_context);
+
+    g_object_unref(priv->dbus_connection);
+    priv->dbus_connection = dbus_connection;
+    priv->dbus_peer       = FALSE;
+    priv->dbus_peer_auto  = FALSE;
+
+    priv->name_owner_changed_id =
+        nm_dbus_connection_signal_subscribe_name_owner_changed(priv->dbus_connection,
+                                                               NM_DBUS_SERVICE,
+                                                               name_owner_changed_cb,
+                                                               self,
+                                                               NULL);
+    name_owner_get_call(self);
+
+    _notify(self, PROP_DBUS_CONNECTION);
+}
+
+static void
+_dbus_peer_closed_cb(GDBusConnection *connection,
+                     gboolean         remote_peer_vanished,
+                     GError *         error,
+                     gpointer         user_data)
+{
+    NMClient *       self = user_data;
+    NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE(self);
+
+    NML_NMCLIENT_LOG_D(self, "private connection to NetworkManager closed");
+
+    nm_clear_g_signal_handler(priv->dbus_connection, &priv->dbus_peer_closed_id);
+
+    name_owner_changed(self, NULL);
+
+    if (priv->dbus_peer_auto) {
+        nm_auto_pop_gmaincontext GMainContext *dbus_context = NULL;
+
+        /* NetworkManager quit. Continue on the message bus, where we can
+         * notice when it comes back. */
+        dbus_context = nm_g_main_context_push_thread_default_if_necessary(priv->dbus_context);
+        g_bus_get(_nm_dbus_bus_type(), NULL, _dbus_peer_bus_get_cb, g_object_ref(self));
+    }
+}
+
 static void
 _init_start_with_bus(NMClient *self)
 {
@@ -7308,6 +7729,19 @@ _init_start_with_bus(NMClient *self)
 
     _assert_main_context_is_current_thread_default(self, dbus_context);
 
+    if (!g_dbus_connection_get_unique_name(priv->dbus_connection)) {
+        /* A peer-to-peer connection to NetworkManager's private socket. There is
+         * no message bus and no name owner to watch. Instead, the connection gets
+         * closed when NetworkManager quits. */
+        priv->dbus_peer           = TRUE;
+        priv->dbus_peer_closed_id = g_signal_connect(priv->dbus_connection,
+                                                     "closed",
+                                                     G_CALLBACK(_dbus_peer_closed_cb),
+                                                     self);
+        name_owner_changed(self, NM_DBUS_SERVICE);
+        return;
+    }
+
     priv->name_owner_changed_id =
         nm_dbus_connection_signal_subscribe_name_owner_changed(priv->dbus_connection,
                                                                NM_DBUS_SERVICE,
@@ -7342,6 +7776,75 @@ _init_start_bus_get_cb(GObject *source, GAsyncResult *result, gpointer user_data
     _notify(self, PROP_DBUS_CONNECTION);
 }
 
+static void
+_init_start_peer_new_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    NMClient *       self = user_data;
+    NMClientPrivate *priv;
+    GDBusConnection *dbus_connection;
+    GError *         error = NULL;
+
+    nm_assert(NM_IS_CLIENT(self));
+
+    dbus_connection = g_dbus_connection_new_for_address_finish(result, &error);
+
+    priv = NM_CLIENT_GET_PRIVATE(self);
+
+    if (!dbus_connection) {
+        if (nm_utils_error_is_cancelled(error)) {
+            _init_start_complete(self, error);
+            return;
+        }
+        NML_NMCLIENT_LOG_D(self, "cannot connect to private socket: %s", error->message);
+        g_error_free(error);
+        g_bus_get(_nm_dbus_bus_type(), priv->init_data->cancellable, _init_start_bus_get_cb, self);
+        return;
+    }
+
+    priv->dbus_connection = dbus_connection;
+    priv->dbus_peer_auto  = TRUE;
+
+    _init_start_with_bus(self);
+
+    _notify(self, PROP_DBUS_CONNECTION);
+}
+
+static const char *_private_socket_path_for_test = NULL;
+
+void
+nmtst_client_set_private_socket_path(const char *socket_path)
+{
+    _private_socket_path_for_test = socket_path;
+}
+
+static const char *
+_init_private_socket_path(NMClient *self)
+{
+    NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE(self);
+    const char *     path;
+
+    /* NetworkManager optionally exports its API on a private unix socket, which
+     * only accepts root. Using it avoids the detour via the message bus, but
+     * the client must ask for it. */
+    if (!NM_FLAGS_HAS((NMClientInstanceFlags) priv->instance_flags,
+                      NM_CLIENT_INSTANCE_FLAGS_USE_PRIVATE_SOCKET))
+        return NULL;
+
+    if (_private_socket_path_for_test)
+        path = _private_socket_path_for_test;
+    else {
+        if (_nm_dbus_bus_type() != G_BUS_TYPE_SYSTEM)
+            return NULL;
+        if (geteuid() != 0)
+            return NULL;
+        path = NM_PRIVATE_CLIENT_SOCKET_PATH;
+    }
+
+    if (access(path, F_OK) != 0)
+        return NULL;
+    return path;
+}
+
 static void
 _init_start(NMClient *self)
 {
@@ -7352,6 +7855,20 @@ _init_start(NMClient *self)
                        priv->init_data->is_sync ? "sync" : "async");
 
     if (!priv->dbus_connection) {
+        const char *socket_path;
+
+        socket_path = _init_private_socket_path(self);
+        if (socket_path) {
+            gs_free char *address = g_strdup_printf("unix:path=%s", socket_path);
+
+            g_dbus_connection_new_for_address(address,
+                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                              NULL,
+                                              priv->init_data->cancellable,
+                                              _init_start_peer_new_cb,
+                                              self);
+            return;
+        }
         g_bus_get(_nm_dbus_bus_type(), priv->init_data->cancellable, _init_start_bus_get_cb, self);
         return;
     }
@@ -7511,6 +8028,12 @@ set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *ps
         g_return_if_fail(!NM_FLAGS_ANY(v_uint, ~((guint) NM_CLIENT_INSTANCE_FLAGS_ALL)));
         v_uint &= ((guint) NM_CLIENT_INSTANCE_FLAGS_ALL);
 
+        /* the flags that restrict the cache select the objects that we fetch and the
+         * signals that we subscribe. They cannot change later. */
+        g_return_if_fail(!priv->instance_flags_constructed
+                         || !NM_FLAGS_ANY(v_uint ^ ((guint) priv->instance_flags),
+                                          _INSTANCE_FLAGS_FILTER_MASK));
+
         if (!priv->instance_flags_constructed) {
             priv->instance_flags_constructed = TRUE;
             priv->instance_flags             = v_uint;
@@ -7818,6 +8341,8 @@ dispose(GObject *object)
 
     nm_clear_g_dbus_connection_signal(priv->dbus_connection, &priv->name_owner_changed_id);
 
+    nm_clear_g_signal_handler(priv->dbus_connection, &priv->dbus_peer_closed_id);
+
     nm_clear_g_free(&priv->name_owner);
 
     _init_release_all(self);
@@ -8027,6 +8552,9 @@ nm_client_class_init(NMClientClass *client_class)
      *
      * If this is not set during object construction, the D-Bus connection will
      * automatically be chosen during async/sync initalization via g_bus_get().
+     * When running as root and NetworkManager provides its private client
+     * socket, a peer-to-peer connection to that socket is chosen instead.
+     * See nm_client_get_dbus_connection().
      *
      * Since: 1.22
      */
@@ -8049,6 +8577,12 @@ nm_client_class_init(NMClientClass *client_class)
      * property to know whether permissions are ready. Note that permissions are only fetched
      * when NMClient has a D-Bus name owner.
      *
+     * The flags %NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS,
+     * %NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS and %NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS
+     * can only be set during construction, changing them later is refused. Objects of
+     * the corresponding types are then not cached and references to them resolve to %NULL.
+     * NMClient also does not subscribe to the property changes of these objects.
+     *
      * Since: 1.24
      */
     obj_properties[PROP_INSTANCE_FLAGS] = g_param_spec_uint(
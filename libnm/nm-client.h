@@ -24,12 +24,39 @@ G_BEGIN_DECLS
  *   can be disabled. You can toggle this flag to enable and disable automatic
  *   fetching of the permissions. Watch also nm_client_get_permissions_state()
  *   to know whether the permissions are up to date.
+ * @NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS: don't cache the connection
+ *   profiles (#NMRemoteConnection) of the settings service. nm_client_get_connections()
+ *   will be empty and references to profiles (like nm_active_connection_get_connection())
+ *   resolve to %NULL. Since the added profile cannot be returned,
+ *   nm_client_add_connection_async() and nm_client_add_connection2() fail
+ *   right away without adding it. Since 1.32.
+ * @NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS: don't cache Wi-Fi access points
+ *   (#NMAccessPoint) and Wi-Fi P2P peers (#NMWifiP2PPeer). Since 1.32.
+ * @NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS: don't cache IP and DHCP configuration
+ *   objects (#NMIPConfig and #NMDhcpConfig). Since 1.32.
+ * @NM_CLIENT_INSTANCE_FLAGS_USE_PRIVATE_SOCKET: when running as root and no
+ *   #NMClient:dbus-connection is given, talk to NetworkManager via its private
+ *   client socket if it provides one (see "private-client-socket" in
+ *   NetworkManager.conf). That is a peer-to-peer connection without message
+ *   bus, which cannot reach other D-Bus services (like polkit) and cannot be used
+ *   to register secret agents. This flag can only be set during construction.
+ *   Since 1.32.
+ *
+ * The flags %NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS,
+ * %NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS and %NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS
+ * restrict the objects that #NMClient mirrors. That makes the initial fetch cheaper
+ * for tools that are only interested in a part of the objects. They can only
+ * be set during construction.
  *
  * Since: 1.24
  */
 typedef enum { /*< flags >*/
                NM_CLIENT_INSTANCE_FLAGS_NONE                      = 0,
-               NM_CLIENT_INSTANCE_FLAGS_NO_AUTO_FETCH_PERMISSIONS = 1,
+               NM_CLIENT_INSTANCE_FLAGS_NO_AUTO_FETCH_PERMISSIONS = 0x1,
+               NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS   = 0x2,
+               NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS          = 0x4,
+               NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS             = 0x8,
+               NM_CLIENT_INSTANCE_FLAGS_USE_PRIVATE_SOCKET        = 0x10,
 } NMClientInstanceFlags;
 
 #define NM_TYPE_CLIENT            (nm_client_get_type())
@@ -231,7 +231,7 @@ typedef enum {
 
 /*****************************************************************************/
 
-#define NM_CLIENT_INSTANCE_FLAGS_ALL ((NMClientInstanceFlags) 0x1)
+#define NM_CLIENT_INSTANCE_FLAGS_ALL ((NMClientInstanceFlags) 0x1F)
 
 typedef struct {
     GType (*get_o_type_fcn)(void);
@@ -895,6 +895,8 @@ void _nm_client_notify_object_changed(NMClient *self, NMLDBusObject *dbobj);
 
 struct udev *_nm_client_get_udev(NMClient *self);
 
+void nmtst_client_set_private_socket_path(const char *socket_path);
+
 /*****************************************************************************/
 
 #define NM_CLIENT_NOTIFY_EVENT_PRIO_BEFORE (-100)
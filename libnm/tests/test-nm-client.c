@@ -7,6 +7,9 @@
 
 #include <sys/types.h>
 #include <signal.h>
+#include <unistd.h>
+
+#include "nm-glib-aux/nm-dbus-aux.h"
 
 #include "nm-test-libnm-utils.h"
 
@@ -1268,6 +1271,461 @@ test_connection_invalid(void)
 
 /*****************************************************************************/
 
+static void
+_get_settings_call_counts(NMTstcServiceInfo *sinfo,
+                          guint *            out_get_settings,
+                          guint *            out_get_all_settings)
+{
+    gs_free_error GError *error    = NULL;
+    gs_unref_variant GVariant *ret = NULL;
+
+    ret = g_dbus_proxy_call_sync(sinfo->proxy,
+                                 "GetSettingsCallCounts",
+                                 NULL,
+                                 G_DBUS_CALL_FLAGS_NONE,
+                                 -1,
+                                 NULL,
+                                 &error);
+    nmtst_assert_success(ret, error);
+    g_variant_get(ret, "(uu)", out_get_settings, out_get_all_settings);
+}
+
+static void
+_test_connection_get_all_settings(gboolean get_all_settings_supported)
+{
+    NMTSTC_SERVICE_INFO_SETUP(my_sinfo)
+    gs_unref_object NMClient *client = NULL;
+    gs_free_error GError *error      = NULL;
+    gs_unref_variant GVariant *ret   = NULL;
+    char *                     paths[3];
+    gs_free char *             path_late = NULL;
+    guint                      n_get_settings;
+    guint                      n_get_all_settings;
+    guint                      i;
+
+    ret = g_dbus_proxy_call_sync(my_sinfo->proxy,
+                                 "SetGetAllSettingsSupported",
+                                 g_variant_new("(b)", get_all_settings_supported),
+                                 G_DBUS_CALL_FLAGS_NONE,
+                                 -1,
+                                 NULL,
+                                 &error);
+    nmtst_assert_success(ret, error);
+
+    for (i = 0; i < G_N_ELEMENTS(paths); i++) {
+        gs_unref_object NMConnection *connection = NULL;
+        gs_free char *                id         = g_strdup_printf("test-get-all-settings-%u", i);
+
+        connection =
+            nmtst_create_minimal_connection(id, NULL, NM_SETTING_WIRED_SETTING_NAME, NULL);
+        nmtstc_service_add_connection(my_sinfo, connection, TRUE, &paths[i]);
+    }
+
+    /* the settings of the profiles that exist at startup are fetched with one
+     * GetAllSettings() call. If the service does not support it, NMClient
+     * falls back to one GetSettings() call per profile. */
+    client = nmtstc_client_new(TRUE);
+
+    g_assert_cmpint(nm_client_get_connections(client)->len, ==, G_N_ELEMENTS(paths));
+    for (i = 0; i < G_N_ELEMENTS(paths); i++) {
+        gs_free char *      id = g_strdup_printf("test-get-all-settings-%u", i);
+        NMRemoteConnection *remote;
+
+        remote = nm_client_get_connection_by_path(client, paths[i]);
+        g_assert(NM_IS_REMOTE_CONNECTION(remote));
+        g_assert_cmpstr(nm_connection_get_id(NM_CONNECTION(remote)), ==, id);
+        nmtst_assert_connection_verifies_without_normalization(NM_CONNECTION(remote));
+    }
+
+    _get_settings_call_counts(my_sinfo, &n_get_settings, &n_get_all_settings);
+    g_assert_cmpint(n_get_all_settings, ==, 1);
+    if (get_all_settings_supported)
+        g_assert_cmpint(n_get_settings, ==, 0);
+    else
+        g_assert_cmpint(n_get_settings, ==, G_N_ELEMENTS(paths));
+
+    /* profiles that get added later are fetched on their own. */
+    {
+        gs_unref_object NMConnection *connection = NULL;
+
+        connection = nmtst_create_minimal_connection("test-get-all-settings-late",
+                                                     NULL,
+                                                     NM_SETTING_WIRED_SETTING_NAME,
+                                                     NULL);
+        nmtstc_service_add_connection(my_sinfo, connection, TRUE, &path_late);
+    }
+    nmtst_main_loop_run(gl.loop, 1000);
+
+    g_assert_cmpint(nm_client_get_connections(client)->len, ==, G_N_ELEMENTS(paths) + 1u);
+    g_assert_cmpstr(
+        nm_connection_get_id(NM_CONNECTION(nm_client_get_connection_by_path(client, path_late))),
+        ==,
+        "test-get-all-settings-late");
+
+    _get_settings_call_counts(my_sinfo, &n_get_settings, &n_get_all_settings);
+    g_assert_cmpint(n_get_all_settings, ==, 1);
+    g_assert_cmpint(n_get_settings,
+                    ==,
+                    (get_all_settings_supported ? 0u : G_N_ELEMENTS(paths)) + 1u);
+
+    for (i = 0; i < G_N_ELEMENTS(paths); i++)
+        g_free(paths[i]);
+}
+
+static void
+test_connection_get_all_settings(void)
+{
+    _test_connection_get_all_settings(TRUE);
+}
+
+static void
+test_connection_get_all_settings_fallback(void)
+{
+    _test_connection_get_all_settings(FALSE);
+}
+
+/*****************************************************************************/
+
+static void
+_add_connection_filtered_cb(GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    GError **           p_error = user_data;
+    NMRemoteConnection *remote;
+
+    remote = nm_client_add_connection_finish(NM_CLIENT(object), result, p_error);
+    g_assert(!remote);
+    g_main_loop_quit(gl.loop);
+}
+
+static void
+test_client_instance_flags_filter(void)
+{
+    NMTSTC_SERVICE_INFO_SETUP(my_sinfo)
+    gs_unref_object NMConnection *connection  = NULL;
+    gs_unref_object NMConnection *connection2 = NULL;
+    gs_unref_object NMClient *client          = NULL;
+    gs_unref_object NMClient *client_full     = NULL;
+    gs_free_error GError *error               = NULL;
+    gs_free char *        path                = NULL;
+    NMDevice *            device;
+
+    connection = nmtst_create_minimal_connection("test-instance-flags-filter",
+                                                 NULL,
+                                                 NM_SETTING_WIRED_SETTING_NAME,
+                                                 NULL);
+    nmtst_connection_normalize(connection);
+    nmtstc_service_add_connection(my_sinfo, connection, TRUE, &path);
+
+    client = nmtstc_context_object_new(NM_TYPE_CLIENT,
+                                       TRUE,
+                                       NM_CLIENT_INSTANCE_FLAGS,
+                                       (guint)(NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS
+                                               | NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS),
+                                       NULL);
+    g_assert_cmpint(nm_client_get_instance_flags(client),
+                    ==,
+                    NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS
+                        | NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS);
+    g_assert_cmpint(nm_client_get_connections(client)->len, ==, 0);
+    g_assert(!nm_client_get_connection_by_path(client, path));
+
+    /* the flags that restrict the cache cannot change after construction... */
+    NMTST_EXPECT_LIBNM_CRITICAL("*assertion*_INSTANCE_FLAGS_FILTER_MASK*failed");
+    g_object_set(client, NM_CLIENT_INSTANCE_FLAGS, (guint) NM_CLIENT_INSTANCE_FLAGS_NONE, NULL);
+    g_test_assert_expected_messages();
+    g_assert_cmpint(nm_client_get_instance_flags(client),
+                    ==,
+                    NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS
+                        | NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS);
+
+    /* ... but the other flags can still be toggled. */
+    g_object_set(client,
+                 NM_CLIENT_INSTANCE_FLAGS,
+                 (guint)(NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS
+                         | NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS
+                         | NM_CLIENT_INSTANCE_FLAGS_NO_AUTO_FETCH_PERMISSIONS),
+                 NULL);
+    g_assert_cmpint(nm_client_get_instance_flags(client),
+                    ==,
+                    NM_CLIENT_INSTANCE_FLAGS_NO_SETTINGS_CONNECTIONS
+                        | NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS
+                        | NM_CLIENT_INSTANCE_FLAGS_NO_AUTO_FETCH_PERMISSIONS);
+
+    client_full = nmtstc_client_new(TRUE);
+    g_assert_cmpint(nm_client_get_connections(client_full)->len, ==, 1);
+
+    /* devices are still mirrored. */
+    device = nmtstc_service_add_device(my_sinfo, client, "AddWiredDevice", "eth0");
+    g_assert(NM_IS_DEVICE_ETHERNET(device));
+    g_assert(nm_client_get_device_by_iface(client, "eth0") == device);
+
+    /* adding a profile fails right away, because the result could not be returned.
+     * The profile is not added. */
+    connection2 = nmtst_create_minimal_connection("test-instance-flags-filter-2",
+                                                  NULL,
+                                                  NM_SETTING_WIRED_SETTING_NAME,
+                                                  NULL);
+    nm_client_add_connection_async(client,
+                                   connection2,
+                                   FALSE,
+                                   NULL,
+                                   _add_connection_filtered_cb,
+                                   &error);
+    nmtst_main_loop_run_assert(gl.loop, 1000);
+    g_assert_error(error, NM_CLIENT_ERROR, NM_CLIENT_ERROR_FAILED);
+
+    nmtst_main_loop_run(gl.loop, 100);
+    g_assert_cmpint(nm_client_get_connections(client_full)->len, ==, 1);
+}
+
+/*****************************************************************************/
+
+/* A minimal fake of NetworkManager's private client socket. It only implements
+ * GetManagedObjects() with the NetworkManager object. */
+
+typedef struct {
+    GDBusServer *    server;
+    GDBusConnection *connection;
+    GDBusNodeInfo *  node_info;
+    bool             close_on_accept;
+} PeerServer;
+
+static const char *const _peer_server_xml =
+    "<node>"
+    "  <interface name='" DBUS_INTERFACE_OBJECT_MANAGER "'>"
+    "    <method name='GetManagedObjects'>"
+    "      <arg name='objects' type='a{oa{sa{sv}}}' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
+static void
+_peer_server_method_call(GDBusConnection *      connection,
+                         const char *           sender,
+                         const char *           object_path,
+                         const char *           interface_name,
+                         const char *           method_name,
+                         GVariant *             parameters,
+                         GDBusMethodInvocation *invocation,
+                         gpointer               user_data)
+{
+    g_assert_cmpstr(method_name, ==, "GetManagedObjects");
+    g_dbus_method_invocation_return_value(
+        invocation,
+        g_variant_new_parsed("({objectpath '" NM_DBUS_PATH "': {'" NM_DBUS_INTERFACE
+                             "': {'Version': <'1.0.0-peer'>}}},)"));
+}
+
+static gboolean
+_peer_server_new_connection_cb(GDBusServer *    server,
+                               GDBusConnection *connection,
+                               gpointer         user_data)
+{
+    static const GDBusInterfaceVTable vtable = {
+        .method_call = _peer_server_method_call,
+    };
+    PeerServer *peer_server                  = user_data;
+    gs_free_error GError *error              = NULL;
+
+    if (peer_server->close_on_accept) {
+        /* like NetworkManager quitting right away. */
+        g_dbus_connection_close(connection, NULL, NULL, NULL);
+        return FALSE;
+    }
+
+    g_assert(!peer_server->connection);
+    peer_server->connection = g_object_ref(connection);
+
+    g_dbus_connection_register_object(connection,
+                                      "/org/freedesktop",
+                                      peer_server->node_info->interfaces[0],
+                                      &vtable,
+                                      NULL,
+                                      NULL,
+                                      &error);
+    g_assert_no_error(error);
+    return TRUE;
+}
+
+static void
+_peer_server_start(PeerServer *peer_server, const char *socket_path)
+{
+    gs_free char *address       = g_strdup_printf("unix:path=%s", socket_path);
+    gs_free char *guid          = g_dbus_generate_guid();
+    gs_free_error GError *error = NULL;
+
+    *peer_server = (PeerServer){};
+
+    peer_server->node_info = g_dbus_node_info_new_for_xml(_peer_server_xml, &error);
+    g_assert_no_error(error);
+
+    peer_server->server =
+        g_dbus_server_new_sync(address, G_DBUS_SERVER_FLAGS_NONE, guid, NULL, NULL, &error);
+    g_assert_no_error(error);
+    g_signal_connect(peer_server->server,
+                     "new-connection",
+                     G_CALLBACK(_peer_server_new_connection_cb),
+                     peer_server);
+    g_dbus_server_start(peer_server->server);
+}
+
+static void
+_peer_server_stop(PeerServer *peer_server, const char *socket_path)
+{
+    g_dbus_server_stop(peer_server->server);
+    g_signal_handlers_disconnect_by_data(peer_server->server, peer_server);
+    g_clear_object(&peer_server->server);
+    g_clear_object(&peer_server->connection);
+    nm_clear_pointer(&peer_server->node_info, g_dbus_node_info_unref);
+    unlink(socket_path);
+}
+
+static void
+_peer_connection_new_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    GDBusConnection **p_connection = user_data;
+    gs_free_error GError *error     = NULL;
+
+    *p_connection = g_dbus_connection_new_for_address_finish(result, &error);
+    g_assert_no_error(error);
+    g_main_loop_quit(gl.loop);
+}
+
+static void
+_peer_client_new_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    NMClient **p_client         = user_data;
+    gs_free_error GError *error = NULL;
+
+    *p_client = NM_CLIENT(g_async_initable_new_finish(G_ASYNC_INITABLE(source), result, &error));
+    g_assert_no_error(error);
+    g_main_loop_quit(gl.loop);
+}
+
+static void
+_peer_client_notify_cb(NMClient *client, GParamSpec *pspec, gpointer user_data)
+{
+    g_main_loop_quit(gl.loop);
+}
+
+static NMClient *
+_peer_client_new(GDBusConnection *dbus_connection, NMClientInstanceFlags instance_flags)
+{
+    NMClient *client = NULL;
+
+    /* NMClient's sync initialization iterates its own main context, so the server
+     * in this thread would not be dispatched. Use the asynchronous initialization. */
+    g_async_initable_new_async(NM_TYPE_CLIENT,
+                               G_PRIORITY_DEFAULT,
+                               NULL,
+                               _peer_client_new_cb,
+                               &client,
+                               NM_CLIENT_DBUS_CONNECTION,
+                               dbus_connection,
+                               NM_CLIENT_INSTANCE_FLAGS,
+                               (guint)(NM_CLIENT_INSTANCE_FLAGS_NO_AUTO_FETCH_PERMISSIONS
+                                       | instance_flags),
+                               NULL);
+    nmtst_main_loop_run_assert(gl.loop, 5000);
+    g_assert(NM_IS_CLIENT(client));
+    return client;
+}
+
+static void
+test_client_private_socket(void)
+{
+    NMTSTC_SERVICE_INFO_SETUP(my_sinfo)
+    gs_unref_object GDBusConnection *peer = NULL;
+    gs_unref_object NMClient *client      = NULL;
+    gs_free char *            socket_path = NULL;
+    PeerServer                peer_server;
+    GDBusConnection *         dbus_connection;
+    gulong                    notify_id;
+    guint                     i;
+
+    socket_path = g_strdup_printf("%s/test-nm-client-%d.socket", g_get_tmp_dir(), getpid());
+    _peer_server_start(&peer_server, socket_path);
+
+    /* a client on a peer connection fetches the objects without message bus... */
+    g_dbus_connection_new_for_address(g_dbus_server_get_client_address(peer_server.server),
+                                      G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                      NULL,
+                                      NULL,
+                                      _peer_connection_new_cb,
+                                      &peer);
+    nmtst_main_loop_run_assert(gl.loop, 5000);
+    g_assert(peer);
+    g_assert(!g_dbus_connection_get_unique_name(peer));
+
+    client = _peer_client_new(peer, NM_CLIENT_INSTANCE_FLAGS_NONE);
+    g_assert(nm_client_get_dbus_connection(client) == peer);
+    g_assert(nm_client_get_nm_running(client));
+    g_assert_cmpstr(nm_client_get_version(client), ==, "1.0.0-peer");
+
+    /* ... receives signals, which have no sender... */
+    notify_id = g_signal_connect(client,
+                                 "notify::" NM_CLIENT_VERSION,
+                                 G_CALLBACK(_peer_client_notify_cb),
+                                 NULL);
+    g_assert(peer_server.connection);
+    g_dbus_connection_emit_signal(
+        peer_server.connection,
+        NULL,
+        NM_DBUS_PATH,
+        DBUS_INTERFACE_PROPERTIES,
+        "PropertiesChanged",
+        g_variant_new_parsed("('" NM_DBUS_INTERFACE "', {'Version': <'1.0.1-peer'>}, @as [])"),
+        NULL);
+    nmtst_main_loop_run_assert(gl.loop, 5000);
+    g_assert_cmpstr(nm_client_get_version(client), ==, "1.0.1-peer");
+    nm_clear_g_signal_handler(client, &notify_id);
+
+    /* ... and notices when NetworkManager quits. A connection that was passed
+     * by the user is kept. */
+    notify_id = g_signal_connect(client,
+                                 "notify::" NM_CLIENT_NM_RUNNING,
+                                 G_CALLBACK(_peer_client_notify_cb),
+                                 NULL);
+    g_dbus_connection_close_sync(peer_server.connection, NULL, NULL);
+    g_clear_object(&peer_server.connection);
+    nmtst_main_loop_run_assert(gl.loop, 5000);
+    g_assert(!nm_client_get_nm_running(client));
+    g_assert(nm_client_get_dbus_connection(client) == peer);
+    nm_clear_g_signal_handler(client, &notify_id);
+    g_clear_object(&client);
+
+    nmtst_client_set_private_socket_path(socket_path);
+
+    /* The private socket is only used on request... */
+    client          = _peer_client_new(NULL, NM_CLIENT_INSTANCE_FLAGS_NONE);
+    dbus_connection = nm_client_get_dbus_connection(client);
+    g_assert(dbus_connection);
+    g_assert(g_dbus_connection_get_unique_name(dbus_connection));
+    g_assert(!peer_server.connection);
+    g_clear_object(&client);
+
+    /* ... and when the automatically chosen private socket gets closed, the
+     * client continues on the message bus. */
+    peer_server.close_on_accept = TRUE;
+    client = _peer_client_new(NULL, NM_CLIENT_INSTANCE_FLAGS_USE_PRIVATE_SOCKET);
+    nmtst_client_set_private_socket_path(NULL);
+
+    for (i = 0; TRUE; i++) {
+        dbus_connection = nm_client_get_dbus_connection(client);
+        if (nm_client_get_nm_running(client) && dbus_connection
+            && g_dbus_connection_get_unique_name(dbus_connection))
+            break;
+        g_assert_cmpint(i, <, 50);
+        nmtst_main_loop_run(gl.loop, 100);
+    }
+    g_assert_cmpstr(nm_client_get_version(client), !=, "1.0.0-peer");
+
+    g_clear_object(&client);
+    _peer_server_stop(&peer_server, socket_path);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -1288,6 +1746,11 @@ main(int argc, char **argv)
     g_test_add_func("/libnm/activate-virtual", test_activate_virtual);
     g_test_add_func("/libnm/device-connection-compatibility", test_device_connection_compatibility);
     g_test_add_func("/libnm/connection/invalid", test_connection_invalid);
+    g_test_add_func("/libnm/connection/get-all-settings", test_connection_get_all_settings);
+    g_test_add_func("/libnm/connection/get-all-settings-fallback",
+                    test_connection_get_all_settings_fallback);
+    g_test_add_func("/libnm/client-instance-flags-filter", test_client_instance_flags_filter);
+    g_test_add_func("/libnm/client-private-socket", test_client_private_socket);
 
     return g_test_run();
 }
@@ -33,6 +33,7 @@ struct NAcdConfig {
         unsigned int transport;
         uint8_t mac[ETH_ALEN];
         size_t n_mac;
+        NAcdSharedSocket *shared_socket;
 };
 
 #define N_ACD_CONFIG_NULL(_x) {                                                 \
@@ -61,6 +62,28 @@ struct NAcdEventNode {
                 .probe_link = C_LIST_INIT((_x).probe_link),                     \
         }
 
+#define N_ACD_SHARED_SOCKET_N_BUCKETS (64)
+
+struct NAcdSharedSocket {
+        unsigned long n_refs;
+        int fd_epoll;
+        int fd_socket;
+        Timer timer;
+        CList context_buckets[N_ACD_SHARED_SOCKET_N_BUCKETS];
+        CList pending_list;
+
+        /* flags */
+        bool preempted : 1;
+};
+
+#define N_ACD_SHARED_SOCKET_NULL(_x) {                                          \
+                .n_refs = 1,                                                    \
+                .fd_epoll = -1,                                                 \
+                .fd_socket = -1,                                                \
+                .timer = TIMER_NULL((_x).timer),                                \
+                .pending_list = C_LIST_INIT((_x).pending_list),                 \
+        }
+
 struct NAcd {
         unsigned long n_refs;
         unsigned int seed;
@@ -69,6 +92,13 @@ struct NAcd {
         CRBTree ip_tree;
         CList event_list;
         Timer timer;
+        void *userdata;
+
+        /* shared socket */
+        NAcdSharedSocket *shared_socket;
+        CList shared_link;
+        CList pending_link;
+        int shared_error;
 
         /* BPF map */
         int fd_bpf_map;
@@ -90,6 +120,8 @@ struct NAcd {
                 .ip_tree = C_RBTREE_INIT,                                       \
                 .event_list = C_LIST_INIT((_x).event_list),                     \
                 .timer = TIMER_NULL((_x).timer),                                \
+                .shared_link = C_LIST_INIT((_x).shared_link),                   \
+                .pending_link = C_LIST_INIT((_x).pending_link),                 \
                 .fd_bpf_map = -1,                                               \
         }
 
@@ -130,6 +162,13 @@ void n_acd_remember(NAcd *acd, uint64_t now, bool success);
 int n_acd_raise(NAcd *acd, NAcdEventNode **nodep, unsigned int event);
 int n_acd_send(NAcd *acd, const struct in_addr *tpa, const struct in_addr *spa);
 int n_acd_ensure_bpf_map_space(NAcd *acd);
+int n_acd_socket_new(int *fdp, int fd_bpf_prog, int ifindex);
+bool n_acd_packet_is_valid(NAcd *acd, void *packet, size_t n_packet);
+int n_acd_handle_packet(NAcd *acd, struct ether_arp *packet);
+
+/* shared sockets */
+
+void n_acd_shared_socket_link(NAcdSharedSocket *socket, NAcd *acd);
 
 /* probes */
 
@@ -148,6 +187,10 @@ int n_acd_bpf_compile(int *progfdp, int mapfd, struct ether_addr *mac);
 
 /* inline helpers */
 
+static inline Timer *n_acd_get_timer(NAcd *acd) {
+        return acd->shared_socket ? &acd->shared_socket->timer : &acd->timer;
+}
+
 static inline void n_acd_event_node_freep(NAcdEventNode **node) {
         if (*node)
                 n_acd_event_node_free(*node);
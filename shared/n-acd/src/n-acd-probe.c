@@ -160,7 +160,7 @@ _c_public_ void n_acd_probe_config_set_timeout(NAcdProbeConfig *config, uint64_t
 static void n_acd_probe_schedule(NAcdProbe *probe, uint64_t n_timeout, unsigned int n_jitter) {
         uint64_t n_time;
 
-        timer_now(&probe->acd->timer, &n_time);
+        timer_now(n_acd_get_timer(probe->acd), &n_time);
         n_time += n_timeout;
 
         /*
@@ -176,7 +176,7 @@ static void n_acd_probe_schedule(NAcdProbe *probe, uint64_t n_timeout, unsigned
                 n_time += random % n_jitter;
         }
 
-        timeout_schedule(&probe->timeout, &probe->acd->timer, n_time);
+        timeout_schedule(&probe->timeout, n_acd_get_timer(probe->acd), n_time);
 }
 
 static void n_acd_probe_unschedule(NAcdProbe *probe) {
@@ -238,7 +238,7 @@ static int n_acd_probe_link(NAcdProbe *probe) {
         /*
          * Add the ip address to the map, if it is not already there.
          */
-        if (n_acd_probe_is_unique(probe)) {
+        if (!probe->acd->shared_socket && n_acd_probe_is_unique(probe)) {
                 r = n_acd_bpf_map_add(probe->acd->fd_bpf_map, &probe->ip);
                 if (r) {
                         /*
@@ -261,7 +261,7 @@ static void n_acd_probe_unlink(NAcdProbe *probe) {
          * If this is the only probe for a given IP, remove the IP from the
          * kernel BPF map.
          */
-        if (n_acd_probe_is_unique(probe)) {
+        if (!probe->acd->shared_socket && n_acd_probe_is_unique(probe)) {
                 r = n_acd_bpf_map_remove(probe->acd->fd_bpf_map, &probe->ip);
                 c_assert(r >= 0);
                 --probe->acd->n_bpf_map;
@@ -522,7 +522,7 @@ int n_acd_probe_handle_packet(NAcdProbe *probe, struct ether_arp *packet, bool h
         uint64_t now;
         int r;
 
-        timer_now(&probe->acd->timer, &now);
+        timer_now(n_acd_get_timer(probe->acd), &now);
 
         switch (probe->state) {
         case N_ACD_PROBE_STATE_PROBING:
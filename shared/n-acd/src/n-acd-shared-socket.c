@@ -0,0 +1,395 @@
+/*
+ * IPv4 Address Conflict Detection Shared Socket
+ *
+ * By default, each ACD context opens its own packet socket bound to its
+ * interface, with its own eBPF filter and map, as well as its own timer and
+ * epoll-fd. When ACD runs on hundreds of interfaces, this becomes a
+ * significant cost in file descriptors, kernel objects and wakeups.
+ *
+ * A shared socket is a single packet socket which is not bound to any
+ * interface, together with a single timer. Contexts using it do not create
+ * any file-descriptors of their own. Probes of all those contexts schedule
+ * their timeouts on the shared timer, so timeouts that expire together are
+ * handled in one wakeup. Incoming ARP packets are demultiplexed to the
+ * contexts of their ingress ifindex.
+ *
+ * The eBPF filter of regular contexts matches on the hardware address of the
+ * interface, which is not possible for a socket shared by many interfaces.
+ * Hence, the shared socket does not attach a filter and relies on the
+ * validation in userspace, just like contexts on kernels without eBPF.
+ *
+ * Unlike a bound socket, an unbound socket never reports ENETDOWN on receive.
+ * Contexts on a shared socket only raise N_ACD_EVENT_DOWN when sending fails.
+ */
+
+#include <c-list.h>
+#include <c-stdaux.h>
+#include <errno.h>
+#include <linux/if_packet.h>
+#include <netinet/if_ether.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "n-acd.h"
+#include "n-acd-private.h"
+
+enum {
+        N_ACD_SHARED_SOCKET_EPOLL_TIMER,
+        N_ACD_SHARED_SOCKET_EPOLL_SOCKET,
+};
+
+/*
+ * The shared socket receives the ARP traffic of all interfaces, so we want a
+ * larger receive buffer than the default. This is best-effort.
+ */
+#define N_ACD_SHARED_SOCKET_RCVBUF (4 * 1024 * 1024)
+
+static CList *n_acd_shared_socket_get_bucket(NAcdSharedSocket *socket, int ifindex) {
+        return &socket->context_buckets[(unsigned int)ifindex % N_ACD_SHARED_SOCKET_N_BUCKETS];
+}
+
+/**
+ * n_acd_shared_socket_new() - allocate new shared socket
+ * @socketp:                    output argument for new shared socket
+ *
+ * This creates a new packet socket and timer that can be shared by several
+ * ACD contexts. The socket is created in the network namespace of the caller.
+ * Pass it to the context configuration via n_acd_config_set_shared_socket().
+ *
+ * The caller owns a single ref-count to the object and is responsible to drop
+ * it, when no longer needed.
+ *
+ * Return: 0 on success, negative error code on failure.
+ */
+_c_public_ int n_acd_shared_socket_new(NAcdSharedSocket **socketp) {
+        _c_cleanup_(n_acd_shared_socket_unrefp) NAcdSharedSocket *socket = NULL;
+        struct epoll_event eevent;
+        int r, rcvbuf = N_ACD_SHARED_SOCKET_RCVBUF;
+        size_t i;
+
+        socket = malloc(sizeof(*socket));
+        if (!socket)
+                return -ENOMEM;
+
+        *socket = (NAcdSharedSocket)N_ACD_SHARED_SOCKET_NULL(*socket);
+        for (i = 0; i < N_ACD_SHARED_SOCKET_N_BUCKETS; ++i)
+                c_list_init(&socket->context_buckets[i]);
+
+        socket->fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (socket->fd_epoll < 0)
+                return -c_errno();
+
+        r = timer_init(&socket->timer);
+        if (r < 0)
+                return r;
+
+        r = n_acd_socket_new(&socket->fd_socket, -1, 0);
+        if (r)
+                return r;
+
+        (void)setsockopt(socket->fd_socket, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        eevent = (struct epoll_event){
+                .events = EPOLLIN,
+                .data.u32 = N_ACD_SHARED_SOCKET_EPOLL_TIMER,
+        };
+        r = epoll_ctl(socket->fd_epoll, EPOLL_CTL_ADD, socket->timer.fd, &eevent);
+        if (r < 0)
+                return -c_errno();
+
+        eevent = (struct epoll_event){
+                .events = EPOLLIN,
+                .data.u32 = N_ACD_SHARED_SOCKET_EPOLL_SOCKET,
+        };
+        r = epoll_ctl(socket->fd_epoll, EPOLL_CTL_ADD, socket->fd_socket, &eevent);
+        if (r < 0)
+                return -c_errno();
+
+        *socketp = socket;
+        socket = NULL;
+        return 0;
+}
+
+static void n_acd_shared_socket_free(NAcdSharedSocket *socket) {
+        size_t i;
+
+        /* contexts pin the shared socket */
+        for (i = 0; i < N_ACD_SHARED_SOCKET_N_BUCKETS; ++i)
+                c_assert(c_list_is_empty(&socket->context_buckets[i]));
+        c_assert(c_list_is_empty(&socket->pending_list));
+
+        if (socket->fd_socket >= 0) {
+                c_assert(socket->fd_epoll >= 0);
+                epoll_ctl(socket->fd_epoll, EPOLL_CTL_DEL, socket->fd_socket, NULL);
+                close(socket->fd_socket);
+        }
+
+        if (socket->timer.fd >= 0) {
+                c_assert(socket->fd_epoll >= 0);
+                epoll_ctl(socket->fd_epoll, EPOLL_CTL_DEL, socket->timer.fd, NULL);
+                timer_deinit(&socket->timer);
+        }
+
+        if (socket->fd_epoll >= 0)
+                close(socket->fd_epoll);
+
+        free(socket);
+}
+
+/**
+ * n_acd_shared_socket_ref() - acquire shared socket reference
+ * @socket:                     shared socket to operate on, or NULL
+ *
+ * This acquires a reference to the shared socket given as @socket. If @socket
+ * is NULL, this function is a no-op.
+ *
+ * Return: @socket is returned.
+ */
+_c_public_ NAcdSharedSocket *n_acd_shared_socket_ref(NAcdSharedSocket *socket) {
+        if (socket)
+                ++socket->n_refs;
+        return socket;
+}
+
+/**
+ * n_acd_shared_socket_unref() - release shared socket reference
+ * @socket:                     shared socket to operate on, or NULL
+ *
+ * This releases a reference to the shared socket given as @socket. If @socket
+ * is NULL, this function is a no-op.
+ *
+ * Return: NULL is returned.
+ */
+_c_public_ NAcdSharedSocket *n_acd_shared_socket_unref(NAcdSharedSocket *socket) {
+        if (socket && !--socket->n_refs)
+                n_acd_shared_socket_free(socket);
+        return NULL;
+}
+
+/**
+ * n_acd_shared_socket_link() - link context into shared socket
+ * @socket:                     shared socket to operate on
+ * @acd:                        context to link
+ *
+ * This makes @socket dispatch incoming packets for the ifindex of @acd to it.
+ * The context unlinks itself when it is freed.
+ */
+void n_acd_shared_socket_link(NAcdSharedSocket *socket, NAcd *acd) {
+        c_list_unlink(&acd->shared_link);
+        c_list_link_tail(n_acd_shared_socket_get_bucket(socket, acd->ifindex), &acd->shared_link);
+}
+
+/**
+ * n_acd_shared_socket_get_fd() - query shared socket file-descriptor
+ * @socket:                     shared socket to operate on
+ * @fdp:                        output argument for file-descriptor
+ *
+ * This queries the file-descriptor of the shared socket. Whenever it is
+ * readable, you should call n_acd_shared_socket_dispatch().
+ *
+ * Currently, the file-descriptor is an epoll-fd.
+ */
+_c_public_ void n_acd_shared_socket_get_fd(NAcdSharedSocket *socket, int *fdp) {
+        *fdp = socket->fd_epoll;
+}
+
+/*
+ * A failure of one context must not stall the others, which share the timer
+ * and socket with it. Hence, the error is recorded on the context, and the
+ * context is queued, so the caller sees it via n_acd_pop_event().
+ */
+static void n_acd_shared_socket_fail_context(NAcdSharedSocket *socket, NAcd *acd, int error) {
+        if (!acd->shared_error)
+                acd->shared_error = error;
+
+        if (!c_list_is_linked(&acd->pending_link))
+                c_list_link_tail(&socket->pending_list, &acd->pending_link);
+}
+
+static int n_acd_shared_socket_dispatch_timer(NAcdSharedSocket *socket,
+                                              struct epoll_event *event) {
+        NAcdProbe *probe;
+        Timeout *timeout;
+        uint64_t now;
+        int r;
+
+        if (event->events & (EPOLLHUP | EPOLLERR))
+                return -EIO;
+
+        if (!(event->events & EPOLLIN))
+                return 0;
+
+        /*
+         * Handle the timeouts of all contexts that expired until now. See
+         * n_acd_handle_timeout() for details. Whatever happens, the timer
+         * must be rearmed afterwards, or no context would ever be woken up
+         * again.
+         */
+        r = timer_read(&socket->timer);
+        if (r == TIMER_E_TRIGGERED) {
+                timer_now(&socket->timer, &now);
+
+                for (;;) {
+                        r = timer_pop_timeout(&socket->timer, now, &timeout);
+                        if (r < 0 || !timeout)
+                                break;
+
+                        probe = (void *)timeout - offsetof(NAcdProbe, timeout);
+                        r = n_acd_probe_handle_timeout(probe);
+                        if (r)
+                                n_acd_shared_socket_fail_context(socket, probe->acd, r);
+                }
+        }
+
+        timer_rearm(&socket->timer);
+        return r < 0 ? r : 0;
+}
+
+/*
+ * Several contexts can run on the same ifindex. In particular, a context that
+ * its owner abandoned stays linked as long as its probes pin it. Hence, every
+ * packet is delivered to all contexts on its ingress ifindex, just like each
+ * of them would receive it on a socket of its own.
+ */
+static void n_acd_shared_socket_handle_packet(NAcdSharedSocket *socket,
+                                              int ifindex,
+                                              struct ether_arp *data,
+                                              size_t n_data) {
+        NAcd *acd;
+        int r;
+
+        c_list_for_each_entry(acd, n_acd_shared_socket_get_bucket(socket, ifindex), shared_link) {
+                if (acd->ifindex != ifindex)
+                        continue;
+
+                if (!n_acd_packet_is_valid(acd, data, n_data))
+                        continue;
+
+                r = n_acd_handle_packet(acd, data);
+                if (r)
+                        n_acd_shared_socket_fail_context(socket, acd, r);
+        }
+}
+
+static int n_acd_shared_socket_dispatch_socket(NAcdSharedSocket *socket,
+                                               struct epoll_event *event) {
+        const size_t n_batch = 8;
+        struct mmsghdr msgs[n_batch];
+        struct iovec iovecs[n_batch];
+        struct sockaddr_ll addresses[n_batch];
+        struct ether_arp data[n_batch];
+        size_t i;
+        int n;
+
+        for (i = 0; i < n_batch; ++i) {
+                iovecs[i].iov_base = data + i;
+                iovecs[i].iov_len = sizeof(data[i]);
+                msgs[i].msg_hdr = (struct msghdr){
+                        .msg_name = addresses + i,
+                        .msg_namelen = sizeof(addresses[i]),
+                        .msg_iov = iovecs + i,
+                        .msg_iovlen = 1,
+                };
+        }
+
+        n = recvmmsg(socket->fd_socket, msgs, n_batch, 0, NULL);
+        if (n < 0) {
+                if (errno == EAGAIN) {
+                        if (event->events & (EPOLLHUP | EPOLLERR))
+                                return -EIO;
+
+                        return 0;
+                }
+
+                return -c_errno();
+        } else if (n >= (ssize_t)n_batch) {
+                /* see n_acd_dispatch_socket() */
+                socket->preempted = true;
+        }
+
+        for (i = 0; (ssize_t)i < n; ++i) {
+                /*
+                 * An unbound packet socket also sees our own outgoing
+                 * packets. Drop them early.
+                 */
+                if (addresses[i].sll_pkttype == PACKET_OUTGOING)
+                        continue;
+
+                n_acd_shared_socket_handle_packet(socket,
+                                                  addresses[i].sll_ifindex,
+                                                  data + i,
+                                                  msgs[i].msg_len);
+        }
+
+        return 0;
+}
+
+/**
+ * n_acd_shared_socket_dispatch() - dispatch shared socket
+ * @socket:                     shared socket to operate on
+ *
+ * This dispatches the timeouts and incoming packets of all contexts running
+ * on @socket. Any event raised by this is queued on the respective context.
+ * Afterwards, the caller should fetch the contexts with pending events via
+ * n_acd_shared_socket_pop_context() and drain each via n_acd_pop_event().
+ *
+ * If a context fails to handle a packet or timeout, the other contexts are
+ * still dispatched. The failed context is queued as well, and its error code
+ * is returned by the next call to n_acd_pop_event() on it.
+ *
+ * Return: 0 on success, N_ACD_E_PREEMPTED on preemption, negative error code
+ *         if the shared socket itself failed.
+ */
+_c_public_ int n_acd_shared_socket_dispatch(NAcdSharedSocket *socket) {
+        struct epoll_event events[2];
+        int n, i, r = 0;
+
+        n = epoll_wait(socket->fd_epoll, events, sizeof(events) / sizeof(*events), 0);
+        if (n < 0) {
+                /* Linux never returns EINTR if `timeout == 0'. */
+                return -c_errno();
+        }
+
+        socket->preempted = false;
+
+        for (i = 0; i < n; ++i) {
+                switch (events[i].data.u32) {
+                case N_ACD_SHARED_SOCKET_EPOLL_TIMER:
+                        r = n_acd_shared_socket_dispatch_timer(socket, events + i);
+                        break;
+                case N_ACD_SHARED_SOCKET_EPOLL_SOCKET:
+                        r = n_acd_shared_socket_dispatch_socket(socket, events + i);
+                        break;
+                default:
+                        c_assert(0);
+                        r = 0;
+                        break;
+                }
+
+                if (r)
+                        return r;
+        }
+
+        return socket->preempted ? N_ACD_E_PREEMPTED : 0;
+}
+
+/**
+ * n_acd_shared_socket_pop_context() - get the next context with events
+ * @socket:                     shared socket to operate on
+ * @acdp:                       output argument for the context
+ *
+ * This returns the next context running on @socket which has pending events,
+ * or NULL if there is none. The context is not pinned. The caller is expected
+ * to drain its events via n_acd_pop_event() right away. A context is only
+ * returned again, after it raised new events.
+ */
+_c_public_ void n_acd_shared_socket_pop_context(NAcdSharedSocket *socket, NAcd **acdp) {
+        NAcd *acd;
+
+        acd = c_list_first_entry(&socket->pending_list, NAcd, pending_link);
+        if (acd)
+                c_list_unlink(&acd->pending_link);
+
+        *acdp = acd;
+}
@@ -109,11 +109,11 @@ static int n_acd_get_random(unsigned int *random) {
         return 0;
 }
 
-static int n_acd_socket_new(int *fdp, int fd_bpf_prog, NAcdConfig *config) {
+int n_acd_socket_new(int *fdp, int fd_bpf_prog, int ifindex) {
         const struct sockaddr_ll address = {
                 .sll_family = AF_PACKET,
                 .sll_protocol = htobe16(ETH_P_ARP),
-                .sll_ifindex = config->ifindex,
+                .sll_ifindex = ifindex,
                 .sll_halen = ETH_ALEN,
                 .sll_addr = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff },
         };
@@ -249,6 +249,20 @@ _c_public_ void n_acd_config_set_mac(NAcdConfig *config, const uint8_t *mac, siz
         memcpy(config->mac, mac, n_mac > ETH_ALEN ? ETH_ALEN : n_mac);
 }
 
+/**
+ * n_acd_config_set_shared_socket() - set shared socket property
+ * @config:                     configuration to operate on
+ * @socket:                     shared socket to use, or NULL
+ *
+ * This makes contexts created from @config use the shared socket @socket
+ * rather than their own packet socket and timer. See
+ * n_acd_shared_socket_new() for details. The context acquires its own
+ * reference to @socket, @config does not.
+ */
+_c_public_ void n_acd_config_set_shared_socket(NAcdConfig *config, NAcdSharedSocket *socket) {
+        config->shared_socket = socket;
+}
+
 int n_acd_event_node_new(NAcdEventNode **nodep) {
         NAcdEventNode *node;
 
@@ -279,7 +293,8 @@ int n_acd_ensure_bpf_map_space(NAcd *acd) {
         size_t  max_map;
         int r;
 
-        if (acd->n_bpf_map < acd->max_bpf_map)
+        /* the shared socket has no eBPF filter, see n-acd-shared-socket.c */
+        if (acd->shared_socket || acd->n_bpf_map < acd->max_bpf_map)
                 return 0;
 
         max_map = 2 * acd->max_bpf_map;
@@ -323,6 +338,9 @@ int n_acd_ensure_bpf_map_space(NAcd *acd) {
  * the selected transport. The configuration is copied into the context. The
  * @config object thus does not have to be retained by the caller.
  *
+ * If @config specifies a shared socket, the context does not create any
+ * file-descriptors of its own, but runs on the shared socket instead.
+ *
  * Return: 0 on success, negative error code on failure.
  */
 _c_public_ int n_acd_new(NAcd **acdp, NAcdConfig *config) {
@@ -349,6 +367,15 @@ _c_public_ int n_acd_new(NAcd **acdp, NAcdConfig *config) {
         if (r)
                 return r;
 
+        if (config->shared_socket) {
+                acd->shared_socket = n_acd_shared_socket_ref(config->shared_socket);
+                n_acd_shared_socket_link(acd->shared_socket, acd);
+
+                *acdp = acd;
+                acd = NULL;
+                return 0;
+        }
+
         acd->fd_epoll = epoll_create1(EPOLL_CLOEXEC);
         if (acd->fd_epoll < 0)
                 return -c_errno();
@@ -367,7 +394,7 @@ _c_public_ int n_acd_new(NAcd **acdp, NAcdConfig *config) {
         if (r)
                 return r;
 
-        r = n_acd_socket_new(&acd->fd_socket, fd_bpf_prog, config);
+        r = n_acd_socket_new(&acd->fd_socket, fd_bpf_prog, acd->ifindex);
         if (r)
                 return r;
 
@@ -403,6 +430,10 @@ static void n_acd_free_internal(NAcd *acd) {
 
         c_assert(c_rbtree_is_empty(&acd->ip_tree));
 
+        c_list_unlink(&acd->pending_link);
+        c_list_unlink(&acd->shared_link);
+        acd->shared_socket = n_acd_shared_socket_unref(acd->shared_socket);
+
         if (acd->fd_socket >= 0) {
                 c_assert(acd->fd_epoll >= 0);
                 epoll_ctl(acd->fd_epoll, EPOLL_CTL_DEL, acd->fd_socket, NULL);
@@ -470,6 +501,9 @@ int n_acd_raise(NAcd *acd, NAcdEventNode **nodep, unsigned int event) {
         node->event.event = event;
         c_list_link_tail(&acd->event_list, &node->acd_link);
 
+        if (acd->shared_socket && !c_list_is_linked(&acd->pending_link))
+                c_list_link_tail(&acd->shared_socket->pending_list, &acd->pending_link);
+
         if (nodep)
                 *nodep = node;
         return 0;
@@ -493,7 +527,9 @@ int n_acd_send(NAcd *acd, const struct in_addr *tpa, const struct in_addr *spa)
                 },
         };
         ssize_t l;
-        int r;
+        int r, fd;
+
+        fd = acd->shared_socket ? acd->shared_socket->fd_socket : acd->fd_socket;
 
         memcpy(arp.arp_sha, acd->mac, sizeof(acd->mac));
         memcpy(arp.arp_tpa, &tpa->s_addr, sizeof(uint32_t));
@@ -501,7 +537,7 @@ int n_acd_send(NAcd *acd, const struct in_addr *tpa, const struct in_addr *spa)
         if (spa)
                 memcpy(arp.arp_spa, &spa->s_addr, sizeof(spa->s_addr));
 
-        l = sendto(acd->fd_socket,
+        l = sendto(fd,
                    &arp,
                    sizeof(arp),
                    MSG_NOSIGNAL,
@@ -567,6 +603,9 @@ int n_acd_send(NAcd *acd, const struct in_addr *tpa, const struct in_addr *spa)
  * called.
  *
  * Currently, the file-descriptor is an epoll-fd.
+ *
+ * Contexts running on a shared socket have no file-descriptor of their own
+ * and return -1. Poll the shared socket instead.
  */
 _c_public_ void n_acd_get_fd(NAcd *acd, int *fdp) {
         *fdp = acd->fd_epoll;
@@ -613,7 +652,7 @@ static int n_acd_handle_timeout(NAcd *acd) {
         return 0;
 }
 
-static int n_acd_handle_packet(NAcd *acd, struct ether_arp *packet) {
+int n_acd_handle_packet(NAcd *acd, struct ether_arp *packet) {
         bool hard_conflict;
         NAcdProbe *probe;
         uint32_t addr;
@@ -735,7 +774,7 @@ static int n_acd_dispatch_timer(NAcd *acd, struct epoll_event *event) {
         return 0;
 }
 
-static bool n_acd_packet_is_valid(NAcd *acd, void *packet, size_t n_packet) {
+bool n_acd_packet_is_valid(NAcd *acd, void *packet, size_t n_packet) {
         struct ether_arp *arp;
 
         /*
@@ -889,6 +928,9 @@ static int n_acd_dispatch_socket(NAcd *acd, struct epoll_event *event) {
  * handles it automatically. However, in case of edge-triggered event
  * mechanisms, the caller must make sure to call the dispatcher again.
  *
+ * Contexts running on a shared socket are dispatched via
+ * n_acd_shared_socket_dispatch(). For them, this is a no-op.
+ *
  * Return: 0 on success, N_ACD_E_PREEMPTED on preemption, negative error code
  *         on failure.
  */
@@ -896,6 +938,9 @@ _c_public_ int n_acd_dispatch(NAcd *acd) {
         struct epoll_event events[2];
         int n, i, r = 0;
 
+        if (acd->shared_socket)
+                return 0;
+
         n = epoll_wait(acd->fd_epoll, events, sizeof(events) / sizeof(*events), 0);
         if (n < 0) {
                 /* Linux never returns EINTR if `timeout == 0'. */
@@ -975,6 +1020,10 @@ _c_public_ int n_acd_dispatch(NAcd *acd) {
  *                          probes is lost and the user better re-probes all
  *                          addresses.
  *
+ * For contexts running on a shared socket, this also returns the error, that
+ * the context failed with during n_acd_shared_socket_dispatch(). The error is
+ * returned once.
+ *
  * Returns: 0 on success, negative error code on failure. The popped event is
  *          returned in @eventp. If no event is pending, NULL is placed in
  *          @eventp and 0 is returned. If an error is returned, @eventp is left
@@ -982,6 +1031,13 @@ _c_public_ int n_acd_dispatch(NAcd *acd) {
  */
 _c_public_ int n_acd_pop_event(NAcd *acd, NAcdEvent **eventp) {
         NAcdEventNode *node, *t_node;
+        int r;
+
+        if (acd->shared_error) {
+                r = acd->shared_error;
+                acd->shared_error = 0;
+                return r;
+        }
 
         c_list_for_each_entry_safe(node, t_node, &acd->event_list, acd_link) {
                 if (node->is_public) {
@@ -994,6 +1050,7 @@ _c_public_ int n_acd_pop_event(NAcd *acd, NAcdEvent **eventp) {
                 return 0;
         }
 
+        c_list_unlink(&acd->pending_link);
         *eventp = NULL;
         return 0;
 }
@@ -1025,3 +1082,32 @@ _c_public_ int n_acd_pop_event(NAcd *acd, NAcdEvent **eventp) {
 _c_public_ int n_acd_probe(NAcd *acd, NAcdProbe **probep, NAcdProbeConfig *config) {
         return n_acd_probe_new(probep, acd, config);
 }
+
+/**
+ * n_acd_set_userdata() - set userdata
+ * @acd:                        context object to operate on
+ * @userdata:                   userdata pointer
+ *
+ * This can be used to set a caller-controlled user-data pointer on @acd. The
+ * value of the pointer is never inspected or used by `n-acd` and is fully
+ * under control of the caller.
+ *
+ * This is mostly useful with shared sockets, to get from a context returned
+ * by n_acd_shared_socket_pop_context() back to the object of the caller.
+ *
+ * The default value is NULL.
+ */
+_c_public_ void n_acd_set_userdata(NAcd *acd, void *userdata) {
+        acd->userdata = userdata;
+}
+
+/**
+ * n_acd_get_userdata() - get userdata
+ * @acd:                        context object to operate on
+ * @userdatap:                  output argument for userdata
+ *
+ * This queries the userdata that was set via n_acd_set_userdata().
+ */
+_c_public_ void n_acd_get_userdata(NAcd *acd, void **userdatap) {
+        *userdatap = acd->userdata;
+}
@@ -22,6 +22,7 @@ typedef struct NAcdConfig NAcdConfig;
 typedef struct NAcdEvent NAcdEvent;
 typedef struct NAcdProbe NAcdProbe;
 typedef struct NAcdProbeConfig NAcdProbeConfig;
+typedef struct NAcdSharedSocket NAcdSharedSocket;
 
 #define N_ACD_TIMEOUT_RFC5227 (UINT64_C(9000))
 
@@ -79,6 +80,7 @@ NAcdConfig *n_acd_config_free(NAcdConfig *config);
 void n_acd_config_set_ifindex(NAcdConfig *config, int ifindex);
 void n_acd_config_set_transport(NAcdConfig *config, unsigned int transport);
 void n_acd_config_set_mac(NAcdConfig *config, const uint8_t *mac, size_t n_mac);
+void n_acd_config_set_shared_socket(NAcdConfig *config, NAcdSharedSocket *socket);
 
 int n_acd_probe_config_new(NAcdProbeConfig **configp);
 NAcdProbeConfig *n_acd_probe_config_free(NAcdProbeConfig *config);
@@ -98,6 +100,19 @@ int n_acd_pop_event(NAcd *acd, NAcdEvent **eventp);
 
 int n_acd_probe(NAcd *acd, NAcdProbe **probep, NAcdProbeConfig *config);
 
+void n_acd_set_userdata(NAcd *acd, void *userdata);
+void n_acd_get_userdata(NAcd *acd, void **userdatap);
+
+/* shared sockets */
+
+int n_acd_shared_socket_new(NAcdSharedSocket **socketp);
+NAcdSharedSocket *n_acd_shared_socket_ref(NAcdSharedSocket *socket);
+NAcdSharedSocket *n_acd_shared_socket_unref(NAcdSharedSocket *socket);
+
+void n_acd_shared_socket_get_fd(NAcdSharedSocket *socket, int *fdp);
+int n_acd_shared_socket_dispatch(NAcdSharedSocket *socket);
+void n_acd_shared_socket_pop_context(NAcdSharedSocket *socket, NAcd **acdp);
+
 /* probes */
 
 NAcdProbe *n_acd_probe_free(NAcdProbe *probe);
@@ -136,6 +151,15 @@ static inline void n_acd_unrefv(NAcd *acd) {
         n_acd_unref(acd);
 }
 
+static inline void n_acd_shared_socket_unrefp(NAcdSharedSocket **socket) {
+        if (*socket)
+                n_acd_shared_socket_unref(*socket);
+}
+
+static inline void n_acd_shared_socket_unrefv(NAcdSharedSocket *socket) {
+        n_acd_shared_socket_unref(socket);
+}
+
 static inline void n_acd_probe_freep(NAcdProbe **probe) {
         if (*probe)
                 n_acd_probe_free(*probe);
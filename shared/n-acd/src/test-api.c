@@ -38,6 +38,7 @@ static void test_api_types(void) {
         assert(sizeof(NAcdProbeConfig*));
         assert(sizeof(NAcd*));
         assert(sizeof(NAcdProbe*));
+        assert(sizeof(NAcdSharedSocket*));
 }
 
 static void test_api_functions(void) {
@@ -47,6 +48,7 @@ static void test_api_functions(void) {
                 (void *)n_acd_config_set_ifindex,
                 (void *)n_acd_config_set_transport,
                 (void *)n_acd_config_set_mac,
+                (void *)n_acd_config_set_shared_socket,
                 (void *)n_acd_probe_config_new,
                 (void *)n_acd_probe_config_free,
                 (void *)n_acd_probe_config_set_ip,
@@ -59,6 +61,15 @@ static void test_api_functions(void) {
                 (void *)n_acd_dispatch,
                 (void *)n_acd_pop_event,
                 (void *)n_acd_probe,
+                (void *)n_acd_set_userdata,
+                (void *)n_acd_get_userdata,
+
+                (void *)n_acd_shared_socket_new,
+                (void *)n_acd_shared_socket_ref,
+                (void *)n_acd_shared_socket_unref,
+                (void *)n_acd_shared_socket_get_fd,
+                (void *)n_acd_shared_socket_dispatch,
+                (void *)n_acd_shared_socket_pop_context,
 
                 (void *)n_acd_probe_free,
                 (void *)n_acd_probe_set_userdata,
@@ -71,6 +82,8 @@ static void test_api_functions(void) {
                 (void *)n_acd_probe_config_freev,
                 (void *)n_acd_unrefp,
                 (void *)n_acd_unrefv,
+                (void *)n_acd_shared_socket_unrefp,
+                (void *)n_acd_shared_socket_unrefv,
                 (void *)n_acd_probe_freep,
                 (void *)n_acd_probe_freev,
         };
@@ -0,0 +1,346 @@
+/*
+ * Test shared sockets on veth links
+ *
+ * Run ACD contexts on both ends of several veth links, all on a single shared
+ * socket. On each link, the parent end probes for an unused address, for an
+ * address configured on the child end, and for an address the child end
+ * probes for simultaneously.
+ *
+ * All links probe for the same addresses, so any packet dispatched to the
+ * context of the wrong link would make an unused address fail.
+ *
+ * Lastly, check that a context which is only kept alive by its probe does not
+ * hide the packets of its ifindex from a new context on the same ifindex.
+ */
+
+#undef NDEBUG
+#include <c-stdaux.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include "test.h"
+
+#define TEST_N_LINKS (16)
+
+enum {
+        TEST_PROBE_UNUSED,
+        TEST_PROBE_CONFIGURED,
+        TEST_PROBE_BOTH,
+        _TEST_PROBE_N,
+};
+
+typedef enum {
+        TEST_ACD_STATE_UNKNOWN,
+        TEST_ACD_STATE_USED,
+        TEST_ACD_STATE_READY,
+} TestAcdState;
+
+typedef struct TestLink {
+        int ifindex_parent;
+        int ifindex_child;
+        struct ether_addr mac_parent;
+        struct ether_addr mac_child;
+        NAcd *acd_parent;
+        NAcd *acd_child;
+        NAcdProbe *probes_parent[_TEST_PROBE_N];
+        NAcdProbe *probe_child;
+} TestLink;
+
+static struct in_addr test_probe_ip(unsigned int probe) {
+        return (struct in_addr){ htobe32((10 << 24) | (probe + 1)) };
+}
+
+static void test_link_new(TestLink *link, unsigned int idx) {
+        char name_parent[IF_NAMESIZE], name_child[IF_NAMESIZE];
+        char *p;
+        int r;
+
+        snprintf(name_parent, sizeof(name_parent), "veth-p%u", idx);
+        snprintf(name_child, sizeof(name_child), "veth-c%u", idx);
+
+        r = asprintf(&p,
+                     "ip link add %s type veth peer name %s && ip link set %s up && ip link set %s up",
+                     name_parent,
+                     name_child,
+                     name_parent,
+                     name_child);
+        c_assert(r >= 0);
+        r = system(p);
+        c_assert(r == 0);
+        free(p);
+
+        /* the child end owns the configured address */
+        r = asprintf(&p,
+                     "ip addr add dev %s %s/32",
+                     name_child,
+                     inet_ntoa(test_probe_ip(TEST_PROBE_CONFIGURED)));
+        c_assert(r >= 0);
+        r = system(p);
+        c_assert(r == 0);
+        free(p);
+
+        test_if_query(name_parent, &link->ifindex_parent, &link->mac_parent);
+        test_if_query(name_child, &link->ifindex_child, &link->mac_child);
+}
+
+static NAcd *test_context_new(NAcdSharedSocket *shared_socket,
+                              int ifindex,
+                              struct ether_addr *mac,
+                              TestLink *link) {
+        NAcdConfig *config;
+        NAcd *acd;
+        int fd, r;
+
+        r = n_acd_config_new(&config);
+        c_assert(!r);
+
+        n_acd_config_set_transport(config, N_ACD_TRANSPORT_ETHERNET);
+        n_acd_config_set_ifindex(config, ifindex);
+        n_acd_config_set_mac(config, mac->ether_addr_octet, sizeof(mac->ether_addr_octet));
+        n_acd_config_set_shared_socket(config, shared_socket);
+
+        r = n_acd_new(&acd, config);
+        c_assert(!r);
+
+        n_acd_config_free(config);
+
+        /* contexts on a shared socket have no file-descriptor of their own */
+        n_acd_get_fd(acd, &fd);
+        c_assert(fd < 0);
+
+        n_acd_set_userdata(acd, link);
+        return acd;
+}
+
+static size_t test_handle_events(NAcd *acd) {
+        NAcdEvent *event;
+        NAcdProbe *probe;
+        unsigned long state;
+        size_t n_done = 0;
+        int r;
+
+        for (;;) {
+                r = n_acd_pop_event(acd, &event);
+                c_assert(!r);
+                if (!event)
+                        return n_done;
+
+                switch (event->event) {
+                case N_ACD_EVENT_READY:
+                        probe = event->ready.probe;
+                        n_acd_probe_get_userdata(probe, (void **)&state);
+                        c_assert(state == TEST_ACD_STATE_UNKNOWN);
+                        n_acd_probe_set_userdata(probe, (void *)TEST_ACD_STATE_READY);
+                        break;
+                case N_ACD_EVENT_USED:
+                        probe = event->used.probe;
+                        n_acd_probe_get_userdata(probe, (void **)&state);
+                        c_assert(state == TEST_ACD_STATE_UNKNOWN);
+                        n_acd_probe_set_userdata(probe, (void *)TEST_ACD_STATE_USED);
+                        break;
+                default:
+                        c_assert(0);
+                }
+
+                ++n_done;
+        }
+}
+
+static unsigned long test_probe_state(NAcdProbe *probe) {
+        unsigned long state;
+
+        n_acd_probe_get_userdata(probe, (void **)&state);
+        return state;
+}
+
+static void test_shared_socket(TestLink *links) {
+        NAcdSharedSocket *shared_socket;
+        NAcdProbeConfig *probe_config;
+        size_t n_running = 0;
+        unsigned int i, j;
+        int r;
+
+        r = n_acd_shared_socket_new(&shared_socket);
+        c_assert(!r);
+
+        r = n_acd_probe_config_new(&probe_config);
+        c_assert(!r);
+        n_acd_probe_config_set_timeout(probe_config, 1024);
+
+        for (i = 0; i < TEST_N_LINKS; ++i) {
+                TestLink *link = &links[i];
+
+                link->acd_parent = test_context_new(shared_socket,
+                                                    link->ifindex_parent,
+                                                    &link->mac_parent,
+                                                    link);
+                link->acd_child = test_context_new(shared_socket,
+                                                   link->ifindex_child,
+                                                   &link->mac_child,
+                                                   link);
+
+                for (j = 0; j < _TEST_PROBE_N; ++j) {
+                        n_acd_probe_config_set_ip(probe_config, test_probe_ip(j));
+                        r = n_acd_probe(link->acd_parent, &link->probes_parent[j], probe_config);
+                        c_assert(!r);
+                        ++n_running;
+                }
+
+                n_acd_probe_config_set_ip(probe_config, test_probe_ip(TEST_PROBE_BOTH));
+                r = n_acd_probe(link->acd_child, &link->probe_child, probe_config);
+                c_assert(!r);
+                ++n_running;
+        }
+
+        n_acd_probe_config_free(probe_config);
+
+        while (n_running > 0) {
+                struct pollfd pfd = { .events = POLLIN };
+                TestLink *link;
+                NAcd *acd;
+
+                n_acd_shared_socket_get_fd(shared_socket, &pfd.fd);
+
+                r = poll(&pfd, 1, -1);
+                c_assert(r >= 0);
+
+                r = n_acd_shared_socket_dispatch(shared_socket);
+                c_assert(!r || r == N_ACD_E_PREEMPTED);
+
+                for (;;) {
+                        n_acd_shared_socket_pop_context(shared_socket, &acd);
+                        if (!acd)
+                                break;
+
+                        n_acd_get_userdata(acd, (void **)&link);
+                        c_assert(acd == link->acd_parent || acd == link->acd_child);
+
+                        n_running -= test_handle_events(acd);
+                }
+        }
+
+        for (i = 0; i < TEST_N_LINKS; ++i) {
+                TestLink *link = &links[i];
+
+                c_assert(test_probe_state(link->probes_parent[TEST_PROBE_UNUSED]) == TEST_ACD_STATE_READY);
+                c_assert(test_probe_state(link->probes_parent[TEST_PROBE_CONFIGURED]) == TEST_ACD_STATE_USED);
+                c_assert(test_probe_state(link->probes_parent[TEST_PROBE_BOTH]) != TEST_ACD_STATE_UNKNOWN);
+                c_assert(test_probe_state(link->probe_child) != TEST_ACD_STATE_UNKNOWN);
+                c_assert(test_probe_state(link->probes_parent[TEST_PROBE_BOTH]) == TEST_ACD_STATE_USED ||
+                         test_probe_state(link->probe_child) == TEST_ACD_STATE_USED);
+
+                for (j = 0; j < _TEST_PROBE_N; ++j)
+                        n_acd_probe_free(link->probes_parent[j]);
+                n_acd_probe_free(link->probe_child);
+
+                link->acd_child = n_acd_unref(link->acd_child);
+                link->acd_parent = n_acd_unref(link->acd_parent);
+        }
+
+        n_acd_shared_socket_unref(shared_socket);
+}
+
+static void test_stale_context(TestLink *link) {
+        NAcdSharedSocket *shared_socket;
+        NAcdProbeConfig *probe_config;
+        NAcdProbe *probe_stale, *probe;
+        NAcd *acd_stale, *acd;
+        int r;
+
+        r = n_acd_shared_socket_new(&shared_socket);
+        c_assert(!r);
+
+        r = n_acd_probe_config_new(&probe_config);
+        c_assert(!r);
+        n_acd_probe_config_set_timeout(probe_config, 1024);
+        n_acd_probe_config_set_ip(probe_config, test_probe_ip(TEST_PROBE_CONFIGURED));
+
+        /*
+         * The owner drops the first context while its probe still runs, like
+         * NetworkManager does when it resets an ACD instance. The probe pins
+         * the context, so it stays linked on the ifindex, ahead of the new
+         * context.
+         */
+        acd_stale = test_context_new(shared_socket,
+                                     link->ifindex_parent,
+                                     &link->mac_parent,
+                                     NULL);
+        r = n_acd_probe(acd_stale, &probe_stale, probe_config);
+        c_assert(!r);
+        acd_stale = n_acd_unref(acd_stale);
+
+        acd = test_context_new(shared_socket, link->ifindex_parent, &link->mac_parent, link);
+        r = n_acd_probe(acd, &probe, probe_config);
+        c_assert(!r);
+
+        n_acd_probe_config_free(probe_config);
+
+        while (test_probe_state(probe) == TEST_ACD_STATE_UNKNOWN) {
+                struct pollfd pfd = { .events = POLLIN };
+                NAcd *acd_pending;
+
+                n_acd_shared_socket_get_fd(shared_socket, &pfd.fd);
+
+                r = poll(&pfd, 1, -1);
+                c_assert(r >= 0);
+
+                r = n_acd_shared_socket_dispatch(shared_socket);
+                c_assert(!r || r == N_ACD_E_PREEMPTED);
+
+                for (;;) {
+                        n_acd_shared_socket_pop_context(shared_socket, &acd_pending);
+                        if (!acd_pending)
+                                break;
+
+                        test_handle_events(acd_pending);
+                }
+        }
+
+        /* the child end owns the address, so the new context must see it */
+        c_assert(test_probe_state(probe) == TEST_ACD_STATE_USED);
+
+        n_acd_probe_free(probe);
+        n_acd_probe_free(probe_stale);
+        n_acd_unref(acd);
+        n_acd_shared_socket_unref(shared_socket);
+}
+
+/*
+ * The test needs user namespaces and the "ip" tool. Probe for them in a
+ * child process, so the test is skipped where they are not available (e.g.,
+ * in containers), instead of failing.
+ */
+static bool test_can_run(void) {
+        int status;
+        pid_t pid;
+
+        pid = fork();
+        c_assert(pid >= 0);
+        if (pid == 0) {
+                if (unshare(CLONE_NEWUSER) < 0)
+                        _exit(1);
+                _exit(system("ip -V >/dev/null 2>&1") == 0 ? 0 : 1);
+        }
+
+        c_assert(waitpid(pid, &status, 0) == pid);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv) {
+        TestLink links[TEST_N_LINKS] = {};
+        unsigned int i;
+
+        if (!test_can_run())
+                return 77;
+
+        test_setup();
+
+        for (i = 0; i < TEST_N_LINKS; ++i)
+                test_link_new(&links[i], i);
+
+        for (i = 0; i < 4; ++i)
+                test_shared_socket(links);
+
+        test_stale_context(&links[0]);
+
+        return 0;
+}
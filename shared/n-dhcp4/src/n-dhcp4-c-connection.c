@@ -159,6 +159,18 @@ int n_dhcp4_c_connection_listen(NDhcp4CConnection *connection) {
                 connection->fd_udp = c_close(connection->fd_udp);
         }
 
+        if (connection->client_config->shared_socket) {
+                /*
+                 * With a shared packet socket, we neither own a socket nor
+                 * attach anything to the epoll context. The shared socket
+                 * dispatches the replies for our ifindex to us.
+                 */
+                n_dhcp4_client_shared_socket_link(connection->client_config->shared_socket,
+                                                  connection);
+                connection->state = N_DHCP4_C_CONNECTION_STATE_PACKET;
+                return 0;
+        }
+
         r = n_dhcp4_c_socket_packet_new(&fd_packet, connection->client_config->ifindex);
         if (r)
                 return r;
@@ -204,6 +216,20 @@ int n_dhcp4_c_connection_connect(NDhcp4CConnection *connection,
         if (r < 0)
                 return -errno;
 
+        if (connection->fd_packet < 0) {
+                /*
+                 * We use a shared packet socket. There is nothing to drain,
+                 * we just stop receiving from it.
+                 */
+                c_list_unlink(&connection->shared_link);
+                connection->state = N_DHCP4_C_CONNECTION_STATE_UDP;
+                connection->fd_udp = fd_udp;
+                fd_udp = -1;
+                connection->client_ip = client->s_addr;
+                connection->server_ip = server->s_addr;
+                return 0;
+        }
+
         r = packet_shutdown(connection->fd_packet);
         if (r < 0) {
                 epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, fd_udp, NULL);
@@ -219,6 +245,8 @@ int n_dhcp4_c_connection_connect(NDhcp4CConnection *connection,
 }
 
 void n_dhcp4_c_connection_close(NDhcp4CConnection *connection) {
+        c_list_unlink(&connection->shared_link);
+
         if (connection->fd_udp >= 0) {
                 epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, connection->fd_udp, NULL);
                 connection->fd_udp = c_close(connection->fd_udp);
@@ -378,7 +406,9 @@ static int n_dhcp4_c_connection_packet_broadcast(NDhcp4CConnection *connection,
 
         c_assert(connection->state == N_DHCP4_C_CONNECTION_STATE_PACKET);
 
-        r = n_dhcp4_c_socket_packet_send(connection->fd_packet,
+        r = n_dhcp4_c_socket_packet_send(connection->client_config->shared_socket
+                                         ? connection->client_config->shared_socket->fd_packet
+                                         : connection->fd_packet,
                                          connection->client_config->ifindex,
                                          connection->client_config->broadcast_mac,
                                          connection->client_config->n_broadcast_mac,
@@ -1146,9 +1176,6 @@ int n_dhcp4_c_connection_dispatch_timer(NDhcp4CConnection *connection,
 int n_dhcp4_c_connection_dispatch_io(NDhcp4CConnection *connection,
                                      NDhcp4Incoming **messagep) {
         _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = NULL;
-        char serv_addr[INET_ADDRSTRLEN];
-        char client_addr[INET_ADDRSTRLEN];
-        uint8_t type;
         int r;
 
         switch (connection->state) {
@@ -1200,6 +1227,42 @@ int n_dhcp4_c_connection_dispatch_io(NDhcp4CConnection *connection,
                 return -ENOTRECOVERABLE;
         }
 
+        r = n_dhcp4_c_connection_accept_incoming(connection, message);
+        if (r)
+                return r;
+
+        *messagep = message;
+        message = NULL;
+        return 0;
+}
+
+/**
+ * n_dhcp4_c_connection_accept_incoming() - verify and accept incoming message
+ * @connection:                 connection to operate on
+ * @message:                    message received for this connection
+ *
+ * This verifies that @message is a reply to the pending request of
+ * @connection, and updates the connection state accordingly. The caller
+ * retains ownership of @message.
+ *
+ * Messages from the connection's own sockets are passed through here by
+ * n_dhcp4_c_connection_dispatch_io(). Messages received on a shared packet
+ * socket are passed through here for each connection on the ingress
+ * interface, until one accepts it.
+ *
+ * Returns:
+ *  0                     on success
+ *  N_DHCP4_E_MALFORMED   if the message is malformed
+ *  N_DHCP4_E_UNEXPECTED  if the message is not meant for this connection
+ *  N_DHCP4_E_AGAIN       if there was another error (non fatal for the client)
+ */
+int n_dhcp4_c_connection_accept_incoming(NDhcp4CConnection *connection,
+                                         NDhcp4Incoming *message) {
+        char serv_addr[INET_ADDRSTRLEN];
+        char client_addr[INET_ADDRSTRLEN];
+        uint8_t type;
+        int r;
+
         r = n_dhcp4_c_connection_verify_incoming(connection, message, &type);
         if (r == N_DHCP4_E_MALFORMED || r == N_DHCP4_E_UNEXPECTED)
                 return r;
@@ -1250,7 +1313,5 @@ int n_dhcp4_c_connection_dispatch_io(NDhcp4CConnection *connection,
                 break;
         }
 
-        *messagep = message;
-        message = NULL;
         return 0;
 }
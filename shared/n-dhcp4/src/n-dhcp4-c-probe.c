@@ -1220,7 +1220,6 @@ int n_dhcp4_client_probe_dispatch_timer(NDhcp4ClientProbe *probe, uint64_t ns_no
  */
 int n_dhcp4_client_probe_dispatch_io(NDhcp4ClientProbe *probe, uint32_t events) {
         _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = NULL;
-        uint8_t type;
         int r;
 
         r = n_dhcp4_c_connection_dispatch_io(&probe->connection, &message);
@@ -1249,6 +1248,27 @@ int n_dhcp4_client_probe_dispatch_io(NDhcp4ClientProbe *probe, uint32_t events)
          */
         probe->client->preempted = true;
 
+        r = n_dhcp4_client_probe_dispatch_message(probe, message);
+        message = NULL; /* consumed */
+        return r;
+}
+
+/**
+ * n_dhcp4_client_probe_dispatch_message() - dispatch incoming message
+ * @probe:                      probe to operate on
+ * @message_take:               message to dispatch, ownership is transferred
+ *
+ * This handles a message that was accepted by the connection of @probe,
+ * regardless whether it was received on the sockets of the connection or on
+ * a shared packet socket.
+ *
+ * Return: 0 on success, negative error code on failure.
+ */
+int n_dhcp4_client_probe_dispatch_message(NDhcp4ClientProbe *probe, NDhcp4Incoming *message_take) {
+        _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = message_take;
+        uint8_t type;
+        int r;
+
         r = n_dhcp4_incoming_query_message_type(message, &type);
         if (r == N_DHCP4_E_UNSET || r == N_DHCP4_E_MALFORMED)
                 /*
@@ -0,0 +1,238 @@
+/*
+ * DHCPv4 Client Shared Packet Socket
+ *
+ * Until a client has an IP address configured, it talks to the server via an
+ * AF_PACKET socket. By default, each probe opens its own packet socket bound
+ * to the interface of the client, with its own BPF filter attached. With many
+ * clients running in parallel (e.g., on hundreds of VLAN interfaces), this
+ * becomes a significant cost in file descriptors, filter programs and wakeups.
+ *
+ * A shared socket is a single packet socket which is not bound to any
+ * interface. Probes using it do not open their own packet socket, but link
+ * their connection into the shared socket instead. Incoming replies are
+ * demultiplexed to the right connection by the ingress ifindex and the
+ * transaction id of the pending request.
+ *
+ * The shared socket is dispatched by the caller, separately from the clients.
+ * Timers are still handled by n_dhcp4_client_dispatch() of each client.
+ */
+
+#include <c-list.h>
+#include <c-stdaux.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "n-dhcp4.h"
+#include "n-dhcp4-private.h"
+
+/*
+ * The shared socket receives the replies for all clients, so we want a larger
+ * receive buffer than the default. This is best-effort.
+ */
+#define N_DHCP4_C_SHARED_SOCKET_RCVBUF (4 * 1024 * 1024)
+
+static CList *n_dhcp4_client_shared_socket_get_bucket(NDhcp4ClientSharedSocket *socket, int ifindex) {
+        return &socket->connection_buckets[(unsigned int)ifindex % N_DHCP4_C_SHARED_SOCKET_N_BUCKETS];
+}
+
+/**
+ * n_dhcp4_client_shared_socket_new() - allocate new shared packet socket
+ * @socketp:                    output argument for new shared socket
+ *
+ * This creates a new packet socket that can be shared by several clients. The
+ * socket is created in the network namespace of the caller. Pass it to the
+ * client configuration via n_dhcp4_client_config_set_shared_socket().
+ *
+ * The caller owns a single ref-count to the object and is responsible to drop
+ * it, when no longer needed.
+ *
+ * Return: 0 on success, negative error code on failure.
+ */
+_c_public_ int n_dhcp4_client_shared_socket_new(NDhcp4ClientSharedSocket **socketp) {
+        _c_cleanup_(n_dhcp4_client_shared_socket_unrefp) NDhcp4ClientSharedSocket *socket = NULL;
+        int r, rcvbuf = N_DHCP4_C_SHARED_SOCKET_RCVBUF;
+        size_t i;
+
+        socket = malloc(sizeof(*socket));
+        if (!socket)
+                return -ENOMEM;
+
+        *socket = (NDhcp4ClientSharedSocket)N_DHCP4_CLIENT_SHARED_SOCKET_NULL(*socket);
+        for (i = 0; i < N_DHCP4_C_SHARED_SOCKET_N_BUCKETS; ++i)
+                c_list_init(&socket->connection_buckets[i]);
+
+        r = n_dhcp4_c_socket_packet_new(&socket->fd_packet, 0);
+        if (r)
+                return r;
+
+        (void)setsockopt(socket->fd_packet, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        *socketp = socket;
+        socket = NULL;
+        return 0;
+}
+
+static void n_dhcp4_client_shared_socket_free(NDhcp4ClientSharedSocket *socket) {
+        size_t i;
+
+        /* connections pin their config, which pins the shared socket */
+        for (i = 0; i < N_DHCP4_C_SHARED_SOCKET_N_BUCKETS; ++i)
+                c_assert(c_list_is_empty(&socket->connection_buckets[i]));
+
+        if (socket->fd_packet >= 0)
+                close(socket->fd_packet);
+
+        free(socket);
+}
+
+/**
+ * n_dhcp4_client_shared_socket_ref() - acquire shared socket reference
+ * @socket:                     shared socket to operate on, or NULL
+ *
+ * This acquires a reference to the shared socket given as @socket. If @socket
+ * is NULL, this function is a no-op.
+ *
+ * Return: @socket is returned.
+ */
+_c_public_ NDhcp4ClientSharedSocket *n_dhcp4_client_shared_socket_ref(NDhcp4ClientSharedSocket *socket) {
+        if (socket)
+                ++socket->n_refs;
+        return socket;
+}
+
+/**
+ * n_dhcp4_client_shared_socket_unref() - release shared socket reference
+ * @socket:                     shared socket to operate on, or NULL
+ *
+ * This releases a reference to the shared socket given as @socket. If @socket
+ * is NULL, this function is a no-op.
+ *
+ * Return: NULL is returned.
+ */
+_c_public_ NDhcp4ClientSharedSocket *n_dhcp4_client_shared_socket_unref(NDhcp4ClientSharedSocket *socket) {
+        if (socket && !--socket->n_refs)
+                n_dhcp4_client_shared_socket_free(socket);
+        return NULL;
+}
+
+/**
+ * n_dhcp4_client_shared_socket_link() - link connection into shared socket
+ * @socket:                     shared socket to operate on
+ * @connection:                 connection to link
+ *
+ * This makes @socket dispatch incoming replies for the ifindex of
+ * @connection to it. The connection unlinks itself when it leaves the
+ * PACKET state.
+ */
+void n_dhcp4_client_shared_socket_link(NDhcp4ClientSharedSocket *socket,
+                                       NDhcp4CConnection *connection) {
+        c_list_unlink(&connection->shared_link);
+        c_list_link_tail(n_dhcp4_client_shared_socket_get_bucket(socket,
+                                                                  connection->client_config->ifindex),
+                         &connection->shared_link);
+}
+
+/**
+ * n_dhcp4_client_shared_socket_get_fd() - query shared socket file-descriptor
+ * @socket:                     shared socket to operate on
+ * @fdp:                        output argument for file-descriptor
+ *
+ * This queries the file-descriptor of the shared socket. Whenever it is
+ * readable, you should call n_dhcp4_client_shared_socket_dispatch().
+ */
+_c_public_ void n_dhcp4_client_shared_socket_get_fd(NDhcp4ClientSharedSocket *socket, int *fdp) {
+        *fdp = socket->fd_packet;
+}
+
+/**
+ * n_dhcp4_client_shared_socket_dispatch() - dispatch shared socket
+ * @socket:                     shared socket to operate on
+ * @clientp:                    output argument for the dispatched client
+ *
+ * This reads one pending packet from the shared socket and forwards it to
+ * the client it is meant for. If the packet was handled by a client, the
+ * client is returned in @clientp and the caller should fetch its pending
+ * events via n_dhcp4_client_pop_event(). Otherwise, NULL is returned in
+ * @clientp. If the client fails to handle the packet, the client is returned
+ * as well, together with the error code. The returned client is not pinned.
+ *
+ * This function never blocks.
+ *
+ * Return: 0 if there was nothing to read, N_DHCP4_E_PREEMPTED if a packet was
+ *         read and there might be more data to dispatch, negative error code
+ *         on failure.
+ */
+_c_public_ int n_dhcp4_client_shared_socket_dispatch(NDhcp4ClientSharedSocket *socket, NDhcp4Client **clientp) {
+        _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = NULL;
+        NDhcp4CConnection *connection;
+        NDhcp4ClientProbe *probe;
+        NDhcp4Client *client;
+        int r, ifindex = 0;
+
+        *clientp = NULL;
+
+        r = n_dhcp4_c_socket_packet_recvfrom(socket->fd_packet,
+                                             socket->scratch_buffer,
+                                             sizeof(socket->scratch_buffer),
+                                             &message,
+                                             &ifindex);
+        if (r) {
+                if (r == N_DHCP4_E_AGAIN)
+                        return 0;
+                else if (r == N_DHCP4_E_MALFORMED || r == N_DHCP4_E_DOWN)
+                        return N_DHCP4_E_PREEMPTED;
+                else if (r < 0)
+                        return r;
+                return N_DHCP4_E_INTERNAL;
+        }
+
+        c_list_for_each_entry(connection,
+                              n_dhcp4_client_shared_socket_get_bucket(socket, ifindex),
+                              shared_link) {
+                if (connection->client_config->ifindex != ifindex)
+                        continue;
+
+                /*
+                 * None of the errors are fatal. If this connection does not
+                 * take the message, another one on the same interface might.
+                 */
+                r = n_dhcp4_c_connection_accept_incoming(connection, message);
+                if (r)
+                        continue;
+
+                probe = c_container_of(connection, NDhcp4ClientProbe, connection);
+                client = probe->client;
+
+                /*
+                 * Unlike n_dhcp4_client_probe_dispatch_io(), the preemption
+                 * is not recorded on the client, as n_dhcp4_client_dispatch()
+                 * would reset it. It is returned to the caller below.
+                 */
+                *clientp = client;
+
+                r = n_dhcp4_client_probe_dispatch_message(probe, message);
+                message = NULL; /* consumed */
+                if (r == N_DHCP4_E_DOWN) {
+                        r = n_dhcp4_client_raise(client, NULL, N_DHCP4_CLIENT_EVENT_DOWN);
+                        if (r)
+                                return r;
+                } else if (r) {
+                        if (r >= _N_DHCP4_E_INTERNAL) {
+                                n_dhcp4_log(&client->log_queue,
+                                            LOG_ERR,
+                                            "invalid internal error code %d after dispatch",
+                                            r);
+                                return N_DHCP4_E_INTERNAL;
+                        }
+                        return r;
+                }
+
+                n_dhcp4_client_arm_timer(client);
+
+                return N_DHCP4_E_PREEMPTED;
+        }
+
+        /* not meant for any of our clients */
+        return N_DHCP4_E_PREEMPTED;
+}
@@ -63,6 +63,7 @@ _c_public_ NDhcp4ClientConfig *n_dhcp4_client_config_free(NDhcp4ClientConfig *co
         if (!config)
                 return NULL;
 
+        n_dhcp4_client_shared_socket_unref(config->shared_socket);
         free(config->client_id);
         free(config);
 
@@ -94,6 +95,8 @@ int n_dhcp4_client_config_dup(NDhcp4ClientConfig *config, NDhcp4ClientConfig **d
         dup->n_mac = config->n_mac;
         memcpy(dup->broadcast_mac, config->broadcast_mac, sizeof(dup->broadcast_mac));
         dup->n_broadcast_mac = config->n_broadcast_mac;
+        if (config->shared_socket)
+                dup->shared_socket = n_dhcp4_client_shared_socket_ref(config->shared_socket);
 
         r = n_dhcp4_client_config_set_client_id(dup,
                                                 config->client_id,
@@ -259,6 +262,27 @@ _c_public_ int n_dhcp4_client_config_set_client_id(NDhcp4ClientConfig *config, c
         return 0;
 }
 
+/**
+ * n_dhcp4_client_config_set_shared_socket() - set shared-socket property
+ * @config:                     client configuration to operate on
+ * @socket:                     shared packet socket to use, or NULL
+ *
+ * This sets the shared-socket property of @config. By default, every probe
+ * opens its own packet socket bound to the ifindex of the client, as long as
+ * it has no IP address configured. If a shared socket is set, the probe uses
+ * it instead. Replies received on the shared socket are dispatched via
+ * n_dhcp4_client_shared_socket_dispatch() rather than
+ * n_dhcp4_client_dispatch().
+ *
+ * The configuration takes a reference on @socket.
+ */
+_c_public_ void n_dhcp4_client_config_set_shared_socket(NDhcp4ClientConfig *config, NDhcp4ClientSharedSocket *socket) {
+        if (socket)
+                n_dhcp4_client_shared_socket_ref(socket);
+        n_dhcp4_client_shared_socket_unref(config->shared_socket);
+        config->shared_socket = socket;
+}
+
 /**
  * n_dhcp4_client_set_log_level() - set the logging level of the client
  * @client:                         the client to operate on
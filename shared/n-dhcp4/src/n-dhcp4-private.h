@@ -243,6 +243,7 @@ struct NDhcp4ClientConfig {
         size_t n_broadcast_mac;
         uint8_t *client_id;
         size_t n_client_id;
+        NDhcp4ClientSharedSocket *shared_socket;
 };
 
 #define N_DHCP4_CLIENT_CONFIG_NULL(_x) {                                        \
@@ -327,6 +328,7 @@ struct NDhcp4CConnection {
         unsigned int state;             /* current connection state */
         int fd_packet;                  /* packet socket */
         int fd_udp;                     /* udp socket */
+        CList shared_link;              /* link into shared packet socket */
 
         NDhcp4Outgoing *request;        /* current request */
 
@@ -347,6 +349,30 @@ struct NDhcp4CConnection {
 #define N_DHCP4_C_CONNECTION_NULL(_x) {                                         \
                 .fd_packet = -1,                                                \
                 .fd_udp = -1,                                                   \
+                .shared_link = C_LIST_INIT((_x).shared_link),                   \
+        }
+
+#define N_DHCP4_C_SHARED_SOCKET_N_BUCKETS 256
+
+struct NDhcp4ClientSharedSocket {
+        unsigned long n_refs;
+
+        int fd_packet;                  /* packet socket, not bound to an interface */
+
+        /*
+         * Connections in PACKET state which use this socket, hashed by their
+         * ifindex. Incoming packets are demultiplexed by the ingress ifindex
+         * and the transaction id of the pending request.
+         */
+        CList connection_buckets[N_DHCP4_C_SHARED_SOCKET_N_BUCKETS];
+
+        /* see NDhcp4CConnection.scratch_buffer */
+        uint8_t scratch_buffer[UINT16_MAX];
+};
+
+#define N_DHCP4_CLIENT_SHARED_SOCKET_NULL(_x) {                                 \
+                .n_refs = 1,                                                    \
+                .fd_packet = -1,                                                \
         }
 
 struct NDhcp4Client {
@@ -572,6 +598,11 @@ int n_dhcp4_c_socket_packet_recv(int sockfd,
                                  uint8_t *buf,
                                  size_t n_buf,
                                  NDhcp4Incoming **messagep);
+int n_dhcp4_c_socket_packet_recvfrom(int sockfd,
+                                     uint8_t *buf,
+                                     size_t n_buf,
+                                     NDhcp4Incoming **messagep,
+                                     int *ifindexp);
 int n_dhcp4_c_socket_udp_recv(int sockfd,
                               uint8_t *buf,
                               size_t n_buf,
@@ -645,6 +676,13 @@ int n_dhcp4_c_connection_dispatch_timer(NDhcp4CConnection *connection,
                                         uint64_t timestamp);
 int n_dhcp4_c_connection_dispatch_io(NDhcp4CConnection *connection,
                                      NDhcp4Incoming **messagep);
+int n_dhcp4_c_connection_accept_incoming(NDhcp4CConnection *connection,
+                                         NDhcp4Incoming *message);
+
+/* client shared sockets */
+
+void n_dhcp4_client_shared_socket_link(NDhcp4ClientSharedSocket *socket,
+                                       NDhcp4CConnection *connection);
 
 /* clients */
 
@@ -662,6 +700,7 @@ int n_dhcp4_client_probe_raise(NDhcp4ClientProbe *probe, NDhcp4CEventNode **node
 void n_dhcp4_client_probe_get_timeout(NDhcp4ClientProbe *probe, uint64_t *timeoutp);
 int n_dhcp4_client_probe_dispatch_timer(NDhcp4ClientProbe *probe, uint64_t ns_now);
 int n_dhcp4_client_probe_dispatch_io(NDhcp4ClientProbe *probe, uint32_t events);
+int n_dhcp4_client_probe_dispatch_message(NDhcp4ClientProbe *probe, NDhcp4Incoming *message_take);
 int n_dhcp4_client_probe_transition_select(NDhcp4ClientProbe *probe, NDhcp4Incoming *offer, uint64_t ns_now);
 int n_dhcp4_client_probe_transition_accept(NDhcp4ClientProbe *probe, NDhcp4Incoming *ack);
 int n_dhcp4_client_probe_transition_decline(NDhcp4ClientProbe *probe, NDhcp4Incoming *offer, const char *error, uint64_t ns_now);
@@ -29,7 +29,9 @@
  * packets before an IP address has been configured.
  *
  * Only unfragmented DHCP packets from a server to a client destined for the given
- * ifindex is returned.
+ * ifindex is returned. If @ifindex is 0, the socket is not bound to an interface
+ * and receives the DHCP packets of all interfaces. This is used by
+ * NDhcp4ClientSharedSocket, which demultiplexes them to the respective clients.
  *
  * Return: 0 on success, or a negative error code on failure.
  */
@@ -554,11 +556,19 @@ int n_dhcp4_c_socket_packet_recv(int sockfd,
                                  uint8_t *buf,
                                  size_t n_buf,
                                  NDhcp4Incoming **messagep) {
+        return n_dhcp4_c_socket_packet_recvfrom(sockfd, buf, n_buf, messagep, NULL);
+}
+
+int n_dhcp4_c_socket_packet_recvfrom(int sockfd,
+                                     uint8_t *buf,
+                                     size_t n_buf,
+                                     NDhcp4Incoming **messagep,
+                                     int *ifindexp) {
         _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = NULL;
         size_t len;
         int r;
 
-        r = packet_recv_udp(sockfd, buf, n_buf, &len);
+        r = packet_recvfrom_udp(sockfd, buf, n_buf, &len, NULL, ifindexp);
         if (r < 0) {
                 if (r == -ENETDOWN)
                         return N_DHCP4_E_DOWN;
@@ -23,6 +23,7 @@ typedef struct NDhcp4ClientEvent NDhcp4ClientEvent;
 typedef struct NDhcp4ClientLease NDhcp4ClientLease;
 typedef struct NDhcp4ClientProbe NDhcp4ClientProbe;
 typedef struct NDhcp4ClientProbeConfig NDhcp4ClientProbeConfig;
+typedef struct NDhcp4ClientSharedSocket NDhcp4ClientSharedSocket;
 typedef struct NDhcp4Server NDhcp4Server;
 typedef struct NDhcp4ServerConfig NDhcp4ServerConfig;
 typedef struct NDhcp4ServerEvent NDhcp4ServerEvent;
@@ -120,6 +121,16 @@ void n_dhcp4_client_config_set_request_broadcast(NDhcp4ClientConfig *config, boo
 void n_dhcp4_client_config_set_mac(NDhcp4ClientConfig *config, const uint8_t *mac, size_t n_mac);
 void n_dhcp4_client_config_set_broadcast_mac(NDhcp4ClientConfig *config, const uint8_t *mac, size_t n_mac);
 int n_dhcp4_client_config_set_client_id(NDhcp4ClientConfig *config, const uint8_t *id, size_t n_id);
+void n_dhcp4_client_config_set_shared_socket(NDhcp4ClientConfig *config, NDhcp4ClientSharedSocket *socket);
+
+/* client shared sockets */
+
+int n_dhcp4_client_shared_socket_new(NDhcp4ClientSharedSocket **socketp);
+NDhcp4ClientSharedSocket *n_dhcp4_client_shared_socket_ref(NDhcp4ClientSharedSocket *socket);
+NDhcp4ClientSharedSocket *n_dhcp4_client_shared_socket_unref(NDhcp4ClientSharedSocket *socket);
+
+void n_dhcp4_client_shared_socket_get_fd(NDhcp4ClientSharedSocket *socket, int *fdp);
+int n_dhcp4_client_shared_socket_dispatch(NDhcp4ClientSharedSocket *socket, NDhcp4Client **clientp);
 
 /* client-probe configs */
 
@@ -232,6 +243,15 @@ static inline void n_dhcp4_client_probe_config_freev(NDhcp4ClientProbeConfig *p)
         n_dhcp4_client_probe_config_free(p);
 }
 
+static inline void n_dhcp4_client_shared_socket_unrefp(NDhcp4ClientSharedSocket **p) {
+        if (*p)
+                n_dhcp4_client_shared_socket_unref(*p);
+}
+
+static inline void n_dhcp4_client_shared_socket_unrefv(NDhcp4ClientSharedSocket *p) {
+        n_dhcp4_client_shared_socket_unref(p);
+}
+
 static inline void n_dhcp4_client_unrefp(NDhcp4Client **p) {
         if (*p)
                 n_dhcp4_client_unref(*p);
@@ -47,6 +47,7 @@ static void test_api_constants(void) {
 static void test_api_types(void) {
         assert(sizeof(NDhcp4ClientConfig*) > 0);
         assert(sizeof(NDhcp4ClientProbeConfig*) > 0);
+        assert(sizeof(NDhcp4ClientSharedSocket*) > 0);
         assert(sizeof(NDhcp4Client*) > 0);
         assert(sizeof(NDhcp4ClientEvent) > 0);
         assert(sizeof(NDhcp4ClientProbe*) > 0);
@@ -70,6 +71,15 @@ static void test_api_functions(void) {
                 (void *)n_dhcp4_client_config_set_mac,
                 (void *)n_dhcp4_client_config_set_broadcast_mac,
                 (void *)n_dhcp4_client_config_set_client_id,
+                (void *)n_dhcp4_client_config_set_shared_socket,
+
+                (void *)n_dhcp4_client_shared_socket_new,
+                (void *)n_dhcp4_client_shared_socket_ref,
+                (void *)n_dhcp4_client_shared_socket_unref,
+                (void *)n_dhcp4_client_shared_socket_unrefp,
+                (void *)n_dhcp4_client_shared_socket_unrefv,
+                (void *)n_dhcp4_client_shared_socket_get_fd,
+                (void *)n_dhcp4_client_shared_socket_dispatch,
 
                 (void *)n_dhcp4_client_probe_config_new,
                 (void *)n_dhcp4_client_probe_config_free,
@@ -0,0 +1,283 @@
+/*
+ * Tests for DHCP4 Client Shared Packet Sockets
+ *
+ * This runs several clients on separate veth links, all sharing a single
+ * packet socket, and verifies that the replies of the per-link servers are
+ * routed to the right client.
+ */
+
+#undef NDEBUG
+#include <assert.h>
+#include <c-stdaux.h>
+#include <endian.h>
+#include <errno.h>
+#include <poll.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include "n-dhcp4.h"
+#include "n-dhcp4-private.h"
+#include "test.h"
+#include "util/link.h"
+#include "util/netns.h"
+
+#define TEST_N_LINKS 16
+
+typedef struct TestLink {
+        int ns_server;
+        Link link_server;
+        Link link_client;
+        struct in_addr addr_server;
+        struct in_addr addr_client;
+        NDhcp4SConnection connection_server;
+        NDhcp4SConnectionIp connection_server_ip;
+        NDhcp4Client *client;
+        NDhcp4ClientProbe *probe;
+        bool offered;
+} TestLink;
+
+static void test_poll(int fd) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int r;
+
+        r = poll(&pfd, 1, -1);
+        c_assert(r == 1);
+        c_assert(pfd.revents == POLLIN);
+}
+
+static void test_link_init(TestLink *link, unsigned int idx, int ns_client) {
+        char ifname[IF_NAMESIZE];
+        int r, oldns;
+
+        link->ns_server = -1;
+        link->link_server = (Link)LINK_NULL(link->link_server);
+        link->link_client = (Link)LINK_NULL(link->link_client);
+        link->addr_server = (struct in_addr){ htonl(10 << 24 | (idx + 1) << 16 | 1) };
+        link->addr_client = (struct in_addr){ htonl(10 << 24 | (idx + 1) << 16 | 2) };
+        link->connection_server = (NDhcp4SConnection)N_DHCP4_S_CONNECTION_NULL(link->connection_server);
+        link->connection_server_ip = (NDhcp4SConnectionIp)N_DHCP4_S_CONNECTION_IP_NULL(link->connection_server_ip);
+
+        netns_new(&link->ns_server);
+        link_new_veth(&link->link_server, &link->link_client, link->ns_server, ns_client);
+        snprintf(ifname, sizeof(ifname), "veth-client-%u", idx);
+        link_set_name(&link->link_client, ifname);
+        link_add_ip4(&link->link_server, &link->addr_server, 16);
+
+        netns_get(&oldns);
+        netns_set(link->ns_server);
+        r = n_dhcp4_s_connection_init(&link->connection_server, link->link_server.ifindex);
+        c_assert(!r);
+        netns_set(oldns);
+
+        n_dhcp4_s_connection_ip_init(&link->connection_server_ip, link->addr_server);
+        n_dhcp4_s_connection_ip_link(&link->connection_server_ip, &link->connection_server);
+}
+
+static void test_link_deinit(TestLink *link) {
+        link->probe = n_dhcp4_client_probe_free(link->probe);
+        link->client = n_dhcp4_client_unref(link->client);
+        n_dhcp4_s_connection_ip_unlink(&link->connection_server_ip);
+        n_dhcp4_s_connection_ip_deinit(&link->connection_server_ip);
+        n_dhcp4_s_connection_deinit(&link->connection_server);
+        link_del_ip4(&link->link_server, &link->addr_server, 16);
+        link_deinit(&link->link_client);
+        link_deinit(&link->link_server);
+        netns_closep(&link->ns_server);
+}
+
+static void test_link_probe(TestLink *link, NDhcp4ClientSharedSocket *shared_socket, unsigned int idx) {
+        _c_cleanup_(n_dhcp4_client_config_freep) NDhcp4ClientConfig *client_config = NULL;
+        _c_cleanup_(n_dhcp4_client_probe_config_freep) NDhcp4ClientProbeConfig *probe_config = NULL;
+        char client_id[32];
+        int r;
+
+        r = n_dhcp4_client_config_new(&client_config);
+        c_assert(!r);
+
+        snprintf(client_id, sizeof(client_id), "client-id-%u", idx);
+
+        n_dhcp4_client_config_set_ifindex(client_config, link->link_client.ifindex);
+        n_dhcp4_client_config_set_transport(client_config, N_DHCP4_TRANSPORT_ETHERNET);
+        n_dhcp4_client_config_set_request_broadcast(client_config, false);
+        n_dhcp4_client_config_set_mac(client_config, link->link_client.mac.ether_addr_octet, ETH_ALEN);
+        n_dhcp4_client_config_set_broadcast_mac(client_config,
+                                                (const uint8_t[]){
+                                                        0xff, 0xff, 0xff,
+                                                        0xff, 0xff, 0xff,
+                                                },
+                                                ETH_ALEN);
+        r = n_dhcp4_client_config_set_client_id(client_config, (void *)client_id, strlen(client_id));
+        c_assert(!r);
+        n_dhcp4_client_config_set_shared_socket(client_config, shared_socket);
+
+        r = n_dhcp4_client_new(&link->client, client_config);
+        c_assert(!r);
+
+        r = n_dhcp4_client_probe_config_new(&probe_config);
+        c_assert(!r);
+
+        n_dhcp4_client_probe_config_set_start_delay(probe_config, 1);
+
+        r = n_dhcp4_client_probe(link->client, &link->probe, probe_config);
+        c_assert(!r);
+}
+
+static void test_link_offer(TestLink *link) {
+        _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *request = NULL;
+        _c_cleanup_(n_dhcp4_outgoing_freep) NDhcp4Outgoing *reply = NULL;
+        uint8_t type;
+        int r, fd;
+
+        n_dhcp4_s_connection_get_fd(&link->connection_server, &fd);
+
+        do {
+                test_poll(fd);
+
+                r = n_dhcp4_s_connection_dispatch_io(&link->connection_server, &request);
+                c_assert(!r);
+        } while (!request);
+
+        r = n_dhcp4_incoming_query_message_type(request, &type);
+        c_assert(!r);
+        c_assert(type == N_DHCP4_MESSAGE_DISCOVER);
+
+        r = n_dhcp4_s_connection_offer_new(&link->connection_server,
+                                           &reply,
+                                           request,
+                                           &link->addr_server,
+                                           &link->addr_client,
+                                           60);
+        c_assert(!r);
+
+        r = n_dhcp4_s_connection_send_reply(&link->connection_server, &link->addr_server, reply);
+        c_assert(!r);
+}
+
+static TestLink *test_find_link(TestLink *links, NDhcp4Client *client) {
+        for (size_t i = 0; i < TEST_N_LINKS; ++i)
+                if (links[i].client == client)
+                        return &links[i];
+
+        c_assert(0);
+        return NULL;
+}
+
+static void test_shared_socket(void) {
+        _c_cleanup_(n_dhcp4_client_shared_socket_unrefp) NDhcp4ClientSharedSocket *shared_socket = NULL;
+        _c_cleanup_(netns_closep) int ns_client = -1;
+        TestLink links[TEST_N_LINKS];
+        NDhcp4ClientEvent *event;
+        NDhcp4Client *client;
+        struct in_addr yiaddr;
+        TestLink *link;
+        size_t i, n_offered = 0;
+        int r, fd, oldns;
+
+        /* setup */
+
+        netns_new(&ns_client);
+
+        for (i = 0; i < TEST_N_LINKS; ++i) {
+                test_link_init(&links[i], i, ns_client);
+                links[i].client = NULL;
+                links[i].probe = NULL;
+                links[i].offered = false;
+        }
+
+        netns_get(&oldns);
+        netns_set(ns_client);
+        r = n_dhcp4_client_shared_socket_new(&shared_socket);
+        c_assert(!r);
+        netns_set(oldns);
+
+        for (i = 0; i < TEST_N_LINKS; ++i)
+                test_link_probe(&links[i], shared_socket, i);
+
+        /* let the probes send their DISCOVER */
+
+        for (i = 0; i < TEST_N_LINKS; ++i) {
+                n_dhcp4_client_get_fd(links[i].client, &fd);
+                test_poll(fd);
+
+                r = n_dhcp4_client_dispatch(links[i].client);
+                c_assert(!r || r == N_DHCP4_E_PREEMPTED);
+        }
+
+        /* reply on each link, in reverse order */
+
+        for (i = TEST_N_LINKS; i-- > 0; )
+                test_link_offer(&links[i]);
+
+        /* all OFFERs arrive on the shared socket and must reach their client */
+
+        n_dhcp4_client_shared_socket_get_fd(shared_socket, &fd);
+
+        while (n_offered < TEST_N_LINKS) {
+                test_poll(fd);
+
+                for (;;) {
+                        r = n_dhcp4_client_shared_socket_dispatch(shared_socket, &client);
+                        if (!r)
+                                break;
+                        c_assert(r == N_DHCP4_E_PREEMPTED);
+
+                        if (!client)
+                                continue;
+
+                        link = test_find_link(links, client);
+
+                        r = n_dhcp4_client_pop_event(client, &event);
+                        c_assert(!r);
+                        c_assert(event);
+                        c_assert(event->event == N_DHCP4_CLIENT_EVENT_OFFER);
+                        c_assert(event->offer.probe == link->probe);
+
+                        n_dhcp4_client_lease_get_yiaddr(event->offer.lease, &yiaddr);
+                        c_assert(yiaddr.s_addr == link->addr_client.s_addr);
+
+                        c_assert(!link->offered);
+                        link->offered = true;
+                        ++n_offered;
+                }
+        }
+
+        /* teardown */
+
+        for (i = 0; i < TEST_N_LINKS; ++i)
+                test_link_deinit(&links[i]);
+}
+
+/*
+ * The test needs user namespaces and the "ip" tool. Probe for them in a
+ * child process, so the test is skipped where they are not available (e.g.,
+ * in containers), instead of failing.
+ */
+static bool test_can_run(void) {
+        int status;
+        pid_t pid;
+
+        pid = fork();
+        c_assert(pid >= 0);
+        if (pid == 0) {
+                if (unshare(CLONE_NEWUSER) < 0)
+                        _exit(1);
+                _exit(system("ip -V >/dev/null 2>&1") == 0 ? 0 : 1);
+        }
+
+        c_assert(waitpid(pid, &status, 0) == pid);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv) {
+        if (!test_can_run())
+                return 77;
+
+        test_setup();
+
+        test_shared_socket();
+
+        return 0;
+}
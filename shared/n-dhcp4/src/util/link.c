@@ -253,6 +253,36 @@ void link_set_master(Link *link, int if_master) {
         netns_set(oldns);
 }
 
+/**
+ * link_set_name() - rename an interface
+ * @link:                       link to operate on
+ * @name:                       new interface name
+ *
+ * This renames @link to @name. The link is set down for the rename and brought
+ * up again afterwards. This allows several links created via link_new_veth() to
+ * live in the same network namespace.
+ */
+void link_set_name(Link *link, const char *name) {
+        int oldns;
+
+        netns_get(&oldns);
+        {
+                char *p, ifname[IF_NAMESIZE + 1] = {};
+                int r;
+
+                netns_set(link->netns);
+
+                p = if_indextoname(link->ifindex, ifname);
+                c_assert(p);
+                r = asprintf(&p, "ip link set %s down && ip link set %s name %s up", ifname, ifname, name);
+                c_assert(r > 0);
+                r = system(p);
+                c_assert(r == 0);
+                free(p);
+        }
+        netns_set(oldns);
+}
+
 /**
  * link_socket() - create socket for link
  * @link:               link to operate on
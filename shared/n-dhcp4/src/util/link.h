@@ -35,4 +35,5 @@ void link_new_bridge(Link *bridgep, int netns);
 void link_add_ip4(Link *link, const struct in_addr *addr, unsigned int prefix);
 void link_del_ip4(Link *link, const struct in_addr *addr, unsigned int prefix);
 void link_set_master(Link *link, int if_master);
+void link_set_name(Link *link, const char *name);
 void link_socket(Link *link, int *socketp, int family, int type);
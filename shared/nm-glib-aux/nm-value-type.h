@@ -12,6 +12,11 @@ typedef enum {
     NM_VALUE_TYPE_INT32  = 3,
     NM_VALUE_TYPE_INT    = 4,
     NM_VALUE_TYPE_STRING = 5,
+    NM_VALUE_TYPE_UINT32 = 6,
+
+    /* a NULL terminated "char **" array, that owns its strings. %NULL and
+     * an empty array are different values. */
+    NM_VALUE_TYPE_STRV = 7,
 } NMValueType;
 
 /*****************************************************************************/
@@ -19,10 +24,12 @@ typedef enum {
 #ifdef NM_VALUE_TYPE_DEFINE_FUNCTIONS
 
 typedef union {
-    bool        v_bool;
-    gint32      v_int32;
-    int         v_int;
-    const char *v_string;
+    bool               v_bool;
+    gint32             v_int32;
+    guint32            v_uint32;
+    int                v_int;
+    const char *       v_string;
+    const char *const *v_strv;
 
     /* for convenience, also let the union contain other pointer types. These are
      * for NM_VALUE_TYPE_UNSPEC. */
@@ -75,11 +82,20 @@ nm_value_type_cmp(NMValueType value_type, gconstpointer p_a, gconstpointer p_b)
     case NM_VALUE_TYPE_INT32:
         NM_CMP_DIRECT(*((const gint32 *) p_a), *((const gint32 *) p_b));
         return 0;
+    case NM_VALUE_TYPE_UINT32:
+        NM_CMP_DIRECT(*((const guint32 *) p_a), *((const guint32 *) p_b));
+        return 0;
     case NM_VALUE_TYPE_INT:
         NM_CMP_DIRECT(*((const int *) p_a), *((const int *) p_b));
         return 0;
     case NM_VALUE_TYPE_STRING:
         return nm_strcmp0(*((const char *const *) p_a), *((const char *const *) p_b));
+    case NM_VALUE_TYPE_STRV:
+        NM_CMP_SELF(*((const char *const *const *) p_a), *((const char *const *const *) p_b));
+        return nm_utils_strv_cmp_n(*((const char *const *const *) p_a),
+                                   -1,
+                                   *((const char *const *const *) p_b),
+                                   -1);
     case NM_VALUE_TYPE_UNSPEC:
         break;
     }
@@ -103,6 +119,9 @@ nm_value_type_copy(NMValueType value_type, gpointer dst, gconstpointer src)
     case NM_VALUE_TYPE_INT32:
         (*((gint32 *) dst) = *((const gint32 *) src));
         return;
+    case NM_VALUE_TYPE_UINT32:
+        (*((guint32 *) dst) = *((const guint32 *) src));
+        return;
     case NM_VALUE_TYPE_INT:
         (*((int *) dst) = *((const int *) src));
         return;
@@ -113,6 +132,12 @@ nm_value_type_copy(NMValueType value_type, gpointer dst, gconstpointer src)
             *((char **) dst) = g_strdup(*((const char *const *) src));
         }
         return;
+    case NM_VALUE_TYPE_STRV:
+        if (*((char ***) dst) != *((char *const *const *) src)) {
+            g_strfreev(*((char ***) dst));
+            *((char ***) dst) = g_strdupv(*((char *const *const *) src));
+        }
+        return;
     case NM_VALUE_TYPE_UNSPEC:
         break;
     }
@@ -132,6 +157,9 @@ nm_value_type_get_from_variant(NMValueType value_type,
     case NM_VALUE_TYPE_INT32:
         *((gint32 *) dst) = g_variant_get_int32(variant);
         return;
+    case NM_VALUE_TYPE_UINT32:
+        *((guint32 *) dst) = g_variant_get_uint32(variant);
+        return;
     case NM_VALUE_TYPE_STRING:
         if (clone) {
             g_free(*((char **) dst));
@@ -141,6 +169,11 @@ nm_value_type_get_from_variant(NMValueType value_type,
             *((const char **) dst) = g_variant_get_string(variant, NULL);
         }
         return;
+    case NM_VALUE_TYPE_STRV:
+        /* the array is always cloned, it does not point into @variant. */
+        g_strfreev(*((char ***) dst));
+        *((char ***) dst) = g_variant_dup_strv(variant, NULL);
+        return;
 
     case NM_VALUE_TYPE_INT:
         /* "int" also does not have a define variant type, because it's not
@@ -156,16 +189,22 @@ nm_value_type_get_from_variant(NMValueType value_type,
 static inline GVariant *
 nm_value_type_to_variant(NMValueType value_type, gconstpointer src)
 {
-    const char *v_string;
+    const char *       v_string;
+    const char *const *v_strv;
 
     switch (value_type) {
     case NM_VALUE_TYPE_BOOL:
         return g_variant_new_boolean(*((const bool *) src));
     case NM_VALUE_TYPE_INT32:
         return g_variant_new_int32(*((const gint32 *) src));
+    case NM_VALUE_TYPE_UINT32:
+        return g_variant_new_uint32(*((const guint32 *) src));
     case NM_VALUE_TYPE_STRING:
         v_string = *((const char *const *) src);
         return v_string ? g_variant_new_string(v_string) : NULL;
+    case NM_VALUE_TYPE_STRV:
+        v_strv = *((const char *const *const *) src);
+        return v_strv ? g_variant_new_strv(v_strv, -1) : NULL;
 
     case NM_VALUE_TYPE_INT:
         /* "int" also does not have a define variant type, because it's not
@@ -187,8 +226,12 @@ nm_value_type_get_variant_type(NMValueType value_type)
         return G_VARIANT_TYPE_BOOLEAN;
     case NM_VALUE_TYPE_INT32:
         return G_VARIANT_TYPE_INT32;
+    case NM_VALUE_TYPE_UINT32:
+        return G_VARIANT_TYPE_UINT32;
     case NM_VALUE_TYPE_STRING:
         return G_VARIANT_TYPE_STRING;
+    case NM_VALUE_TYPE_STRV:
+        return G_VARIANT_TYPE_STRING_ARRAY;
 
     case NM_VALUE_TYPE_INT:
         /* "int" also does not have a define variant type, because it's not
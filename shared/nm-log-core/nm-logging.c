@@ -9,6 +9,8 @@
 #include "nm-logging.h"
 
 #include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
 #include <syslog.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,6 +18,7 @@
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <strings.h>
+#include <time.h>
 
 #if SYSTEMD_JOURNAL
     #define SD_JOURNAL_SUPPRESS_LOCATION
@@ -94,6 +97,8 @@ typedef struct {
     bool        init_pre_done : 1;
     bool        init_done : 1;
     bool        debug_stderr : 1;
+    bool        async : 1;
+    bool        flight_recorder : 1;
     const char *prefix;
     const char *syslog_identifier;
 
@@ -141,6 +146,30 @@ NMLogDomain _nm_logging_enabled_state[_LOGL_N_REAL] = {
     [LOGL_ERR]  = LOGD_DEFAULT,
 };
 
+/* The logging levels and domains as configured by nm_logging_setup(). With the flight
+ * recorder enabled, _nm_logging_enabled_state also has DEBUG and TRACE enabled for
+ * FLIGHT_RECORDER_DOMAINS, but only messages enabled here are passed to the backend. */
+static NMLogDomain _nm_logging_output_state[_LOGL_N_REAL] = {
+    [LOGL_INFO] = LOGD_DEFAULT,
+    [LOGL_WARN] = LOGD_DEFAULT,
+    [LOGL_ERR]  = LOGD_DEFAULT,
+};
+
+#define FLIGHT_RECORDER_DOMAINS (LOGD_ALL & ~LOGD_VPN_PLUGIN)
+
+/* must be called with the log lock held. */
+static void
+_enabled_state_update(void)
+{
+    int i;
+
+    for (i = 0; i < G_N_ELEMENTS(_nm_logging_enabled_state); i++) {
+        _nm_logging_enabled_state[i] = _nm_logging_output_state[i];
+        if (gl.imm.flight_recorder && i <= LOGL_DEBUG)
+            _nm_logging_enabled_state[i] |= FLIGHT_RECORDER_DOMAINS;
+    }
+}
+
 /*****************************************************************************/
 
 static const LogDesc domain_desc[] = {
@@ -273,7 +302,7 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
     g_return_val_if_fail(!error || !*error, FALSE);
 
     cur_log_level = gl.imm.log_level;
-    memcpy(cur_log_state, _nm_logging_enabled_state, sizeof(cur_log_state));
+    memcpy(cur_log_state, _nm_logging_output_state, sizeof(cur_log_state));
 
     new_log_level = cur_log_level;
 
@@ -394,7 +423,8 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
 
     gl.mut.log_level = new_log_level;
     for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
-        _nm_logging_enabled_state[i] = new_log_state[i];
+        _nm_logging_output_state[i] = new_log_state[i];
+    _enabled_state_update();
 
     G_UNLOCK(log);
 
@@ -445,7 +475,7 @@ nm_logging_domains_to_string(void)
 
     if (G_UNLIKELY(!gl_main.logging_domains_to_string)) {
         gl_main.logging_domains_to_string =
-            _domains_to_string(TRUE, gl.imm.log_level, _nm_logging_enabled_state);
+            _domains_to_string(TRUE, gl.imm.log_level, _nm_logging_output_state);
     }
 
     return gl_main.logging_domains_to_string;
@@ -558,11 +588,32 @@ nm_logging_get_level(NMLogDomain domain)
     NMLogLevel sl = _LOGL_OFF;
 
     G_STATIC_ASSERT(LOGL_TRACE == 0);
-    while (sl > LOGL_TRACE && _nm_logging_enabled_lockfree(sl - 1, domain))
+    while (sl > LOGL_TRACE && NM_FLAGS_ANY(_nm_logging_output_state[sl - 1], domain))
         sl--;
     return sl;
 }
 
+/**
+ * nm_logging_output_enabled:
+ * @level: the logging level
+ * @domain: the logging domains
+ *
+ * Contrary to nm_logging_enabled(), this ignores the flight recorder. Use it
+ * to decide about side effects of verbose logging, like enabling debug output
+ * of helper processes.
+ *
+ * Returns: whether messages for @level and @domain are passed to the
+ *   logging backend.
+ */
+gboolean
+nm_logging_output_enabled(NMLogLevel level, NMLogDomain domain)
+{
+    NM_ASSERT_ON_MAIN_THREAD();
+
+    return ((guint) level) < G_N_ELEMENTS(_nm_logging_output_state)
+           && NM_FLAGS_ANY(_nm_logging_output_state[level], domain);
+}
+
 gboolean
 _nm_logging_enabled_locking(NMLogLevel level, NMLogDomain domain)
 {
@@ -643,79 +694,50 @@ _nm_printf(3, 4) static void _iovec_set_format(struct iovec *iov,
 
 #endif
 
-void
-_nm_log_impl(const char *file,
-             guint       line,
-             const char *func,
-             gboolean    mt_require_locking,
-             NMLogLevel  level,
-             NMLogDomain domain,
-             int         error,
-             const char *ifname,
-             const char *conn_uuid,
-             const char *fmt,
-             ...)
-{
-    va_list            args;
-    char *             msg;
-    GTimeVal           tv;
-    int                errsv;
-    const NMLogDomain *cur_log_state;
-    NMLogDomain        cur_log_state_copy[_LOGL_N_REAL];
-    Global             g_copy;
-    const Global *     g;
-
-    if (G_UNLIKELY(mt_require_locking)) {
-        G_LOCK(log);
-        /* we evaluate logging-enabled under lock. There is still a race that
-         * we might log the message below *after* logging was disabled. That means,
-         * when disabling logging, we might still log messages. */
-        if (!_nm_logging_enabled_lockfree(level, domain)) {
-            G_UNLOCK(log);
-            return;
-        }
-        g_copy = gl.imm;
-        memcpy(cur_log_state_copy, _nm_logging_enabled_state, sizeof(cur_log_state_copy));
-        G_UNLOCK(log);
-        g             = &g_copy;
-        cur_log_state = cur_log_state_copy;
-    } else {
-        NM_ASSERT_ON_MAIN_THREAD();
-        if (!_nm_logging_enabled_lockfree(level, domain))
-            return;
-        g             = &gl.imm;
-        cur_log_state = _nm_logging_enabled_state;
-    }
-
-    (void) cur_log_state;
+typedef struct {
+    const char *file;
+    const char *func;
+    const char *ifname;
+    const char *conn_uuid;
+    const char *msg;
+    GTimeVal    tv;
+    gint64      now;
+    guint       line;
+    NMLogLevel  level;
+    NMLogDomain domain;
+    int         error;
+} LogMsg;
 
-    errsv = errno;
+static void
+_log_msg_init_time(const Global *g, LogMsg *m)
+{
+    g_get_current_time(&m->tv);
 
-    /* Make sure that %m maps to the specified error */
-    if (error != 0) {
-        if (error < 0)
-            error = -error;
-        errno = error;
-    }
+    m->now = 0;
+#if SYSTEMD_JOURNAL
+    /* We only log the monotonic-timestamp with structured logging (journal). */
+    if (g->log_backend == LOG_BACKEND_JOURNAL)
+        m->now = nm_utils_get_monotonic_timestamp_nsec();
+#endif
+}
 
-    va_start(args, fmt);
-    msg = g_strdup_vprintf(fmt, args);
-    va_end(args);
+static void
+_log_emit(const Global *g, const LogMsg *m)
+{
+    const NMLogLevel level = m->level;
 
 #define MESSAGE_FMT "%s%-7s [%ld.%04ld] %s"
 #define MESSAGE_ARG(prefix, tv, msg) \
     prefix, level_desc[level].level_str, (tv).tv_sec, ((tv).tv_usec / 100), (msg)
 
-    g_get_current_time(&tv);
-
     if (g->debug_stderr)
-        g_printerr(MESSAGE_FMT "\n", MESSAGE_ARG(g->prefix, tv, msg));
+        g_printerr(MESSAGE_FMT "\n", MESSAGE_ARG(g->prefix, m->tv, m->msg));
 
     switch (g->log_backend) {
 #if SYSTEMD_JOURNAL
     case LOG_BACKEND_JOURNAL:
     {
-        gint64         now, boottime;
+        gint64         boottime;
         struct iovec   iov_data[15];
         struct iovec * iov = iov_data;
         char *         iov_free_data[5];
@@ -726,18 +748,17 @@ _nm_log_impl(const char *file,
         char *s_log_domains;
         gsize l_log_domains;
 
-        now      = nm_utils_get_monotonic_timestamp_nsec();
-        boottime = nm_utils_monotonic_timestamp_as_boottime(now, 1);
+        boottime = nm_utils_monotonic_timestamp_as_boottime(m->now, 1);
 
         _iovec_set_format_a(iov++, 30, "PRIORITY=%d", level_desc[level].syslog_level);
         _iovec_set_format(iov++,
                           iov_free++,
                           "MESSAGE=" MESSAGE_FMT,
-                          MESSAGE_ARG(g->prefix, tv, msg));
+                          MESSAGE_ARG(g->prefix, m->tv, m->msg));
         _iovec_set_string(iov++, syslog_identifier_full(g->syslog_identifier));
         _iovec_set_format_a(iov++, 30, "SYSLOG_PID=%ld", (long) getpid());
 
-        dom_all       = domain;
+        dom_all       = m->domain;
         s_log_domains = s_log_domains_buf;
         l_log_domains = sizeof(s_log_domains_buf);
 
@@ -745,7 +766,7 @@ _nm_log_impl(const char *file,
         for (diter = &domain_desc[0]; dom_all != 0 && diter->name; diter++) {
             if (!NM_FLAGS_ANY(dom_all, diter->num))
                 continue;
-            if (dom_all != domain)
+            if (dom_all != m->domain)
                 nm_utils_strbuf_append_c(&s_log_domains, &l_log_domains, ',');
             nm_utils_strbuf_append_str(&s_log_domains, &l_log_domains, diter->name);
             dom_all &= ~diter->num;
@@ -756,26 +777,26 @@ _nm_log_impl(const char *file,
         G_STATIC_ASSERT_EXPR(LOG_FAC(LOG_DAEMON) == 3);
         _iovec_set_string_literal(iov++, "SYSLOG_FACILITY=3");
         _iovec_set_format_str_a(iov++, 15, "NM_LOG_LEVEL=%s", level_desc[level].name);
-        if (func)
-            _iovec_set_format(iov++, iov_free++, "CODE_FUNC=%s", func);
-        _iovec_set_format(iov++, iov_free++, "CODE_FILE=%s", file ?: "");
-        _iovec_set_format_a(iov++, 20, "CODE_LINE=%u", line);
+        if (m->func)
+            _iovec_set_format(iov++, iov_free++, "CODE_FUNC=%s", m->func);
+        _iovec_set_format(iov++, iov_free++, "CODE_FILE=%s", m->file ?: "");
+        _iovec_set_format_a(iov++, 20, "CODE_LINE=%u", m->line);
         _iovec_set_format_a(iov++,
                             60,
                             "TIMESTAMP_MONOTONIC=%lld.%06lld",
-                            (long long) (now / NM_UTILS_NSEC_PER_SEC),
-                            (long long) ((now % NM_UTILS_NSEC_PER_SEC) / 1000));
+                            (long long) (m->now / NM_UTILS_NSEC_PER_SEC),
+                            (long long) ((m->now % NM_UTILS_NSEC_PER_SEC) / 1000));
         _iovec_set_format_a(iov++,
                             60,
                             "TIMESTAMP_BOOTTIME=%lld.%06lld",
                             (long long) (boottime / NM_UTILS_NSEC_PER_SEC),
                             (long long) ((boottime % NM_UTILS_NSEC_PER_SEC) / 1000));
-        if (error != 0)
-            _iovec_set_format_a(iov++, 30, "ERRNO=%d", error);
-        if (ifname)
-            _iovec_set_format(iov++, iov_free++, "NM_DEVICE=%s", ifname);
-        if (conn_uuid)
-            _iovec_set_format(iov++, iov_free++, "NM_CONNECTION=%s", conn_uuid);
+        if (m->error != 0)
+            _iovec_set_format_a(iov++, 30, "ERRNO=%d", m->error);
+        if (m->ifname)
+            _iovec_set_format(iov++, iov_free++, "NM_DEVICE=%s", m->ifname);
+        if (m->conn_uuid)
+            _iovec_set_format(iov++, iov_free++, "NM_CONNECTION=%s", m->conn_uuid);
 
         nm_assert(iov <= &iov_data[G_N_ELEMENTS(iov_data)]);
         nm_assert(iov_free <= &iov_free_data[G_N_ELEMENTS(iov_free_data)]);
@@ -787,15 +808,1118 @@ _nm_log_impl(const char *file,
     } break;
 #endif
     case LOG_BACKEND_SYSLOG:
-        syslog(level_desc[level].syslog_level, MESSAGE_FMT, MESSAGE_ARG(g->prefix, tv, msg));
+        syslog(level_desc[level].syslog_level,
+               MESSAGE_FMT,
+               MESSAGE_ARG(g->prefix, m->tv, m->msg));
         break;
     default:
         g_log(syslog_identifier_domain(g->syslog_identifier),
               level_desc[level].g_log_level,
               MESSAGE_FMT,
-              MESSAGE_ARG(g->prefix, tv, msg));
+              MESSAGE_ARG(g->prefix, m->tv, m->msg));
         break;
     }
+}
+
+/*****************************************************************************/
+
+/* Asynchronous logging.
+ *
+ * Passing a message to the journal or to syslog is a blocking write to a socket, which
+ * is expensive compared to formatting it. With debug or trace logging enabled, that
+ * slows down the main loop considerably. With asynchronous logging, _nm_log_impl() only
+ * formats the message into a slot of a preallocated ring buffer, and a logging thread
+ * passes the messages on to the backend.
+ *
+ * The ring buffer is a bounded multi-producer, single-consumer queue. Each slot has a
+ * sequence number, which tells whether the slot is free for the producer at a certain
+ * position, or whether it holds a message for the consumer. Producers never block. If
+ * the ring buffer is full, the message is dropped and counted, and the logging thread
+ * reports the number of dropped messages. Producers only take a lock to wake up the
+ * logging thread, if it is idle. */
+
+#define LOG_ASYNC_N_SLOTS   1024u
+#define LOG_ASYNC_SLOT_SIZE 1024u
+
+/* How long a crashing thread waits for the logging thread to write out pending
+ * messages. */
+#define LOG_ASYNC_CRASH_WAIT_MSEC 1000
+
+/* positions wrap around at G_MAXUINT, which must map to the last slot. */
+G_STATIC_ASSERT(((LOG_ASYNC_N_SLOTS - 1) & LOG_ASYNC_N_SLOTS) == 0);
+
+typedef struct {
+    int    seq;
+    LogMsg m;
+
+    /* the message, ifname and conn_uuid are stored in @buf. Only if that is too small,
+     * they are stored in @buf_heap. */
+    char *buf_heap;
+    char  buf[LOG_ASYNC_SLOT_SIZE];
+} LogSlot;
+
+typedef struct {
+    LogSlot * slots;
+    GThread * thread;
+    pthread_t thread_id;
+    GMutex    mutex;
+    GCond     cond_wakeup;
+    GCond     cond_flushed;
+    int       enqueue_pos;
+    int       dequeue_pos;
+    int       n_dropped;
+    int       consumer_idle;
+
+    /* the position up to which messages are written out, and the messages
+     * that were dropped before are reported. Protected by @mutex. */
+    int flushed_pos;
+} GlobalAsync;
+
+static GlobalAsync gl_async;
+
+static void
+_log_async_slot_set_strings(LogSlot *   slot,
+                            const char *ifname,
+                            const char *conn_uuid,
+                            const char *fmt,
+                            va_list     ap)
+{
+    const gsize l_ifname = ifname ? strlen(ifname) + 1 : 0;
+    const gsize l_uuid   = conn_uuid ? strlen(conn_uuid) + 1 : 0;
+    const int   errsv    = errno;
+    char *      buf      = slot->buf;
+    gsize       l_msg;
+    va_list     ap2;
+    int         l;
+
+    va_copy(ap2, ap);
+    l = g_vsnprintf(slot->buf, sizeof(slot->buf), fmt, ap2);
+    va_end(ap2);
+
+    if (l < 0) {
+        slot->buf[0] = '\0';
+        l            = 0;
+    }
+    l_msg = ((gsize) l) + 1;
+
+    if (l_msg + l_ifname + l_uuid > sizeof(slot->buf)) {
+        buf = g_malloc(l_msg + l_ifname + l_uuid);
+        if (l_msg > sizeof(slot->buf)) {
+            errno = errsv;
+            g_vsnprintf(buf, l_msg, fmt, ap);
+        } else
+            memcpy(buf, slot->buf, l_msg);
+        slot->buf_heap = buf;
+    }
+
+    slot->m.msg       = buf;
+    slot->m.ifname    = ifname ? memcpy(&buf[l_msg], ifname, l_ifname) : NULL;
+    slot->m.conn_uuid = conn_uuid ? memcpy(&buf[l_msg + l_ifname], conn_uuid, l_uuid) : NULL;
+}
+
+static void
+_log_async_push(const LogMsg *m, const char *fmt, va_list ap)
+{
+    LogSlot *slot;
+    guint    pos;
+    guint    seq;
+
+    pos = g_atomic_int_get(&gl_async.enqueue_pos);
+    for (;;) {
+        slot = &gl_async.slots[pos % LOG_ASYNC_N_SLOTS];
+        seq  = g_atomic_int_get(&slot->seq);
+        if (seq == pos) {
+            if (g_atomic_int_compare_and_exchange(&gl_async.enqueue_pos,
+                                                  (int) pos,
+                                                  (int) (pos + 1)))
+                break;
+        } else if ((int) (seq - pos) < 0) {
+            /* The slot still holds the message from the previous round. The
+             * ring buffer is full. */
+            g_atomic_int_inc(&gl_async.n_dropped);
+            return;
+        }
+        pos = g_atomic_int_get(&gl_async.enqueue_pos);
+    }
+
+    slot->m = *m;
+    _log_async_slot_set_strings(slot, m->ifname, m->conn_uuid, fmt, ap);
+
+    g_atomic_int_set(&slot->seq, (int) (pos + 1));
+
+    if (g_atomic_int_get(&gl_async.consumer_idle)) {
+        g_mutex_lock(&gl_async.mutex);
+        g_cond_signal(&gl_async.cond_wakeup);
+        g_mutex_unlock(&gl_async.mutex);
+    }
+}
+
+static gboolean
+_log_async_has_pending(void)
+{
+    const guint pos = g_atomic_int_get(&gl_async.dequeue_pos);
+
+    return (guint) g_atomic_int_get(&gl_async.slots[pos % LOG_ASYNC_N_SLOTS].seq) == pos + 1;
+}
+
+static gboolean
+_log_async_pop(const Global *g)
+{
+    const guint pos  = g_atomic_int_get(&gl_async.dequeue_pos);
+    LogSlot *   slot = &gl_async.slots[pos % LOG_ASYNC_N_SLOTS];
+
+    if (!_log_async_has_pending())
+        return FALSE;
+
+    _log_emit(g, &slot->m);
+    nm_clear_g_free(&slot->buf_heap);
+
+    g_atomic_int_set(&slot->seq, (int) (pos + LOG_ASYNC_N_SLOTS));
+    g_atomic_int_set(&gl_async.dequeue_pos, (int) (pos + 1));
+    return TRUE;
+}
+
+static gboolean
+_log_async_pos_reached(int *pos, guint target)
+{
+    return (int) (((guint) g_atomic_int_get(pos)) - target) >= 0;
+}
+
+static void
+_log_async_report_dropped(const Global *g)
+{
+    char   buf[100];
+    LogMsg m;
+    int    n;
+
+    n = g_atomic_int_get(&gl_async.n_dropped);
+    if (n == 0)
+        return;
+    g_atomic_int_add(&gl_async.n_dropped, -n);
+
+    m = (LogMsg){
+        .file   = __FILE__,
+        .func   = G_STRFUNC,
+        .line   = __LINE__,
+        .level  = LOGL_WARN,
+        .domain = LOGD_CORE,
+        .msg    = nm_sprintf_buf(buf, "logging: %d messages dropped", n),
+    };
+    _log_msg_init_time(g, &m);
+    _log_emit(g, &m);
+}
+
+static gpointer
+_log_async_thread(gpointer user_data)
+{
+    Global g_copy;
+
+    gl_async.thread_id = pthread_self();
+
+    for (;;) {
+        G_LOCK(log);
+        g_copy = gl.imm;
+        G_UNLOCK(log);
+
+        while (_log_async_pop(&g_copy))
+            continue;
+
+        _log_async_report_dropped(&g_copy);
+
+        g_mutex_lock(&gl_async.mutex);
+        g_atomic_int_set(&gl_async.flushed_pos, g_atomic_int_get(&gl_async.dequeue_pos));
+        g_cond_broadcast(&gl_async.cond_flushed);
+        g_atomic_int_set(&gl_async.consumer_idle, TRUE);
+        /* A producer that publishes a message after this check sees
+         * @consumer_idle and wakes us up. */
+        if (!_log_async_has_pending())
+            g_cond_wait(&gl_async.cond_wakeup, &gl_async.mutex);
+        g_atomic_int_set(&gl_async.consumer_idle, FALSE);
+        g_mutex_unlock(&gl_async.mutex);
+    }
+
+    return NULL;
+}
+
+static void
+_log_async_crash_handler(int signo)
+{
+    const struct timespec ts = {
+        .tv_nsec = 10 * NM_UTILS_NSEC_PER_MSEC,
+    };
+    const guint target = g_atomic_int_get(&gl_async.enqueue_pos);
+    int         i;
+
+    /* Give the logging thread a chance to write out the messages that are
+     * still queued. Only async-signal-safe operations are allowed here, so
+     * we poll instead of waiting for a condition. */
+    if (!pthread_equal(pthread_self(), gl_async.thread_id)) {
+        for (i = 0; i < LOG_ASYNC_CRASH_WAIT_MSEC / 10; i++) {
+            if (_log_async_pos_reached(&gl_async.dequeue_pos, target))
+                break;
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    /* The handler was reset to the default action (SA_RESETHAND). */
+    raise(signo);
+}
+
+static void
+_log_async_setup_crash_handler(void)
+{
+    static const int signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+    struct sigaction sa        = {
+        .sa_handler = _log_async_crash_handler,
+        .sa_flags   = SA_RESETHAND | SA_NODEFER,
+    };
+    struct sigaction sa_old;
+    int              i;
+
+    sigemptyset(&sa.sa_mask);
+
+    for (i = 0; i < (int) G_N_ELEMENTS(signals); i++) {
+        /* don't interfere with handlers that somebody else installed. */
+        if (sigaction(signals[i], NULL, &sa_old) != 0 || sa_old.sa_handler != SIG_DFL)
+            continue;
+        sigaction(signals[i], &sa, NULL);
+    }
+}
+
+/**
+ * nm_logging_flush:
+ *
+ * Wait until all messages that were logged before the call are passed on
+ * to the logging backend. If messages were dropped because the queue was
+ * full, that is reported before this returns. This is a no-op unless
+ * asynchronous logging is enabled, and when called on the logging thread.
+ * It is registered via atexit() by nm_logging_init_async().
+ */
+void
+nm_logging_flush(void)
+{
+    guint target;
+
+    if (!gl_async.thread)
+        return;
+
+    if (pthread_equal(pthread_self(), gl_async.thread_id))
+        return;
+
+    target = g_atomic_int_get(&gl_async.enqueue_pos);
+
+    g_mutex_lock(&gl_async.mutex);
+    while (!_log_async_pos_reached(&gl_async.flushed_pos, target)) {
+        g_cond_signal(&gl_async.cond_wakeup);
+        g_cond_wait(&gl_async.cond_flushed, &gl_async.mutex);
+    }
+    g_mutex_unlock(&gl_async.mutex);
+}
+
+/*****************************************************************************/
+
+/* Flight recorder.
+ *
+ * Debug and trace messages are usually disabled, so by the time somebody raises the
+ * logging level, the interesting events are long gone. The flight recorder always
+ * records debug and trace messages of all domains (except VPN_PLUGIN, which may
+ * expose secrets) into a fixed-size ring buffer, regardless of the logging level.
+ * The oldest records get overwritten. The recorded messages can be dumped on demand.
+ *
+ * Recording must be cheap, so the message is not formatted. Instead, a record contains
+ * the format string and the raw arguments. The format strings are literals, so we keep
+ * the pointer. String arguments are copied, because they likely don't exist anymore
+ * when the record gets dumped. Only when dumping, the records are formatted.
+ *
+ * Formats that we cannot parse (like positional arguments or wide strings) are
+ * formatted right away. */
+
+#define FLIGHT_RECORDER_SIZE_MIN ((gsize) 4096)
+#define FLIGHT_RECORDER_SIZE_MAX ((gsize) (256 * 1024 * 1024))
+
+/* the maximum size of a single record. Longer string arguments get truncated. */
+#define FLIGHT_RECORDER_RECORD_MAX 2048
+
+typedef struct {
+    guint32     len;
+    guint8      level;
+    bool        preformatted;
+    int         errsv;
+    NMLogDomain domain;
+    gint64      time_usec;
+    const char *fmt;
+} FRHeader;
+
+typedef struct {
+    const char *start;
+    const char *len_start;
+    const char *end;
+    int         prec;
+    char        conv;
+    char        len_mod;
+    bool        width_star : 1;
+    bool        prec_star : 1;
+    bool        has_prec : 1;
+} FRSpec;
+
+typedef struct {
+    guint8 *buf;
+    gsize   size;
+    guint64 head;
+    guint64 tail;
+    guint64 n_overwritten;
+} GlobalRecorder;
+
+G_LOCK_DEFINE_STATIC(recorder);
+
+static GlobalRecorder gl_rec;
+
+/* Parses the conversion specification at @s, which points to a '%'. Returns %FALSE for
+ * specifications that we don't support. */
+static gboolean
+_fr_parse_spec(const char *s, FRSpec *spec)
+{
+    const char *p = &s[1];
+
+    *spec = (FRSpec){
+        .start = s,
+    };
+
+    if (*p == '%') {
+        spec->conv = '%';
+        spec->end  = &p[1];
+        return TRUE;
+    }
+
+    while (*p && strchr("-+ #0'I", *p))
+        p++;
+
+    if (*p == '*') {
+        spec->width_star = TRUE;
+        p++;
+    } else {
+        while (g_ascii_isdigit(*p))
+            p++;
+        if (*p == '$')
+            return FALSE;
+    }
+
+    if (*p == '.') {
+        spec->has_prec = TRUE;
+        p++;
+        if (*p == '*') {
+            spec->prec_star = TRUE;
+            p++;
+        } else {
+            while (g_ascii_isdigit(*p)) {
+                if (spec->prec < 100000)
+                    spec->prec = spec->prec * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+
+    spec->len_start = p;
+    switch (*p) {
+    case 'h':
+        if (p[1] == 'h') {
+            spec->len_mod = 'H';
+            p++;
+        } else
+            spec->len_mod = 'h';
+        p++;
+        break;
+    case 'l':
+        if (p[1] == 'l') {
+            spec->len_mod = 'q';
+            p++;
+        } else
+            spec->len_mod = 'l';
+        p++;
+        break;
+    case 'q':
+    case 'j':
+    case 'z':
+    case 'Z':
+    case 't':
+    case 'L':
+        spec->len_mod = *p;
+        p++;
+        break;
+    }
+
+    spec->conv = *p;
+    if (!spec->conv || !strchr("diouxXcsfFeEgGaApm", spec->conv))
+        return FALSE;
+    if (spec->len_mod == 'L' || (spec->len_mod == 'l' && NM_IN_SET(spec->conv, 'c', 's')))
+        return FALSE;
+
+    spec->end = &p[1];
+    return TRUE;
+}
+
+static gboolean
+_fr_put(guint8 *buf, gsize *len, const void *data, gsize n)
+{
+    if (n > FLIGHT_RECORDER_RECORD_MAX - *len)
+        return FALSE;
+    memcpy(&buf[*len], data, n);
+    *len += n;
+    return TRUE;
+}
+
+static gboolean
+_fr_put_str(guint8 *buf, gsize *len, const char *str, int max_len)
+{
+    gsize n;
+
+    if (*len >= FLIGHT_RECORDER_RECORD_MAX)
+        return FALSE;
+
+    if (!str)
+        str = "(null)";
+    n = (max_len >= 0) ? strnlen(str, max_len) : strlen(str);
+    n = MIN(n, FLIGHT_RECORDER_RECORD_MAX - *len - 1);
+
+    memcpy(&buf[*len], str, n);
+    buf[*len + n] = '\0';
+    *len += n + 1;
+    return TRUE;
+}
+
+static gboolean
+_fr_capture_args(guint8 *buf, gsize *len, const char *fmt, va_list ap)
+{
+    const char *s;
+    FRSpec      spec;
+
+    for (s = strchr(fmt, '%'); s; s = strchr(spec.end, '%')) {
+        union {
+            gint64  i;
+            guint64 u;
+            double  d;
+        } v;
+        int prec = -1;
+
+        if (!_fr_parse_spec(s, &spec))
+            return FALSE;
+
+        if (spec.width_star) {
+            v.i = va_arg(ap, int);
+            if (!_fr_put(buf, len, &v, sizeof(v)))
+                return FALSE;
+        }
+        if (spec.prec_star) {
+            v.i = prec = va_arg(ap, int);
+            if (!_fr_put(buf, len, &v, sizeof(v)))
+                return FALSE;
+        } else if (spec.has_prec)
+            prec = spec.prec;
+
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+            switch (spec.len_mod) {
+            case 'H':
+                v.i = (signed char) va_arg(ap, int);
+                break;
+            case 'h':
+                v.i = (short) va_arg(ap, int);
+                break;
+            case 'l':
+                v.i = va_arg(ap, long);
+                break;
+            case 'q':
+                v.i = va_arg(ap, long long);
+                break;
+            case 'j':
+                v.i = va_arg(ap, intmax_t);
+                break;
+            case 'z':
+            case 'Z':
+                v.i = va_arg(ap, gssize);
+                break;
+            case 't':
+                v.i = va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                v.i = va_arg(ap, int);
+                break;
+            }
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            switch (spec.len_mod) {
+            case 'H':
+                v.u = (unsigned char) va_arg(ap, unsigned);
+                break;
+            case 'h':
+                v.u = (unsigned short) va_arg(ap, unsigned);
+                break;
+            case 'l':
+                v.u = va_arg(ap, unsigned long);
+                break;
+            case 'q':
+                v.u = va_arg(ap, unsigned long long);
+                break;
+            case 'j':
+                v.u = va_arg(ap, uintmax_t);
+                break;
+            case 'z':
+            case 'Z':
+                v.u = va_arg(ap, gsize);
+                break;
+            case 't':
+                v.u = (guint64) va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                v.u = va_arg(ap, unsigned);
+                break;
+            }
+            break;
+        case 'c':
+            v.i = va_arg(ap, int);
+            break;
+        case 'p':
+            v.u = (guintptr) va_arg(ap, void *);
+            break;
+        case 's':
+            if (!_fr_put_str(buf, len, va_arg(ap, const char *), prec))
+                return FALSE;
+            continue;
+        case 'm':
+        case '%':
+            continue;
+        default:
+            v.d = va_arg(ap, double);
+            break;
+        }
+
+        if (!_fr_put(buf, len, &v, sizeof(v)))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+_fr_ring_read(guint64 offset, void *dst, gsize n)
+{
+    const gsize pos = offset % gl_rec.size;
+    const gsize n1  = MIN(n, gl_rec.size - pos);
+
+    memcpy(dst, &gl_rec.buf[pos], n1);
+    memcpy(&((guint8 *) dst)[n1], gl_rec.buf, n - n1);
+}
+
+static void
+_fr_ring_write(guint64 offset, const void *src, gsize n)
+{
+    const gsize pos = offset % gl_rec.size;
+    const gsize n1  = MIN(n, gl_rec.size - pos);
+
+    memcpy(&gl_rec.buf[pos], src, n1);
+    memcpy(gl_rec.buf, &((const guint8 *) src)[n1], n - n1);
+}
+
+static void
+_fr_ring_append(const guint8 *record, gsize len)
+{
+    guint32 len_old;
+
+    while (gl_rec.head + len - gl_rec.tail > gl_rec.size) {
+        _fr_ring_read(gl_rec.tail, &len_old, sizeof(len_old));
+        gl_rec.tail += len_old;
+        gl_rec.n_overwritten++;
+    }
+
+    _fr_ring_write(gl_rec.head, record, len);
+    gl_rec.head += len;
+}
+
+_nm_printf(3, 0) static void _fr_record(NMLogLevel  level,
+                                        NMLogDomain domain,
+                                        const char *fmt,
+                                        va_list     ap)
+{
+    guint8   record[FLIGHT_RECORDER_RECORD_MAX];
+    FRHeader h;
+    gsize    len = sizeof(h);
+    va_list  ap2;
+    int      l;
+
+    h = (FRHeader){
+        .level     = level,
+        .domain    = domain,
+        .errsv     = errno,
+        .time_usec = g_get_real_time(),
+        .fmt       = fmt,
+    };
+
+    va_copy(ap2, ap);
+    if (!_fr_capture_args(record, &len, fmt, ap2)) {
+        h.preformatted = TRUE;
+        errno          = h.errsv;
+        l = g_vsnprintf((char *) &record[sizeof(h)], sizeof(record) - sizeof(h), fmt, ap);
+        len = sizeof(h) + MIN((gsize) MAX(l, 0), sizeof(record) - sizeof(h) - 1) + 1;
+        errno = h.errsv;
+    }
+    va_end(ap2);
+
+    h.len = len;
+    memcpy(record, &h, sizeof(h));
+
+    G_LOCK(recorder);
+    if (gl_rec.buf)
+        _fr_ring_append(record, len);
+    G_UNLOCK(recorder);
+}
+
+static void
+_fr_format(GString *str, const FRHeader *h, const guint8 *args, gsize args_len)
+{
+    const char *s;
+    const char *fmt = h->fmt;
+    FRSpec      spec;
+
+    if (h->preformatted) {
+        g_string_append_len(str, (const char *) args, strnlen((const char *) args, args_len));
+        return;
+    }
+
+    NM_PRAGMA_WARNING_DISABLE("-Wformat-nonliteral")
+
+    for (s = strchr(fmt, '%'); s; s = strchr(fmt, '%')) {
+        char        spec_buf[64];
+        char *      b = spec_buf;
+        const char *p;
+        gint64      v;
+        const char *v_str = NULL;
+
+        g_string_append_len(str, fmt, s - fmt);
+
+        if (!_fr_parse_spec(s, &spec))
+            nm_assert_not_reached();
+        fmt = spec.end;
+
+        if (spec.conv == '%') {
+            g_string_append_c(str, '%');
+            continue;
+        }
+
+        /* rebuild the specification, with the '*' replaced by the recorded values
+         * and a length modifier that matches how we stored the value. */
+        for (p = spec.start; p < spec.len_start && b < &spec_buf[sizeof(spec_buf) - 20]; p++) {
+            if (*p != '*') {
+                *(b++) = *p;
+                continue;
+            }
+            if (args_len < sizeof(v))
+                return;
+            memcpy(&v, args, sizeof(v));
+            args += sizeof(v);
+            args_len -= sizeof(v);
+            b += g_snprintf(b, 12, "%d", (int) v);
+        }
+        if (strchr("diouxX", spec.conv)) {
+            *(b++) = 'l';
+            *(b++) = 'l';
+        }
+        *(b++) = spec.conv;
+        *b     = '\0';
+
+        if (spec.conv == 'm') {
+            errno = h->errsv;
+            g_string_append_printf(str, spec_buf);
+            continue;
+        }
+
+        if (spec.conv == 's') {
+            v_str = (const char *) args;
+            v     = strnlen(v_str, args_len);
+            if (v == args_len)
+                return;
+            args += v + 1;
+            args_len -= v + 1;
+            g_string_append_printf(str, spec_buf, v_str);
+            continue;
+        }
+
+        if (args_len < sizeof(v))
+            return;
+
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+        {
+            gint64 i;
+
+            memcpy(&i, args, sizeof(i));
+            g_string_append_printf(str, spec_buf, (long long) i);
+            break;
+        }
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+        {
+            guint64 u;
+
+            memcpy(&u, args, sizeof(u));
+            g_string_append_printf(str, spec_buf, (unsigned long long) u);
+            break;
+        }
+        case 'c':
+        {
+            gint64 i;
+
+            memcpy(&i, args, sizeof(i));
+            g_string_append_printf(str, spec_buf, (int) i);
+            break;
+        }
+        case 'p':
+        {
+            guint64 u;
+
+            memcpy(&u, args, sizeof(u));
+            g_string_append_printf(str, spec_buf, (void *) (guintptr) u);
+            break;
+        }
+        default:
+        {
+            double d;
+
+            memcpy(&d, args, sizeof(d));
+            g_string_append_printf(str, spec_buf, d);
+            break;
+        }
+        }
+        args += sizeof(v);
+        args_len -= sizeof(v);
+    }
+
+    NM_PRAGMA_WARNING_REENABLE
+
+    g_string_append(str, fmt);
+}
+
+typedef void (*FRForeachFunc)(const FRHeader *h, const char *msg, gpointer user_data);
+
+static void
+_fr_foreach(FRForeachFunc func, gpointer user_data)
+{
+    nm_auto_free_gstring GString *str    = NULL;
+    gs_free guint8 *              buf    = NULL;
+    gsize                         offset = 0;
+    gsize                         len;
+    guint64                       n_overwritten;
+    FRHeader                      h;
+
+    /* copy the ring buffer, so that we don't hold the lock while formatting. */
+    G_LOCK(recorder);
+    len = gl_rec.head - gl_rec.tail;
+    if (len > 0) {
+        buf = g_malloc(len);
+        _fr_ring_read(gl_rec.tail, buf, len);
+    }
+    n_overwritten = gl_rec.n_overwritten;
+    G_UNLOCK(recorder);
+
+    str = g_string_new(NULL);
+
+    if (n_overwritten > 0) {
+        h = (FRHeader){
+            .level     = LOGL_INFO,
+            .domain    = LOGD_CORE,
+            .time_usec = g_get_real_time(),
+        };
+        g_string_printf(str,
+                        "flight recorder: %" G_GUINT64_FORMAT " older messages were overwritten",
+                        n_overwritten);
+        func(&h, str->str, user_data);
+    }
+
+    while (offset < len) {
+        memcpy(&h, &buf[offset], sizeof(h));
+        nm_assert(h.len >= sizeof(h) && h.len <= len - offset);
+
+        g_string_truncate(str, 0);
+        _fr_format(str, &h, &buf[offset + sizeof(h)], h.len - sizeof(h));
+        func(&h, str->str, user_data);
+
+        offset += h.len;
+    }
+}
+
+typedef struct {
+    GString *str;
+    gsize    max_len;
+    guint64  n_dropped;
+} FRDumpData;
+
+static void
+_fr_dump_trim(FRDumpData *data)
+{
+    const char *s = data->str->str;
+    const char *nl;
+    gsize       cut;
+
+    if (data->str->len <= data->max_len)
+        return;
+
+    /* drop the oldest lines, so that at most max_len bytes are left. Each
+     * line ends with a newline. */
+    nl = memchr(&s[data->str->len - data->max_len - 1], '\n', data->max_len + 1);
+    nm_assert(nl);
+    cut = (nl - s) + 1;
+
+    for (nl = s; (nl = memchr(nl, '\n', cut - (nl - s))); nl++)
+        data->n_dropped++;
+
+    g_string_erase(data->str, 0, cut);
+}
+
+static void
+_fr_dump_append(GString *str, const FRHeader *h, const char *msg)
+{
+    g_string_append_printf(str,
+                           "%-7s [%" G_GINT64_FORMAT ".%04d] %s\n",
+                           level_desc[h->level].level_str,
+                           h->time_usec / G_USEC_PER_SEC,
+                           (int) ((h->time_usec % G_USEC_PER_SEC) / 100),
+                           msg);
+}
+
+static void
+_fr_dump_to_string_cb(const FRHeader *h, const char *msg, gpointer user_data)
+{
+    FRDumpData *data = user_data;
+
+    _fr_dump_append(data->str, h, msg);
+
+    /* trim now and then, so that the dump never needs much more memory
+     * than max_len. */
+    if (data->str->len / 2 > data->max_len)
+        _fr_dump_trim(data);
+}
+
+/* room for the line that tells how many messages were left out. */
+#define FR_DUMP_NOTE_MAX 128
+
+/**
+ * nm_logging_flight_recorder_dump:
+ * @max_len: the maximum length of the result. If the recorded messages
+ *   don't fit, the oldest lines are left out.
+ *
+ * Returns: (transfer full): the recorded messages, one per line, or %NULL
+ *   if the flight recorder is disabled.
+ */
+char *
+nm_logging_flight_recorder_dump(gsize max_len)
+{
+    FRDumpData data = {
+        .max_len = max_len,
+    };
+
+    if (!gl.imm.flight_recorder)
+        return NULL;
+
+    data.str = g_string_new(NULL);
+    _fr_foreach(_fr_dump_to_string_cb, &data);
+    _fr_dump_trim(&data);
+
+    if (data.n_dropped > 0 && data.max_len > FR_DUMP_NOTE_MAX) {
+        nm_auto_free_gstring GString *note = g_string_new(NULL);
+        gs_free char *                msg  = NULL;
+        const FRHeader                h    = {
+            .level     = LOGL_INFO,
+            .domain    = LOGD_CORE,
+            .time_usec = g_get_real_time(),
+        };
+
+        data.max_len -= FR_DUMP_NOTE_MAX;
+        _fr_dump_trim(&data);
+
+        msg = g_strdup_printf("flight recorder: %" G_GUINT64_FORMAT
+                              " older lines were left out of the dump",
+                              data.n_dropped);
+        _fr_dump_append(note, &h, msg);
+        nm_assert(note->len <= FR_DUMP_NOTE_MAX);
+        g_string_prepend(data.str, note->str);
+    }
+
+    return g_string_free(data.str, FALSE);
+}
+
+static void
+_fr_dump_to_log_cb(const FRHeader *h, const char *msg, gpointer user_data)
+{
+    const Global *g        = user_data;
+    gs_free char *msg_full = g_strdup_printf("flight-recorder: %s", msg);
+    LogMsg        m;
+
+    m = (LogMsg){
+        .level  = h->level,
+        .domain = h->domain,
+        .msg    = msg_full,
+    };
+    _log_msg_init_time(g, &m);
+    m.tv.tv_sec  = h->time_usec / G_USEC_PER_SEC;
+    m.tv.tv_usec = h->time_usec % G_USEC_PER_SEC;
+    _log_emit(g, &m);
+}
+
+/**
+ * nm_logging_flight_recorder_log:
+ *
+ * Writes the recorded messages to the logging backend, regardless of
+ * the logging level. This must be called on the main thread.
+ */
+void
+nm_logging_flight_recorder_log(void)
+{
+    NM_ASSERT_ON_MAIN_THREAD();
+
+    if (!gl.imm.flight_recorder)
+        return;
+
+    /* keep the order with messages that are still queued for the logging thread. */
+    nm_logging_flush();
+
+    _fr_foreach(_fr_dump_to_log_cb, (gpointer) &gl.imm);
+}
+
+/**
+ * nm_logging_flight_recorder_setup:
+ * @size: the size of the ring buffer in bytes, or zero to disable
+ *   the flight recorder.
+ *
+ * Enables or disables the flight recorder. Changing the size drops
+ * the recorded messages. This must be called on the main thread.
+ */
+void
+nm_logging_flight_recorder_setup(gsize size)
+{
+    gs_free guint8 *buf_old = NULL;
+    guint8 *        buf     = NULL;
+
+    NM_ASSERT_ON_MAIN_THREAD();
+
+    if (size > 0) {
+        size = CLAMP(size, FLIGHT_RECORDER_SIZE_MIN, FLIGHT_RECORDER_SIZE_MAX);
+        buf  = g_malloc(size);
+    }
+
+    G_LOCK(recorder);
+    buf_old = gl_rec.buf;
+    gl_rec  = (GlobalRecorder){
+        .buf  = buf,
+        .size = size,
+    };
+    G_UNLOCK(recorder);
+
+    G_LOCK(log);
+    gl.mut.flight_recorder = (size > 0);
+    _enabled_state_update();
+    G_UNLOCK(log);
+}
+
+/*****************************************************************************/
+
+void
+_nm_log_impl(const char *file,
+             guint       line,
+             const char *func,
+             gboolean    mt_require_locking,
+             NMLogLevel  level,
+             NMLogDomain domain,
+             int         error,
+             const char *ifname,
+             const char *conn_uuid,
+             const char *fmt,
+             ...)
+{
+    va_list            args;
+    char *             msg;
+    LogMsg             m;
+    int                errsv;
+    const NMLogDomain *cur_log_state;
+    NMLogDomain        cur_log_state_copy[_LOGL_N_REAL];
+    Global             g_copy;
+    const Global *     g;
+
+    if (G_UNLIKELY(mt_require_locking)) {
+        G_LOCK(log);
+        /* we evaluate logging-enabled under lock. There is still a race that
+         * we might log the message below *after* logging was disabled. That means,
+         * when disabling logging, we might still log messages. */
+        if (!_nm_logging_enabled_lockfree(level, domain)) {
+            G_UNLOCK(log);
+            return;
+        }
+        g_copy = gl.imm;
+        memcpy(cur_log_state_copy, _nm_logging_output_state, sizeof(cur_log_state_copy));
+        G_UNLOCK(log);
+        g             = &g_copy;
+        cur_log_state = cur_log_state_copy;
+    } else {
+        NM_ASSERT_ON_MAIN_THREAD();
+        if (!_nm_logging_enabled_lockfree(level, domain))
+            return;
+        g             = &gl.imm;
+        cur_log_state = _nm_logging_output_state;
+    }
+
+    errsv = errno;
+
+    /* Make sure that %m maps to the specified error */
+    if (error != 0) {
+        if (error < 0)
+            error = -error;
+        errno = error;
+    }
+
+    if (g->flight_recorder && level <= LOGL_DEBUG
+        && NM_FLAGS_ANY(domain, FLIGHT_RECORDER_DOMAINS)) {
+        va_start(args, fmt);
+        _fr_record(level, domain, fmt, args);
+        va_end(args);
+    }
+
+    if (!NM_FLAGS_ANY(cur_log_state[level], domain)) {
+        /* only enabled for the flight recorder. */
+        errno = errsv;
+        return;
+    }
+
+    m = (LogMsg){
+        .file      = file,
+        .func      = func,
+        .ifname    = ifname,
+        .conn_uuid = conn_uuid,
+        .line      = line,
+        .level     = level,
+        .domain    = domain,
+        .error     = error,
+    };
+    _log_msg_init_time(g, &m);
+
+    if (g->async) {
+        va_start(args, fmt);
+        _log_async_push(&m, fmt, args);
+        va_end(args);
+        errno = errsv;
+        return;
+    }
+
+    va_start(args, fmt);
+    msg = g_strdup_vprintf(fmt, args);
+    va_end(args);
+
+    m.msg = msg;
+    _log_emit(g, &m);
 
     g_free(msg);
 
@@ -860,6 +1984,10 @@ nm_log_handler(const char *log_domain, GLogLevelFlags level, const char *message
      * once during nm_logging_init() and the global data is not modified afterwards. */
     nm_assert(gl.imm.init_done);
 
+    /* keep the order with messages that are still queued for the logging thread. This
+     * also makes sure they are written before a fatal message aborts the process. */
+    nm_logging_flush();
+
     if (gl.imm.debug_stderr)
         g_printerr("%s%s\n", gl.imm.prefix, message ?: "");
 
@@ -1033,3 +2161,39 @@ nm_logging_init(const char *logging_backend, gboolean debug)
         );
     }
 }
+
+/**
+ * nm_logging_init_async:
+ *
+ * Start a logging thread and from now on, only queue messages for it
+ * instead of passing them to the logging backend directly. This may be
+ * called once on the main thread, usually after nm_logging_init(). Without
+ * nm_logging_init(), as in the unit tests, the logging thread passes the
+ * messages on with g_log(). Pending messages are flushed at exit and, on a
+ * best effort basis, when the process crashes.
+ */
+void
+nm_logging_init_async(void)
+{
+    guint i;
+
+    NM_ASSERT_ON_MAIN_THREAD();
+
+    if (gl.imm.async)
+        g_return_if_reached();
+
+    gl_async.slots = g_new0(LogSlot, LOG_ASYNC_N_SLOTS);
+    for (i = 0; i < LOG_ASYNC_N_SLOTS; i++)
+        gl_async.slots[i].seq = i;
+
+    gl_async.thread = g_thread_new("nm-logging", _log_async_thread, NULL);
+
+    G_LOCK(log);
+    gl.mut.async = TRUE;
+    G_UNLOCK(log);
+
+    atexit(nm_logging_flush);
+    _log_async_setup_crash_handler();
+
+    nm_log_dbg(LOGD_CORE, "logging: messages are passed to the logging backend asynchronously");
+}
@@ -143,6 +143,8 @@ nm_logging_enabled_mt(gboolean mt_require_locking, NMLogLevel level, NMLogDomain
 
 NMLogLevel nm_logging_get_level(NMLogDomain domain);
 
+gboolean nm_logging_output_enabled(NMLogLevel level, NMLogDomain domain);
+
 const char *nm_logging_all_levels_to_string(void);
 const char *nm_logging_all_domains_to_string(void);
 
@@ -153,6 +155,14 @@ void nm_logging_init_pre(const char *syslog_identifier, char *prefix_take);
 
 void nm_logging_init(const char *logging_backend, gboolean debug);
 
+void nm_logging_init_async(void);
+
+void nm_logging_flush(void);
+
+void  nm_logging_flight_recorder_setup(gsize size);
+char *nm_logging_flight_recorder_dump(gsize max_len);
+void  nm_logging_flight_recorder_log(void);
+
 gboolean nm_logging_syslog_enabled(void);
 
 /*****************************************************************************/
@@ -820,7 +820,7 @@ nm_utils_match_connection(NMConnection *const *  connections,
                                                   default_v6_metric);
             }
 
-            if (!best_match && nm_logging_enabled(LOGL_DEBUG, LOGD_CORE)) {
+            if (!best_match && nm_logging_output_enabled(LOGL_DEBUG, LOGD_CORE)) {
                 GString *      diff_string;
                 GHashTableIter s_iter, p_iter;
                 gpointer       setting_name, setting;
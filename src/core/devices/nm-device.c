@@ -4583,6 +4583,7 @@ concheck_start(NMDevice *                   self,
                                                    nm_device_get_platform(self),
                                                    nm_device_get_ip_ifindex(self),
                                                    nm_device_get_ip_iface(self),
+                                                   is_periodic,
                                                    concheck_cb,
                                                    handle);
     return handle;
@@ -9422,6 +9423,7 @@ dhcp4_start(NMDevice *self)
                                   nm_netns_get_multi_idx(nm_device_get_netns(self)),
                                   nm_device_get_ip_iface(self),
                                   nm_device_get_ip_ifindex(self),
+                                  nm_setting_connection_get_autoconnect_priority(s_con),
                                   hwaddr,
                                   bcast_hwaddr,
                                   nm_connection_get_uuid(connection),
@@ -10855,10 +10857,12 @@ addrconf6_start(NMDevice *self, NMSettingIP6ConfigPrivacy use_tempaddr)
     const char *        stable_id;
     NMNDiscNodeType     node_type;
     int                 max_addresses;
+    guint               max_routes;
     int                 router_solicitations;
     int                 router_solicitation_interval;
     guint32             ra_timeout;
     guint32             default_ra_timeout;
+    gs_free char *      value = NULL;
 
     connection = nm_device_get_applied_connection(self);
     g_assert(connection);
@@ -10893,6 +10897,12 @@ addrconf6_start(NMDevice *self, NMSettingIP6ConfigPrivacy use_tempaddr)
             ra_timeout = default_ra_timeout;
     }
 
+    value      = nm_config_data_get_device_config(NM_CONFIG_GET_DATA,
+                                                  NM_CONFIG_KEYFILE_KEY_DEVICE_NDISC_MAX_ROUTES,
+                                                  self,
+                                                  NULL);
+    max_routes = _nm_utils_ascii_str_to_int64(value, 10, 0, G_MAXUINT32, 0);
+
     stable_id   = _prop_get_connection_stable_id(self, connection, &stable_type);
     priv->ndisc = nm_lndp_ndisc_new(nm_device_get_platform(self),
                                     nm_device_get_ip_ifindex(self),
@@ -10902,6 +10912,7 @@ addrconf6_start(NMDevice *self, NMSettingIP6ConfigPrivacy use_tempaddr)
                                     nm_setting_ip6_config_get_addr_gen_mode(s_ip6),
                                     node_type,
                                     max_addresses,
+                                    max_routes,
                                     router_solicitations,
                                     router_solicitation_interval,
                                     ra_timeout,
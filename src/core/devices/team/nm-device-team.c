@@ -687,7 +687,7 @@ teamd_start(NMDeviceTeam *self)
         g_ptr_array_add(argv, (gpointer) config);
     }
 
-    if (nm_logging_enabled(LOGL_DEBUG, LOGD_TEAM))
+    if (nm_logging_output_enabled(LOGL_DEBUG, LOGD_TEAM))
         g_ptr_array_add(argv, (gpointer) "-gg");
     g_ptr_array_add(argv, NULL);
 
@@ -104,7 +104,7 @@ peer_list_dump(gpointer user_data)
 
     priv->peer_dump_id = 0;
 
-    if (_LOGD_ENABLED(LOGD_WIFI_SCAN)) {
+    if (nm_logging_output_enabled(LOGL_DEBUG, LOGD_WIFI_SCAN)) {
         NMWifiP2PPeer *peer;
         gint32         now_s = nm_utils_get_monotonic_timestamp_sec();
 
@@ -120,7 +120,8 @@ schedule_peer_list_dump(NMDeviceWifiP2P *self)
 {
     NMDeviceWifiP2PPrivate *priv = NM_DEVICE_WIFI_P2P_GET_PRIVATE(self);
 
-    if (!priv->peer_dump_id && _LOGD_ENABLED(LOGD_WIFI_SCAN))
+    /* like the AP list of NMDeviceWifi, not for the flight recorder. */
+    if (!priv->peer_dump_id && nm_logging_output_enabled(LOGL_DEBUG, LOGD_WIFI_SCAN))
         priv->peer_dump_id = g_timeout_add_seconds(1, peer_list_dump, self);
 }
 
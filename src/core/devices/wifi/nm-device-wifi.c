@@ -1877,7 +1877,7 @@ ap_list_dump(gpointer user_data)
 
     priv->ap_dump_id = 0;
 
-    if (_LOGD_ENABLED(LOGD_WIFI_SCAN)) {
+    if (nm_logging_output_enabled(LOGL_DEBUG, LOGD_WIFI_SCAN)) {
         NMWifiAP *ap;
         gint64    now_msec = nm_utils_get_monotonic_timestamp_msec();
         char      str_buf[100];
@@ -1903,7 +1903,9 @@ schedule_ap_list_dump(NMDeviceWifi *self)
 {
     NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
 
-    if (!priv->ap_dump_id && _LOGD_ENABLED(LOGD_WIFI_SCAN))
+    /* the periodic dump of all APs is not worth recording in the flight
+     * recorder. */
+    if (!priv->ap_dump_id && nm_logging_output_enabled(LOGL_DEBUG, LOGD_WIFI_SCAN))
         priv->ap_dump_id = g_timeout_add_seconds(1, ap_list_dump, self);
 }
 
@@ -31,6 +31,10 @@ enum { SIGNAL_STATE_CHANGED, SIGNAL_PREFIX_DELEGATED, LAST_SIGNAL };
 
 static guint signals[LAST_SIGNAL] = {0};
 
+/* Clients with a running helper process, indexed by the PID of the helper.
+ * Events from the helper are resolved to their client by PID. */
+static GHashTable *_pid_idx;
+
 NM_GOBJECT_PROPERTIES_DEFINE(NMDhcpClient,
                              PROP_ADDR_FAMILY,
                              PROP_FLAGS,
@@ -92,6 +96,35 @@ nm_dhcp_client_get_pid(NMDhcpClient *self)
     return NM_DHCP_CLIENT_GET_PRIVATE(self)->pid;
 }
 
+NMDhcpClient *
+nm_dhcp_client_lookup_by_pid(pid_t pid)
+{
+    if (pid <= 0 || !_pid_idx)
+        return NULL;
+
+    return g_hash_table_lookup(_pid_idx, GINT_TO_POINTER(pid));
+}
+
+static void
+_set_pid(NMDhcpClient *self, pid_t pid)
+{
+    NMDhcpClientPrivate *priv = NM_DHCP_CLIENT_GET_PRIVATE(self);
+
+    if (priv->pid == pid)
+        return;
+
+    if (priv->pid > 0 && nm_dhcp_client_lookup_by_pid(priv->pid) == self)
+        g_hash_table_remove(_pid_idx, GINT_TO_POINTER(priv->pid));
+
+    priv->pid = pid;
+
+    if (pid > 0) {
+        if (!_pid_idx)
+            _pid_idx = g_hash_table_new(nm_direct_hash, NULL);
+        g_hash_table_insert(_pid_idx, GINT_TO_POINTER(pid), self);
+    }
+}
+
 NMDedupMultiIndex *
 nm_dhcp_client_get_multi_idx(NMDhcpClient *self)
 {
@@ -429,7 +462,7 @@ stop(NMDhcpClient *self, gboolean release)
         watch_cleanup(self);
         nm_dhcp_client_stop_pid(priv->pid, priv->iface);
     }
-    priv->pid = -1;
+    _set_pid(self, -1);
 }
 
 void
@@ -462,7 +495,7 @@ nm_dhcp_client_set_state(NMDhcpClient *self,
         && !NM_IN_SET(new_state, NM_DHCP_STATE_BOUND, NM_DHCP_STATE_EXTENDED))
         return;
 
-    if (_LOGD_ENABLED()) {
+    if (nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN)) {
         gs_free const char **keys = NULL;
         guint                i, nkeys;
 
@@ -529,7 +562,7 @@ daemon_watch_cb(GPid pid, int status, gpointer user_data)
     else
         _LOGW("client died abnormally");
 
-    priv->pid = -1;
+    _set_pid(self, -1);
 
     nm_dhcp_client_set_state(self, NM_DHCP_STATE_TERMINATED, NULL, NULL);
 }
@@ -555,7 +588,7 @@ nm_dhcp_client_watch_child(NMDhcpClient *self, pid_t pid)
     NMDhcpClientPrivate *priv = NM_DHCP_CLIENT_GET_PRIVATE(self);
 
     g_return_if_fail(priv->pid == -1);
-    priv->pid = pid;
+    _set_pid(self, pid);
 
     nm_dhcp_client_start_timeout(self);
 
@@ -569,7 +602,7 @@ nm_dhcp_client_stop_watch_child(NMDhcpClient *self, pid_t pid)
     NMDhcpClientPrivate *priv = NM_DHCP_CLIENT_GET_PRIVATE(self);
 
     g_return_if_fail(priv->pid == pid);
-    priv->pid = -1;
+    _set_pid(self, -1);
 
     watch_cleanup(self);
     timeout_cleanup(self);
@@ -1169,6 +1202,9 @@ dispose(GObject *object)
     watch_cleanup(self);
     timeout_cleanup(self);
 
+    /* The helper may keep running, but we no longer handle its events. */
+    _set_pid(self, -1);
+
     nm_clear_g_free(&priv->iface);
     nm_clear_g_free(&priv->hostname);
     nm_clear_g_free(&priv->uuid);
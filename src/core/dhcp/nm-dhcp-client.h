@@ -112,6 +112,8 @@ struct _NMDedupMultiIndex *nm_dhcp_client_get_multi_idx(NMDhcpClient *self);
 
 pid_t nm_dhcp_client_get_pid(NMDhcpClient *self);
 
+NMDhcpClient *nm_dhcp_client_lookup_by_pid(pid_t pid);
+
 int nm_dhcp_client_get_addr_family(NMDhcpClient *self);
 
 const char *nm_dhcp_client_get_iface(NMDhcpClient *self);
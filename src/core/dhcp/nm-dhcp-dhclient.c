@@ -684,11 +684,9 @@ nm_dhcp_dhclient_init(NMDhcpDhclient *self)
         }
     }
 
+    /* Events are resolved to the client by the PID of the helper, see
+     * nm_dhcp_client_lookup_by_pid(). We only keep the listener alive. */
     priv->dhcp_listener = g_object_ref(nm_dhcp_listener_get());
-    g_signal_connect(priv->dhcp_listener,
-                     NM_DHCP_LISTENER_EVENT,
-                     G_CALLBACK(nm_dhcp_client_handle_event),
-                     self);
 }
 
 static void
@@ -696,12 +694,7 @@ dispose(GObject *object)
 {
     NMDhcpDhclientPrivate *priv = NM_DHCP_DHCLIENT_GET_PRIVATE(object);
 
-    if (priv->dhcp_listener) {
-        g_signal_handlers_disconnect_by_func(priv->dhcp_listener,
-                                             G_CALLBACK(nm_dhcp_client_handle_event),
-                                             NM_DHCP_DHCLIENT(object));
-        g_clear_object(&priv->dhcp_listener);
-    }
+    g_clear_object(&priv->dhcp_listener);
 
     nm_clear_g_free(&priv->pid_file);
     nm_clear_g_free(&priv->conf_file);
@@ -199,10 +199,6 @@ nm_dhcp_dhcpcanon_init(NMDhcpDhcpcanon *self)
     NMDhcpDhcpcanonPrivate *priv = NM_DHCP_DHCPCANON_GET_PRIVATE(self);
 
     priv->dhcp_listener = g_object_ref(nm_dhcp_listener_get());
-    g_signal_connect(priv->dhcp_listener,
-                     NM_DHCP_LISTENER_EVENT,
-                     G_CALLBACK(nm_dhcp_client_handle_event),
-                     self);
 }
 
 static void
@@ -210,12 +206,7 @@ dispose(GObject *object)
 {
     NMDhcpDhcpcanonPrivate *priv = NM_DHCP_DHCPCANON_GET_PRIVATE(object);
 
-    if (priv->dhcp_listener) {
-        g_signal_handlers_disconnect_by_func(priv->dhcp_listener,
-                                             G_CALLBACK(nm_dhcp_client_handle_event),
-                                             NM_DHCP_DHCPCANON(object));
-        g_clear_object(&priv->dhcp_listener);
-    }
+    g_clear_object(&priv->dhcp_listener);
 
     nm_clear_g_free(&priv->pid_file);
 
@@ -200,10 +200,6 @@ nm_dhcp_dhcpcd_init(NMDhcpDhcpcd *self)
     NMDhcpDhcpcdPrivate *priv = NM_DHCP_DHCPCD_GET_PRIVATE(self);
 
     priv->dhcp_listener = g_object_ref(nm_dhcp_listener_get());
-    g_signal_connect(priv->dhcp_listener,
-                     NM_DHCP_LISTENER_EVENT,
-                     G_CALLBACK(nm_dhcp_client_handle_event),
-                     self);
 }
 
 static void
@@ -211,12 +207,7 @@ dispose(GObject *object)
 {
     NMDhcpDhcpcdPrivate *priv = NM_DHCP_DHCPCD_GET_PRIVATE(object);
 
-    if (priv->dhcp_listener) {
-        g_signal_handlers_disconnect_by_func(priv->dhcp_listener,
-                                             G_CALLBACK(nm_dhcp_client_handle_event),
-                                             NM_DHCP_DHCPCD(object));
-        g_clear_object(&priv->dhcp_listener);
-    }
+    g_clear_object(&priv->dhcp_listener);
 
     G_OBJECT_CLASS(nm_dhcp_dhcpcd_parent_class)->dispose(object);
 }
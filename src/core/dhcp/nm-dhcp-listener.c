@@ -133,6 +133,7 @@ _method_call_handle(NMDhcpListener *self, GVariant *parameters)
     gs_free char *   pid_str           = NULL;
     gs_free char *   reason            = NULL;
     gs_unref_variant GVariant *options = NULL;
+    NMDhcpClient *             client;
     int                        pid;
     gboolean                   handled = FALSE;
 
@@ -157,7 +158,11 @@ _method_call_handle(NMDhcpListener *self, GVariant *parameters)
         return;
     }
 
-    g_signal_emit(self, signals[EVENT], 0, iface, pid, options, reason, &handled);
+    client = nm_dhcp_client_lookup_by_pid(pid);
+    if (client)
+        handled = nm_dhcp_client_handle_event(NULL, iface, pid, options, reason, client);
+    if (!handled)
+        g_signal_emit(self, signals[EVENT], 0, iface, pid, options, reason, &handled);
     if (!handled) {
         if (g_ascii_strcasecmp(reason, "RELEASE") == 0) {
             /* Ignore event when the dhcp client gets killed and we receive its last message */
@@ -20,14 +20,33 @@
 #include "systemd/nm-sd-utils-shared.h"
 
 #include "nm-config.h"
+#include "nm-dhcp-utils.h"
 #include "NetworkManagerUtils.h"
 
 /*****************************************************************************/
 
+/* A DHCPv4 client whose start is deferred by the start queue. */
+typedef struct {
+    NMDhcpStartQueueEntry queue_entry;
+    NMDhcpClient *        client;
+    GBytes *              client_id;
+    char *                dhcp_anycast_addr;
+    char *                last_ip4_address;
+} StartData;
+
 typedef struct {
     const NMDhcpClientFactory *client_factory;
     char *                     default_hostname;
     CList                      dhcp_client_lst_head;
+
+    /* Clients indexed by ifindex, one table per address family. */
+    GHashTable *client_idx[2];
+
+    /* Starting DHCPv4 clients is rate limited and jittered. */
+    NMDhcpStartQueue start_queue;
+    GHashTable *     start_idx;
+    GSource *        start_source;
+    guint            start_queue_peak;
 } NMDhcpManagerPrivate;
 
 struct _NMDhcpManager {
@@ -150,28 +169,173 @@ static NMDhcpClient *
 get_client_for_ifindex(NMDhcpManager *manager, int addr_family, int ifindex)
 {
     NMDhcpManagerPrivate *priv;
-    NMDhcpClient *        client;
 
     g_return_val_if_fail(NM_IS_DHCP_MANAGER(manager), NULL);
     g_return_val_if_fail(ifindex > 0, NULL);
 
     priv = NM_DHCP_MANAGER_GET_PRIVATE(manager);
 
-    c_list_for_each_entry (client, &priv->dhcp_client_lst_head, dhcp_client_lst) {
-        if (nm_dhcp_client_get_ifindex(client) == ifindex
-            && nm_dhcp_client_get_addr_family(client) == addr_family)
-            return client;
+    return g_hash_table_lookup(priv->client_idx[NM_IS_IPv4(addr_family)], GINT_TO_POINTER(ifindex));
+}
+
+static void
+_start_data_free(StartData *start_data)
+{
+    nm_clear_pointer(&start_data->client_id, g_bytes_unref);
+    g_free(start_data->dhcp_anycast_addr);
+    g_free(start_data->last_ip4_address);
+    nm_g_slice_free(start_data);
+}
+
+static void
+_start_queue_unlink(NMDhcpManager *self, StartData *start_data)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+
+    g_hash_table_remove(priv->start_idx, start_data->client);
+    if (c_list_is_linked(&start_data->queue_entry.queue_lst))
+        nm_dhcp_start_queue_remove(&priv->start_queue, &start_data->queue_entry);
+
+    if (priv->start_queue.len == 0) {
+        if (priv->start_queue_peak > 1) {
+            nm_log_info(LOGD_DHCP4,
+                        "dhcp4: start queue drained (up to %u clients were waiting)",
+                        priv->start_queue_peak);
+        }
+        priv->start_queue_peak = 0;
+        nm_clear_g_source_inst(&priv->start_source);
     }
+}
 
-    return NULL;
+static gboolean _start_queue_timeout_cb(gpointer user_data);
+
+static void
+_start_queue_schedule(NMDhcpManager *self, gint64 now_msec)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    gint64                timeout_msec;
+
+    nm_clear_g_source_inst(&priv->start_source);
+
+    timeout_msec = nm_dhcp_start_queue_get_timeout_msec(&priv->start_queue, now_msec);
+    if (timeout_msec < 0)
+        return;
+
+    priv->start_source = nm_g_timeout_source_new(NM_MIN(timeout_msec, (gint64) G_MAXUINT),
+                                                 G_PRIORITY_DEFAULT,
+                                                 _start_queue_timeout_cb,
+                                                 self,
+                                                 NULL);
+    g_source_attach(priv->start_source, NULL);
+}
+
+static void
+_start_queue_start_one(NMDhcpManager *self, StartData *start_data)
+{
+    NMDhcpManagerPrivate *priv           = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    gs_unref_object NMDhcpClient *client = g_object_ref(start_data->client);
+    gs_free_error GError *error          = NULL;
+
+    _start_queue_unlink(self, start_data);
+
+    nm_log_dbg(LOGD_DHCP4,
+               "dhcp4 (%s): starting queued client (priority %d, %u still waiting)",
+               nm_dhcp_client_get_iface(client),
+               start_data->queue_entry.priority,
+               priv->start_queue.len);
+
+    if (!nm_dhcp_client_start_ip4(client,
+                                  start_data->client_id,
+                                  start_data->dhcp_anycast_addr,
+                                  start_data->last_ip4_address,
+                                  &error)) {
+        nm_log_warn(LOGD_DHCP4,
+                    "dhcp4 (%s): failure to start DHCP: %s",
+                    nm_dhcp_client_get_iface(client),
+                    error->message);
+        nm_dhcp_client_set_state(client, NM_DHCP_STATE_FAIL, NULL, NULL);
+    }
+
+    _start_data_free(start_data);
+}
+
+static gboolean
+_start_queue_timeout_cb(gpointer user_data)
+{
+    NMDhcpManager *        self = user_data;
+    NMDhcpManagerPrivate * priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    NMDhcpStartQueueEntry *entry;
+    gint64                 now_msec;
+
+    nm_clear_g_source_inst(&priv->start_source);
+
+    now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    /* Start all clients whose delay passed, as long as there are tokens.
+     * Each client has its own delay, so this does not serialize the starts. */
+    while ((entry = nm_dhcp_start_queue_pop(&priv->start_queue, now_msec)))
+        _start_queue_start_one(self, c_list_entry(entry, StartData, queue_entry));
+
+    _start_queue_schedule(self, now_msec);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_start_queue_add(NMDhcpManager *self,
+                 NMDhcpClient * client,
+                 int            priority,
+                 GBytes *       client_id,
+                 const char *   dhcp_anycast_addr,
+                 const char *   last_ip4_address,
+                 gint64         now_msec)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    StartData *           start_data;
+
+    start_data  = g_slice_new(StartData);
+    *start_data = (StartData){
+        .client            = client,
+        .client_id         = client_id ? g_bytes_ref(client_id) : NULL,
+        .dhcp_anycast_addr = g_strdup(dhcp_anycast_addr),
+        .last_ip4_address  = g_strdup(last_ip4_address),
+    };
+
+    nm_dhcp_start_queue_add(&priv->start_queue, &start_data->queue_entry, priority, now_msec);
+
+    g_hash_table_insert(priv->start_idx, client, start_data);
+    priv->start_queue_peak = NM_MAX(priv->start_queue_peak, priv->start_queue.len);
+
+    nm_log_dbg(LOGD_DHCP4,
+               "dhcp4 (%s): queued start of client (priority %d, %u waiting)",
+               nm_dhcp_client_get_iface(client),
+               priority,
+               priv->start_queue.len);
+
+    _start_queue_schedule(self, now_msec);
 }
 
 static void
 remove_client(NMDhcpManager *self, NMDhcpClient *client)
 {
+    NMDhcpManagerPrivate *priv    = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    const int             IS_IPv4 = NM_IS_IPv4(nm_dhcp_client_get_addr_family(client));
+    StartData *           start_data;
+    gpointer              ifindex;
+
+    start_data = g_hash_table_lookup(priv->start_idx, client);
+    if (start_data) {
+        _start_queue_unlink(self, start_data);
+        _start_data_free(start_data);
+    }
+
     g_signal_handlers_disconnect_by_func(client, client_state_changed, self);
     c_list_unlink(&client->dhcp_client_lst);
 
+    /* only drop the index entry if it still refers to this client. */
+    ifindex = GINT_TO_POINTER(nm_dhcp_client_get_ifindex(client));
+    if (g_hash_table_lookup(priv->client_idx[IS_IPv4], ifindex) == client)
+        g_hash_table_remove(priv->client_idx[IS_IPv4], ifindex);
+
     /* Stopping the client is left up to the controlling device
      * explicitly since we may want to quit NetworkManager but not terminate
      * the DHCP client.
@@ -202,6 +366,7 @@ client_start(NMDhcpManager *           self,
              NMDedupMultiIndex *       multi_idx,
              const char *              iface,
              int                       ifindex,
+             int                       start_priority,
              GBytes *                  hwaddr,
              GBytes *                  bcast_hwaddr,
              const char *              uuid,
@@ -339,6 +504,9 @@ client_start(NMDhcpManager *           self,
                           NULL);
     nm_assert(client && c_list_is_empty(&client->dhcp_client_lst));
     c_list_link_tail(&priv->dhcp_client_lst_head, &client->dhcp_client_lst);
+    g_hash_table_insert(priv->client_idx[NM_IS_IPv4(addr_family)],
+                        GINT_TO_POINTER(ifindex),
+                        client);
     g_signal_connect(client,
                      NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED,
                      G_CALLBACK(client_state_changed),
@@ -370,6 +538,21 @@ client_start(NMDhcpManager *           self,
      * default outside of NetworkManager API.
      */
 
+    if (addr_family == AF_INET && nm_dhcp_start_queue_is_enabled(&priv->start_queue)) {
+        gint64 now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+        if (!nm_dhcp_start_queue_try_start(&priv->start_queue, now_msec)) {
+            _start_queue_add(self,
+                             client,
+                             start_priority,
+                             dhcp_client_id,
+                             dhcp_anycast_addr,
+                             last_ip4_address,
+                             now_msec);
+            return g_object_ref(client);
+        }
+    }
+
     if (addr_family == AF_INET) {
         success = nm_dhcp_client_start_ip4(client,
                                            dhcp_client_id,
@@ -395,12 +578,15 @@ client_start(NMDhcpManager *           self,
     return g_object_ref(client);
 }
 
-/* Caller owns a reference to the NMDhcpClient on return */
+/* Caller owns a reference to the NMDhcpClient on return.
+ * If starting DHCPv4 clients is rate limited, the client may only be started
+ * later, with clients of higher @start_priority going first. */
 NMDhcpClient *
 nm_dhcp_manager_start_ip4(NMDhcpManager *     self,
                           NMDedupMultiIndex * multi_idx,
                           const char *        iface,
                           int                 ifindex,
+                          int                 start_priority,
                           GBytes *            hwaddr,
                           GBytes *            bcast_hwaddr,
                           const char *        uuid,
@@ -456,6 +642,7 @@ nm_dhcp_manager_start_ip4(NMDhcpManager *     self,
                         multi_idx,
                         iface,
                         ifindex,
+                        start_priority,
                         hwaddr,
                         bcast_hwaddr,
                         uuid,
@@ -521,6 +708,7 @@ nm_dhcp_manager_start_ip6(NMDhcpManager *           self,
                         multi_idx,
                         iface,
                         ifindex,
+                        0,
                         NULL,
                         NULL,
                         uuid,
@@ -581,17 +769,37 @@ nmtst_dhcp_manager_unget(gpointer self)
     _nmtst_nm_dhcp_manager_get_reset(self);
 }
 
+void
+nmtst_dhcp_manager_set_client_factory(NMDhcpManager *self, const NMDhcpClientFactory *factory)
+{
+    NM_DHCP_MANAGER_GET_PRIVATE(self)->client_factory = factory;
+}
+
+NMDhcpClient *
+nmtst_dhcp_manager_get_client(NMDhcpManager *self, int addr_family, int ifindex)
+{
+    return get_client_for_ifindex(self, addr_family, ifindex);
+}
+
 static void
 nm_dhcp_manager_init(NMDhcpManager *self)
 {
     NMDhcpManagerPrivate *     priv        = NM_DHCP_MANAGER_GET_PRIVATE(self);
     NMConfig *                 config      = nm_config_get();
+    const NMConfigData *       config_data;
     gs_free char *             client_free = NULL;
     const char *               client;
     int                        i;
     const NMDhcpClientFactory *client_factory = NULL;
+    guint                      start_rate;
+    guint                      start_burst;
+    guint                      start_jitter_msec;
 
     c_list_init(&priv->dhcp_client_lst_head);
+    priv->client_idx[0] = g_hash_table_new(nm_direct_hash, NULL);
+    priv->client_idx[1] = g_hash_table_new(nm_direct_hash, NULL);
+    priv->start_idx     = g_hash_table_new(nm_direct_hash, NULL);
+    nm_dhcp_start_queue_init(&priv->start_queue, 0, 0, 0, 0);
 
     for (i = 0; i < G_N_ELEMENTS(_nm_dhcp_manager_factories); i++) {
         const NMDhcpClientFactory *f = _nm_dhcp_manager_factories[i];
@@ -656,6 +864,43 @@ nm_dhcp_manager_init(NMDhcpManager *self)
      * beware that the "dhcp-plugin" device spec made decisions based on
      * the previous plugin and may need reevaluation. */
     priv->client_factory = client_factory;
+
+    config_data = nm_config_get_data_orig(config);
+    start_rate  = nm_config_data_get_value_int64(config_data,
+                                                NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                                NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_RATE,
+                                                10,
+                                                0,
+                                                G_MAXINT32,
+                                                0);
+    start_burst = nm_config_data_get_value_int64(config_data,
+                                                 NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                                 NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_BURST,
+                                                 10,
+                                                 1,
+                                                 G_MAXINT32,
+                                                 NM_MAX(start_rate, 1u));
+    start_jitter_msec =
+        nm_config_data_get_value_int64(config_data,
+                                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                       NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_JITTER,
+                                       10,
+                                       0,
+                                       60000,
+                                       0);
+    nm_dhcp_start_queue_init(&priv->start_queue,
+                             start_rate,
+                             start_burst,
+                             start_jitter_msec,
+                             nm_utils_get_monotonic_timestamp_msec());
+
+    if (nm_dhcp_start_queue_is_enabled(&priv->start_queue)) {
+        nm_log_info(LOGD_DHCP,
+                    "dhcp-init: rate limiting DHCPv4 starts (%u/s, burst %u, jitter %u ms)",
+                    start_rate,
+                    start_burst,
+                    start_jitter_msec);
+    }
 }
 
 static void
@@ -668,6 +913,14 @@ dispose(GObject *object)
     c_list_for_each_entry_safe (client, client_safe, &priv->dhcp_client_lst_head, dhcp_client_lst)
         remove_client_unref(self, client);
 
+    nm_assert(priv->start_queue.len == 0);
+
+    nm_dhcp_utils_lease_file_flush(NULL);
+    nm_clear_g_source_inst(&priv->start_source);
+    nm_clear_pointer(&priv->start_idx, g_hash_table_unref);
+    nm_clear_pointer(&priv->client_idx[0], g_hash_table_unref);
+    nm_clear_pointer(&priv->client_idx[1], g_hash_table_unref);
+
     G_OBJECT_CLASS(nm_dhcp_manager_parent_class)->dispose(object);
 
     nm_clear_g_free(&priv->default_hostname);
@@ -36,6 +36,7 @@ NMDhcpClient *nm_dhcp_manager_start_ip4(NMDhcpManager *            manager,
                                         struct _NMDedupMultiIndex *multi_idx,
                                         const char *               iface,
                                         int                        ifindex,
+                                        int                        start_priority,
                                         GBytes *                   hwaddr,
                                         GBytes *                   bcast_hwaddr,
                                         const char *               uuid,
@@ -84,4 +85,8 @@ extern const NMDhcpClientFactory *const _nm_dhcp_manager_factories[6];
 
 void nmtst_dhcp_manager_unget(gpointer singleton_instance);
 
+void nmtst_dhcp_manager_set_client_factory(NMDhcpManager *self, const NMDhcpClientFactory *factory);
+
+NMDhcpClient *nmtst_dhcp_manager_get_client(NMDhcpManager *self, int addr_family, int ifindex);
+
 #endif /* __NETWORKMANAGER_DHCP_MANAGER_H__ */
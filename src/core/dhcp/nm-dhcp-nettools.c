@@ -70,6 +70,19 @@ G_DEFINE_TYPE(NMDhcpNettools, nm_dhcp_nettools, NM_TYPE_DHCP_CLIENT)
 
 /*****************************************************************************/
 
+/* With "main.dhcp-shared-socket", all clients share one packet socket
+ * while they have no address. It exists as long as there are clients
+ * using it. */
+typedef struct {
+    NDhcp4ClientSharedSocket *socket;
+    GSource *                 source;
+    GHashTable *              clients; /* NDhcp4Client * -> NMDhcpNettools * */
+} SharedSocketData;
+
+static SharedSocketData *_shared_socket_data;
+
+/*****************************************************************************/
+
 static void
 set_error_nettools(GError **error, int r, const char *message)
 {
@@ -719,7 +732,6 @@ lease_save(NMDhcpNettools *self, NDhcp4ClientLease *lease, const char *lease_fil
     struct in_addr           a_address;
     nm_auto_str_buf NMStrBuf sbuf = NM_STR_BUF_INIT(NM_UTILS_GET_NEXT_REALLOC_SIZE_104, FALSE);
     char                     addr_str[NM_UTILS_INET_ADDRSTRLEN];
-    gs_free_error GError *error = NULL;
 
     nm_assert(lease);
     nm_assert(lease_file);
@@ -733,8 +745,7 @@ lease_save(NMDhcpNettools *self, NDhcp4ClientLease *lease, const char *lease_fil
                              "ADDRESS=%s\n",
                              _nm_utils_inet4_ntop(a_address.s_addr, addr_str));
 
-    if (!g_file_set_contents(lease_file, nm_str_buf_get_str_unsafe(&sbuf), sbuf.len, &error))
-        _LOGW("error saving lease to %s: %s", lease_file, error->message);
+    nm_dhcp_utils_lease_file_write(lease_file, nm_str_buf_get_str_unsafe(&sbuf), sbuf.len);
 }
 
 static void
@@ -840,36 +851,157 @@ dhcp4_event_handle(NMDhcpNettools *self, NDhcp4ClientEvent *event)
     }
 }
 
+static void
+dhcp4_event_pop_all(NMDhcpNettools *self)
+{
+    NMDhcpNettoolsPrivate *priv = NM_DHCP_NETTOOLS_GET_PRIVATE(self);
+    NDhcp4ClientEvent *    event;
+
+    while (!n_dhcp4_client_pop_event(priv->client, &event) && event) {
+        dhcp4_event_handle(self, event);
+    }
+}
+
+static void
+dhcp4_dispatch_failed(NMDhcpNettools *self, int r)
+{
+    NMDhcpNettoolsPrivate *priv = NM_DHCP_NETTOOLS_GET_PRIVATE(self);
+
+    /* FIXME: if any operation (e.g. send()) fails during the
+     * dispatch, n-dhcp4 returns an error without arming timers
+     * or progressing state, so the only reasonable thing to do
+     * is to move to failed state so that the client will be
+     * restarted. Ideally n-dhcp4 should retry failed operations
+     * a predefined number of times (possibly infinite).
+     */
+    _LOGE("error %d dispatching events", r);
+    nm_clear_g_source_inst(&priv->event_source);
+    nm_dhcp_client_set_state(NM_DHCP_CLIENT(self), NM_DHCP_STATE_FAIL, NULL, NULL);
+}
+
 static gboolean
 dhcp4_event_cb(int fd, GIOCondition condition, gpointer user_data)
 {
     NMDhcpNettools *       self = user_data;
     NMDhcpNettoolsPrivate *priv = NM_DHCP_NETTOOLS_GET_PRIVATE(self);
-    NDhcp4ClientEvent *    event;
     int                    r;
 
     r = n_dhcp4_client_dispatch(priv->client);
     if (r < 0) {
-        /* FIXME: if any operation (e.g. send()) fails during the
-         * dispatch, n-dhcp4 returns an error without arming timers
-         * or progressing state, so the only reasonable thing to do
-         * is to move to failed state so that the client will be
-         * restarted. Ideally n-dhcp4 should retry failed operations
-         * a predefined number of times (possibly infinite).
-         */
-        _LOGE("error %d dispatching events", r);
-        nm_clear_g_source_inst(&priv->event_source);
-        nm_dhcp_client_set_state(NM_DHCP_CLIENT(self), NM_DHCP_STATE_FAIL, NULL, NULL);
+        dhcp4_dispatch_failed(self, r);
         return G_SOURCE_REMOVE;
     }
 
-    while (!n_dhcp4_client_pop_event(priv->client, &event) && event) {
-        dhcp4_event_handle(self, event);
+    dhcp4_event_pop_all(self);
+
+    return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+
+/* Upper bound of packets read from the shared socket per wakeup, so that
+ * a flood of replies does not starve the rest of the main loop. */
+#define SHARED_SOCKET_DISPATCH_MAX 64
+
+static gboolean
+_shared_socket_event_cb(int fd, GIOCondition condition, gpointer user_data)
+{
+    SharedSocketData *                 data   = user_data;
+    nm_auto_unref_gsource GSource *source = g_source_ref(data->source);
+    NDhcp4Client *                     client;
+    NMDhcpNettools *                   self;
+    guint                              i;
+    int                                r;
+
+    for (i = 0; i < SHARED_SOCKET_DISPATCH_MAX; i++) {
+        r = n_dhcp4_client_shared_socket_dispatch(data->socket, &client);
+        if (r == 0)
+            break;
+
+        self = client ? g_hash_table_lookup(data->clients, client) : NULL;
+
+        if (r < 0) {
+            if (self)
+                dhcp4_dispatch_failed(self, r);
+            else
+                nm_log_warn(LOGD_DHCP4, "dhcp4: error %d dispatching shared socket", r);
+        } else if (self)
+            dhcp4_event_pop_all(self);
+
+        /* handling the events may have released the last client and
+         * with it the shared socket. */
+        if (g_source_is_destroyed(source))
+            return G_SOURCE_REMOVE;
     }
 
     return G_SOURCE_CONTINUE;
 }
 
+static NDhcp4ClientSharedSocket *
+_shared_socket_acquire(GError **error)
+{
+    SharedSocketData *data;
+    int               r, fd;
+
+    if (_shared_socket_data)
+        return _shared_socket_data->socket;
+
+    data = g_slice_new(SharedSocketData);
+
+    r = n_dhcp4_client_shared_socket_new(&data->socket);
+    if (r) {
+        set_error_nettools(error, r, "failed to create shared socket");
+        g_slice_free(SharedSocketData, data);
+        return NULL;
+    }
+
+    n_dhcp4_client_shared_socket_get_fd(data->socket, &fd);
+
+    data->clients = g_hash_table_new(nm_direct_hash, NULL);
+    data->source  = nm_g_unix_fd_source_new(fd,
+                                           G_IO_IN,
+                                           G_PRIORITY_DEFAULT,
+                                           _shared_socket_event_cb,
+                                           data,
+                                           NULL);
+    g_source_attach(data->source, NULL);
+
+    _shared_socket_data = data;
+    return data->socket;
+}
+
+static void
+_shared_socket_register(NMDhcpNettools *self)
+{
+    NMDhcpNettoolsPrivate *priv = NM_DHCP_NETTOOLS_GET_PRIVATE(self);
+
+    nm_assert(_shared_socket_data);
+
+    g_hash_table_insert(_shared_socket_data->clients, priv->client, self);
+}
+
+static void
+_shared_socket_release_if_unused(void)
+{
+    SharedSocketData *data = _shared_socket_data;
+
+    if (!data || g_hash_table_size(data->clients) > 0)
+        return;
+
+    _shared_socket_data = NULL;
+    nm_clear_g_source_inst(&data->source);
+    g_hash_table_unref(data->clients);
+    n_dhcp4_client_shared_socket_unref(data->socket);
+    g_slice_free(SharedSocketData, data);
+}
+
+static void
+_shared_socket_release(NDhcp4Client *client)
+{
+    if (_shared_socket_data && g_hash_table_remove(_shared_socket_data->clients, client))
+        _shared_socket_release_if_unused();
+}
+
 static gboolean
 nettools_create(NMDhcpNettools *self, const char *dhcp_anycast_addr, GError **error)
 {
@@ -886,6 +1018,7 @@ nettools_create(NMDhcpNettools *self, const char *dhcp_anycast_addr, GError **er
     gs_unref_bytes GBytes *client_id_new = NULL;
     const uint8_t *        client_id_arr;
     size_t                 client_id_len;
+    gboolean               use_shared_socket = FALSE;
     int                    r, fd, arp_type, transport;
 
     g_return_val_if_fail(!priv->client, FALSE);
@@ -946,15 +1079,36 @@ nettools_create(NMDhcpNettools *self, const char *dhcp_anycast_addr, GError **er
         return FALSE;
     }
 
+    if (nm_config_data_get_value_boolean(NM_CONFIG_GET_DATA,
+                                         NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                         NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_SHARED_SOCKET,
+                                         FALSE)) {
+        NDhcp4ClientSharedSocket *shared_socket;
+
+        shared_socket = _shared_socket_acquire(error);
+        if (!shared_socket)
+            return FALSE;
+        n_dhcp4_client_config_set_shared_socket(config, shared_socket);
+        use_shared_socket = TRUE;
+    }
+
     r = n_dhcp4_client_new(&client, config);
     if (r) {
         set_error_nettools(error, r, "failed to create client");
+        if (use_shared_socket) {
+            /* no client got registered. Drop the shared socket again, if we
+             * just created it. */
+            _shared_socket_release_if_unused();
+        }
         return FALSE;
     }
 
     priv->client = client;
     client       = NULL;
 
+    if (use_shared_socket)
+        _shared_socket_register(self);
+
     n_dhcp4_client_set_log_level(priv->client,
                                  nm_log_level_to_syslog(nm_logging_get_level(LOGD_DHCP4)));
 
@@ -1078,6 +1232,7 @@ ip4_start(NMDhcpClient *client,
          */
         nm_auto(sd_dhcp_lease_unrefp) sd_dhcp_lease *lease = NULL;
 
+        nm_dhcp_utils_lease_file_flush(lease_file);
         dhcp_lease_load(&lease, lease_file);
         if (lease)
             sd_dhcp_lease_get_address(lease, &last_addr);
@@ -1221,7 +1376,10 @@ dispose(GObject *object)
     nm_clear_g_source_inst(&priv->event_source);
     nm_clear_pointer(&priv->lease, n_dhcp4_client_lease_unref);
     nm_clear_pointer(&priv->probe, n_dhcp4_client_probe_free);
-    nm_clear_pointer(&priv->client, n_dhcp4_client_unref);
+    if (priv->client) {
+        _shared_socket_release(priv->client);
+        nm_clear_pointer(&priv->client, n_dhcp4_client_unref);
+    }
 
     G_OBJECT_CLASS(nm_dhcp_nettools_parent_class)->dispose(object);
 }
@@ -818,6 +818,440 @@ nm_dhcp_utils_get_leasefile_path(int         addr_family,
     return FALSE;
 }
 
+/*****************************************************************************/
+
+/* Lease files are written by a worker thread, so that the fsync() of
+ * g_file_set_contents() does not block the main loop. Writes are delayed
+ * a bit and coalesced per file, and skipped if the file on disk already
+ * has the content. The file is read each time, so that a file that was
+ * removed or modified by somebody else gets written again.
+ *
+ * The worker never holds the lock while doing I/O, so that queueing
+ * a write from the main thread never waits for the disk. */
+
+#define LEASE_FILE_WRITE_DELAY_MSEC 1000
+
+typedef struct {
+    char *  path;
+    GError *error;
+} LeaseFileError;
+
+static struct {
+    GMutex      lock;
+    GCond       cond;
+    GHashTable *pending;   /* path -> GBytes, to be written */
+    GPtrArray * errors;    /* LeaseFileError, to be logged on the main thread */
+    char *      in_flight; /* path currently written by the worker */
+    GSource *   delay_source;
+    bool        worker_running;
+} _lease_files;
+
+static GHashTable *
+_lease_file_table_new(void)
+{
+    return g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_bytes_unref);
+}
+
+static void
+_lease_file_error_free(gpointer data)
+{
+    LeaseFileError *e = data;
+
+    g_free(e->path);
+    g_error_free(e->error);
+    nm_g_slice_free(e);
+}
+
+static gboolean
+_lease_file_write_one(const char *path, GBytes *contents, GError **error)
+{
+    gs_free char *old_contents = NULL;
+    gsize         old_len;
+    gconstpointer data;
+    gsize         len;
+
+    data = g_bytes_get_data(contents, &len);
+
+    if (g_file_get_contents(path, &old_contents, &old_len, NULL) && old_len == len
+        && memcmp(old_contents, data, len) == 0)
+        return TRUE;
+
+    return g_file_set_contents(path, data, len, error);
+}
+
+static void
+_lease_file_worker_thread_fn(GTask *       task,
+                             gpointer      source_object,
+                             gpointer      task_data,
+                             GCancellable *cancellable)
+{
+    GHashTableIter iter;
+
+    g_mutex_lock(&_lease_files.lock);
+    for (;;) {
+        gs_unref_bytes GBytes *contents = NULL;
+        gs_free_error GError *error     = NULL;
+        char *                path;
+
+        g_hash_table_iter_init(&iter, _lease_files.pending);
+        if (!g_hash_table_iter_next(&iter, (gpointer *) &path, (gpointer *) &contents))
+            break;
+        g_hash_table_iter_steal(&iter);
+        _lease_files.in_flight = path;
+        g_mutex_unlock(&_lease_files.lock);
+
+        _lease_file_write_one(path, contents, &error);
+
+        g_mutex_lock(&_lease_files.lock);
+        if (error) {
+            LeaseFileError *e;
+
+            e  = g_slice_new(LeaseFileError);
+            *e = (LeaseFileError){
+                .path  = g_strdup(path),
+                .error = g_steal_pointer(&error),
+            };
+            g_ptr_array_add(_lease_files.errors, e);
+        }
+        g_free(path);
+        _lease_files.in_flight = NULL;
+        g_cond_broadcast(&_lease_files.cond);
+    }
+    _lease_files.worker_running = FALSE;
+    g_mutex_unlock(&_lease_files.lock);
+
+    g_task_return_boolean(task, TRUE);
+}
+
+static void
+_lease_file_log_errors(void)
+{
+    gs_unref_ptrarray GPtrArray *errors = NULL;
+    guint                        i;
+
+    g_mutex_lock(&_lease_files.lock);
+    if (_lease_files.errors->len > 0) {
+        errors              = _lease_files.errors;
+        _lease_files.errors = g_ptr_array_new_with_free_func(_lease_file_error_free);
+    }
+    g_mutex_unlock(&_lease_files.lock);
+
+    if (!errors)
+        return;
+
+    for (i = 0; i < errors->len; i++) {
+        LeaseFileError *e = errors->pdata[i];
+
+        nm_log_warn(LOGD_DHCP, "dhcp: error saving lease to %s: %s", e->path, e->error->message);
+    }
+}
+
+static void
+_lease_file_worker_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    _lease_file_log_errors();
+}
+
+static gboolean
+_lease_file_delay_cb(gpointer user_data)
+{
+    GTask *task;
+
+    nm_clear_g_source_inst(&_lease_files.delay_source);
+
+    g_mutex_lock(&_lease_files.lock);
+    if (_lease_files.worker_running || g_hash_table_size(_lease_files.pending) == 0) {
+        /* a running worker picks up the pending writes. */
+        g_mutex_unlock(&_lease_files.lock);
+        return G_SOURCE_REMOVE;
+    }
+    _lease_files.worker_running = TRUE;
+    g_mutex_unlock(&_lease_files.lock);
+
+    task = g_task_new(NULL, NULL, _lease_file_worker_cb, NULL);
+    g_task_run_in_thread(task, _lease_file_worker_thread_fn);
+    g_object_unref(task);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_lease_files_init(void)
+{
+    if (G_LIKELY(_lease_files.pending))
+        return;
+
+    /* the statically allocated lock and cond need no initialization. */
+    _lease_files.pending = _lease_file_table_new();
+    _lease_files.errors  = g_ptr_array_new_with_free_func(_lease_file_error_free);
+}
+
+/**
+ * nm_dhcp_utils_lease_file_write:
+ * @path: the lease file
+ * @contents: the new content of the file
+ * @len: the length of @contents
+ *
+ * Schedules writing @contents to @path. The file is written later on a
+ * worker thread. If the file is written again before, only the last
+ * content is written. Must be called on the main thread.
+ */
+void
+nm_dhcp_utils_lease_file_write(const char *path, const char *contents, gsize len)
+{
+    g_return_if_fail(path);
+
+    _lease_files_init();
+
+    g_mutex_lock(&_lease_files.lock);
+    g_hash_table_insert(_lease_files.pending, g_strdup(path), g_bytes_new(contents, len));
+    g_mutex_unlock(&_lease_files.lock);
+
+    if (!_lease_files.delay_source) {
+        _lease_files.delay_source = nm_g_timeout_source_new(LEASE_FILE_WRITE_DELAY_MSEC,
+                                                            G_PRIORITY_DEFAULT_IDLE,
+                                                            _lease_file_delay_cb,
+                                                            NULL,
+                                                            NULL);
+        g_source_attach(_lease_files.delay_source, NULL);
+    }
+}
+
+/**
+ * nm_dhcp_utils_lease_file_flush:
+ * @path: (allow-none): the lease file to flush, or %NULL for all files
+ *
+ * Synchronously writes the pending content of @path, or of all lease
+ * files. Afterwards, the content last passed to nm_dhcp_utils_lease_file_write()
+ * is on disk. This is for reading back a lease file and for shutdown.
+ */
+void
+nm_dhcp_utils_lease_file_flush(const char *path)
+{
+    gs_unref_hashtable GHashTable *flush = NULL;
+    GHashTableIter                 iter;
+    const char *                   p;
+    GBytes *                       contents;
+
+    if (!_lease_files.pending)
+        return;
+
+    g_mutex_lock(&_lease_files.lock);
+
+    while (_lease_files.in_flight && (!path || nm_streq(_lease_files.in_flight, path)))
+        g_cond_wait(&_lease_files.cond, &_lease_files.lock);
+
+    if (path) {
+        gpointer k, v;
+
+        if (g_hash_table_steal_extended(_lease_files.pending, path, &k, &v)) {
+            flush = _lease_file_table_new();
+            g_hash_table_insert(flush, k, v);
+        }
+    } else if (g_hash_table_size(_lease_files.pending) > 0) {
+        flush                = _lease_files.pending;
+        _lease_files.pending = _lease_file_table_new();
+    }
+
+    g_mutex_unlock(&_lease_files.lock);
+
+    if (flush) {
+        g_hash_table_iter_init(&iter, flush);
+        while (g_hash_table_iter_next(&iter, (gpointer *) &p, (gpointer *) &contents)) {
+            gs_free_error GError *error = NULL;
+
+            if (!_lease_file_write_one(p, contents, &error))
+                nm_log_warn(LOGD_DHCP, "dhcp: error saving lease to %s: %s", p, error->message);
+        }
+    }
+
+    _lease_file_log_errors();
+}
+
+/*****************************************************************************/
+
+void
+nm_dhcp_start_queue_init(NMDhcpStartQueue *queue,
+                         guint             rate,
+                         guint             burst,
+                         guint             jitter_msec,
+                         gint64            now_msec)
+{
+    *queue = (NMDhcpStartQueue){
+        .wait_lst_head  = C_LIST_INIT(queue->wait_lst_head),
+        .ready_lst_head = C_LIST_INIT(queue->ready_lst_head),
+        .rate           = rate,
+        .burst          = NM_MAX(burst, 1u),
+        .jitter_msec    = jitter_msec,
+        .tokens         = (gint64) NM_MAX(burst, 1u) * 1000,
+        .tokens_msec    = now_msec,
+    };
+}
+
+static void
+_start_queue_refill(NMDhcpStartQueue *queue, gint64 now_msec)
+{
+    if (queue->rate == 0 || now_msec <= queue->tokens_msec)
+        return;
+
+    queue->tokens      = NM_MIN((gint64) queue->burst * 1000,
+                           queue->tokens + (now_msec - queue->tokens_msec) * queue->rate);
+    queue->tokens_msec = now_msec;
+}
+
+static gboolean
+_start_queue_take_token(NMDhcpStartQueue *queue, gint64 now_msec)
+{
+    if (queue->rate == 0)
+        return TRUE;
+
+    _start_queue_refill(queue, now_msec);
+    if (queue->tokens < 1000)
+        return FALSE;
+    queue->tokens -= 1000;
+    return TRUE;
+}
+
+/**
+ * nm_dhcp_start_queue_try_start:
+ * @queue: the #NMDhcpStartQueue
+ * @now_msec: the current monotonic timestamp
+ *
+ * Returns: %TRUE if a client may start right away, without going through the
+ *   queue. That consumes a token.
+ */
+gboolean
+nm_dhcp_start_queue_try_start(NMDhcpStartQueue *queue, gint64 now_msec)
+{
+    if (queue->jitter_msec > 0 || queue->len > 0)
+        return FALSE;
+    return _start_queue_take_token(queue, now_msec);
+}
+
+/**
+ * nm_dhcp_start_queue_add:
+ * @queue: the #NMDhcpStartQueue
+ * @entry: the entry to enqueue
+ * @priority: entries with higher priority start first
+ * @now_msec: the current monotonic timestamp
+ *
+ * Enqueues @entry. With jitter, the entry gets its own random delay
+ * relative to @now_msec. The delays of the entries are independent of each
+ * other and of the rate limit.
+ */
+void
+nm_dhcp_start_queue_add(NMDhcpStartQueue *     queue,
+                        NMDhcpStartQueueEntry *entry,
+                        int                    priority,
+                        gint64                 now_msec)
+{
+    CList *iter;
+
+    entry->priority   = priority;
+    entry->ready_msec = now_msec;
+    if (queue->jitter_msec > 0)
+        entry->ready_msec += g_random_int_range(0, queue->jitter_msec + 1);
+
+    /* The wait list is sorted by ascending ready time, and in FIFO order for
+     * equal times. New entries tend to be ready last, so search from the end. */
+    for (iter = queue->wait_lst_head.prev; iter != &queue->wait_lst_head; iter = iter->prev) {
+        if (c_list_entry(iter, NMDhcpStartQueueEntry, queue_lst)->ready_msec <= entry->ready_msec)
+            break;
+    }
+    c_list_link_after(iter, &entry->queue_lst);
+    queue->len++;
+}
+
+void
+nm_dhcp_start_queue_remove(NMDhcpStartQueue *queue, NMDhcpStartQueueEntry *entry)
+{
+    nm_assert(queue->len > 0);
+    nm_assert(c_list_contains(&queue->wait_lst_head, &entry->queue_lst)
+              || c_list_contains(&queue->ready_lst_head, &entry->queue_lst));
+
+    c_list_unlink(&entry->queue_lst);
+    queue->len--;
+}
+
+static void
+_start_queue_promote(NMDhcpStartQueue *queue, gint64 now_msec)
+{
+    NMDhcpStartQueueEntry *entry;
+    CList *                iter;
+
+    /* Move the entries whose delay passed to the ready list. It is sorted by
+     * descending priority, and in FIFO order for equal priorities. Usually,
+     * all clients have the same priority, so search from the end. */
+    while ((entry = c_list_first_entry(&queue->wait_lst_head, NMDhcpStartQueueEntry, queue_lst))
+           && entry->ready_msec <= now_msec) {
+        c_list_unlink(&entry->queue_lst);
+        for (iter = queue->ready_lst_head.prev; iter != &queue->ready_lst_head; iter = iter->prev) {
+            if (c_list_entry(iter, NMDhcpStartQueueEntry, queue_lst)->priority >= entry->priority)
+                break;
+        }
+        c_list_link_after(iter, &entry->queue_lst);
+    }
+}
+
+/**
+ * nm_dhcp_start_queue_pop:
+ * @queue: the #NMDhcpStartQueue
+ * @now_msec: the current monotonic timestamp
+ *
+ * Returns: the entry with the highest priority, whose delay has passed, if
+ *   a token is available. The entry is removed from the queue. Otherwise,
+ *   %NULL.
+ */
+NMDhcpStartQueueEntry *
+nm_dhcp_start_queue_pop(NMDhcpStartQueue *queue, gint64 now_msec)
+{
+    NMDhcpStartQueueEntry *entry;
+
+    _start_queue_promote(queue, now_msec);
+
+    entry = c_list_first_entry(&queue->ready_lst_head, NMDhcpStartQueueEntry, queue_lst);
+    if (!entry)
+        return NULL;
+    if (!_start_queue_take_token(queue, now_msec))
+        return NULL;
+    nm_dhcp_start_queue_remove(queue, entry);
+    return entry;
+}
+
+/**
+ * nm_dhcp_start_queue_get_timeout_msec:
+ * @queue: the #NMDhcpStartQueue
+ * @now_msec: the current monotonic timestamp
+ *
+ * Returns: the time in milliseconds until the next entry can be popped,
+ *   or -1 if the queue is empty.
+ */
+gint64
+nm_dhcp_start_queue_get_timeout_msec(NMDhcpStartQueue *queue, gint64 now_msec)
+{
+    NMDhcpStartQueueEntry *entry;
+    gint64                 timeout_msec;
+
+    if (queue->len == 0)
+        return -1;
+
+    if (!c_list_is_empty(&queue->ready_lst_head))
+        timeout_msec = 0;
+    else {
+        entry        = c_list_first_entry(&queue->wait_lst_head, NMDhcpStartQueueEntry, queue_lst);
+        timeout_msec = NM_MAX(entry->ready_msec - now_msec, 0);
+    }
+
+    _start_queue_refill(queue, now_msec);
+    if (queue->rate > 0 && queue->tokens < 1000) {
+        timeout_msec =
+            NM_MAX(timeout_msec, (1000 - queue->tokens + queue->rate - 1) / queue->rate);
+    }
+
+    return timeout_msec;
+}
+
+/*****************************************************************************/
+
 char *
 nm_dhcp_utils_get_dhcp6_event_id(GHashTable *lease)
 {
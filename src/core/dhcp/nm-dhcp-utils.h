@@ -36,10 +36,65 @@ gboolean nm_dhcp_utils_get_leasefile_path(int         addr_family,
                                           const char *uuid,
                                           char **     out_leasefile_path);
 
+void nm_dhcp_utils_lease_file_write(const char *path, const char *contents, gsize len);
+void nm_dhcp_utils_lease_file_flush(const char *path);
+
 char *nm_dhcp_utils_get_dhcp6_event_id(GHashTable *lease);
 
 /*****************************************************************************/
 
+/* Admits the start of DHCP clients. A token bucket limits how many clients
+ * start per second, and each queued client gets its own random delay
+ * (jitter). Tokens are counted in thousandths, so that they can be refilled
+ * per millisecond.
+ *
+ * Entries wait in a list sorted by their ready time. Once their delay passed,
+ * they move to a second list sorted by priority, from which they are popped. */
+
+typedef struct {
+    CList  queue_lst;
+    gint64 ready_msec;
+    int    priority;
+} NMDhcpStartQueueEntry;
+
+typedef struct {
+    CList  wait_lst_head;
+    CList  ready_lst_head;
+    gint64 tokens;
+    gint64 tokens_msec;
+    guint  rate;
+    guint  burst;
+    guint  jitter_msec;
+    guint  len;
+} NMDhcpStartQueue;
+
+void nm_dhcp_start_queue_init(NMDhcpStartQueue *queue,
+                              guint             rate,
+                              guint             burst,
+                              guint             jitter_msec,
+                              gint64            now_msec);
+
+static inline gboolean
+nm_dhcp_start_queue_is_enabled(const NMDhcpStartQueue *queue)
+{
+    return queue->rate > 0 || queue->jitter_msec > 0;
+}
+
+gboolean nm_dhcp_start_queue_try_start(NMDhcpStartQueue *queue, gint64 now_msec);
+
+void nm_dhcp_start_queue_add(NMDhcpStartQueue *     queue,
+                             NMDhcpStartQueueEntry *entry,
+                             int                    priority,
+                             gint64                 now_msec);
+
+void nm_dhcp_start_queue_remove(NMDhcpStartQueue *queue, NMDhcpStartQueueEntry *entry);
+
+NMDhcpStartQueueEntry *nm_dhcp_start_queue_pop(NMDhcpStartQueue *queue, gint64 now_msec);
+
+gint64 nm_dhcp_start_queue_get_timeout_msec(NMDhcpStartQueue *queue, gint64 now_msec);
+
+/*****************************************************************************/
+
 static inline gboolean
 nm_dhcp_lease_data_consume(const uint8_t **datap, size_t *n_datap, void *out, size_t n_out)
 {
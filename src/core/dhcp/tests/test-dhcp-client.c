@@ -0,0 +1,523 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "nm-glib-aux/nm-dedup-multi.h"
+
+#include "dhcp/nm-dhcp-client.h"
+#include "dhcp/nm-dhcp-manager.h"
+#include "nm-config.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+/* A fake DHCP client, whose helper process is a child that waits until
+ * the test closes a pipe. Clients started by the manager have no helper. */
+
+#define NMTST_TYPE_DHCP_CLIENT (nmtst_dhcp_client_get_type())
+
+typedef struct {
+    NMDhcpClient parent;
+} NMTstDhcpClient;
+
+typedef struct {
+    NMDhcpClientClass parent;
+} NMTstDhcpClientClass;
+
+GType nmtst_dhcp_client_get_type(void);
+
+G_DEFINE_TYPE(NMTstDhcpClient, nmtst_dhcp_client, NM_TYPE_DHCP_CLIENT)
+
+/* the PID of the helper for the next client that starts, if any. */
+static pid_t _next_pid;
+
+static gboolean
+ip4_start(NMDhcpClient *client,
+          const char *  dhcp_anycast_addr,
+          const char *  last_ip4_address,
+          GError **     error)
+{
+    if (_next_pid > 0)
+        nm_dhcp_client_watch_child(client, _next_pid);
+    return TRUE;
+}
+
+static gboolean
+ip6_start(NMDhcpClient *            client,
+          const char *              anycast_addr,
+          const struct in6_addr *   ll_addr,
+          NMSettingIP6ConfigPrivacy privacy,
+          guint                     needed_prefixes,
+          GError **                 error)
+{
+    return TRUE;
+}
+
+static void
+stop(NMDhcpClient *client, gboolean release)
+{
+    nm_dhcp_client_stop_watch_child(client, nm_dhcp_client_get_pid(client));
+}
+
+static void
+nmtst_dhcp_client_init(NMTstDhcpClient *self)
+{}
+
+static void
+nmtst_dhcp_client_class_init(NMTstDhcpClientClass *klass)
+{
+    NMDhcpClientClass *client_class = NM_DHCP_CLIENT_CLASS(klass);
+
+    client_class->ip4_start = ip4_start;
+    client_class->ip6_start = ip6_start;
+    client_class->stop      = stop;
+}
+
+/*****************************************************************************/
+
+static pid_t
+_helper_spawn(const int fds[2])
+{
+    pid_t pid;
+
+    pid = fork();
+    g_assert_cmpint(pid, >=, 0);
+    if (pid == 0) {
+        char c;
+
+        /* exit once the test closes the other end of the pipe. */
+        close(fds[1]);
+        while (read(fds[0], &c, 1) < 0 && errno == EINTR) {}
+        _exit(0);
+    }
+    return pid;
+}
+
+static void
+_helper_reap(pid_t pid)
+{
+    int status;
+
+    g_assert_cmpint(waitpid(pid, &status, 0), ==, pid);
+    g_assert(WIFEXITED(status));
+}
+
+static NMDhcpClient *
+_client_new(NMDedupMultiIndex *multi_idx, int ifindex, pid_t pid)
+{
+    gs_free char *iface = g_strdup_printf("fake%d", ifindex);
+    NMDhcpClient *client;
+
+    client = g_object_new(NMTST_TYPE_DHCP_CLIENT,
+                          NM_DHCP_CLIENT_MULTI_IDX,
+                          multi_idx,
+                          NM_DHCP_CLIENT_ADDR_FAMILY,
+                          AF_INET,
+                          NM_DHCP_CLIENT_INTERFACE,
+                          iface,
+                          NM_DHCP_CLIENT_IFINDEX,
+                          ifindex,
+                          NM_DHCP_CLIENT_UUID,
+                          "6f8a4c3e-1b2d-4e5f-8a9b-0c1d2e3f4a5b",
+                          NM_DHCP_CLIENT_TIMEOUT,
+                          (guint) NM_DHCP_TIMEOUT_INFINITY,
+                          NULL);
+
+    _next_pid = pid;
+    if (!nm_dhcp_client_start_ip4(client, NULL, NULL, NULL, NULL))
+        g_assert_not_reached();
+    g_assert_cmpint(nm_dhcp_client_get_pid(client), ==, pid);
+    return client;
+}
+
+static void
+test_lookup_by_pid(void)
+{
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new();
+    gs_unref_object NMDhcpClient *client_stopped                 = NULL;
+    gs_unref_object NMDhcpClient *client_exited                  = NULL;
+    NMDhcpClient *                client_disposed;
+    pid_t                         pid_stopped;
+    pid_t                         pid_exited;
+    pid_t                         pid_disposed;
+    int                           fds[2];
+
+    g_assert_cmpint(pipe2(fds, O_CLOEXEC), ==, 0);
+    pid_stopped  = _helper_spawn(fds);
+    pid_exited   = _helper_spawn(fds);
+    pid_disposed = _helper_spawn(fds);
+    nm_close(fds[0]);
+
+    g_assert(!nm_dhcp_client_lookup_by_pid(pid_stopped));
+
+    client_stopped  = _client_new(multi_idx, 1, pid_stopped);
+    client_exited   = _client_new(multi_idx, 2, pid_exited);
+    client_disposed = _client_new(multi_idx, 3, pid_disposed);
+
+    g_assert(nm_dhcp_client_lookup_by_pid(pid_stopped) == client_stopped);
+    g_assert(nm_dhcp_client_lookup_by_pid(pid_exited) == client_exited);
+    g_assert(nm_dhcp_client_lookup_by_pid(pid_disposed) == client_disposed);
+    g_assert(!nm_dhcp_client_lookup_by_pid(getpid()));
+    g_assert(!nm_dhcp_client_lookup_by_pid(-1));
+
+    /* a stopped or destroyed client no longer receives events of its helper. */
+    nm_dhcp_client_stop(client_stopped, FALSE);
+    g_assert(!nm_dhcp_client_lookup_by_pid(pid_stopped));
+    g_assert_cmpint(nm_dhcp_client_get_pid(client_stopped), ==, -1);
+
+    g_object_unref(client_disposed);
+    g_assert(!nm_dhcp_client_lookup_by_pid(pid_disposed));
+
+    g_assert(nm_dhcp_client_lookup_by_pid(pid_exited) == client_exited);
+
+    /* when the helper exits, its PID no longer resolves to the client. */
+    nm_close(fds[1]);
+    nmtst_main_context_iterate_until_assert(NULL,
+                                            5000,
+                                            nm_dhcp_client_get_pid(client_exited) == -1);
+    g_assert(!nm_dhcp_client_lookup_by_pid(pid_exited));
+
+    /* these helpers are no longer watched by their client. */
+    _helper_reap(pid_stopped);
+    _helper_reap(pid_disposed);
+}
+
+static void
+test_lookup_by_pid_bench(void)
+{
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new();
+    gs_unref_ptrarray GPtrArray *clients   = g_ptr_array_new_with_free_func(g_object_unref);
+    gs_free pid_t *              pids      = NULL;
+    const guint                  n_clients = 1000;
+    gint64                       t_start;
+    guint                        i;
+    int                          fds[2];
+
+    g_assert_cmpint(pipe2(fds, O_CLOEXEC), ==, 0);
+    pids = g_new(pid_t, n_clients);
+    for (i = 0; i < n_clients; i++)
+        pids[i] = _helper_spawn(fds);
+    nm_close(fds[0]);
+
+    for (i = 0; i < n_clients; i++)
+        g_ptr_array_add(clients, _client_new(multi_idx, i + 1, pids[i]));
+
+    /* resolve an event of each helper to its client, and report the time spent. */
+    t_start = g_get_monotonic_time();
+    for (i = 0; i < n_clients; i++) {
+        if (nm_dhcp_client_lookup_by_pid(pids[i]) != clients->pdata[i])
+            g_assert_not_reached();
+    }
+    g_test_message("%u clients: lookup by PID %" G_GINT64_FORMAT " usec",
+                   n_clients,
+                   g_get_monotonic_time() - t_start);
+
+    for (i = 0; i < n_clients; i++)
+        nm_dhcp_client_stop(clients->pdata[i], FALSE);
+    nm_close(fds[1]);
+    for (i = 0; i < n_clients; i++)
+        _helper_reap(pids[i]);
+}
+
+/*****************************************************************************/
+
+static char *config_filename;
+
+static void
+_config_setup(void)
+{
+    gs_free_error GError *  error = NULL;
+    NMConfigCmdLineOptions *cli;
+    GOptionContext *        context;
+    NMConfig *              config;
+    int                     fd;
+    char *                  argv_data[] = {
+        "test-dhcp-client",
+        "--config",
+        NULL,
+        "--intern-config",
+        "",
+        "--config-dir",
+        "/no/such/dir",
+        "--system-config-dir",
+        "",
+        NULL,
+    };
+    char **argv = argv_data;
+    int    argc = G_N_ELEMENTS(argv_data) - 1;
+
+    fd = g_file_open_tmp("test-dhcp-client-XXXXXX.conf", &config_filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    nm_close(fd);
+    if (!g_file_set_contents(config_filename, "[main]\ndhcp=internal\n", -1, NULL))
+        g_assert_not_reached();
+    argv_data[2] = config_filename;
+
+    cli     = nm_config_cmd_line_options_new(FALSE);
+    context = g_option_context_new(NULL);
+    nm_config_cmd_line_options_add_to_entries(cli, context);
+    if (!g_option_context_parse(context, &argc, &argv, NULL))
+        g_assert_not_reached();
+    g_option_context_free(context);
+
+    config = nm_config_setup(cli, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(config);
+    nm_config_cmd_line_options_free(cli);
+}
+
+/* the manager singleton, creating the fake clients instead of the configured plugin. */
+static NMDhcpManager *
+_manager_get(void)
+{
+    static const NMDhcpClientFactory factory = {
+        .name     = "nmtst",
+        .get_type = nmtst_dhcp_client_get_type,
+    };
+    NMDhcpManager *manager;
+
+    if (!config_filename)
+        _config_setup();
+
+    manager = nm_dhcp_manager_get();
+    nmtst_dhcp_manager_set_client_factory(manager, &factory);
+    return manager;
+}
+
+static NMDhcpClient *
+_manager_start_ip4(NMDhcpManager *manager, NMDedupMultiIndex *multi_idx, int ifindex)
+{
+    const guint8           addr[]       = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    const guint8           bcast_addr[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    gs_unref_bytes GBytes *hwaddr       = g_bytes_new(addr, sizeof(addr));
+    gs_unref_bytes GBytes *bcast        = g_bytes_new(bcast_addr, sizeof(bcast_addr));
+    gs_free char *         iface        = g_strdup_printf("fake%d", ifindex);
+    gs_free_error GError *error         = NULL;
+    NMDhcpClient *         client;
+
+    _next_pid = 0;
+
+    client = nm_dhcp_manager_start_ip4(manager,
+                                       multi_idx,
+                                       iface,
+                                       ifindex,
+                                       0,
+                                       hwaddr,
+                                       bcast,
+                                       "6f8a4c3e-1b2d-4e5f-8a9b-0c1d2e3f4a5b",
+                                       0,
+                                       0,
+                                       FALSE,
+                                       NULL,
+                                       NULL,
+                                       NM_DHCP_HOSTNAME_FLAG_NONE,
+                                       NULL,
+                                       NULL,
+                                       NM_DHCP_TIMEOUT_INFINITY,
+                                       NULL,
+                                       NULL,
+                                       NULL,
+                                       NULL,
+                                       &error);
+    g_assert_no_error(error);
+    g_assert(NM_IS_DHCP_CLIENT(client));
+    g_assert_cmpint(nm_dhcp_client_get_addr_family(client), ==, AF_INET);
+    g_assert_cmpint(nm_dhcp_client_get_ifindex(client), ==, ifindex);
+    return client;
+}
+
+static NMDhcpClient *
+_manager_start_ip6(NMDhcpManager *manager, NMDedupMultiIndex *multi_idx, int ifindex)
+{
+    const guint8           duid_data[] = {0x00, 0x04, 0x01, 0x02, 0x03, 0x04};
+    gs_unref_bytes GBytes *duid        = g_bytes_new(duid_data, sizeof(duid_data));
+    gs_free char *         iface       = g_strdup_printf("fake%d", ifindex);
+    gs_free_error GError *error        = NULL;
+    NMDhcpClient *         client;
+
+    client = nm_dhcp_manager_start_ip6(manager,
+                                       multi_idx,
+                                       iface,
+                                       ifindex,
+                                       NULL,
+                                       "6f8a4c3e-1b2d-4e5f-8a9b-0c1d2e3f4a5b",
+                                       0,
+                                       0,
+                                       FALSE,
+                                       NULL,
+                                       NM_DHCP_HOSTNAME_FLAG_NONE,
+                                       NULL,
+                                       duid,
+                                       TRUE,
+                                       0,
+                                       FALSE,
+                                       NM_DHCP_TIMEOUT_INFINITY,
+                                       NULL,
+                                       FALSE,
+                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN,
+                                       0,
+                                       &error);
+    g_assert_no_error(error);
+    g_assert(NM_IS_DHCP_CLIENT(client));
+    g_assert_cmpint(nm_dhcp_client_get_addr_family(client), ==, AF_INET6);
+    g_assert_cmpint(nm_dhcp_client_get_ifindex(client), ==, ifindex);
+    return client;
+}
+
+typedef struct {
+    NMDhcpState state;
+    guint       n_changed;
+} StateData;
+
+static void
+_state_changed_cb(NMDhcpClient *client,
+                  NMDhcpState   state,
+                  GObject *     ip_config,
+                  gpointer      options,
+                  StateData *   data)
+{
+    data->state = state;
+    data->n_changed++;
+}
+
+static void
+test_manager_ifindex(void)
+{
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new();
+    NMDhcpManager *                                    manager   = _manager_get();
+    gs_unref_object NMDhcpClient *client1                        = NULL;
+    gs_unref_object NMDhcpClient *client1_new                    = NULL;
+    gs_unref_object NMDhcpClient *client2                        = NULL;
+    gs_unref_object NMDhcpClient *client1_6                      = NULL;
+    StateData                     data1                          = {};
+    StateData                     data2                          = {};
+
+    client1   = _manager_start_ip4(manager, multi_idx, 1);
+    client2   = _manager_start_ip4(manager, multi_idx, 2);
+    client1_6 = _manager_start_ip6(manager, multi_idx, 1);
+
+    /* the index is per address family. */
+    g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET, 1) == client1);
+    g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET, 2) == client2);
+    g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET6, 1) == client1_6);
+    g_assert(!nmtst_dhcp_manager_get_client(manager, AF_INET6, 2));
+    g_assert(!nmtst_dhcp_manager_get_client(manager, AF_INET, 3));
+
+    g_signal_connect(client1,
+                     NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED,
+                     G_CALLBACK(_state_changed_cb),
+                     &data1);
+    g_signal_connect(client2,
+                     NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED,
+                     G_CALLBACK(_state_changed_cb),
+                     &data2);
+
+    /* starting again on the interface stops the old client and replaces it. */
+    client1_new = _manager_start_ip4(manager, multi_idx, 1);
+    g_assert(client1_new != client1);
+    g_assert_cmpint(data1.n_changed, ==, 1);
+    g_assert_cmpint(data1.state, ==, NM_DHCP_STATE_DONE);
+    g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET, 1) == client1_new);
+    g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET6, 1) == client1_6);
+
+    /* the replaced client no longer owns the interface. */
+    nm_dhcp_client_set_state(client1, NM_DHCP_STATE_FAIL, NULL, NULL);
+    g_assert_cmpint(data1.n_changed, ==, 2);
+    g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET, 1) == client1_new);
+
+    /* a client that fails or times out is dropped from the index. */
+    nm_dhcp_client_set_state(client2, NM_DHCP_STATE_FAIL, NULL, NULL);
+    g_assert_cmpint(data2.n_changed, ==, 1);
+    g_assert_cmpint(data2.state, ==, NM_DHCP_STATE_FAIL);
+    g_assert(!nmtst_dhcp_manager_get_client(manager, AF_INET, 2));
+
+    nm_dhcp_client_set_state(client1_6, NM_DHCP_STATE_TIMEOUT, NULL, NULL);
+    g_assert(!nmtst_dhcp_manager_get_client(manager, AF_INET6, 1));
+    g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET, 1) == client1_new);
+
+    nm_dhcp_client_stop(client1_new, FALSE);
+    g_assert(!nmtst_dhcp_manager_get_client(manager, AF_INET, 1));
+
+    g_signal_handlers_disconnect_by_data(client1, &data1);
+    g_signal_handlers_disconnect_by_data(client2, &data2);
+}
+
+static void
+test_manager_ifindex_bench(void)
+{
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new();
+    NMDhcpManager *                                    manager   = _manager_get();
+    gs_unref_ptrarray GPtrArray *clients     = g_ptr_array_new_with_free_func(g_object_unref);
+    gs_unref_ptrarray GPtrArray *clients_new = g_ptr_array_new_with_free_func(g_object_unref);
+    const guint                  n_clients   = 5000;
+    StateData                    data        = {};
+    gint64                       t_start;
+    guint                        i;
+
+    /* start the clients. Each start looks up the interface's existing client. */
+    t_start = g_get_monotonic_time();
+    for (i = 0; i < n_clients; i++)
+        g_ptr_array_add(clients, _manager_start_ip4(manager, multi_idx, i + 1));
+    g_test_message("%u clients: start %" G_GINT64_FORMAT " usec",
+                   n_clients,
+                   g_get_monotonic_time() - t_start);
+
+    for (i = 0; i < n_clients; i++) {
+        g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET, i + 1) == clients->pdata[i]);
+        g_signal_connect(clients->pdata[i],
+                         NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED,
+                         G_CALLBACK(_state_changed_cb),
+                         &data);
+    }
+
+    /* restart them, which stops and replaces each of the old clients. */
+    t_start = g_get_monotonic_time();
+    for (i = 0; i < n_clients; i++)
+        g_ptr_array_add(clients_new, _manager_start_ip4(manager, multi_idx, i + 1));
+    g_test_message("%u clients: restart %" G_GINT64_FORMAT " usec",
+                   n_clients,
+                   g_get_monotonic_time() - t_start);
+
+    g_assert_cmpint(data.n_changed, ==, n_clients);
+    g_assert_cmpint(data.state, ==, NM_DHCP_STATE_DONE);
+    for (i = 0; i < n_clients; i++) {
+        g_assert(nmtst_dhcp_manager_get_client(manager, AF_INET, i + 1) == clients_new->pdata[i]);
+        g_signal_handlers_disconnect_by_data(clients->pdata[i], &data);
+    }
+
+    for (i = 0; i < n_clients; i++)
+        nm_dhcp_client_stop(clients_new->pdata[i], FALSE);
+    for (i = 0; i < n_clients; i++)
+        g_assert(!nmtst_dhcp_manager_get_client(manager, AF_INET, i + 1));
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE();
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    nmtst_init_assert_logging(&argc, &argv, "WARN", "DEFAULT");
+
+    g_test_add_func("/dhcp/client/lookup-by-pid", test_lookup_by_pid);
+    g_test_add_func("/dhcp/manager/ifindex", test_manager_ifindex);
+    if (g_test_perf()) {
+        g_test_add_func("/dhcp/client/lookup-by-pid-bench", test_lookup_by_pid_bench);
+        g_test_add_func("/dhcp/manager/ifindex-bench", test_manager_ifindex_bench);
+    }
+
+    ret = g_test_run();
+
+    if (config_filename) {
+        unlink(config_filename);
+        nm_clear_g_free(&config_filename);
+    }
+    return ret;
+}
@@ -7,6 +7,7 @@
 
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <unistd.h>
 #include <linux/rtnetlink.h>
 
 #include "nm-glib-aux/nm-dedup-multi.h"
@@ -783,6 +784,214 @@ test_dhcp_opt_list(gconstpointer test_data)
 
 /*****************************************************************************/
 
+static gboolean
+_file_has_contents(const char *path, const char *expected)
+{
+    gs_free char *contents = NULL;
+
+    return g_file_get_contents(path, &contents, NULL, NULL) && nm_streq(contents, expected);
+}
+
+static void
+test_lease_file_write(void)
+{
+    gs_free_error GError *error = NULL;
+    gs_free char *        dir   = NULL;
+    gs_free char *        path  = NULL;
+
+    dir = g_dir_make_tmp("nm-test-dhcp-lease-XXXXXX", &error);
+    nmtst_assert_success(dir, error);
+    path = g_build_filename(dir, "test.lease", NULL);
+
+    /* pending writes are coalesced, the last content wins. */
+    nm_dhcp_utils_lease_file_write(path, "ADDRESS=192.168.1.1\n", 20);
+    nm_dhcp_utils_lease_file_write(path, "ADDRESS=192.168.1.2\n", 20);
+    nm_dhcp_utils_lease_file_flush(path);
+    g_assert(_file_has_contents(path, "ADDRESS=192.168.1.2\n"));
+
+    /* the same content is written again, if the file was modified or removed
+     * meanwhile. */
+    g_assert(g_file_set_contents(path, "modified\n", -1, NULL));
+    nm_dhcp_utils_lease_file_write(path, "ADDRESS=192.168.1.2\n", 20);
+    nm_dhcp_utils_lease_file_flush(path);
+    g_assert(_file_has_contents(path, "ADDRESS=192.168.1.2\n"));
+
+    g_assert(unlink(path) == 0);
+    nm_dhcp_utils_lease_file_write(path, "ADDRESS=192.168.1.2\n", 20);
+    nm_dhcp_utils_lease_file_flush(path);
+    g_assert(_file_has_contents(path, "ADDRESS=192.168.1.2\n"));
+
+    /* without flush, the file is written in the background. */
+    nm_dhcp_utils_lease_file_write(path, "ADDRESS=192.168.1.3\n", 20);
+    nmtst_main_context_iterate_until_assert_full(NULL,
+                                                 5000,
+                                                 50,
+                                                 _file_has_contents(path, "ADDRESS=192.168.1.3\n"));
+
+    nm_dhcp_utils_lease_file_flush(NULL);
+    g_assert(unlink(path) == 0);
+    g_assert(rmdir(dir) == 0);
+}
+
+/*****************************************************************************/
+
+static void
+test_start_queue_bucket(void)
+{
+    NMDhcpStartQueue      queue;
+    NMDhcpStartQueueEntry entries[5];
+
+    /* 10 starts per second, with a burst of 2. */
+    nm_dhcp_start_queue_init(&queue, 10, 2, 0, 1000);
+    g_assert(nm_dhcp_start_queue_is_enabled(&queue));
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 1000), ==, -1);
+
+    g_assert(nm_dhcp_start_queue_try_start(&queue, 1000));
+    g_assert(nm_dhcp_start_queue_try_start(&queue, 1000));
+    g_assert(!nm_dhcp_start_queue_try_start(&queue, 1000));
+
+    /* the next token is available after 100 msec. */
+    nm_dhcp_start_queue_add(&queue, &entries[0], 0, 1000);
+    g_assert(!nm_dhcp_start_queue_try_start(&queue, 1000));
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 1000), ==, 100);
+    g_assert(!nm_dhcp_start_queue_pop(&queue, 1000));
+    g_assert(!nm_dhcp_start_queue_pop(&queue, 1099));
+    g_assert(nm_dhcp_start_queue_pop(&queue, 1100) == &entries[0]);
+    g_assert_cmpint(queue.len, ==, 0);
+
+    /* higher priorities start first, equal priorities in FIFO order. */
+    nm_dhcp_start_queue_add(&queue, &entries[1], 0, 1100);
+    nm_dhcp_start_queue_add(&queue, &entries[2], 0, 1100);
+    nm_dhcp_start_queue_add(&queue, &entries[3], 5, 1100);
+    nm_dhcp_start_queue_add(&queue, &entries[4], 0, 1100);
+    g_assert_cmpint(queue.len, ==, 4);
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 1100), ==, 100);
+    g_assert(nm_dhcp_start_queue_pop(&queue, 1200) == &entries[3]);
+    g_assert(!nm_dhcp_start_queue_pop(&queue, 1200));
+    g_assert(nm_dhcp_start_queue_pop(&queue, 1300) == &entries[1]);
+
+    nm_dhcp_start_queue_remove(&queue, &entries[2]);
+    g_assert_cmpint(queue.len, ==, 1);
+
+    /* after a long time, the bucket is full, but not more than the burst. */
+    g_assert(nm_dhcp_start_queue_pop(&queue, 100000) == &entries[4]);
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 100000), ==, -1);
+    g_assert(nm_dhcp_start_queue_try_start(&queue, 100000));
+    g_assert(!nm_dhcp_start_queue_try_start(&queue, 100000));
+
+    /* without rate and jitter, nothing gets queued. */
+    nm_dhcp_start_queue_init(&queue, 0, 0, 0, 0);
+    g_assert(!nm_dhcp_start_queue_is_enabled(&queue));
+    g_assert(nm_dhcp_start_queue_try_start(&queue, 0));
+    g_assert(nm_dhcp_start_queue_try_start(&queue, 0));
+}
+
+#define START_QUEUE_N_JITTER 50
+
+static void
+test_start_queue_jitter(void)
+{
+    NMDhcpStartQueue      queue;
+    NMDhcpStartQueueEntry entries[START_QUEUE_N_JITTER];
+    gint64                ready_min = G_MAXINT64;
+    gboolean              any_different;
+    guint                 i;
+
+    nm_dhcp_start_queue_init(&queue, 0, 0, 500, 0);
+    g_assert(nm_dhcp_start_queue_is_enabled(&queue));
+
+    /* with jitter, starts always get queued. */
+    g_assert(!nm_dhcp_start_queue_try_start(&queue, 0));
+
+    any_different = FALSE;
+    for (i = 0; i < START_QUEUE_N_JITTER; i++) {
+        nm_dhcp_start_queue_add(&queue, &entries[i], 0, 0);
+        g_assert_cmpint(entries[i].ready_msec, >=, 0);
+        g_assert_cmpint(entries[i].ready_msec, <=, 500);
+        ready_min = NM_MIN(ready_min, entries[i].ready_msec);
+        if (entries[i].ready_msec != entries[0].ready_msec)
+            any_different = TRUE;
+    }
+    g_assert(any_different);
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 0), ==, ready_min);
+
+    /* each client has its own delay. Once the jitter passed, all of them may
+     * start, instead of one per jitter interval. */
+    for (i = 0; i < START_QUEUE_N_JITTER; i++) {
+        NMDhcpStartQueueEntry *entry;
+
+        entry = nm_dhcp_start_queue_pop(&queue, 500);
+        g_assert(entry);
+        g_assert_cmpint(entry->ready_msec, <=, 500);
+    }
+    g_assert_cmpint(queue.len, ==, 0);
+
+    /* the token bucket still limits the rate of the starts whose delay passed. */
+    nm_dhcp_start_queue_init(&queue, 10, 1, 100, 0);
+    for (i = 0; i < 3; i++)
+        nm_dhcp_start_queue_add(&queue, &entries[i], 0, 0);
+    g_assert(nm_dhcp_start_queue_pop(&queue, 100));
+    g_assert(!nm_dhcp_start_queue_pop(&queue, 100));
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 100), ==, 100);
+    g_assert(nm_dhcp_start_queue_pop(&queue, 200));
+    g_assert(nm_dhcp_start_queue_pop(&queue, 300));
+    g_assert_cmpint(queue.len, ==, 0);
+}
+
+#define START_QUEUE_N_ORDER 1000
+
+static void
+test_start_queue_order(void)
+{
+    NMDhcpStartQueue       queue;
+    NMDhcpStartQueueEntry  entries[START_QUEUE_N_ORDER];
+    NMDhcpStartQueueEntry  prio;
+    NMDhcpStartQueueEntry *entry;
+    gint64                 last_msec;
+    guint                  i;
+
+    /* entries are popped in the order of their ready time, not in the order
+     * in which they were added. */
+    nm_dhcp_start_queue_init(&queue, 0, 0, 10000, 0);
+    for (i = 0; i < START_QUEUE_N_ORDER; i++)
+        nm_dhcp_start_queue_add(&queue, &entries[i], 0, i);
+
+    last_msec = 0;
+    for (i = 0; i < START_QUEUE_N_ORDER; i++) {
+        last_msec += nm_dhcp_start_queue_get_timeout_msec(&queue, last_msec);
+        entry = nm_dhcp_start_queue_pop(&queue, last_msec);
+        g_assert(entry);
+        g_assert_cmpint(entry->ready_msec, ==, last_msec);
+    }
+    g_assert_cmpint(queue.len, ==, 0);
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, last_msec), ==, -1);
+
+    /* a higher priority only counts once the delay of the entry passed. */
+    nm_dhcp_start_queue_init(&queue, 0, 0, 0, 0);
+    nm_dhcp_start_queue_add(&queue, &prio, 5, 100);
+    nm_dhcp_start_queue_add(&queue, &entries[0], 0, 0);
+    nm_dhcp_start_queue_add(&queue, &entries[1], 0, 0);
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 0), ==, 0);
+    g_assert(nm_dhcp_start_queue_pop(&queue, 0) == &entries[0]);
+    g_assert(nm_dhcp_start_queue_pop(&queue, 100) == &prio);
+    g_assert(nm_dhcp_start_queue_pop(&queue, 100) == &entries[1]);
+    g_assert(!nm_dhcp_start_queue_pop(&queue, 100));
+
+    /* removing works for waiting and for ready entries. Without a token,
+     * entries[0] becomes ready but stays queued. */
+    nm_dhcp_start_queue_init(&queue, 1, 1, 0, 0);
+    g_assert(nm_dhcp_start_queue_try_start(&queue, 0));
+    nm_dhcp_start_queue_add(&queue, &entries[0], 0, 0);
+    nm_dhcp_start_queue_add(&queue, &entries[1], 0, 100);
+    g_assert(!nm_dhcp_start_queue_pop(&queue, 0));
+    nm_dhcp_start_queue_remove(&queue, &entries[1]);
+    nm_dhcp_start_queue_remove(&queue, &entries[0]);
+    g_assert_cmpint(queue.len, ==, 0);
+    g_assert_cmpint(nm_dhcp_start_queue_get_timeout_msec(&queue, 0), ==, -1);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -819,6 +1028,10 @@ main(int argc, char **argv)
     g_test_add_func("/dhcp/client-id-from-string", test_client_id_from_string);
     g_test_add_func("/dhcp/vendor-option-metered", test_vendor_option_metered);
     g_test_add_func("/dhcp/parse-search-list", test_parse_search_list);
+    g_test_add_func("/dhcp/lease-file-write", test_lease_file_write);
+    g_test_add_func("/dhcp/start-queue-bucket", test_start_queue_bucket);
+    g_test_add_func("/dhcp/start-queue-jitter", test_start_queue_jitter);
+    g_test_add_func("/dhcp/start-queue-order", test_start_queue_order);
     g_test_add_data_func("/dhcp/test_dhcp_opt_list/IPv4", GINT_TO_POINTER(0), test_dhcp_opt_list);
     g_test_add_data_func("/dhcp/test_dhcp_opt_list/IPv6", GINT_TO_POINTER(1), test_dhcp_opt_list);
 
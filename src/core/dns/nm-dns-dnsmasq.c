@@ -537,7 +537,7 @@ _gl_pid_spawn_next_step(void)
     argv[argv_idx++] = NULL;
     nm_assert(argv_idx <= G_N_ELEMENTS(argv));
 
-    if (!_LOGD_ENABLED())
+    if (!nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN))
         _LOGI("starting %s", gl_pid.spawn_data->dm_binary);
     else {
         gs_free char *cmdline = NULL;
@@ -114,7 +114,7 @@ create_dm_cmd_line(const char *       iface,
 
     nm_strv_ptrarray_add_string_dup(cmd, dm_binary);
 
-    if (nm_logging_enabled(LOGL_TRACE, LOGD_SHARING) || getenv("NM_DNSMASQ_DEBUG")) {
+    if (nm_logging_output_enabled(LOGL_TRACE, LOGD_SHARING) || getenv("NM_DNSMASQ_DEBUG")) {
         nm_strv_ptrarray_add_string_dup(cmd, "--log-dhcp");
         nm_strv_ptrarray_add_string_dup(cmd, "--log-queries");
     }
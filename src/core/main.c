@@ -30,6 +30,7 @@
 #include "settings/nm-settings.h"
 #include "nm-auth-manager.h"
 #include "nm-core-internal.h"
+#include "nm-libnm-core-intern/nm-common-macros.h"
 #include "nm-dbus-object.h"
 #include "nm-connectivity.h"
 #include "dns/nm-dns-manager.h"
@@ -123,6 +124,7 @@ nm_main_config_reload(int signal)
         reload_flags = NM_CONFIG_CHANGE_CAUSE_SIGUSR1;
         break;
     case SIGUSR2:
+        nm_logging_flight_recorder_log();
         reload_flags = NM_CONFIG_CHANGE_CAUSE_SIGUSR2;
         break;
     default:
@@ -425,6 +427,21 @@ main(int argc, char *argv[])
         nm_logging_init(v, nm_config_get_is_debug(config));
     }
 
+    if (nm_config_data_get_value_boolean(NM_CONFIG_GET_DATA_ORIG,
+                                         NM_CONFIG_KEYFILE_GROUP_LOGGING,
+                                         NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC,
+                                         FALSE))
+        nm_logging_init_async();
+
+    nm_logging_flight_recorder_setup(
+        nm_config_data_get_value_int64(NM_CONFIG_GET_DATA_ORIG,
+                                       NM_CONFIG_KEYFILE_GROUP_LOGGING,
+                                       NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER_SIZE,
+                                       10,
+                                       0,
+                                       G_MAXINT32,
+                                       0));
+
     nm_log_info(LOGD_CORE,
                 "NetworkManager (version " NM_DIST_VERSION ") is starting... (%s%s)",
                 nm_config_get_first_start(config) ? "for the first time" : "after a restart",
@@ -479,12 +496,29 @@ main(int argc, char *argv[])
 
     NM_UTILS_KEEP_ALIVE(config, nm_netns_get(), "NMConfig-depends-on-NMNetns");
 
+    nm_netns_set_acd_shared_socket_enabled(
+        nm_netns_get(),
+        nm_config_data_get_value_boolean(nm_config_get_data_orig(config),
+                                         NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                         NM_CONFIG_KEYFILE_KEY_MAIN_ACD_SHARED_SOCKET,
+                                         FALSE));
+
     nm_auth_manager_setup(nm_config_data_get_main_auth_polkit(nm_config_get_data_orig(config)));
 
     manager = nm_manager_setup();
 
     nm_dbus_manager_start(nm_dbus_manager_get(), nm_manager_dbus_set_property_handle, manager);
 
+    if (nm_config_data_get_value_boolean(nm_config_get_data_orig(config),
+                                         NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                         NM_CONFIG_KEYFILE_KEY_MAIN_PRIVATE_CLIENT_SOCKET,
+                                         FALSE)) {
+        nm_dbus_manager_private_server_register_full(nm_dbus_manager_get(),
+                                                     NM_PRIVATE_CLIENT_SOCKET_PATH,
+                                                     "client",
+                                                     TRUE);
+    }
+
     g_signal_connect(manager,
                      NM_MANAGER_CONFIGURE_QUIT,
                      G_CALLBACK(manager_configure_quit),
@@ -24,9 +24,13 @@
 
 /*****************************************************************************/
 
+typedef struct _NMLndpShared NMLndpShared;
+
 typedef struct {
-    struct ndp *ndp;
-    GSource *   event_source;
+    struct ndp *  ndp;
+    GSource *     event_source;
+    NMLndpShared *shared;
+    bool          shared_started : 1;
 } NMLndpNDiscPrivate;
 
 /*****************************************************************************/
@@ -570,6 +574,200 @@ receive_rs(struct ndp *ndp, struct ndp_msg *msg, gpointer user_data)
     return 0;
 }
 
+/*****************************************************************************/
+
+static void
+_ndp_set_icmp6_filter(struct ndp *ndp, gboolean pass_ra, gboolean pass_rs)
+{
+    struct icmp6_filter filter;
+
+    ICMP6_FILTER_SETBLOCKALL(&filter);
+    if (pass_ra)
+        ICMP6_FILTER_SETPASS(ND_ROUTER_ADVERT, &filter);
+    if (pass_rs)
+        ICMP6_FILTER_SETPASS(ND_ROUTER_SOLICIT, &filter);
+
+    /* Best effort. Otherwise the raw socket wakes us up for every ICMPv6
+     * message, which libndp then drops. */
+    (void) setsockopt(ndp_get_eventfd(ndp), IPPROTO_ICMPV6, ICMP6_FILTER, &filter, sizeof(filter));
+}
+
+/*****************************************************************************/
+
+/* All instances in a network namespace share one libndp socket. libndp
+ * would invoke every registered handler for each message, so we register
+ * a single handler and dispatch by ifindex ourselves. An instance only
+ * opens its own socket, if its ifindex is already taken by another one. */
+
+/* The shared socket receives the RAs and RSs of all interfaces, so we want a
+ * larger receive buffer than the default. This is best effort. */
+#define SHARED_RCVBUF (4 * 1024 * 1024)
+
+struct _NMLndpShared {
+    NMPNetns *  netns;
+    struct ndp *ndp;
+    GSource *   event_source;
+    GHashTable *ndisc_by_ifindex;
+    int         ref_count;
+};
+
+static GHashTable *_shared_by_netns;
+
+static int
+_shared_receive(struct ndp *ndp, struct ndp_msg *msg, gpointer user_data)
+{
+    NMLndpShared *           shared = user_data;
+    gs_unref_object NMNDisc *ndisc  = NULL;
+    NMNDisc *                ndisc_for_ifindex;
+
+    ndisc_for_ifindex =
+        g_hash_table_lookup(shared->ndisc_by_ifindex, GUINT_TO_POINTER(ndp_msg_ifindex(msg)));
+    if (!ndisc_for_ifindex || !NM_LNDP_NDISC_GET_PRIVATE(ndisc_for_ifindex)->shared_started)
+        return 0;
+
+    ndisc = g_object_ref(ndisc_for_ifindex);
+
+    switch (ndp_msg_type(msg)) {
+    case NDP_MSG_RA:
+        if (nm_ndisc_get_node_type(ndisc) == NM_NDISC_NODE_TYPE_HOST)
+            return receive_ra(ndp, msg, ndisc);
+        break;
+    case NDP_MSG_RS:
+        if (nm_ndisc_get_node_type(ndisc) == NM_NDISC_NODE_TYPE_ROUTER)
+            return receive_rs(ndp, msg, ndisc);
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+static void
+_shared_unref(NMLndpShared *shared)
+{
+    nm_assert(shared->ref_count > 0);
+
+    if (--shared->ref_count > 0)
+        return;
+
+    nm_assert(g_hash_table_size(shared->ndisc_by_ifindex) == 0);
+
+    g_hash_table_remove(_shared_by_netns, shared->netns);
+    nm_clear_g_source_inst(&shared->event_source);
+    ndp_msgrcv_handler_unregister(shared->ndp, _shared_receive, NDP_MSG_ALL, 0, shared);
+    ndp_close(shared->ndp);
+    g_hash_table_unref(shared->ndisc_by_ifindex);
+    if (shared->netns)
+        g_object_unref(shared->netns);
+    nm_g_slice_free(shared);
+}
+
+static gboolean
+_shared_event_ready(int fd, GIOCondition condition, gpointer user_data)
+{
+    NMLndpShared *shared = user_data;
+
+    if (shared->netns && !nmp_netns_push(shared->netns)) {
+        /* something is very wrong. Stop handling events. */
+        nm_clear_g_source_inst(&shared->event_source);
+        return G_SOURCE_REMOVE;
+    }
+
+    /* the handlers may release the last instance. Keep the socket alive
+     * until libndp returns. */
+    shared->ref_count++;
+    ndp_callall_eventfd_handler(shared->ndp);
+
+    if (shared->netns)
+        nmp_netns_pop(shared->netns);
+    _shared_unref(shared);
+    return G_SOURCE_CONTINUE;
+}
+
+/* Must be called with @netns pushed. Returns %NULL, if the socket cannot be
+ * created or if another instance already claimed @ifindex. */
+static NMLndpShared *
+_shared_acquire(NMPNetns *netns, int ifindex, NMNDisc *ndisc)
+{
+    NMLndpShared *shared;
+    struct ndp *  ndp;
+    int           rcvbuf = SHARED_RCVBUF;
+
+    if (!_shared_by_netns)
+        _shared_by_netns = g_hash_table_new(nm_direct_hash, NULL);
+
+    shared = g_hash_table_lookup(_shared_by_netns, netns);
+    if (shared) {
+        if (g_hash_table_contains(shared->ndisc_by_ifindex, GINT_TO_POINTER(ifindex)))
+            return NULL;
+    } else {
+        if (ndp_open(&ndp) != 0)
+            return NULL;
+
+        _ndp_set_icmp6_filter(ndp, TRUE, TRUE);
+        (void) setsockopt(ndp_get_eventfd(ndp), SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        shared  = g_slice_new(NMLndpShared);
+        *shared = (NMLndpShared){
+            .netns            = netns ? g_object_ref(netns) : NULL,
+            .ndp              = ndp,
+            .ndisc_by_ifindex = g_hash_table_new(nm_direct_hash, NULL),
+        };
+        ndp_msgrcv_handler_register(ndp, _shared_receive, NDP_MSG_ALL, 0, shared);
+        shared->event_source = nm_g_unix_fd_source_new(ndp_get_eventfd(ndp),
+                                                       G_IO_IN,
+                                                       G_PRIORITY_DEFAULT,
+                                                       _shared_event_ready,
+                                                       shared,
+                                                       NULL);
+        g_source_attach(shared->event_source, NULL);
+        g_hash_table_insert(_shared_by_netns, netns, shared);
+    }
+
+    g_hash_table_insert(shared->ndisc_by_ifindex, GINT_TO_POINTER(ifindex), ndisc);
+    shared->ref_count++;
+    return shared;
+}
+
+static void
+_shared_release(NMLndpShared *shared, int ifindex)
+{
+    g_hash_table_remove(shared->ndisc_by_ifindex, GINT_TO_POINTER(ifindex));
+    _shared_unref(shared);
+}
+
+gboolean
+nmtst_lndp_ndisc_is_shared(NMNDisc *ndisc)
+{
+    return !!NM_LNDP_NDISC_GET_PRIVATE(ndisc)->shared;
+}
+
+/* Pass an RA from @gateway on @ifindex to the shared socket of @ndisc, as if
+ * the socket received it. Like _shared_event_ready(), the socket is kept alive
+ * while dispatching. */
+void
+nmtst_lndp_ndisc_shared_receive_ra(NMNDisc *ndisc, int ifindex, const struct in6_addr *gateway)
+{
+    NMLndpShared *  shared = NM_LNDP_NDISC_GET_PRIVATE(ndisc)->shared;
+    struct ndp_msg *msg;
+
+    g_assert(shared);
+
+    if (ndp_msg_new(&msg, NDP_MSG_RA) != 0)
+        g_assert_not_reached();
+    ndp_msg_ifindex_set(msg, ifindex);
+    *ndp_msg_addrto(msg) = *gateway;
+    ndp_msgra_router_lifetime_set(ndp_msgra(msg), 1800);
+
+    shared->ref_count++;
+    _shared_receive(shared->ndp, msg, shared);
+    _shared_unref(shared);
+
+    ndp_msg_destroy(msg);
+}
+
+/*****************************************************************************/
+
 static gboolean
 event_ready(int fd, GIOCondition condition, gpointer user_data)
 {
@@ -595,6 +793,13 @@ start(NMNDisc *ndisc)
     NMLndpNDiscPrivate *priv = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
     int                 fd;
 
+    if (priv->shared) {
+        /* The shared socket is already dispatched, but messages for us were
+         * dropped until now. */
+        priv->shared_started = TRUE;
+        return;
+    }
+
     g_return_if_fail(!priv->event_source);
 
     fd = ndp_get_eventfd(priv->ndp);
@@ -631,6 +836,13 @@ _cleanup(NMNDisc *ndisc)
 {
     NMLndpNDiscPrivate *priv = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
 
+    if (priv->shared) {
+        _shared_release(g_steal_pointer(&priv->shared), nm_ndisc_get_ifindex(ndisc));
+        priv->shared_started = FALSE;
+        priv->ndp            = NULL;
+        return;
+    }
+
     nm_clear_g_source_inst(&priv->event_source);
 
     if (priv->ndp) {
@@ -742,6 +954,7 @@ nm_lndp_ndisc_new(NMPlatform *                  platform,
                   NMSettingIP6ConfigAddrGenMode addr_gen_mode,
                   NMNDiscNodeType               node_type,
                   int                           max_addresses,
+                  guint                         max_routes,
                   int                           router_solicitations,
                   int                           router_solicitation_interval,
                   guint32                       ra_timeout,
@@ -776,6 +989,8 @@ nm_lndp_ndisc_new(NMPlatform *                  platform,
                          (int) node_type,
                          NM_NDISC_MAX_ADDRESSES,
                          max_addresses,
+                         NM_NDISC_MAX_ROUTES,
+                         max_routes,
                          NM_NDISC_ROUTER_SOLICITATIONS,
                          router_solicitations,
                          NM_NDISC_ROUTER_SOLICITATION_INTERVAL,
@@ -786,6 +1001,12 @@ nm_lndp_ndisc_new(NMPlatform *                  platform,
 
     priv = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
 
+    priv->shared = _shared_acquire(nm_platform_netns_get(platform), ifindex, ndisc);
+    if (priv->shared) {
+        priv->ndp = priv->shared->ndp;
+        return ndisc;
+    }
+
     errsv = ndp_open(&priv->ndp);
 
     if (errsv != 0) {
@@ -799,6 +1020,10 @@ nm_lndp_ndisc_new(NMPlatform *                  platform,
         g_object_unref(ndisc);
         return NULL;
     }
+
+    _ndp_set_icmp6_filter(priv->ndp,
+                          node_type == NM_NDISC_NODE_TYPE_HOST,
+                          node_type == NM_NDISC_NODE_TYPE_ROUTER);
     return ndisc;
 }
 
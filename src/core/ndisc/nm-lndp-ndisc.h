@@ -31,6 +31,7 @@ NMNDisc *nm_lndp_ndisc_new(NMPlatform *                  platform,
                            NMSettingIP6ConfigAddrGenMode addr_gen_mode,
                            NMNDiscNodeType               node_type,
                            int                           max_addresses,
+                           guint                         max_routes,
                            int                           router_solicitations,
                            int                           router_solicitation_interval,
                            guint32                       ra_timeout,
@@ -43,4 +44,11 @@ void nm_lndp_ndisc_get_sysctl(NMPlatform *platform,
                               int *       out_router_solicitation_interval,
                               guint32 *   out_default_ra_timeout);
 
+/*****************************************************************************/
+
+gboolean nmtst_lndp_ndisc_is_shared(NMNDisc *ndisc);
+
+void
+nmtst_lndp_ndisc_shared_receive_ra(NMNDisc *ndisc, int ifindex, const struct in6_addr *gateway);
+
 #endif /* __NETWORKMANAGER_LNDP_NDISC_H__ */
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <arpa/inet.h>
 
+#include "c-list/src/c-list.h"
 #include "nm-setting-ip6-config.h"
 
 #include "nm-ndisc-private.h"
@@ -49,6 +50,18 @@ struct _NMNDiscPrivate {
 
     GSource *timeout_expire_source;
 
+    /* The routes, indexed by network and prefix length, and in the order
+     * of rdata.routes. rdata.routes is only a copy that gets updated before
+     * the data is published. */
+    GHashTable *routes_idx;
+    CList       routes_lst_head;
+    guint       routes_n_by_prio[4];
+    bool        routes_dirty;
+
+    /* A lower bound for the expiry of rdata.routes. The routes only get
+     * scanned for expired entries, once this timestamp is reached. */
+    gint64 routes_expiry_msec;
+
     NMUtilsIPv6IfaceId iid;
 
     /* immutable values: */
@@ -56,6 +69,7 @@ struct _NMNDiscPrivate {
     char *                        ifname;
     char *                        network_id;
     guint                         max_addresses;
+    guint                         max_routes;
     NMSettingIP6ConfigAddrGenMode addr_gen_mode;
     NMUtilsStableType             stable_type;
     guint32                       ra_timeout;
@@ -76,6 +90,7 @@ NM_GOBJECT_PROPERTIES_DEFINE_BASE(PROP_PLATFORM,
                                   PROP_NETWORK_ID,
                                   PROP_ADDR_GEN_MODE,
                                   PROP_MAX_ADDRESSES,
+                                  PROP_MAX_ROUTES,
                                   PROP_RA_TIMEOUT,
                                   PROP_ROUTER_SOLICITATIONS,
                                   PROP_ROUTER_SOLICITATION_INTERVAL,
@@ -271,6 +286,132 @@ _get_exp(char *buf, gsize buf_size, gint64 now_msec, gint64 expiry_time)
 
 /*****************************************************************************/
 
+typedef struct {
+    CList        routes_lst;
+    NMNDiscRoute route;
+} RouteEntry;
+
+static guint
+_route_entry_hash(gconstpointer ptr)
+{
+    const RouteEntry *entry = ptr;
+    NMHashState       h;
+
+    nm_hash_init(&h, 1930465477u);
+    nm_hash_update_valp(&h, &entry->route.network);
+    nm_hash_update_val(&h, entry->route.plen);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_route_entry_equal(gconstpointer a, gconstpointer b)
+{
+    const RouteEntry *entry_a = a;
+    const RouteEntry *entry_b = b;
+
+    return entry_a->route.plen == entry_b->route.plen
+           && IN6_ARE_ADDR_EQUAL(&entry_a->route.network, &entry_b->route.network);
+}
+
+static void
+_route_entry_free(gpointer ptr)
+{
+    RouteEntry *entry = ptr;
+
+    c_list_unlink_stale(&entry->routes_lst);
+    nm_g_slice_free(entry);
+}
+
+static RouteEntry *
+_routes_lookup(NMNDiscPrivate *priv, const struct in6_addr *network, guint8 plen)
+{
+    const RouteEntry needle = {
+        .route.network = *network,
+        .route.plen    = plen,
+    };
+
+    return g_hash_table_lookup(priv->routes_idx, &needle);
+}
+
+static void
+_routes_insert(NMNDiscPrivate *priv, const NMNDiscRoute *route)
+{
+    RouteEntry *entry;
+    RouteEntry *entry_before = NULL;
+    int         prio         = _preference_to_priority(route->preference);
+    int         p;
+
+    /* Put before less preferable routes, otherwise first. Only look for
+     * the position if there are less preferable routes at all. */
+    for (p = 0; p < prio; p++) {
+        if (priv->routes_n_by_prio[p] > 0)
+            break;
+    }
+    if (p < prio) {
+        c_list_for_each_entry (entry, &priv->routes_lst_head, routes_lst) {
+            if (_preference_to_priority(entry->route.preference) < prio) {
+                entry_before = entry;
+                break;
+            }
+        }
+    }
+
+    entry  = g_slice_new(RouteEntry);
+    *entry = (RouteEntry){
+        .route = *route,
+    };
+    if (entry_before)
+        c_list_link_before(&entry_before->routes_lst, &entry->routes_lst);
+    else
+        c_list_link_front(&priv->routes_lst_head, &entry->routes_lst);
+    if (!g_hash_table_add(priv->routes_idx, entry))
+        nm_assert_not_reached();
+
+    priv->routes_n_by_prio[prio]++;
+    priv->routes_dirty       = TRUE;
+    priv->routes_expiry_msec = NM_MIN(priv->routes_expiry_msec, route->expiry_msec);
+}
+
+static void
+_routes_remove(NMNDiscPrivate *priv, RouteEntry *entry)
+{
+    nm_assert(priv->routes_n_by_prio[_preference_to_priority(entry->route.preference)] > 0);
+
+    priv->routes_n_by_prio[_preference_to_priority(entry->route.preference)]--;
+    priv->routes_dirty = TRUE;
+    g_hash_table_remove(priv->routes_idx, entry);
+}
+
+static void
+_routes_clear(NMNDiscPrivate *priv)
+{
+    g_hash_table_remove_all(priv->routes_idx);
+    memset(priv->routes_n_by_prio, 0, sizeof(priv->routes_n_by_prio));
+    priv->routes_expiry_msec = NM_NDISC_EXPIRY_INFINITY;
+    priv->routes_dirty       = FALSE;
+    g_array_set_size(priv->rdata.routes, 0);
+}
+
+static void
+_routes_sync(NMNDiscPrivate *priv)
+{
+    GArray *    routes = priv->rdata.routes;
+    RouteEntry *entry;
+    guint       i = 0;
+
+    if (!priv->routes_dirty)
+        return;
+
+    priv->routes_dirty = FALSE;
+
+    g_array_set_size(routes, g_hash_table_size(priv->routes_idx));
+    c_list_for_each_entry (entry, &priv->routes_lst_head, routes_lst)
+        g_array_index(routes, NMNDiscRoute, i++) = entry->route;
+    nm_assert(i == routes->len);
+}
+
+/*****************************************************************************/
+
 NMPNetns *
 nm_ndisc_netns_get(NMNDisc *self)
 {
@@ -382,6 +523,7 @@ _data_complete(NMNDiscDataInternal *data)
 void
 nm_ndisc_emit_config_change(NMNDisc *self, NMNDiscConfigMap changed)
 {
+    _routes_sync(NM_NDISC_GET_PRIVATE(self));
     _config_changed_log(self, changed);
     g_signal_emit(self,
                   signals[CONFIG_RECEIVED],
@@ -628,11 +770,9 @@ nm_ndisc_complete_and_add_address(NMNDisc *ndisc, const NMNDiscAddress *new_item
 gboolean
 nm_ndisc_add_route(NMNDisc *ndisc, const NMNDiscRoute *new_item, gint64 now_msec)
 {
-    NMNDiscPrivate *     priv;
-    NMNDiscDataInternal *rdata;
-    guint                i;
-    guint                insert_idx = G_MAXUINT;
-    gboolean             changed    = FALSE;
+    NMNDiscPrivate *priv;
+    RouteEntry *    entry;
+    gboolean        changed = FALSE;
 
     if (new_item->plen == 0 || new_item->plen > 128) {
         /* Only expect non-default routes.  The router has no idea what the
@@ -645,52 +785,43 @@ nm_ndisc_add_route(NMNDisc *ndisc, const NMNDiscRoute *new_item, gint64 now_msec
         g_return_val_if_reached(FALSE);
     }
 
-    priv  = NM_NDISC_GET_PRIVATE(ndisc);
-    rdata = &priv->rdata;
-
-    for (i = 0; i < rdata->routes->len;) {
-        NMNDiscRoute *item = &g_array_index(rdata->routes, NMNDiscRoute, i);
+    priv = NM_NDISC_GET_PRIVATE(ndisc);
 
-        if (IN6_ARE_ADDR_EQUAL(&item->network, &new_item->network)
-            && item->plen == new_item->plen) {
-            if (new_item->expiry_msec <= now_msec) {
-                g_array_remove_index(rdata->routes, i);
-                return TRUE;
-            }
+    entry = _routes_lookup(priv, &new_item->network, new_item->plen);
+    if (entry) {
+        NMNDiscRoute *item = &entry->route;
 
-            if (item->preference != new_item->preference) {
-                g_array_remove_index(rdata->routes, i);
-                changed = TRUE;
-                continue;
-            }
+        if (new_item->expiry_msec <= now_msec) {
+            _routes_remove(priv, entry);
+            return TRUE;
+        }
 
+        if (item->preference != new_item->preference) {
+            _routes_remove(priv, entry);
+            changed = TRUE;
+        } else {
             if (item->expiry_msec == new_item->expiry_msec
                 && IN6_ARE_ADDR_EQUAL(&item->gateway, &new_item->gateway))
                 return FALSE;
 
             item->expiry_msec = new_item->expiry_msec;
             item->gateway     = new_item->gateway;
+
+            priv->routes_dirty       = TRUE;
+            priv->routes_expiry_msec = NM_MIN(priv->routes_expiry_msec, item->expiry_msec);
             return TRUE;
         }
-
-        /* Put before less preferable routes. */
-        if (_preference_to_priority(item->preference)
-                < _preference_to_priority(new_item->preference)
-            && insert_idx == G_MAXUINT)
-            insert_idx = i;
-
-        i++;
     }
 
-    if (rdata->routes->len >= _SIZE_MAX_ROUTES)
-        return FALSE;
+    if (g_hash_table_size(priv->routes_idx) >= priv->max_routes)
+        return changed;
 
     if (new_item->expiry_msec <= now_msec) {
         nm_assert(!changed);
         return FALSE;
     }
 
-    g_array_insert_val(rdata->routes, insert_idx == G_MAXUINT ? 0u : insert_idx, *new_item);
+    _routes_insert(priv, new_item);
     return TRUE;
 }
 
@@ -1144,7 +1275,7 @@ nm_ndisc_stop(NMNDisc *ndisc)
 
     g_array_set_size(rdata->gateways, 0);
     g_array_set_size(rdata->addresses, 0);
-    g_array_set_size(rdata->routes, 0);
+    _routes_clear(priv);
     g_array_set_size(rdata->dns_servers, 0);
     g_array_set_size(rdata->dns_domains, 0);
     priv->rdata.public.hop_limit = 64;
@@ -1240,7 +1371,7 @@ _config_changed_log(NMNDisc *ndisc, NMNDiscConfigMap changed)
     char                 str_exp[100];
     gint64               now_msec;
 
-    if (!_LOGD_ENABLED())
+    if (!nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN))
         return;
 
     now_msec = nm_utils_get_monotonic_timestamp_msec();
@@ -1382,29 +1513,33 @@ clean_addresses(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gint
 static void
 clean_routes(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gint64 *next_msec)
 {
-    NMNDiscDataInternal *rdata = &NM_NDISC_GET_PRIVATE(ndisc)->rdata;
-    NMNDiscRoute *       arr;
-    guint                i;
-    guint                j;
+    NMNDiscPrivate *     priv  = NM_NDISC_GET_PRIVATE(ndisc);
+    NMNDiscDataInternal *rdata = &priv->rdata;
+    RouteEntry *         entry;
+    RouteEntry *         entry_safe;
+    gint64               expiry_msec;
 
-    if (rdata->routes->len == 0)
+    if (c_list_is_empty(&priv->routes_lst_head))
         return;
 
-    arr = &g_array_index(rdata->routes, NMNDiscRoute, 0);
-
-    for (i = 0, j = 0; i < rdata->routes->len; i++) {
-        if (!expiry_next(now_msec, arr[i].expiry_msec, next_msec))
-            continue;
-        if (i != j)
-            arr[j] = arr[i];
-        j++;
+    if (priv->routes_expiry_msec > now_msec) {
+        /* nothing expired yet. */
+        expiry_next(now_msec, priv->routes_expiry_msec, next_msec);
+        return;
     }
 
-    if (i != j) {
+    expiry_msec = NM_NDISC_EXPIRY_INFINITY;
+
+    c_list_for_each_entry_safe (entry, entry_safe, &priv->routes_lst_head, routes_lst) {
+        if (expiry_next(now_msec, entry->route.expiry_msec, &expiry_msec))
+            continue;
+        _routes_remove(priv, entry);
         *changed |= NM_NDISC_CONFIG_ROUTES;
-        g_array_set_size(rdata->routes, j);
     }
 
+    priv->routes_expiry_msec = expiry_msec;
+    expiry_next(now_msec, expiry_msec, next_msec);
+
     if (_array_set_size_max(rdata->gateways, _SIZE_MAX_ROUTES))
         *changed |= NM_NDISC_CONFIG_ROUTES;
 }
@@ -1629,6 +1764,12 @@ set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *ps
         else if (priv->max_addresses > 3u * _SIZE_MAX_ADDRESSES)
             priv->max_addresses = 3u * _SIZE_MAX_ADDRESSES;
         break;
+    case PROP_MAX_ROUTES:
+        /* construct-only */
+        priv->max_routes = g_value_get_uint(value);
+        if (priv->max_routes == 0)
+            priv->max_routes = NM_NDISC_MAX_ROUTES_DEFAULT;
+        break;
     case PROP_RA_TIMEOUT:
         /* construct-only */
         priv->ra_timeout = g_value_get_uint(value);
@@ -1671,6 +1812,14 @@ nm_ndisc_init(NMNDisc *ndisc)
     rdata->dns_domains = g_array_new(FALSE, FALSE, sizeof(NMNDiscDNSDomain));
     g_array_set_clear_func(rdata->dns_domains, dns_domain_free);
     priv->rdata.public.hop_limit = 64;
+
+    priv->routes_idx = g_hash_table_new_full(_route_entry_hash,
+                                             _route_entry_equal,
+                                             _route_entry_free,
+                                             NULL);
+    c_list_init(&priv->routes_lst_head);
+
+    priv->routes_expiry_msec = NM_NDISC_EXPIRY_INFINITY;
 }
 
 static void
@@ -1702,6 +1851,7 @@ finalize(GObject *object)
     g_array_unref(rdata->gateways);
     g_array_unref(rdata->addresses);
     g_array_unref(rdata->routes);
+    g_hash_table_unref(priv->routes_idx);
     g_array_unref(rdata->dns_servers);
     g_array_unref(rdata->dns_domains);
 
@@ -1772,6 +1922,14 @@ nm_ndisc_class_init(NMNDiscClass *klass)
                          G_MAXINT32,
                          NM_NDISC_MAX_ADDRESSES_DEFAULT,
                          G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+    obj_properties[PROP_MAX_ROUTES] =
+        g_param_spec_uint(NM_NDISC_MAX_ROUTES,
+                          "",
+                          "",
+                          0,
+                          G_MAXUINT32,
+                          NM_NDISC_MAX_ROUTES_DEFAULT,
+                          G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
     G_STATIC_ASSERT_EXPR(G_MAXINT32 == NM_RA_TIMEOUT_INFINITY);
     obj_properties[PROP_RA_TIMEOUT] =
         g_param_spec_uint(NM_NDISC_RA_TIMEOUT,
@@ -34,6 +34,7 @@
 #define NM_NDISC_STABLE_TYPE                  "stable-type"
 #define NM_NDISC_NODE_TYPE                    "node-type"
 #define NM_NDISC_MAX_ADDRESSES                "max-addresses"
+#define NM_NDISC_MAX_ROUTES                   "max-routes"
 #define NM_NDISC_RA_TIMEOUT                   "ra-timeout"
 #define NM_NDISC_ROUTER_SOLICITATIONS         "router-solicitations"
 #define NM_NDISC_ROUTER_SOLICITATION_INTERVAL "router-solicitation-interval"
@@ -159,6 +160,7 @@ typedef enum {
 #define NM_NDISC_RFC4861_MAX_RTR_SOLICITATION_DELAY 1 /* seconds */
 
 #define NM_NDISC_MAX_ADDRESSES_DEFAULT          16
+#define NM_NDISC_MAX_ROUTES_DEFAULT             1000
 #define NM_NDISC_ROUTER_SOLICITATIONS_DEFAULT   3 /* RFC4861, MAX_RTR_SOLICITATIONS */
 #define NM_NDISC_ROUTER_ADVERTISEMENTS_DEFAULT  3 /* RFC4861, MAX_INITIAL_RTR_ADVERTISEMENTS */
 #define NM_NDISC_ROUTER_ADVERT_DELAY            3 /* RFC4861, MIN_DELAY_BETWEEN_RAS */
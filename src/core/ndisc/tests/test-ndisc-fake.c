@@ -632,6 +632,122 @@ test_dns_solicit_loop(void)
 
 /*****************************************************************************/
 
+#define MANY_ROUTES_N 1200
+
+static void
+_many_routes_network(char *buf, gsize len, guint i)
+{
+    g_snprintf(buf, len, "2001:db8:%x::", i);
+}
+
+static void
+test_many_routes_changed(NMNDisc *          ndisc,
+                         const NMNDiscData *rdata,
+                         guint              changed_int,
+                         TestData *         data)
+{
+    NMNDiscConfigMap changed = changed_int;
+    char             network[INET6_ADDRSTRLEN];
+
+    switch (data->counter++) {
+    case 0:
+        g_assert(changed & NM_NDISC_CONFIG_ROUTES);
+
+        /* only up to the default limit of routes is accepted, the latest first. */
+        g_assert_cmpint(rdata->routes_n, ==, NM_NDISC_MAX_ROUTES_DEFAULT);
+        _many_routes_network(network, sizeof(network), NM_NDISC_MAX_ROUTES_DEFAULT - 1);
+        match_route(rdata, 0, network, 56, "fe80::1", data->timestamp_msec_1 + 10000, 10);
+        _many_routes_network(network, sizeof(network), 0);
+        match_route(rdata,
+                    NM_NDISC_MAX_ROUTES_DEFAULT - 1,
+                    network,
+                    56,
+                    "fe80::1",
+                    data->timestamp_msec_1 + 10000,
+                    10);
+        break;
+    case 1:
+        /* the refreshed routes are unchanged, only the withdrawn one is gone. */
+        g_assert_cmpint(changed, ==, NM_NDISC_CONFIG_ROUTES);
+        g_assert_cmpint(rdata->routes_n, ==, NM_NDISC_MAX_ROUTES_DEFAULT - 1);
+        _many_routes_network(network, sizeof(network), 6);
+        match_route(rdata,
+                    NM_NDISC_MAX_ROUTES_DEFAULT - 7,
+                    network,
+                    56,
+                    "fe80::1",
+                    data->timestamp_msec_1 + 10000,
+                    10);
+        _many_routes_network(network, sizeof(network), 4);
+        match_route(rdata,
+                    NM_NDISC_MAX_ROUTES_DEFAULT - 6,
+                    network,
+                    56,
+                    "fe80::1",
+                    data->timestamp_msec_1 + 10000,
+                    10);
+
+        g_assert(nm_fake_ndisc_done(NM_FAKE_NDISC(ndisc)));
+        g_main_loop_quit(data->loop);
+        break;
+    default:
+        g_assert_not_reached();
+    }
+}
+
+static void
+test_many_routes(void)
+{
+    nm_auto_unref_gmainloop GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    gs_unref_object NMFakeNDisc *ndisc      = ndisc_new();
+    const gint64                 now_msec   = nm_utils_get_monotonic_timestamp_msec();
+    TestData                     data       = {
+        .loop             = loop,
+        .timestamp_msec_1 = now_msec,
+    };
+    char  network[INET6_ADDRSTRLEN];
+    guint id;
+    guint i;
+
+    /* Routers announcing many Route Information Options. */
+
+    id = nm_fake_ndisc_add_ra(ndisc, 1, NM_NDISC_DHCP_LEVEL_NONE, 4, 1500);
+    g_assert(id);
+    for (i = 0; i < MANY_ROUTES_N; i++) {
+        _many_routes_network(network, sizeof(network), i);
+        nm_fake_ndisc_add_prefix(ndisc,
+                                 id,
+                                 network,
+                                 56,
+                                 "fe80::1",
+                                 now_msec + 10000,
+                                 now_msec + 10000,
+                                 10);
+    }
+
+    id = nm_fake_ndisc_add_ra(ndisc, 1, NM_NDISC_DHCP_LEVEL_NONE, 4, 1500);
+    g_assert(id);
+    for (i = 0; i < 10; i++) {
+        _many_routes_network(network, sizeof(network), i);
+        nm_fake_ndisc_add_prefix(ndisc,
+                                 id,
+                                 network,
+                                 56,
+                                 "fe80::1",
+                                 i == 5 ? now_msec : now_msec + 10000,
+                                 i == 5 ? now_msec : now_msec + 10000,
+                                 10);
+    }
+
+    g_signal_connect(ndisc, NM_NDISC_CONFIG_RECEIVED, G_CALLBACK(test_many_routes_changed), &data);
+
+    nm_ndisc_start(NM_NDISC(ndisc));
+    nmtst_main_loop_run_assert(data.loop, 15000);
+    g_assert_cmpint(data.counter, ==, 2);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -652,6 +768,7 @@ main(int argc, char **argv)
     g_test_add_func("/ndisc/preference-order", test_preference_order);
     g_test_add_func("/ndisc/preference-changed", test_preference_changed);
     g_test_add_func("/ndisc/dns-solicit-loop", test_dns_solicit_loop);
+    g_test_add_func("/ndisc/many-routes", test_many_routes);
 
     return g_test_run();
 }
@@ -64,6 +64,7 @@ main(int argc, char **argv)
                               NM_SETTING_IP6_CONFIG_ADDR_GEN_MODE_EUI64,
                               NM_NDISC_NODE_TYPE_HOST,
                               max_addresses,
+                              0,
                               router_solicitations,
                               router_solicitation_interval,
                               ra_timeout,
@@ -0,0 +1,257 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include <sched.h>
+
+#include "ndisc/nm-ndisc.h"
+#include "ndisc/nm-lndp-ndisc.h"
+
+#include "platform/nm-fake-platform.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    NMNDisc *ndisc;
+    guint    counter;
+    gboolean unref_self;
+    NMNDisc *unref_other;
+} ReceivedData;
+
+static NMNDisc *
+_ndisc_new(int ifindex)
+{
+    gs_free_error GError *error = NULL;
+    gs_free char *        ifname = g_strdup_printf("nmtst%d", ifindex);
+    NMNDisc *             ndisc;
+
+    ndisc = nm_lndp_ndisc_new(NM_PLATFORM_GET,
+                              ifindex,
+                              ifname,
+                              NM_UTILS_STABLE_TYPE_UUID,
+                              "8ce666e8-d34d-4fb1-b858-f15a7a128086",
+                              NM_SETTING_IP6_CONFIG_ADDR_GEN_MODE_EUI64,
+                              NM_NDISC_NODE_TYPE_HOST,
+                              NM_NDISC_MAX_ADDRESSES_DEFAULT,
+                              0,
+                              NM_NDISC_ROUTER_SOLICITATIONS_DEFAULT,
+                              NM_NDISC_RFC4861_RTR_SOLICITATION_INTERVAL,
+                              30,
+                              &error);
+    nmtst_assert_success(ndisc, error);
+    return ndisc;
+}
+
+static gboolean
+_can_open_socket(void)
+{
+    gs_free_error GError *error = NULL;
+    NMNDisc *             ndisc;
+
+    ndisc = nm_lndp_ndisc_new(NM_PLATFORM_GET,
+                              1,
+                              "lo",
+                              NM_UTILS_STABLE_TYPE_UUID,
+                              "8ce666e8-d34d-4fb1-b858-f15a7a128086",
+                              NM_SETTING_IP6_CONFIG_ADDR_GEN_MODE_EUI64,
+                              NM_NDISC_NODE_TYPE_HOST,
+                              NM_NDISC_MAX_ADDRESSES_DEFAULT,
+                              0,
+                              NM_NDISC_ROUTER_SOLICITATIONS_DEFAULT,
+                              NM_NDISC_RFC4861_RTR_SOLICITATION_INTERVAL,
+                              30,
+                              &error);
+    if (!ndisc) {
+        g_test_skip(error->message);
+        return FALSE;
+    }
+    g_object_unref(ndisc);
+    return TRUE;
+}
+
+static void
+_config_received_cb(NMNDisc *ndisc, const NMNDiscData *rdata, guint changed, ReceivedData *data)
+{
+    g_assert(ndisc == data->ndisc);
+    g_assert(NM_FLAGS_HAS(changed, NM_NDISC_CONFIG_GATEWAYS));
+
+    data->counter++;
+
+    if (data->unref_other)
+        g_object_unref(g_steal_pointer(&data->unref_other));
+    if (data->unref_self) {
+        data->unref_self = FALSE;
+        g_object_unref(ndisc);
+    }
+}
+
+static void
+_received_data_init(ReceivedData *data, NMNDisc *ndisc)
+{
+    *data = (ReceivedData){
+        .ndisc = ndisc,
+    };
+    g_signal_connect(ndisc, NM_NDISC_CONFIG_RECEIVED, G_CALLBACK(_config_received_cb), data);
+}
+
+/*****************************************************************************/
+
+static void
+test_shared_dispatch(void)
+{
+    gs_unref_object NMNDisc *ndisc1 = NULL;
+    gs_unref_object NMNDisc *ndisc2 = NULL;
+    gs_unref_object NMNDisc *ndisc3 = NULL;
+    ReceivedData             data1;
+    ReceivedData             data2;
+    ReceivedData             data3;
+    const struct in6_addr    gateway = *nmtst_inet6_from_string("fe80::1");
+
+    if (!_can_open_socket())
+        return;
+
+    ndisc1 = _ndisc_new(11);
+    ndisc2 = _ndisc_new(12);
+    ndisc3 = _ndisc_new(13);
+    g_assert(nmtst_lndp_ndisc_is_shared(ndisc1));
+    g_assert(nmtst_lndp_ndisc_is_shared(ndisc2));
+    g_assert(nmtst_lndp_ndisc_is_shared(ndisc3));
+
+    _received_data_init(&data1, ndisc1);
+    _received_data_init(&data2, ndisc2);
+    _received_data_init(&data3, ndisc3);
+
+    nm_ndisc_start(ndisc1);
+    nm_ndisc_start(ndisc2);
+
+    /* each message goes only to the instance of its ifindex. */
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1, 12, &gateway);
+    g_assert_cmpint(data1.counter, ==, 0);
+    g_assert_cmpint(data2.counter, ==, 1);
+    g_assert_cmpint(data3.counter, ==, 0);
+
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc2, 11, &gateway);
+    g_assert_cmpint(data1.counter, ==, 1);
+    g_assert_cmpint(data2.counter, ==, 1);
+    g_assert_cmpint(data3.counter, ==, 0);
+
+    /* messages for an instance that is not started, or for an unknown
+     * ifindex, are dropped. */
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1, 13, &gateway);
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1, 14, &gateway);
+    g_assert_cmpint(data1.counter, ==, 1);
+    g_assert_cmpint(data2.counter, ==, 1);
+    g_assert_cmpint(data3.counter, ==, 0);
+
+    nm_ndisc_start(ndisc3);
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1, 13, &gateway);
+    g_assert_cmpint(data3.counter, ==, 1);
+}
+
+static void
+test_shared_fallback(void)
+{
+    gs_unref_object NMNDisc *ndisc1  = NULL;
+    gs_unref_object NMNDisc *ndisc1b = NULL;
+    gs_unref_object NMNDisc *ndisc1c = NULL;
+    ReceivedData             data1b;
+    ReceivedData             data1c;
+    const struct in6_addr    gateway = *nmtst_inet6_from_string("fe80::1");
+
+    if (!_can_open_socket())
+        return;
+
+    /* the second instance on an ifindex gets a socket of its own. */
+    ndisc1  = _ndisc_new(11);
+    ndisc1b = _ndisc_new(11);
+    g_assert(nmtst_lndp_ndisc_is_shared(ndisc1));
+    g_assert(!nmtst_lndp_ndisc_is_shared(ndisc1b));
+
+    /* once the ifindex is free again, a new instance shares the socket. */
+    g_clear_object(&ndisc1);
+    ndisc1c = _ndisc_new(11);
+    g_assert(nmtst_lndp_ndisc_is_shared(ndisc1c));
+
+    _received_data_init(&data1b, ndisc1b);
+    _received_data_init(&data1c, ndisc1c);
+    nm_ndisc_start(ndisc1b);
+    nm_ndisc_start(ndisc1c);
+
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1c, 11, &gateway);
+    g_assert_cmpint(data1b.counter, ==, 0);
+    g_assert_cmpint(data1c.counter, ==, 1);
+}
+
+static void
+test_shared_release_in_dispatch(void)
+{
+    gs_unref_object NMNDisc *ndisc3 = NULL;
+    NMNDisc *                ndisc1;
+    NMNDisc *                ndisc2;
+    ReceivedData             data1;
+    ReceivedData             data2;
+    const struct in6_addr    gateway  = *nmtst_inet6_from_string("fe80::1");
+    const struct in6_addr    gateway2 = *nmtst_inet6_from_string("fe80::2");
+
+    if (!_can_open_socket())
+        return;
+
+    ndisc1 = _ndisc_new(11);
+    ndisc2 = _ndisc_new(12);
+    ndisc3 = _ndisc_new(13);
+    g_object_add_weak_pointer(G_OBJECT(ndisc1), (gpointer *) &ndisc1);
+    g_object_add_weak_pointer(G_OBJECT(ndisc2), (gpointer *) &ndisc2);
+
+    _received_data_init(&data1, ndisc1);
+    _received_data_init(&data2, ndisc2);
+    nm_ndisc_start(ndisc1);
+    nm_ndisc_start(ndisc2);
+    nm_ndisc_start(ndisc3);
+
+    /* while handling its message, the first instance drops the second one. */
+    data1.unref_other = ndisc2;
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1, 11, &gateway);
+    g_assert_cmpint(data1.counter, ==, 1);
+    g_assert(!ndisc2);
+
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1, 12, &gateway);
+    g_assert_cmpint(data2.counter, ==, 0);
+
+    /* ... and then itself, as the last user of the shared socket. The socket
+     * is only closed after dispatching. */
+    g_clear_object(&ndisc3);
+    data1.unref_self = TRUE;
+    nmtst_lndp_ndisc_shared_receive_ra(ndisc1, 11, &gateway2);
+    g_assert_cmpint(data1.counter, ==, 2);
+    g_assert(!ndisc1);
+
+    /* a new instance opens the shared socket again. */
+    ndisc3 = _ndisc_new(13);
+    g_assert(nmtst_lndp_ndisc_is_shared(ndisc3));
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE();
+
+int
+main(int argc, char **argv)
+{
+    /* libndp needs a raw socket, which requires CAP_NET_RAW. As unprivileged
+     * user, try to get that in a new user and network namespace. Otherwise
+     * the tests are skipped. */
+    if (geteuid() != 0)
+        (void) unshare(CLONE_NEWUSER | CLONE_NEWNET);
+
+    nmtst_init_with_logging(&argc, &argv, NULL, "DEFAULT");
+
+    nm_fake_platform_setup();
+
+    g_test_add_func("/ndisc/lndp/shared-dispatch", test_shared_dispatch);
+    g_test_add_func("/ndisc/lndp/shared-fallback", test_shared_fallback);
+    g_test_add_func("/ndisc/lndp/shared-release-in-dispatch", test_shared_release_in_dispatch);
+
+    return g_test_run();
+}
@@ -835,40 +835,54 @@ typedef struct {
 static const ConfigGroup config_groups[] = {
     {
         .group = NM_CONFIG_KEYFILE_GROUP_MAIN,
-        .keys  = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_MAIN_ASSUME_IPV6LL_ONLY,
+        .keys  = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_MAIN_ACD_SHARED_SOCKET,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_ASSUME_IPV6LL_ONLY,
                              NM_CONFIG_KEYFILE_KEY_MAIN_AUTH_POLKIT,
                              NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_RETRIES_DEFAULT,
                              NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT,
                              NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG,
                              NM_CONFIG_KEYFILE_KEY_MAIN_DHCP,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_SHARED_SOCKET,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_BURST,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_JITTER,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_RATE,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DISPATCHER_COALESCE,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DISPATCHER_MAX_PARALLEL,
                              NM_CONFIG_KEYFILE_KEY_MAIN_DNS,
                              NM_CONFIG_KEYFILE_KEY_MAIN_HOSTNAME_MODE,
                              NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_CARRIER,
                              NM_CONFIG_KEYFILE_KEY_MAIN_MONITOR_CONNECTION_FILES,
                              NM_CONFIG_KEYFILE_KEY_MAIN_NO_AUTO_DEFAULT,
                              NM_CONFIG_KEYFILE_KEY_MAIN_PLUGINS,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_PRIVATE_CLIENT_SOCKET,
                              NM_CONFIG_KEYFILE_KEY_MAIN_RC_MANAGER,
                              NM_CONFIG_KEYFILE_KEY_MAIN_SLAVES_ORDER,
                              NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED, ),
     },
     {
         .group = NM_CONFIG_KEYFILE_GROUP_LOGGING,
-        .keys  = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT,
+        .keys  = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC,
+                             NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT,
                              NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND,
                              NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS,
+                             NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER_SIZE,
                              NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL, ),
     },
     {
         .group = NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
         .keys  = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_ENABLED,
                              NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_INTERVAL,
+                             NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_MAX_PARALLEL,
                              NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_RESPONSE,
+                             NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_REUSE_CONNECTIONS,
+                             NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_START_JITTER,
                              NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_URI, ),
     },
     {
         .group = NM_CONFIG_KEYFILE_GROUP_KEYFILE,
         .keys  = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_KEYFILE_HOSTNAME,
                              NM_CONFIG_KEYFILE_KEY_KEYFILE_PATH,
+                             NM_CONFIG_KEYFILE_KEY_KEYFILE_RELOAD_INCREMENTAL,
                              NM_CONFIG_KEYFILE_KEY_KEYFILE_UNMANAGED_DEVICES, ),
     },
     {
@@ -881,6 +895,7 @@ static const ConfigGroup config_groups[] = {
         .keys      = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_WAIT_TIMEOUT,
                              NM_CONFIG_KEYFILE_KEY_DEVICE_IGNORE_CARRIER,
                              NM_CONFIG_KEYFILE_KEY_DEVICE_MANAGED,
+                             NM_CONFIG_KEYFILE_KEY_DEVICE_NDISC_MAX_ROUTES,
                              NM_CONFIG_KEYFILE_KEY_DEVICE_SRIOV_NUM_VFS,
                              NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_BACKEND,
                              NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_SCAN_RAND_MAC_ADDRESS,
@@ -42,35 +42,49 @@
 #define NM_CONFIG_KEYFILE_GROUP_GLOBAL_DNS   "global-dns"
 #define NM_CONFIG_KEYFILE_GROUP_CONFIG       ".config"
 
+#define NM_CONFIG_KEYFILE_KEY_MAIN_ACD_SHARED_SOCKET           "acd-shared-socket"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_ASSUME_IPV6LL_ONLY          "assume-ipv6ll-only"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_AUTH_POLKIT                 "auth-polkit"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_RETRIES_DEFAULT "autoconnect-retries-default"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT          "configure-and-quit"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG                       "debug"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP                        "dhcp"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_SHARED_SOCKET          "dhcp-shared-socket"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_BURST            "dhcp-start-burst"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_JITTER           "dhcp-start-jitter"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_RATE             "dhcp-start-rate"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DISPATCHER_COALESCE         "dispatcher-coalesce"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DISPATCHER_MAX_PARALLEL     "dispatcher-max-parallel"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DNS                         "dns"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_HOSTNAME_MODE               "hostname-mode"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_CARRIER              "ignore-carrier"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_MONITOR_CONNECTION_FILES    "monitor-connection-files"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_NO_AUTO_DEFAULT             "no-auto-default"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_PLUGINS                     "plugins"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_PRIVATE_CLIENT_SOCKET       "private-client-socket"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_RC_MANAGER                  "rc-manager"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SLAVES_ORDER                "slaves-order"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED            "systemd-resolved"
 
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT   "audit"
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND "backend"
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS "domains"
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL   "level"
-
-#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_ENABLED  "enabled"
-#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_INTERVAL "interval"
-#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_RESPONSE "response"
-#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_URI      "uri"
-
-#define NM_CONFIG_KEYFILE_KEY_KEYFILE_PATH              "path"
-#define NM_CONFIG_KEYFILE_KEY_KEYFILE_UNMANAGED_DEVICES "unmanaged-devices"
-#define NM_CONFIG_KEYFILE_KEY_KEYFILE_HOSTNAME          "hostname"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC                "async"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT                "audit"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND              "backend"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS              "domains"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER_SIZE "flight-recorder-size"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL                "level"
+
+#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_ENABLED           "enabled"
+#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_INTERVAL          "interval"
+#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_MAX_PARALLEL      "max-parallel"
+#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_RESPONSE          "response"
+#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_REUSE_CONNECTIONS "reuse-connections"
+#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_START_JITTER      "start-jitter"
+#define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_URI               "uri"
+
+#define NM_CONFIG_KEYFILE_KEY_KEYFILE_PATH               "path"
+#define NM_CONFIG_KEYFILE_KEY_KEYFILE_UNMANAGED_DEVICES  "unmanaged-devices"
+#define NM_CONFIG_KEYFILE_KEY_KEYFILE_HOSTNAME           "hostname"
+#define NM_CONFIG_KEYFILE_KEY_KEYFILE_RELOAD_INCREMENTAL "reload-incremental"
 
 #define NM_CONFIG_KEYFILE_KEY_IFUPDOWN_MANAGED "managed"
 
@@ -83,6 +97,7 @@
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_MANAGED                    "managed"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_IGNORE_CARRIER             "ignore-carrier"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_SRIOV_NUM_VFS              "sriov-num-vfs"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_NDISC_MAX_ROUTES           "ndisc-max-routes"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_BACKEND               "wifi.backend"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_SCAN_RAND_MAC_ADDRESS "wifi.scan-rand-mac-address"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_SCAN_GENERATE_MAC_ADDRESS_MASK \
@@ -24,6 +24,18 @@
 
 #define HEADER_STATUS_ONLINE "X-NetworkManager-Status: online\r\n"
 
+/* How long an unused per-interface context is kept, together with its idle
+ * keep-alive connections and cached addresses. curl itself closes connections
+ * that were idle for longer than 118 seconds. */
+#define CON_CONTEXT_IDLE_TIMEOUT_SEC 120
+
+/* With keep-alive, a check that succeeded before the whole response was
+ * received completes right away, and the rest of the response is read in the
+ * background, so that the connection can be reused. But not more than this,
+ * and not for longer than this. */
+#define CON_DRAIN_MAX         (16 * 1024)
+#define CON_DRAIN_TIMEOUT_SEC 20
+
 /*****************************************************************************/
 
 static NM_UTILS_LOOKUP_STR_DEFINE(_state_to_string,
@@ -57,6 +69,38 @@ typedef struct {
     char *response;
 } ConConfig;
 
+#if WITH_CONCHECK
+/* Checks on the same interface and for the same address family share a curl
+ * multi handle, and thereby its connection and DNS caches. */
+typedef struct {
+    NMConnectivity *self;
+    char *          ifspec;
+    CURLM *         curl_mhandle;
+    CList           sock_lst_head;
+    GSource *       idle_source;
+    guint           curl_timer;
+    guint           n_handles;
+    int             addr_family;
+
+    /* the transfers that read the rest of a response after their check
+     * completed. */
+    CList drain_lst_head;
+
+    NMConnectivityResolveCache resolve_cache;
+} ConContext;
+
+/* A transfer that outlives its check, until the rest of the response is read
+ * and curl can reuse the connection. */
+typedef struct {
+    CList              drain_lst;
+    ConContext *       ctx;
+    CURL *             curl_ehandle;
+    struct curl_slist *hosts;
+    GSource *          timeout_source;
+    gsize              drain_cnt;
+} ConDrain;
+#endif
+
 struct _NMConnectivityCheckHandle {
     CList                       handles_lst;
     NMConnectivity *            self;
@@ -70,18 +114,27 @@ struct _NMConnectivityCheckHandle {
 
 #if WITH_CONCHECK
     struct {
-        ConConfig *con_config;
+        ConConfig * con_config;
+        ConContext *ctx;
+
+        /* linked in the start queue, while the periodic check waits to start. */
+        NMConnectivityStartQueueEntry start_entry;
 
         GCancellable *     resolve_cancellable;
-        CURLM *            curl_mhandle;
         CURL *             curl_ehandle;
         struct curl_slist *request_headers;
         struct curl_slist *hosts;
 
         gsize response_good_cnt;
+        gsize drain_cnt;
+
+        NMConnectivityState verdict_state;
 
-        guint curl_timer;
-        int   ch_ifindex;
+        int ch_ifindex;
+
+        bool started : 1;
+        bool keepalive : 1;
+        bool transfer_done : 1;
     } concheck;
 #endif
 
@@ -110,8 +163,19 @@ typedef struct {
     ConConfig *con_config;
     guint      interval;
 
+    /* Periodic checks wait in the start queue, if the number of running checks
+     * is limited, or if their start is delayed by a random jitter. */
+    CList    start_lst_head;
+    GSource *start_source;
+    guint    n_running;
+    guint    max_parallel;
+    guint    start_jitter_msec;
+
+    GHashTable *contexts;
+
     bool enabled : 1;
     bool uri_valid : 1;
+    bool reuse_connections : 1;
 } NMConnectivityPrivate;
 
 struct _NMConnectivity {
@@ -193,6 +257,144 @@ _con_config_get_response(const ConConfig *con_config)
 {
     return con_config->response ?: NM_CONFIG_DEFAULT_CONNECTIVITY_RESPONSE;
 }
+
+/*****************************************************************************/
+
+typedef struct {
+    CList       sock_lst;
+    ConContext *ctx;
+
+    GSource *source;
+
+    /* this is a very simplistic weak-pointer. If ConCurlSockData gets
+     * destroyed, it will set *destroy_notify to TRUE.
+     *
+     * _con_curl_socketevent_cb() uses this to detect whether it can
+     * safely access @fdp after _con_curl_check_connectivity(). */
+    gboolean *destroy_notify;
+
+} ConCurlSockData;
+
+static void
+_con_curl_sock_data_free(ConCurlSockData *fdp)
+{
+    if (fdp->destroy_notify)
+        *fdp->destroy_notify = TRUE;
+    c_list_unlink_stale(&fdp->sock_lst);
+    nm_clear_g_source_inst(&fdp->source);
+    nm_g_slice_free(fdp);
+}
+
+static guint
+_con_context_hash(gconstpointer ptr)
+{
+    const ConContext *ctx = ptr;
+    NMHashState       h;
+
+    nm_hash_init(&h, 1430285837u);
+    nm_hash_update_val(&h, ctx->addr_family);
+    nm_hash_update_str(&h, ctx->ifspec);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_con_context_equal(gconstpointer a, gconstpointer b)
+{
+    const ConContext *ctx_a = a;
+    const ConContext *ctx_b = b;
+
+    return ctx_a->addr_family == ctx_b->addr_family && nm_streq(ctx_a->ifspec, ctx_b->ifspec);
+}
+
+static void
+_con_drain_free(ConDrain *drain)
+{
+    c_list_unlink_stale(&drain->drain_lst);
+    nm_clear_g_source_inst(&drain->timeout_source);
+
+    /* not called from within a libcurl callback. */
+    curl_multi_remove_handle(drain->ctx->curl_mhandle, drain->curl_ehandle);
+    curl_easy_cleanup(drain->curl_ehandle);
+    curl_slist_free_all(drain->hosts);
+    nm_g_slice_free(drain);
+}
+
+static ConDrain *
+_con_drain_find(ConContext *ctx, CURL *ehandle)
+{
+    ConDrain *drain;
+
+    c_list_for_each_entry (drain, &ctx->drain_lst_head, drain_lst) {
+        if (drain->curl_ehandle == ehandle)
+            return drain;
+    }
+    return NULL;
+}
+
+static void
+_con_context_free(gpointer data)
+{
+    ConContext *     ctx = data;
+    ConCurlSockData *fdp;
+    ConDrain *       drain;
+
+    nm_assert(ctx->n_handles == 0);
+
+    nm_clear_g_source_inst(&ctx->idle_source);
+
+    /* the drains don't keep the context alive. Give up on their connections. */
+    while ((drain = c_list_first_entry(&ctx->drain_lst_head, ConDrain, drain_lst)))
+        _con_drain_free(drain);
+
+    curl_multi_cleanup(ctx->curl_mhandle);
+    nm_clear_g_source(&ctx->curl_timer);
+
+    /* curl unregisters the sockets of the connections that it closes. Don't
+     * rely on it. */
+    while ((fdp = c_list_first_entry(&ctx->sock_lst_head, ConCurlSockData, sock_lst)))
+        _con_curl_sock_data_free(fdp);
+
+    nm_connectivity_resolve_cache_clear(&ctx->resolve_cache);
+    g_free(ctx->ifspec);
+    nm_g_slice_free(ctx);
+}
+
+static gboolean
+_con_context_idle_cb(gpointer user_data)
+{
+    ConContext *ctx = user_data;
+
+    nm_clear_g_source_inst(&ctx->idle_source);
+    g_hash_table_remove(NM_CONNECTIVITY_GET_PRIVATE(ctx->self)->contexts, ctx);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_con_context_release(NMConnectivity *self, ConContext *ctx)
+{
+    NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE(self);
+
+    nm_assert(ctx->n_handles > 0);
+
+    if (--ctx->n_handles > 0)
+        return;
+
+    if (!priv->reuse_connections) {
+        g_hash_table_remove(priv->contexts, ctx);
+        return;
+    }
+
+    nm_assert(!ctx->idle_source);
+    ctx->idle_source = nm_g_timeout_source_new_seconds(CON_CONTEXT_IDLE_TIMEOUT_SEC,
+                                                       G_PRIORITY_DEFAULT,
+                                                       _con_context_idle_cb,
+                                                       ctx,
+                                                       NULL);
+    g_source_attach(ctx->idle_source, NULL);
+}
+
+static void _start_queue_schedule(NMConnectivity *self);
+static void _con_drain_start(NMConnectivityCheckHandle *cb_data);
 #endif
 
 /*****************************************************************************/
@@ -219,6 +421,8 @@ cb_data_complete(NMConnectivityCheckHandle *cb_data,
     c_list_unlink_stale(&cb_data->handles_lst);
 
 #if WITH_CONCHECK
+    c_list_unlink(&cb_data->concheck.start_entry.start_lst);
+
     if (cb_data->concheck.curl_ehandle) {
         /* Contrary to what cURL manual claim it is *not* safe to remove
          * the easy handle "at any moment"; specifically it's not safe to
@@ -234,15 +438,32 @@ cb_data_complete(NMConnectivityCheckHandle *cb_data,
         curl_easy_setopt(cb_data->concheck.curl_ehandle, CURLOPT_PRIVATE, NULL);
         curl_easy_setopt(cb_data->concheck.curl_ehandle, CURLOPT_HTTPHEADER, NULL);
 
-        curl_multi_remove_handle(cb_data->concheck.curl_mhandle, cb_data->concheck.curl_ehandle);
-        curl_easy_cleanup(cb_data->concheck.curl_ehandle);
-        curl_multi_cleanup(cb_data->concheck.curl_mhandle);
-
-        curl_slist_free_all(cb_data->concheck.request_headers);
-        curl_slist_free_all(cb_data->concheck.hosts);
+        if (cb_data->concheck.verdict_state == state && !cb_data->concheck.transfer_done) {
+            /* the result is known, but curl still reads the response. */
+            _con_drain_start(cb_data);
+        } else {
+            curl_multi_remove_handle(cb_data->concheck.ctx->curl_mhandle,
+                                     cb_data->concheck.curl_ehandle);
+            curl_easy_cleanup(cb_data->concheck.curl_ehandle);
+        }
     }
-    nm_clear_g_source(&cb_data->concheck.curl_timer);
+    curl_slist_free_all(cb_data->concheck.request_headers);
+    curl_slist_free_all(cb_data->concheck.hosts);
     nm_clear_g_cancellable(&cb_data->concheck.resolve_cancellable);
+
+    if (cb_data->concheck.ctx) {
+        nm_connectivity_resolve_cache_check_completed(&cb_data->concheck.ctx->resolve_cache,
+                                                      state);
+        _con_context_release(self, g_steal_pointer(&cb_data->concheck.ctx));
+    }
+
+    if (cb_data->concheck.started) {
+        NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE(self);
+
+        nm_assert(priv->n_running > 0);
+        priv->n_running--;
+        _start_queue_schedule(self);
+    }
 #endif
 
     nm_clear_g_source(&cb_data->timeout_id);
@@ -310,9 +531,11 @@ _complete_queued(NMConnectivity *self)
 }
 
 static gboolean
-_con_curl_check_connectivity(CURLM *mhandle, int sockfd, int ev_bitmask)
+_con_curl_check_connectivity(ConContext *ctx, int sockfd, int ev_bitmask)
 {
     NMConnectivityCheckHandle *cb_data;
+    ConDrain *                 drain;
+    CList                      drain_done_lst_head = C_LIST_INIT(drain_done_lst_head);
     CURLMsg *                  msg;
     int                        m_left;
     long                       response_code;
@@ -320,13 +543,13 @@ _con_curl_check_connectivity(CURLM *mhandle, int sockfd, int ev_bitmask)
     int                        running_handles;
     gboolean                   success = TRUE;
 
-    ret = curl_multi_socket_action(mhandle, sockfd, ev_bitmask, &running_handles);
+    ret = curl_multi_socket_action(ctx->curl_mhandle, sockfd, ev_bitmask, &running_handles);
     if (ret != CURLM_OK) {
         _LOGD("connectivity check failed: (%d) %s", ret, curl_multi_strerror(ret));
         success = FALSE;
     }
 
-    while ((msg = curl_multi_info_read(mhandle, &m_left))) {
+    while ((msg = curl_multi_info_read(ctx->curl_mhandle, &m_left))) {
         const char *response;
         CURLcode    eret;
 
@@ -343,9 +566,22 @@ _con_curl_check_connectivity(CURLM *mhandle, int sockfd, int ev_bitmask)
             continue;
         }
 
-        nm_assert(cb_data);
+        if (!cb_data) {
+            /* the check completed earlier, and we finished reading the response. Free the
+             * drain only after reading all messages. */
+            drain = _con_drain_find(ctx, msg->easy_handle);
+            nm_assert(drain);
+            if (drain) {
+                c_list_unlink(&drain->drain_lst);
+                c_list_link_tail(&drain_done_lst_head, &drain->drain_lst);
+            }
+            continue;
+        }
+
         nm_assert(NM_IS_CONNECTIVITY(cb_data->self));
 
+        cb_data->concheck.transfer_done = TRUE;
+
         if (cb_data->completed_state != NM_CONNECTIVITY_UNKNOWN) {
             /* callback was already invoked earlier. Nothing to do. */
             continue;
@@ -394,6 +630,9 @@ _con_curl_check_connectivity(CURLM *mhandle, int sockfd, int ev_bitmask)
         cb_data_queue_completed(cb_data, NM_CONNECTIVITY_PORTAL, "unexpected short response", NULL);
     }
 
+    while ((drain = c_list_first_entry(&drain_done_lst_head, ConDrain, drain_lst)))
+        _con_drain_free(drain);
+
     /* if we return a failure, we don't know what went wrong. It's likely serious, because
      * a failure here is not expected. Return FALSE, so that we stop polling the file descriptor.
      * Worst case, this leaves the pending connectivity check unhandled, until our regular
@@ -404,46 +643,35 @@ _con_curl_check_connectivity(CURLM *mhandle, int sockfd, int ev_bitmask)
 static gboolean
 _con_curl_timeout_cb(gpointer user_data)
 {
-    NMConnectivityCheckHandle *cb_data = user_data;
+    ConContext *    ctx  = user_data;
+    NMConnectivity *self = ctx->self;
+
+    _con_curl_check_connectivity(ctx, CURL_SOCKET_TIMEOUT, 0);
 
-    _con_curl_check_connectivity(cb_data->concheck.curl_mhandle, CURL_SOCKET_TIMEOUT, 0);
-    _complete_queued(cb_data->self);
+    /* this might destroy @ctx. */
+    _complete_queued(self);
     return G_SOURCE_CONTINUE;
 }
 
 static int
 multi_timer_cb(CURLM *multi, long timeout_msec, void *userdata)
 {
-    NMConnectivityCheckHandle *cb_data = userdata;
+    ConContext *ctx = userdata;
 
-    nm_clear_g_source(&cb_data->concheck.curl_timer);
+    nm_clear_g_source(&ctx->curl_timer);
     if (timeout_msec != -1)
-        cb_data->concheck.curl_timer = g_timeout_add(timeout_msec, _con_curl_timeout_cb, cb_data);
+        ctx->curl_timer = g_timeout_add(timeout_msec, _con_curl_timeout_cb, ctx);
     return 0;
 }
 
-typedef struct {
-    NMConnectivityCheckHandle *cb_data;
-
-    GSource *source;
-
-    /* this is a very simplistic weak-pointer. If ConCurlSockData gets
-     * destroyed, it will set *destroy_notify to TRUE.
-     *
-     * _con_curl_socketevent_cb() uses this to detect whether it can
-     * safely access @fdp after _con_curl_check_connectivity(). */
-    gboolean *destroy_notify;
-
-} ConCurlSockData;
-
 static gboolean
 _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
 {
-    ConCurlSockData *          fdp           = user_data;
-    NMConnectivityCheckHandle *cb_data       = fdp->cb_data;
-    int                        action        = 0;
-    gboolean                   fdp_destroyed = FALSE;
-    gboolean                   success;
+    ConCurlSockData *fdp           = user_data;
+    NMConnectivity * self          = fdp->ctx->self;
+    int              action        = 0;
+    gboolean         fdp_destroyed = FALSE;
+    gboolean         success;
 
     if (condition & G_IO_IN)
         action |= CURL_CSELECT_IN;
@@ -455,7 +683,7 @@ _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
     nm_assert(!fdp->destroy_notify);
     fdp->destroy_notify = &fdp_destroyed;
 
-    success = _con_curl_check_connectivity(cb_data->concheck.curl_mhandle, fd, action);
+    success = _con_curl_check_connectivity(fdp->ctx, fd, action);
 
     if (fdp_destroyed) {
         /* hups. fdp got invalidated during _con_curl_check_connectivity(). That's fine,
@@ -467,7 +695,8 @@ _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
             nm_clear_g_source_inst(&fdp->source);
     }
 
-    _complete_queued(cb_data->self);
+    /* this might destroy the context, together with @fdp. */
+    _complete_queued(self);
 
     return G_SOURCE_CONTINUE;
 }
@@ -475,18 +704,15 @@ _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
 static int
 multi_socket_cb(CURL *e_handle, curl_socket_t fd, int what, void *userdata, void *socketp)
 {
-    NMConnectivityCheckHandle *cb_data = userdata;
-    ConCurlSockData *          fdp     = socketp;
+    ConContext *     ctx = userdata;
+    ConCurlSockData *fdp = socketp;
 
     (void) _NM_ENSURE_TYPE(int, fd);
 
     if (what == CURL_POLL_REMOVE) {
         if (fdp) {
-            if (fdp->destroy_notify)
-                *fdp->destroy_notify = TRUE;
-            nm_clear_g_source_inst(&fdp->source);
-            curl_multi_assign(cb_data->concheck.curl_mhandle, fd, NULL);
-            g_slice_free(ConCurlSockData, fdp);
+            curl_multi_assign(ctx->curl_mhandle, fd, NULL);
+            _con_curl_sock_data_free(fdp);
         }
     } else {
         GIOCondition condition;
@@ -494,9 +720,10 @@ multi_socket_cb(CURL *e_handle, curl_socket_t fd, int what, void *userdata, void
         if (!fdp) {
             fdp  = g_slice_new(ConCurlSockData);
             *fdp = (ConCurlSockData){
-                .cb_data = cb_data,
+                .ctx = ctx,
             };
-            curl_multi_assign(cb_data->concheck.curl_mhandle, fd, fdp);
+            c_list_link_tail(&ctx->sock_lst_head, &fdp->sock_lst);
+            curl_multi_assign(ctx->curl_mhandle, fd, fdp);
         } else
             nm_clear_g_source_inst(&fdp->source);
 
@@ -523,22 +750,54 @@ multi_socket_cb(CURL *e_handle, curl_socket_t fd, int what, void *userdata, void
     return CURLM_OK;
 }
 
+/* Completes the check from within a curl callback. Returns the value for the callback,
+ * that is, whether curl should continue receiving. */
+static size_t
+_con_complete_from_cb(NMConnectivityCheckHandle *cb_data,
+                      NMConnectivityState        state,
+                      const char *               log_message,
+                      size_t                     len)
+{
+    cb_data_queue_completed(cb_data, state, log_message, NULL);
+
+    if (state == NM_CONNECTIVITY_FULL && cb_data->concheck.keepalive) {
+        /* aborting the transfer would close the connection. Complete the check,
+         * but let curl read the rest of the response. */
+        cb_data->concheck.verdict_state = state;
+        return len;
+    }
+
+    return 0;
+}
+
+static size_t
+_con_drain_add(gsize *drain_cnt, size_t len)
+{
+    *drain_cnt += len;
+    if (*drain_cnt > CON_DRAIN_MAX) {
+        /* not worth it. Give up on the connection. */
+        return 0;
+    }
+    return len;
+}
+
 static size_t
 easy_header_cb(char *buffer, size_t size, size_t nitems, void *userdata)
 {
     NMConnectivityCheckHandle *cb_data = userdata;
     size_t                     len     = size * nitems;
 
+    if (cb_data->concheck.verdict_state != NM_CONNECTIVITY_UNKNOWN)
+        return _con_drain_add(&cb_data->concheck.drain_cnt, len);
+
     if (cb_data->completed_state != NM_CONNECTIVITY_UNKNOWN) {
         /* already completed. */
         return 0;
     }
 
     if (len >= sizeof(HEADER_STATUS_ONLINE) - 1
-        && !g_ascii_strncasecmp(buffer, HEADER_STATUS_ONLINE, sizeof(HEADER_STATUS_ONLINE) - 1)) {
-        cb_data_queue_completed(cb_data, NM_CONNECTIVITY_FULL, "status header found", NULL);
-        return 0;
-    }
+        && !g_ascii_strncasecmp(buffer, HEADER_STATUS_ONLINE, sizeof(HEADER_STATUS_ONLINE) - 1))
+        return _con_complete_from_cb(cb_data, NM_CONNECTIVITY_FULL, "status header found", len);
 
     return len;
 }
@@ -552,6 +811,9 @@ easy_write_cb(void *buffer, size_t size, size_t nmemb, void *userdata)
     size_t                     check_len;
     const char *               response;
 
+    if (cb_data->concheck.verdict_state != NM_CONNECTIVITY_UNKNOWN)
+        return _con_drain_add(&cb_data->concheck.drain_cnt, len);
+
     if (cb_data->completed_state != NM_CONNECTIVITY_UNKNOWN) {
         /* already completed. */
         return 0;
@@ -609,13 +871,58 @@ easy_write_cb(void *buffer, size_t size, size_t nmemb, void *userdata)
 
     if (cb_data->concheck.response_good_cnt >= response_len) {
         /* We already have enough data, and it matched. */
-        cb_data_queue_completed(cb_data, NM_CONNECTIVITY_FULL, "expected response", NULL);
-        return 0;
+        return _con_complete_from_cb(cb_data, NM_CONNECTIVITY_FULL, "expected response", len);
     }
 
     return len;
 }
 
+static size_t
+_con_drain_cb(char *buffer, size_t size, size_t nmemb, void *userdata)
+{
+    ConDrain *drain = userdata;
+
+    return _con_drain_add(&drain->drain_cnt, size * nmemb);
+}
+
+static gboolean
+_con_drain_timeout_cb(gpointer user_data)
+{
+    _con_drain_free(user_data);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_con_drain_start(NMConnectivityCheckHandle *cb_data)
+{
+    ConContext *ctx = cb_data->concheck.ctx;
+    ConDrain *  drain;
+
+    nm_assert(cb_data->concheck.keepalive);
+    nm_assert(!cb_data->concheck.request_headers);
+
+    drain  = g_slice_new(ConDrain);
+    *drain = (ConDrain){
+        .ctx          = ctx,
+        .curl_ehandle = g_steal_pointer(&cb_data->concheck.curl_ehandle),
+        .hosts        = g_steal_pointer(&cb_data->concheck.hosts),
+        .drain_cnt    = cb_data->concheck.drain_cnt,
+    };
+    c_list_link_tail(&ctx->drain_lst_head, &drain->drain_lst);
+
+    curl_easy_setopt(drain->curl_ehandle, CURLOPT_WRITEFUNCTION, _con_drain_cb);
+    curl_easy_setopt(drain->curl_ehandle, CURLOPT_WRITEDATA, drain);
+    curl_easy_setopt(drain->curl_ehandle, CURLOPT_HEADERFUNCTION, _con_drain_cb);
+    curl_easy_setopt(drain->curl_ehandle, CURLOPT_HEADERDATA, drain);
+
+    drain->timeout_source = nm_g_timeout_source_new_seconds(CON_DRAIN_TIMEOUT_SEC,
+                                                            G_PRIORITY_DEFAULT,
+                                                            _con_drain_timeout_cb,
+                                                            drain,
+                                                            NULL);
+    g_source_attach(drain->timeout_source, NULL);
+}
+
 static gboolean
 _timeout_cb(gpointer user_data)
 {
@@ -625,6 +932,10 @@ _timeout_cb(gpointer user_data)
     nm_assert(c_list_contains(&NM_CONNECTIVITY_GET_PRIVATE(cb_data->self)->handles_lst_head,
                               &cb_data->handles_lst));
 
+    /* a check with a known result completed right away, also if curl is still
+     * reading the response. */
+    nm_assert(cb_data->concheck.verdict_state == NM_CONNECTIVITY_UNKNOWN);
+
     cb_data_complete(cb_data, NM_CONNECTIVITY_LIMITED, "timeout");
     return G_SOURCE_REMOVE;
 }
@@ -646,35 +957,63 @@ _idle_cb(gpointer user_data)
 }
 
 #if WITH_CONCHECK
-static void
-do_curl_request(NMConnectivityCheckHandle *cb_data)
+static ConContext *
+_con_context_acquire(NMConnectivity *self, const char *ifspec, int addr_family)
 {
-    CURLM *mhandle;
-    CURL * ehandle;
-    long   resolve;
+    NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE(self);
+    ConContext *           ctx;
+    CURLM *                mhandle;
+
+    ctx = g_hash_table_lookup(priv->contexts,
+                              &((const ConContext){
+                                  .ifspec      = (char *) ifspec,
+                                  .addr_family = addr_family,
+                              }));
+    if (!ctx) {
+        mhandle = curl_multi_init();
+        if (!mhandle)
+            return NULL;
+
+        ctx  = g_slice_new(ConContext);
+        *ctx = (ConContext){
+            .self         = self,
+            .ifspec       = g_strdup(ifspec),
+            .addr_family  = addr_family,
+            .curl_mhandle = mhandle,
+        };
+        c_list_init(&ctx->sock_lst_head);
+        c_list_init(&ctx->drain_lst_head);
 
-    mhandle = curl_multi_init();
-    if (!mhandle) {
-        cb_data_complete(cb_data, NM_CONNECTIVITY_ERROR, "curl error");
-        return;
+        curl_multi_setopt(mhandle, CURLMOPT_SOCKETFUNCTION, multi_socket_cb);
+        curl_multi_setopt(mhandle, CURLMOPT_SOCKETDATA, ctx);
+        curl_multi_setopt(mhandle, CURLMOPT_TIMERFUNCTION, multi_timer_cb);
+        curl_multi_setopt(mhandle, CURLMOPT_TIMERDATA, ctx);
+
+        g_hash_table_add(priv->contexts, ctx);
     }
 
+    nm_clear_g_source_inst(&ctx->idle_source);
+    ctx->n_handles++;
+    return ctx;
+}
+
+static void
+do_curl_request(NMConnectivityCheckHandle *cb_data)
+{
+    CURL *ehandle;
+    long  resolve;
+
     ehandle = curl_easy_init();
     if (!ehandle) {
-        curl_multi_cleanup(mhandle);
         cb_data_complete(cb_data, NM_CONNECTIVITY_ERROR, "curl error");
         return;
     }
 
-    cb_data->concheck.curl_mhandle    = mhandle;
-    cb_data->concheck.curl_ehandle    = ehandle;
-    cb_data->concheck.request_headers = curl_slist_append(NULL, "Connection: close");
-    cb_data->timeout_id               = g_timeout_add_seconds(20, _timeout_cb, cb_data);
-
-    curl_multi_setopt(mhandle, CURLMOPT_SOCKETFUNCTION, multi_socket_cb);
-    curl_multi_setopt(mhandle, CURLMOPT_SOCKETDATA, cb_data);
-    curl_multi_setopt(mhandle, CURLMOPT_TIMERFUNCTION, multi_timer_cb);
-    curl_multi_setopt(mhandle, CURLMOPT_TIMERDATA, cb_data);
+    cb_data->concheck.curl_ehandle = ehandle;
+    cb_data->concheck.keepalive    = NM_CONNECTIVITY_GET_PRIVATE(cb_data->self)->reuse_connections;
+    if (!cb_data->concheck.keepalive)
+        cb_data->concheck.request_headers = curl_slist_append(NULL, "Connection: close");
+    cb_data->timeout_id = g_timeout_add_seconds(20, _timeout_cb, cb_data);
 
     switch (cb_data->addr_family) {
     case AF_INET:
@@ -701,8 +1040,16 @@ do_curl_request(NMConnectivityCheckHandle *cb_data)
     curl_easy_setopt(ehandle, CURLOPT_INTERFACE, cb_data->ifspec);
     curl_easy_setopt(ehandle, CURLOPT_RESOLVE, cb_data->concheck.hosts);
     curl_easy_setopt(ehandle, CURLOPT_IPRESOLVE, resolve);
+    if (!cb_data->concheck.keepalive)
+        curl_easy_setopt(ehandle, CURLOPT_FORBID_REUSE, 1L);
 
-    curl_multi_add_handle(mhandle, ehandle);
+    curl_multi_add_handle(cb_data->concheck.ctx->curl_mhandle, ehandle);
+}
+
+static char *
+_con_config_get_host_port(const ConConfig *con_config)
+{
+    return g_strdup_printf("%s:%s", con_config->host, con_config->port ?: "80");
 }
 
 static void
@@ -711,11 +1058,12 @@ resolve_cb(GObject *object, GAsyncResult *res, gpointer user_data)
     NMConnectivityCheckHandle *cb_data;
     gs_unref_variant GVariant *result    = NULL;
     gs_unref_variant GVariant *addresses = NULL;
-    gsize                      no_addresses;
-    int                        ifindex;
-    int                        addr_family;
-    gsize                      len = 0;
-    gsize                      i;
+    gs_unref_ptrarray GPtrArray *entries = NULL;
+    gsize                        no_addresses;
+    int                          ifindex;
+    int                          addr_family;
+    gsize                        len = 0;
+    gsize                        i;
     gs_free_error GError *error = NULL;
 
     result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object), res, &error);
@@ -735,6 +1083,7 @@ resolve_cb(GObject *object, GAsyncResult *res, gpointer user_data)
 
     addresses    = g_variant_get_child_value(result, 0);
     no_addresses = g_variant_n_children(addresses);
+    entries      = g_ptr_array_new_with_free_func(g_free);
 
     for (i = 0; i < no_addresses; i++) {
         gs_unref_variant GVariant *address = NULL;
@@ -758,6 +1107,20 @@ resolve_cb(GObject *object, GAsyncResult *res, gpointer user_data)
                                      nm_utils_inet_ntop(addr_family, address_buf, str_addr));
         cb_data->concheck.hosts = curl_slist_append(cb_data->concheck.hosts, host_entry);
         _LOG2T("adding '%s' to curl resolve list", host_entry);
+        g_ptr_array_add(entries, g_steal_pointer(&host_entry));
+    }
+
+    if (NM_CONNECTIVITY_GET_PRIVATE(cb_data->self)->reuse_connections && entries->len > 0) {
+        gs_free char *host_port = NULL;
+        char **       resolved_entries;
+
+        host_port = _con_config_get_host_port(cb_data->concheck.con_config);
+        g_ptr_array_add(entries, NULL);
+        resolved_entries = (char **) g_ptr_array_free(g_steal_pointer(&entries), FALSE);
+        nm_connectivity_resolve_cache_set(&cb_data->concheck.ctx->resolve_cache,
+                                          host_port,
+                                          resolved_entries,
+                                          nm_utils_get_monotonic_timestamp_msec());
     }
 
     do_curl_request(cb_data);
@@ -833,12 +1196,187 @@ check_platform_config(NMConnectivity *self,
     return NM_CONNECTIVITY_UNKNOWN;
 }
 
+#if WITH_CONCHECK
+static void
+_concheck_run(NMConnectivityCheckHandle *cb_data)
+{
+    NMConnectivity *       self            = cb_data->self;
+    NMConnectivityPrivate *priv            = NM_CONNECTIVITY_GET_PRIVATE(self);
+    const ConConfig *      con_config      = cb_data->concheck.con_config;
+    gs_free char *         host_port       = NULL;
+    gs_free char *         host_port_unset = NULL;
+    const char *const *    resolved_entries;
+    ConContext *           ctx;
+    gboolean               has_systemd_resolved;
+    guint                  i;
+
+    cb_data->concheck.started = TRUE;
+    priv->n_running++;
+
+    ctx = _con_context_acquire(self, cb_data->ifspec, cb_data->addr_family);
+    if (!ctx) {
+        _LOG2D("start fake request (fail due to curl error)");
+        cb_data->completed_state  = NM_CONNECTIVITY_ERROR;
+        cb_data->completed_reason = "curl error";
+        cb_data->timeout_id       = g_idle_add(_idle_cb, cb_data);
+        return;
+    }
+    cb_data->concheck.ctx = ctx;
+
+    /* an earlier check on the same context might have left addresses for the host
+     * in curl's DNS cache. Drop them, and only use what we add below. */
+    host_port               = _con_config_get_host_port(con_config);
+    host_port_unset         = g_strconcat("-", host_port, NULL);
+    cb_data->concheck.hosts = curl_slist_append(NULL, host_port_unset);
+
+    if (nm_utils_parse_inaddr_bin(AF_INET, con_config->host, NULL, NULL)) {
+        /* nothing to resolve. */
+        _LOG2D("start request to '%s'", con_config->uri);
+        do_curl_request(cb_data);
+        return;
+    }
+
+    resolved_entries =
+        nm_connectivity_resolve_cache_lookup(&ctx->resolve_cache,
+                                             host_port,
+                                             nm_utils_get_monotonic_timestamp_msec());
+    if (resolved_entries) {
+        for (i = 0; resolved_entries[i]; i++) {
+            cb_data->concheck.hosts =
+                curl_slist_append(cb_data->concheck.hosts, resolved_entries[i]);
+            _LOG2T("adding '%s' to curl resolve list (cached)", resolved_entries[i]);
+        }
+        _LOG2D("start request to '%s' (with cached addresses of '%s')",
+               con_config->uri,
+               con_config->host);
+        do_curl_request(cb_data);
+        return;
+    }
+
+    /* note that we pick up support for systemd-resolved right away when we need it.
+     * We don't need to remember the setting, because we can (cheaply) check anew
+     * on each request.
+     *
+     * Yes, this makes NMConnectivity singleton dependent on NMDnsManager singleton.
+     * Well, not really: it makes connectivity-check-start dependent on NMDnsManager
+     * which merely means, not to start a connectivity check, late during shutdown.
+     *
+     * NMDnsSystemdResolved tries to D-Bus activate systemd-resolved only once,
+     * to not spam syslog with failures messages from dbus-daemon.
+     * Note that unless NMDnsSystemdResolved tried and failed to start systemd-resolved,
+     * it guesses that systemd-resolved is activatable and returns %TRUE here. That
+     * means, while NMDnsSystemdResolved would not try to D-Bus activate systemd-resolved
+     * more than once, NMConnectivity might -- until NMDnsSystemdResolved tried itself
+     * and noticed that systemd-resolved is not available.
+     * This is relatively cumbersome to avoid, because we would have to go through
+     * NMDnsSystemdResolved trying to asynchronously start the service, to ensure there
+     * is only one attempt to start the service. */
+    has_systemd_resolved = nm_dns_manager_has_systemd_resolved(nm_dns_manager_get());
+
+    if (has_systemd_resolved) {
+        GDBusConnection *dbus_connection;
+
+        dbus_connection = NM_MAIN_DBUS_CONNECTION_GET;
+        if (!dbus_connection) {
+            /* we have no D-Bus connection? That might happen in configure and quit mode.
+             *
+             * Anyway, something is very odd, just fail connectivity check. */
+            _LOG2D("start fake request (fail due to no D-Bus connection)");
+            cb_data->completed_state  = NM_CONNECTIVITY_ERROR;
+            cb_data->completed_reason = "no D-Bus connection";
+            cb_data->timeout_id       = g_idle_add(_idle_cb, cb_data);
+            return;
+        }
+
+        cb_data->concheck.resolve_cancellable = g_cancellable_new();
+
+        g_dbus_connection_call(dbus_connection,
+                               "org.freedesktop.resolve1",
+                               "/org/freedesktop/resolve1",
+                               "org.freedesktop.resolve1.Manager",
+                               "ResolveHostname",
+                               g_variant_new("(isit)",
+                                             (gint32) cb_data->concheck.ch_ifindex,
+                                             con_config->host,
+                                             (gint32) cb_data->addr_family,
+                                             SD_RESOLVED_DNS),
+                               G_VARIANT_TYPE("(a(iiay)st)"),
+                               G_DBUS_CALL_FLAGS_NONE,
+                               -1,
+                               cb_data->concheck.resolve_cancellable,
+                               resolve_cb,
+                               cb_data);
+        _LOG2D("start request to '%s' (try resolving '%s' using systemd-resolved)",
+               con_config->uri,
+               con_config->host);
+    } else {
+        _LOG2D("start request to '%s' (systemd-resolved not available)", con_config->uri);
+        do_curl_request(cb_data);
+    }
+}
+
+static gboolean _start_queue_timeout_cb(gpointer user_data);
+
+static void
+_start_queue_schedule(NMConnectivity *self)
+{
+    NMConnectivityPrivate *priv     = NM_CONNECTIVITY_GET_PRIVATE(self);
+    gint64                 now_msec = nm_utils_get_monotonic_timestamp_msec();
+    gint64                 timeout_msec;
+
+    nm_clear_g_source_inst(&priv->start_source);
+
+    /* when a running check completes, we get called again. */
+    if (priv->max_parallel > 0 && priv->n_running >= priv->max_parallel)
+        return;
+
+    timeout_msec = nm_connectivity_start_queue_get_timeout_msec(&priv->start_lst_head, now_msec);
+    if (timeout_msec < 0)
+        return;
+
+    priv->start_source = nm_g_timeout_source_new(timeout_msec,
+                                                 G_PRIORITY_DEFAULT,
+                                                 _start_queue_timeout_cb,
+                                                 self,
+                                                 NULL);
+    g_source_attach(priv->start_source, NULL);
+}
+
+static gboolean
+_start_queue_timeout_cb(gpointer user_data)
+{
+    gs_unref_object NMConnectivity *self     = g_object_ref(user_data);
+    NMConnectivityPrivate *         priv     = NM_CONNECTIVITY_GET_PRIVATE(self);
+    gint64                          now_msec = nm_utils_get_monotonic_timestamp_msec();
+    NMConnectivityStartQueueEntry * entry;
+    NMConnectivityCheckHandle *     cb_data;
+
+    nm_clear_g_source_inst(&priv->start_source);
+
+    /* the queue is sorted. Starting a check might complete other checks, so
+     * take the head anew each time. */
+    while ((entry = nm_connectivity_start_queue_peek(&priv->start_lst_head, now_msec))) {
+        if (priv->max_parallel > 0 && priv->n_running >= priv->max_parallel)
+            break;
+
+        cb_data = c_list_entry(entry, NMConnectivityCheckHandle, concheck.start_entry);
+        c_list_unlink(&entry->start_lst);
+        _LOG2T("start queued check (%u running)", priv->n_running);
+        _concheck_run(cb_data);
+    }
+
+    _start_queue_schedule(self);
+    return G_SOURCE_REMOVE;
+}
+#endif
+
 NMConnectivityCheckHandle *
 nm_connectivity_check_start(NMConnectivity *            self,
                             int                         addr_family,
                             NMPlatform *                platform,
                             int                         ifindex,
                             const char *                iface,
+                            gboolean                    is_periodic,
                             NMConnectivityCheckCallback callback,
                             gpointer                    user_data)
 {
@@ -865,10 +1403,10 @@ nm_connectivity_check_start(NMConnectivity *            self,
 
 #if WITH_CONCHECK
 
+    c_list_init(&cb_data->concheck.start_entry.start_lst);
     cb_data->concheck.con_config = _con_config_ref(priv->con_config);
 
     if (iface && ifindex > 0 && priv->enabled && priv->uri_valid) {
-        gboolean            has_systemd_resolved;
         NMConnectivityState state;
         const char *        reason;
 
@@ -886,68 +1424,19 @@ nm_connectivity_check_start(NMConnectivity *            self,
             }
         }
 
-        /* note that we pick up support for systemd-resolved right away when we need it.
-         * We don't need to remember the setting, because we can (cheaply) check anew
-         * on each request.
-         *
-         * Yes, this makes NMConnectivity singleton dependent on NMDnsManager singleton.
-         * Well, not really: it makes connectivity-check-start dependent on NMDnsManager
-         * which merely means, not to start a connectivity check, late during shutdown.
-         *
-         * NMDnsSystemdResolved tries to D-Bus activate systemd-resolved only once,
-         * to not spam syslog with failures messages from dbus-daemon.
-         * Note that unless NMDnsSystemdResolved tried and failed to start systemd-resolved,
-         * it guesses that systemd-resolved is activatable and returns %TRUE here. That
-         * means, while NMDnsSystemdResolved would not try to D-Bus activate systemd-resolved
-         * more than once, NMConnectivity might -- until NMDnsSystemdResolved tried itself
-         * and noticed that systemd-resolved is not available.
-         * This is relatively cumbersome to avoid, because we would have to go through
-         * NMDnsSystemdResolved trying to asynchronously start the service, to ensure there
-         * is only one attempt to start the service. */
-        has_systemd_resolved = nm_dns_manager_has_systemd_resolved(nm_dns_manager_get());
-
-        if (has_systemd_resolved) {
-            GDBusConnection *dbus_connection;
-
-            dbus_connection = NM_MAIN_DBUS_CONNECTION_GET;
-            if (!dbus_connection) {
-                /* we have no D-Bus connection? That might happen in configure and quit mode.
-                 *
-                 * Anyway, something is very odd, just fail connectivity check. */
-                _LOG2D("start fake request (fail due to no D-Bus connection)");
-                cb_data->completed_state  = NM_CONNECTIVITY_ERROR;
-                cb_data->completed_reason = "no D-Bus connection";
-                cb_data->timeout_id       = g_idle_add(_idle_cb, cb_data);
-                return cb_data;
-            }
-
-            cb_data->concheck.resolve_cancellable = g_cancellable_new();
-
-            g_dbus_connection_call(dbus_connection,
-                                   "org.freedesktop.resolve1",
-                                   "/org/freedesktop/resolve1",
-                                   "org.freedesktop.resolve1.Manager",
-                                   "ResolveHostname",
-                                   g_variant_new("(isit)",
-                                                 (gint32) cb_data->concheck.ch_ifindex,
-                                                 cb_data->concheck.con_config->host,
-                                                 (gint32) cb_data->addr_family,
-                                                 SD_RESOLVED_DNS),
-                                   G_VARIANT_TYPE("(a(iiay)st)"),
-                                   G_DBUS_CALL_FLAGS_NONE,
-                                   -1,
-                                   cb_data->concheck.resolve_cancellable,
-                                   resolve_cb,
-                                   cb_data);
-            _LOG2D("start request to '%s' (try resolving '%s' using systemd-resolved)",
+        if (is_periodic && (priv->max_parallel > 0 || priv->start_jitter_msec > 0)) {
+            nm_connectivity_start_queue_add(&priv->start_lst_head,
+                                            &cb_data->concheck.start_entry,
+                                            priv->start_jitter_msec,
+                                            nm_utils_get_monotonic_timestamp_msec());
+            _LOG2D("queue request to '%s' (%u running)",
                    cb_data->concheck.con_config->uri,
-                   cb_data->concheck.con_config->host);
-        } else {
-            _LOG2D("start request to '%s' (systemd-resolved not available)",
-                   cb_data->concheck.con_config->uri);
-            do_curl_request(cb_data);
+                   priv->n_running);
+            _start_queue_schedule(self);
+            return cb_data;
         }
 
+        _concheck_run(cb_data);
         return cb_data;
     }
 #endif
@@ -998,6 +1487,147 @@ nm_connectivity_get_interval(NMConnectivity *self)
     return nm_connectivity_check_enabled(self) ? NM_CONNECTIVITY_GET_PRIVATE(self)->interval : 0;
 }
 
+/*****************************************************************************/
+
+void
+nm_connectivity_resolve_cache_clear(NMConnectivityResolveCache *cache)
+{
+    nm_clear_g_free(&cache->host_port);
+    nm_clear_pointer(&cache->entries, g_strfreev);
+    cache->expiry_msec = 0;
+}
+
+void
+nm_connectivity_resolve_cache_set(NMConnectivityResolveCache *cache,
+                                  const char *                host_port,
+                                  char **                     entries_take,
+                                  gint64                      now_msec)
+{
+    nm_assert(host_port);
+    nm_assert(entries_take && entries_take[0]);
+
+    nm_connectivity_resolve_cache_clear(cache);
+    cache->host_port   = g_strdup(host_port);
+    cache->entries     = entries_take;
+    cache->expiry_msec = now_msec + NM_CONNECTIVITY_RESOLVE_CACHE_MSEC;
+}
+
+/**
+ * nm_connectivity_resolve_cache_lookup:
+ * @cache: the #NMConnectivityResolveCache
+ * @host_port: the "host:port" to look up
+ * @now_msec: the current monotonic timestamp
+ *
+ * Returns: the %NULL terminated, cached entries for @host_port, or %NULL if
+ *   there are none. Expired entries are dropped.
+ */
+const char *const *
+nm_connectivity_resolve_cache_lookup(NMConnectivityResolveCache *cache,
+                                     const char *                host_port,
+                                     gint64                      now_msec)
+{
+    if (!cache->entries)
+        return NULL;
+
+    if (cache->expiry_msec <= now_msec) {
+        nm_connectivity_resolve_cache_clear(cache);
+        return NULL;
+    }
+
+    if (!nm_streq(cache->host_port, host_port))
+        return NULL;
+
+    return (const char *const *) cache->entries;
+}
+
+/**
+ * nm_connectivity_resolve_cache_check_completed:
+ * @cache: the #NMConnectivityResolveCache
+ * @state: the result of a check that might have used the cached entries
+ *
+ * Drops the cached entries if the check failed, because they might be the
+ * reason for the failure.
+ */
+void
+nm_connectivity_resolve_cache_check_completed(NMConnectivityResolveCache *cache,
+                                              NMConnectivityState         state)
+{
+    if (NM_IN_SET(state, NM_CONNECTIVITY_ERROR, NM_CONNECTIVITY_LIMITED, NM_CONNECTIVITY_PORTAL))
+        nm_connectivity_resolve_cache_clear(cache);
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_connectivity_start_queue_add:
+ * @start_lst_head: the start queue
+ * @entry: the entry to queue. It must not be queued already.
+ * @jitter_msec: the maximum random delay for @entry
+ * @now_msec: the current monotonic timestamp
+ *
+ * Queues @entry with its own random delay, independent of the other queued
+ * entries. Entries with the same ready time keep their order.
+ */
+void
+nm_connectivity_start_queue_add(CList *                        start_lst_head,
+                                NMConnectivityStartQueueEntry *entry,
+                                guint                          jitter_msec,
+                                gint64                         now_msec)
+{
+    CList *iter;
+
+    nm_assert(c_list_is_empty(&entry->start_lst));
+
+    entry->ready_msec = now_msec;
+    if (jitter_msec > 0)
+        entry->ready_msec += g_random_int_range(0, jitter_msec + 1);
+
+    /* new entries tend to be ready last. Search from the tail. */
+    for (iter = start_lst_head->prev; iter != start_lst_head; iter = iter->prev) {
+        if (c_list_entry(iter, NMConnectivityStartQueueEntry, start_lst)->ready_msec
+            <= entry->ready_msec)
+            break;
+    }
+    c_list_link_after(iter, &entry->start_lst);
+}
+
+/**
+ * nm_connectivity_start_queue_peek:
+ * @start_lst_head: the start queue
+ * @now_msec: the current monotonic timestamp
+ *
+ * Returns: the first queued entry, if it may start at @now_msec.
+ */
+NMConnectivityStartQueueEntry *
+nm_connectivity_start_queue_peek(CList *start_lst_head, gint64 now_msec)
+{
+    NMConnectivityStartQueueEntry *entry;
+
+    entry = c_list_first_entry(start_lst_head, NMConnectivityStartQueueEntry, start_lst);
+    if (!entry || entry->ready_msec > now_msec)
+        return NULL;
+    return entry;
+}
+
+/**
+ * nm_connectivity_start_queue_get_timeout_msec:
+ * @start_lst_head: the start queue
+ * @now_msec: the current monotonic timestamp
+ *
+ * Returns: the milliseconds until the first entry may start, or -1 if
+ *   the queue is empty.
+ */
+gint64
+nm_connectivity_start_queue_get_timeout_msec(CList *start_lst_head, gint64 now_msec)
+{
+    NMConnectivityStartQueueEntry *entry;
+
+    entry = c_list_first_entry(start_lst_head, NMConnectivityStartQueueEntry, start_lst);
+    if (!entry)
+        return -1;
+    return NM_MAX(entry->ready_msec - now_msec, 0);
+}
+
 static gboolean
 host_and_port_from_uri(const char *uri, char **host, char **port)
 {
@@ -1137,6 +1767,45 @@ update_config(NMConnectivity *self, NMConfigData *config_data)
         changed       = TRUE;
     }
 
+    priv->max_parallel =
+        nm_config_data_get_value_int64(config_data,
+                                       NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
+                                       NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_MAX_PARALLEL,
+                                       10,
+                                       0,
+                                       G_MAXINT32,
+                                       0);
+    priv->start_jitter_msec =
+        nm_config_data_get_value_int64(config_data,
+                                       NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
+                                       NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_START_JITTER,
+                                       10,
+                                       0,
+                                       G_MAXINT32,
+                                       0);
+    priv->reuse_connections =
+        nm_config_data_get_value_boolean(config_data,
+                                         NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
+                                         NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_REUSE_CONNECTIONS,
+                                         FALSE);
+
+#if WITH_CONCHECK
+    if (!priv->reuse_connections) {
+        GHashTableIter iter;
+        ConContext *   ctx;
+
+        /* drop the contexts that are only kept for reuse. */
+        g_hash_table_iter_init(&iter, priv->contexts);
+        while (g_hash_table_iter_next(&iter, (gpointer *) &ctx, NULL)) {
+            if (ctx->n_handles == 0)
+                g_hash_table_iter_remove(&iter);
+        }
+    }
+
+    /* the limits might have changed. */
+    _start_queue_schedule(self);
+#endif
+
     if (changed)
         g_signal_emit(self, signals[CONFIG_CHANGED], 0);
 }
@@ -1163,6 +1832,12 @@ nm_connectivity_init(NMConnectivity *self)
 
     c_list_init(&priv->handles_lst_head);
     c_list_init(&priv->completed_handles_lst_head);
+    c_list_init(&priv->start_lst_head);
+
+#if WITH_CONCHECK
+    priv->contexts =
+        g_hash_table_new_full(_con_context_hash, _con_context_equal, _con_context_free, NULL);
+#endif
 
     priv->config = g_object_ref(nm_config_get());
     g_signal_connect(G_OBJECT(priv->config),
@@ -1199,6 +1874,11 @@ dispose(GObject *object)
     nm_clear_pointer(&priv->con_config, _con_config_unref);
 
 #if WITH_CONCHECK
+    nm_assert(c_list_is_empty(&priv->start_lst_head));
+    nm_clear_g_source_inst(&priv->start_source);
+
+    nm_clear_pointer(&priv->contexts, g_hash_table_unref);
+
     curl_global_cleanup();
 #endif
 
@@ -65,9 +65,58 @@ NMConnectivityCheckHandle *nm_connectivity_check_start(NMConnectivity *
                                                        NMPlatform *                platform,
                                                        int                         ifindex,
                                                        const char *                iface,
+                                                       gboolean                    is_periodic,
                                                        NMConnectivityCheckCallback callback,
                                                        gpointer                    user_data);
 
 void nm_connectivity_check_cancel(NMConnectivityCheckHandle *handle);
 
+/*****************************************************************************/
+
+/* Remembers the addresses that systemd-resolved returned for "host:port", as
+ * entries for CURLOPT_RESOLVE. systemd-resolved does not tell us their TTL,
+ * so they are kept as long as curl caches the names that it resolves itself. */
+
+#define NM_CONNECTIVITY_RESOLVE_CACHE_MSEC (60 * 1000)
+
+typedef struct {
+    char *  host_port;
+    char ** entries;
+    gint64  expiry_msec;
+} NMConnectivityResolveCache;
+
+void nm_connectivity_resolve_cache_clear(NMConnectivityResolveCache *cache);
+
+void nm_connectivity_resolve_cache_set(NMConnectivityResolveCache *cache,
+                                       const char *                host_port,
+                                       char **                     entries_take,
+                                       gint64                      now_msec);
+
+const char *const *nm_connectivity_resolve_cache_lookup(NMConnectivityResolveCache *cache,
+                                                        const char *                host_port,
+                                                        gint64                      now_msec);
+
+void nm_connectivity_resolve_cache_check_completed(NMConnectivityResolveCache *cache,
+                                                   NMConnectivityState         state);
+
+/*****************************************************************************/
+
+/* Periodic checks wait in the start queue until their random start delay
+ * passed. The queue is kept sorted by the time when the entries may start. */
+
+typedef struct {
+    CList  start_lst;
+    gint64 ready_msec;
+} NMConnectivityStartQueueEntry;
+
+void nm_connectivity_start_queue_add(CList *                        start_lst_head,
+                                     NMConnectivityStartQueueEntry *entry,
+                                     guint                          jitter_msec,
+                                     gint64                         now_msec);
+
+NMConnectivityStartQueueEntry *nm_connectivity_start_queue_peek(CList *start_lst_head,
+                                                                gint64 now_msec);
+
+gint64 nm_connectivity_start_queue_get_timeout_msec(CList *start_lst_head, gint64 now_msec);
+
 #endif /* __NETWORKMANAGER_CONNECTIVITY_H__ */
@@ -2329,7 +2329,7 @@ nm_utils_log_connection_diff(NMConnection *connection,
 
     /* For VPN setting types, this is broken, because we cannot (generically) print the content of data/secrets. Bummer... */
 
-    if (!nm_logging_enabled(level, domain))
+    if (!nm_logging_output_enabled(level, domain))
         return;
 
     if (!prefix)
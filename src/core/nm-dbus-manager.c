@@ -43,15 +43,25 @@ typedef struct {
 
 typedef struct {
     GVariant *value;
+
+    /* whether the property changed and a PropertiesChanged signal is pending. */
+    bool dirty;
 } PropertyCacheData;
 
 typedef struct {
-    CList              registration_lst;
-    NMDBusObject *     obj;
-    NMDBusObjectClass *klass;
-    guint              info_idx;
-    guint              registration_id;
-    PropertyCacheData  property_cache[];
+    CList                      registration_lst;
+    NMDBusObject *             obj;
+    NMDBusObjectClass *        klass;
+    const NMDBusPropertyIndex *property_index;
+    guint                      info_idx;
+    guint                      registration_id;
+
+    /* the a{sv} dictionary with all properties of the interface, as used by
+     * GetManagedObjects() and InterfacesAdded. It is cleared when any of the
+     * properties changes. */
+    GVariant *properties_value;
+
+    PropertyCacheData property_cache[];
 } RegistrationData;
 
 /* we require that @path is the first member of NMDBusManagerData
@@ -73,6 +83,9 @@ typedef struct {
 
     CList private_servers_lst_head;
 
+    /* the ObjectMgrData of connections on private servers that export our objects. */
+    CList exported_peers_lst_head;
+
     NMDBusManagerSetPropertyHandler set_property_handler;
     gpointer                        set_property_handler_data;
 
@@ -80,6 +93,18 @@ typedef struct {
 
     CList caller_info_lst_head;
 
+    /* maps the exported NMDBusInterfaceInfoExtended to its NMDBusPropertyIndex. */
+    GHashTable *property_indexes;
+
+    /* objects with pending PropertiesChanged signals, see _nm_dbus_manager_obj_notify(). */
+    CList dirty_lst_head;
+    guint dirty_idle_id;
+
+    /* how many property notifications were merged into an already pending
+     * PropertiesChanged signal, and how many signals were emitted. */
+    guint64 n_properties_changed_coalesced;
+    guint64 n_properties_changed_emitted;
+
     guint objmgr_registration_id;
     bool  started : 1;
     bool  shutting_down : 1;
@@ -110,6 +135,7 @@ NM_DEFINE_SINGLETON_GETTER(NMDBusManager, nm_dbus_manager_get, NM_TYPE_DBUS_MANA
 static const GDBusInterfaceInfo interface_info_objmgr;
 static const GDBusSignalInfo    signal_info_objmgr_interfaces_added;
 static const GDBusSignalInfo    signal_info_objmgr_interfaces_removed;
+static const GDBusInterfaceVTable dbus_vtable_objmgr;
 static GVariantBuilder *_obj_collect_properties_all(NMDBusObject *obj, GVariantBuilder *builder);
 
 /*****************************************************************************/
@@ -163,14 +189,31 @@ typedef struct {
     CList object_mgr_lst_head;
 
     NMDBusManager *manager;
+
+    /* whether the server exports all our objects to the peers, like
+     * on the system bus. */
+    bool export_objects : 1;
 } PrivateServer;
 
 typedef struct {
-    CList                     object_mgr_lst;
+    CList            object_mgr_lst;
+    CList            exported_peers_lst;
+    GDBusConnection *connection;
+
+    /* for servers that don't export our objects, the users of the private
+     * connection export their objects via this manager. */
     GDBusObjectManagerServer *manager;
-    char *                    fake_sender;
+
+    /* for servers that export our objects, maps the RegistrationData to the
+     * registration ID on @connection. */
+    GHashTable *registrations;
+    guint       objmgr_registration_id;
+
+    char *fake_sender;
 } ObjectMgrData;
 
+static void _obj_mgr_data_export_all(NMDBusManager *self, ObjectMgrData *obj_mgr_data);
+
 typedef struct {
     GDBusConnection *connection;
     PrivateServer *  server;
@@ -182,15 +225,29 @@ typedef struct {
 static void
 _object_mgr_data_free(ObjectMgrData *obj_mgr_data)
 {
-    GDBusConnection *connection;
+    GDBusConnection *connection = obj_mgr_data->connection;
 
     c_list_unlink_stale(&obj_mgr_data->object_mgr_lst);
+    c_list_unlink(&obj_mgr_data->exported_peers_lst);
+
+    if (obj_mgr_data->registrations) {
+        GHashTableIter iter;
+        gpointer       registration_id;
+
+        g_hash_table_iter_init(&iter, obj_mgr_data->registrations);
+        while (g_hash_table_iter_next(&iter, NULL, &registration_id))
+            g_dbus_connection_unregister_object(connection, GPOINTER_TO_UINT(registration_id));
+        g_hash_table_destroy(obj_mgr_data->registrations);
+    }
+    if (obj_mgr_data->objmgr_registration_id != 0)
+        g_dbus_connection_unregister_object(connection, obj_mgr_data->objmgr_registration_id);
 
-    connection = g_dbus_object_manager_server_get_connection(obj_mgr_data->manager);
     if (!g_dbus_connection_is_closed(connection))
         g_dbus_connection_close(connection, NULL, NULL, NULL);
-    g_dbus_object_manager_server_set_connection(obj_mgr_data->manager, NULL);
-    g_object_unref(obj_mgr_data->manager);
+    if (obj_mgr_data->manager) {
+        g_dbus_object_manager_server_set_connection(obj_mgr_data->manager, NULL);
+        g_object_unref(obj_mgr_data->manager);
+    }
     g_object_unref(connection);
 
     g_free(obj_mgr_data->fake_sender);
@@ -208,10 +265,12 @@ close_connection_in_idle(gpointer user_data)
     ObjectMgrData *      obj_mgr_data, *obj_mgr_data_safe;
 
     /* Emit this for the manager */
-    g_signal_emit(server->manager,
-                  signals[PRIVATE_CONNECTION_DISCONNECTED],
-                  server->detail,
-                  info->connection);
+    if (!server->export_objects) {
+        g_signal_emit(server->manager,
+                      signals[PRIVATE_CONNECTION_DISCONNECTED],
+                      server->detail,
+                      info->connection);
+    }
 
     /* FIXME: there's a bug (754730) in GLib for which the connection
      * is marked as closed when the remote peer vanishes but its
@@ -224,10 +283,7 @@ close_connection_in_idle(gpointer user_data)
                                 obj_mgr_data_safe,
                                 &server->object_mgr_lst_head,
                                 object_mgr_lst) {
-        gs_unref_object GDBusConnection *connection = NULL;
-
-        connection = g_dbus_object_manager_server_get_connection(obj_mgr_data->manager);
-        if (connection == info->connection) {
+        if (obj_mgr_data->connection == info->connection) {
             _object_mgr_data_free(obj_mgr_data);
             break;
         }
@@ -268,35 +324,42 @@ private_server_closed_connection(GDBusConnection *conn,
 static gboolean
 private_server_new_connection(GDBusServer *server, GDBusConnection *conn, gpointer user_data)
 {
-    PrivateServer *           s = user_data;
-    ObjectMgrData *           obj_mgr_data;
-    static guint32            counter = 0;
-    GDBusObjectManagerServer *manager;
-    char *                    sender;
+    PrivateServer *s = user_data;
+    ObjectMgrData *obj_mgr_data;
+    static guint32 counter = 0;
 
     g_signal_connect(conn, "closed", G_CALLBACK(private_server_closed_connection), s);
 
-    /* Fake a sender since private connections don't have one */
-    sender = g_strdup_printf("x:y:%d", counter++);
+    obj_mgr_data             = g_slice_new0(ObjectMgrData);
+    obj_mgr_data->connection = g_object_ref(conn);
+    c_list_init(&obj_mgr_data->exported_peers_lst);
 
-    manager = g_dbus_object_manager_server_new(OBJECT_MANAGER_SERVER_BASE_PATH);
-    g_dbus_object_manager_server_set_connection(manager, conn);
+    /* Fake a sender since private connections don't have one */
+    obj_mgr_data->fake_sender = g_strdup_printf("x:y:%d", counter++);
 
-    obj_mgr_data              = g_slice_new(ObjectMgrData);
-    obj_mgr_data->manager     = manager;
-    obj_mgr_data->fake_sender = sender;
     c_list_link_tail(&s->object_mgr_lst_head, &obj_mgr_data->object_mgr_lst);
 
     _LOGD("(%s) accepted connection " NM_HASH_OBFUSCATE_PTR_FMT " on private socket",
           s->tag,
           NM_HASH_OBFUSCATE_PTR(conn));
 
-    /* Emit this for the manager.
-     *
-     * It is essential to do this from the "new-connection" signal handler, as
+    /* It is essential to do this from the "new-connection" signal handler, as
      * at that point no messages from the connection are yet processed
      * (which avoids races with registering objects). */
-    g_signal_emit(s->manager, signals[PRIVATE_CONNECTION_NEW], s->detail, conn, manager);
+    if (s->export_objects) {
+        _obj_mgr_data_export_all(s->manager, obj_mgr_data);
+        return TRUE;
+    }
+
+    obj_mgr_data->manager = g_dbus_object_manager_server_new(OBJECT_MANAGER_SERVER_BASE_PATH);
+    g_dbus_object_manager_server_set_connection(obj_mgr_data->manager, conn);
+
+    /* Emit this for the manager. */
+    g_signal_emit(s->manager,
+                  signals[PRIVATE_CONNECTION_NEW],
+                  s->detail,
+                  conn,
+                  obj_mgr_data->manager);
     return TRUE;
 }
 
@@ -306,7 +369,11 @@ private_server_authorize(GDBusAuthObserver *observer,
                          GCredentials *     credentials,
                          gpointer           user_data)
 {
-    return g_credentials_get_unix_user(credentials, NULL) == 0;
+    uid_t uid;
+
+    /* root, or the user that NetworkManager runs as (root, outside of tests). */
+    uid = g_credentials_get_unix_user(credentials, NULL);
+    return uid == 0 || uid == geteuid();
 }
 
 static gboolean
@@ -343,8 +410,23 @@ private_server_free(gpointer ptr)
     g_slice_free(PrivateServer, s);
 }
 
+/**
+ * nm_dbus_manager_private_server_register_full:
+ * @self: the #NMDBusManager
+ * @path: the path of the unix socket
+ * @tag: the tag of the server. Only one server per tag is created.
+ * @export_objects: if %TRUE, all exported objects are also exported on
+ *   the peer connections, including the object manager at "/org/freedesktop"
+ *   and all signals. The server then behaves for the (root) peers like
+ *   NetworkManager on the system bus, without going through the bus broker.
+ *   Otherwise, the peers get a separate #GDBusObjectManagerServer via the
+ *   %NM_DBUS_MANAGER_PRIVATE_CONNECTION_NEW signal.
+ */
 void
-nm_dbus_manager_private_server_register(NMDBusManager *self, const char *path, const char *tag)
+nm_dbus_manager_private_server_register_full(NMDBusManager *self,
+                                             const char *   path,
+                                             const char *   tag,
+                                             gboolean       export_objects)
 {
     NMDBusManagerPrivate *priv;
     PrivateServer *       s;
@@ -360,6 +442,11 @@ nm_dbus_manager_private_server_register(NMDBusManager *self, const char *path, c
 
     priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
 
+    if (export_objects && priv->objmgr_registration_id == 0) {
+        /* we don't export objects (configure-and-quit mode). */
+        return;
+    }
+
     /* Only one instance per tag; but don't warn */
     c_list_for_each_entry (s, &priv->private_servers_lst_head, private_servers_lst) {
         if (nm_streq0(tag, s->tag))
@@ -401,9 +488,10 @@ nm_dbus_manager_private_server_register(NMDBusManager *self, const char *path, c
 
     c_list_init(&s->object_mgr_lst_head);
 
-    s->manager = self;
-    s->detail  = g_quark_from_string(tag);
-    s->tag     = g_quark_to_string(s->detail);
+    s->manager        = self;
+    s->detail         = g_quark_from_string(tag);
+    s->tag            = g_quark_to_string(s->detail);
+    s->export_objects = export_objects;
 
     c_list_link_tail(&priv->private_servers_lst_head, &s->private_servers_lst);
 
@@ -419,10 +507,7 @@ private_server_get_connection_owner(PrivateServer *s, GDBusConnection *connectio
     nm_assert(G_IS_DBUS_CONNECTION(connection));
 
     c_list_for_each_entry (obj_mgr_data, &s->object_mgr_lst_head, object_mgr_lst) {
-        gs_unref_object GDBusConnection *c = NULL;
-
-        c = g_dbus_object_manager_server_get_connection(obj_mgr_data->manager);
-        if (c == connection)
+        if (obj_mgr_data->connection == connection)
             return obj_mgr_data->fake_sender;
     }
     return NULL;
@@ -438,7 +523,7 @@ private_server_get_connection_by_owner(PrivateServer *s, const char *owner)
 
     c_list_for_each_entry (obj_mgr_data, &s->object_mgr_lst_head, object_mgr_lst) {
         if (nm_streq(owner, obj_mgr_data->fake_sender))
-            return g_dbus_object_manager_server_get_connection(obj_mgr_data->manager);
+            return g_object_ref(obj_mgr_data->connection);
     }
     return NULL;
 }
@@ -752,6 +837,26 @@ nm_dbus_manager_get_unix_user(NMDBusManager *self, const char *sender, gulong *o
 
 /*****************************************************************************/
 
+static void _obj_flush_properties_changed(NMDBusManager *self);
+
+/*****************************************************************************/
+
+static const NMDBusPropertyIndex *
+_property_index_get(NMDBusManager *self, const NMDBusInterfaceInfoExtended *interface_info)
+{
+    NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
+    NMDBusPropertyIndex * index;
+
+    /* the interface infos are static data of the classes. Create the index of
+     * each exported interface once, and keep it as long as the manager. */
+    index = g_hash_table_lookup(priv->property_indexes, interface_info);
+    if (!index) {
+        index = nm_dbus_utils_property_index_new(interface_info);
+        g_hash_table_insert(priv->property_indexes, (gpointer) interface_info, index);
+    }
+    return index;
+}
+
 static const NMDBusInterfaceInfoExtended *
 _reg_data_get_interface_info(RegistrationData *reg_data)
 {
@@ -797,11 +902,10 @@ dbus_vtable_method_call(GDBusConnection *      connection,
 
         nm_assert(nm_streq(property_interface, interface_info->parent.name));
 
-        property_info =
-            (const NMDBusPropertyInfoExtended *) nm_dbus_utils_interface_info_lookup_property(
-                &interface_info->parent,
-                property_name,
-                NULL);
+        property_info = (const NMDBusPropertyInfoExtended *) nm_dbus_utils_property_index_lookup(
+            reg_data->property_index,
+            property_name,
+            NULL);
         if (!property_info
             || !NM_FLAGS_HAS(property_info->parent.flags, G_DBUS_PROPERTY_INFO_FLAGS_WRITABLE))
             g_return_if_reached();
@@ -869,9 +973,11 @@ _obj_get_property(RegistrationData *reg_data, guint property_idx, gboolean refet
     property_info =
         (const NMDBusPropertyInfoExtended *) (interface_info->parent.properties[property_idx]);
 
-    if (refetch)
+    if (refetch || reg_data->property_cache[property_idx].dirty) {
+        /* a dirty value is outdated, even if the PropertiesChanged signal
+         * was not yet emitted. */
         nm_clear_g_variant(&reg_data->property_cache[property_idx].value);
-    else {
+    } else {
         value = reg_data->property_cache[property_idx].value;
         if (value)
             goto out;
@@ -894,13 +1000,12 @@ dbus_vtable_get_property(GDBusConnection *connection,
                          GError **        error,
                          gpointer         user_data)
 {
-    RegistrationData *                 reg_data       = user_data;
-    const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info(reg_data);
-    guint                              property_idx;
+    RegistrationData *reg_data = user_data;
+    guint             property_idx;
 
-    if (!nm_dbus_utils_interface_info_lookup_property(&interface_info->parent,
-                                                      property_name,
-                                                      &property_idx))
+    if (!nm_dbus_utils_property_index_lookup(reg_data->property_index,
+                                             property_name,
+                                             &property_idx))
         g_return_val_if_reached(NULL);
 
     return _obj_get_property(reg_data, property_idx, FALSE);
@@ -915,6 +1020,89 @@ static const GDBusInterfaceVTable dbus_vtable = {
     .set_property = NULL,
 };
 
+static void
+_obj_mgr_data_register(NMDBusManager *self, ObjectMgrData *obj_mgr_data, RegistrationData *reg_data)
+{
+    const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info(reg_data);
+    gs_free_error GError *error                       = NULL;
+    guint                 registration_id;
+
+    registration_id = g_dbus_connection_register_object(
+        obj_mgr_data->connection,
+        reg_data->obj->internal.path,
+        NM_UNCONST_PTR(GDBusInterfaceInfo, &interface_info->parent),
+        &dbus_vtable,
+        reg_data,
+        NULL,
+        &error);
+    if (!registration_id) {
+        _LOGW("failure to register object %s on private connection: %s",
+              reg_data->obj->internal.path,
+              error->message);
+        return;
+    }
+
+    g_hash_table_insert(obj_mgr_data->registrations, reg_data, GUINT_TO_POINTER(registration_id));
+}
+
+static void
+_obj_mgr_data_unregister(ObjectMgrData *obj_mgr_data, RegistrationData *reg_data)
+{
+    gpointer registration_id;
+
+    if (g_hash_table_steal_extended(obj_mgr_data->registrations, reg_data, NULL, &registration_id))
+        g_dbus_connection_unregister_object(obj_mgr_data->connection,
+                                            GPOINTER_TO_UINT(registration_id));
+}
+
+static void
+_emit_signal(NMDBusManager *self,
+             const char *   object_path,
+             const char *   interface_name,
+             const char *   signal_name,
+             GVariant *     args)
+{
+    NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
+    ObjectMgrData *       obj_mgr_data;
+
+    if (G_LIKELY(c_list_is_empty(&priv->exported_peers_lst_head))) {
+        g_dbus_connection_emit_signal(priv->main_dbus_connection,
+                                      NULL,
+                                      object_path,
+                                      interface_name,
+                                      signal_name,
+                                      args,
+                                      NULL);
+        return;
+    }
+
+    /* the signal is also sent to the peers on private servers. */
+    if (args)
+        g_variant_ref_sink(args);
+
+    g_dbus_connection_emit_signal(priv->main_dbus_connection,
+                                  NULL,
+                                  object_path,
+                                  interface_name,
+                                  signal_name,
+                                  args,
+                                  NULL);
+
+    c_list_for_each_entry (obj_mgr_data, &priv->exported_peers_lst_head, exported_peers_lst) {
+        if (g_dbus_connection_is_closed(obj_mgr_data->connection))
+            continue;
+        g_dbus_connection_emit_signal(obj_mgr_data->connection,
+                                      NULL,
+                                      object_path,
+                                      interface_name,
+                                      signal_name,
+                                      args,
+                                      NULL);
+    }
+
+    nm_g_variant_unref(args);
+}
+
 static void
 _obj_register(NMDBusManager *self, NMDBusObject *obj)
 {
@@ -925,6 +1113,7 @@ _obj_register(NMDBusManager *self, NMDBusObject *obj)
     NMDBusObjectClass *                       klasses[10];
     const NMDBusInterfaceInfoExtended *const *prev_interface_infos = NULL;
     GVariantBuilder                           builder;
+    ObjectMgrData *                           obj_mgr_data;
 
     nm_assert(c_list_is_empty(&obj->internal.registration_lst_head));
     nm_assert(priv->main_dbus_connection);
@@ -981,9 +1170,15 @@ _obj_register(NMDBusManager *self, NMDBusObject *obj)
 
             reg_data->obj             = obj;
             reg_data->klass           = g_type_class_ref(G_TYPE_FROM_CLASS(klass));
+            reg_data->property_index  = _property_index_get(self, interface_info);
             reg_data->info_idx        = i;
             reg_data->registration_id = registration_id;
             c_list_link_tail(&obj->internal.registration_lst_head, &reg_data->registration_lst);
+
+            c_list_for_each_entry (obj_mgr_data,
+                                   &priv->exported_peers_lst_head,
+                                   exported_peers_lst)
+                _obj_mgr_data_register(self, obj_mgr_data, reg_data);
         }
     }
 
@@ -1005,15 +1200,14 @@ _obj_register(NMDBusManager *self, NMDBusObject *obj)
      *
      * In general, it's ok to export an object with frozen signals. But you better make sure
      * that all properties are in a self-consistent state when exporting the object. */
-    g_dbus_connection_emit_signal(priv->main_dbus_connection,
-                                  NULL,
-                                  OBJECT_MANAGER_SERVER_BASE_PATH,
-                                  interface_info_objmgr.name,
-                                  signal_info_objmgr_interfaces_added.name,
-                                  g_variant_new("(oa{sa{sv}})",
-                                                obj->internal.path,
-                                                _obj_collect_properties_all(obj, &builder)),
-                                  NULL);
+    _obj_flush_properties_changed(self);
+    _emit_signal(self,
+                 OBJECT_MANAGER_SERVER_BASE_PATH,
+                 interface_info_objmgr.name,
+                 signal_info_objmgr_interfaces_added.name,
+                 g_variant_new("(oa{sa{sv}})",
+                               obj->internal.path,
+                               _obj_collect_properties_all(obj, &builder)));
 }
 
 static void
@@ -1021,6 +1215,7 @@ _obj_unregister(NMDBusManager *self, NMDBusObject *obj)
 {
     NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
     RegistrationData *    reg_data;
+    ObjectMgrData *       obj_mgr_data;
     GVariantBuilder       builder;
 
     nm_assert(NM_IS_DBUS_OBJECT(obj));
@@ -1029,6 +1224,11 @@ _obj_unregister(NMDBusManager *self, NMDBusObject *obj)
     nm_assert(priv->started);
     nm_assert(!c_list_is_empty(&obj->internal.registration_lst_head));
 
+    /* emit pending PropertiesChanged signals (including those of @obj) before
+     * the object disappears. */
+    _obj_flush_properties_changed(self);
+    nm_assert(c_list_is_empty(&obj->internal.dirty_lst));
+
     g_variant_builder_init(&builder, G_VARIANT_TYPE("as"));
 
     while ((reg_data = c_list_last_entry(&obj->internal.registration_lst_head,
@@ -1043,22 +1243,24 @@ _obj_unregister(NMDBusManager *self, NMDBusObject *obj)
                                                  reg_data->registration_id))
             nm_assert_not_reached();
 
+        c_list_for_each_entry (obj_mgr_data, &priv->exported_peers_lst_head, exported_peers_lst)
+            _obj_mgr_data_unregister(obj_mgr_data, reg_data);
+
         if (interface_info->parent.properties) {
             for (i = 0; interface_info->parent.properties[i]; i++)
                 nm_clear_g_variant(&reg_data->property_cache[i].value);
         }
+        nm_clear_g_variant(&reg_data->properties_value);
 
         g_type_class_unref(reg_data->klass);
         g_free(reg_data);
     }
 
-    g_dbus_connection_emit_signal(priv->main_dbus_connection,
-                                  NULL,
-                                  OBJECT_MANAGER_SERVER_BASE_PATH,
-                                  interface_info_objmgr.name,
-                                  signal_info_objmgr_interfaces_removed.name,
-                                  g_variant_new("(oas)", obj->internal.path, &builder),
-                                  NULL);
+    _emit_signal(self,
+                 OBJECT_MANAGER_SERVER_BASE_PATH,
+                 interface_info_objmgr.name,
+                 signal_info_objmgr_interfaces_removed.name,
+                 g_variant_new("(oas)", obj->internal.path, &builder));
 }
 
 gpointer
@@ -1132,33 +1334,17 @@ _nm_dbus_manager_obj_unexport(NMDBusObject *obj)
     c_list_unlink(&obj->internal.objects_lst);
 }
 
-void
-_nm_dbus_manager_obj_notify(NMDBusObject *obj, guint n_pspecs, const GParamSpec *const *pspecs)
+static void
+_obj_emit_properties_changed(NMDBusManager *self, NMDBusObject *obj)
 {
-    NMDBusManager *       self;
-    NMDBusManagerPrivate *priv;
+    NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
     RegistrationData *    reg_data;
-    guint                 i, p;
+    guint                 i;
     gboolean              any_legacy_signals    = FALSE;
     gboolean              any_legacy_properties = FALSE;
     GVariantBuilder       legacy_builder;
     GVariant *            device_statistics_args = NULL;
 
-    nm_assert(NM_IS_DBUS_OBJECT(obj));
-    nm_assert(obj->internal.path);
-    nm_assert(NM_IS_DBUS_MANAGER(obj->internal.bus_manager));
-    nm_assert(!c_list_is_empty(&obj->internal.objects_lst));
-
-    self = obj->internal.bus_manager;
-    priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
-
-    nm_assert(!priv->started || priv->objmgr_registration_id != 0);
-    nm_assert(priv->objmgr_registration_id == 0 || priv->main_dbus_connection);
-    nm_assert(c_list_is_empty(&obj->internal.registration_lst_head) != priv->started);
-
-    if (G_UNLIKELY(!priv->started))
-        return;
-
     c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
         if (_reg_data_get_interface_info(reg_data)->legacy_property_changed) {
             any_legacy_signals = TRUE;
@@ -1166,13 +1352,8 @@ _nm_dbus_manager_obj_notify(NMDBusObject *obj, guint n_pspecs, const GParamSpec
         }
     }
 
-    /* do a naive search for the matching NMDBusPropertyInfoExtended infos. Since the number of
-     * (interfaces x properties) is static and possibly small, this naive search is effectively
-     * O(1). We might wanna introduce some index to lookup the properties in question faster.
-     *
-     * The nice part of this implementation is however, that the order in which properties
-     * are added to the GVariant is strictly defined to be the order in which the D-Bus property-info
-     * is declared. Getting a defined ordering with some smart lookup would be hard. */
+    /* The order in which properties are added to the GVariant is strictly defined
+     * to be the order in which the D-Bus property-info is declared. */
     c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
         const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info(reg_data);
         gboolean                           has_properties = FALSE;
@@ -1186,34 +1367,29 @@ _nm_dbus_manager_obj_notify(NMDBusObject *obj, guint n_pspecs, const GParamSpec
         for (i = 0; interface_info->parent.properties[i]; i++) {
             const NMDBusPropertyInfoExtended *property_info =
                 (const NMDBusPropertyInfoExtended *) interface_info->parent.properties[i];
+            gs_unref_variant GVariant *value = NULL;
 
-            for (p = 0; p < n_pspecs; p++) {
-                const GParamSpec *pspec          = pspecs[p];
-                gs_unref_variant GVariant *value = NULL;
-
-                if (!nm_streq(property_info->property_name, pspec->name))
-                    continue;
-
-                value = _obj_get_property(reg_data, i, TRUE);
-
-                if (property_info->include_in_legacy_property_changed && any_legacy_signals) {
-                    /* also track the value in the legacy_builder to emit legacy signals below. */
-                    if (!any_legacy_properties) {
-                        any_legacy_properties = TRUE;
-                        g_variant_builder_init(&legacy_builder, G_VARIANT_TYPE("a{sv}"));
-                    }
-                    g_variant_builder_add(&legacy_builder,
-                                          "{sv}",
-                                          property_info->parent.name,
-                                          value);
-                }
+            if (!reg_data->property_cache[i].dirty)
+                continue;
 
-                if (!has_properties) {
-                    has_properties = TRUE;
-                    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+            reg_data->property_cache[i].dirty = FALSE;
+
+            value = _obj_get_property(reg_data, i, TRUE);
+
+            if (property_info->include_in_legacy_property_changed && any_legacy_signals) {
+                /* also track the value in the legacy_builder to emit legacy signals below. */
+                if (!any_legacy_properties) {
+                    any_legacy_properties = TRUE;
+                    g_variant_builder_init(&legacy_builder, G_VARIANT_TYPE("a{sv}"));
                 }
-                g_variant_builder_add(&builder, "{sv}", property_info->parent.name, value);
+                g_variant_builder_add(&legacy_builder, "{sv}", property_info->parent.name, value);
             }
+
+            if (!has_properties) {
+                has_properties = TRUE;
+                g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+            }
+            g_variant_builder_add(&builder, "{sv}", property_info->parent.name, value);
         }
 
         if (!has_properties)
@@ -1229,27 +1405,24 @@ _nm_dbus_manager_obj_notify(NMDBusObject *obj, guint n_pspecs, const GParamSpec
         }
 
         g_variant_builder_init(&invalidated_builder, G_VARIANT_TYPE("as"));
-        g_dbus_connection_emit_signal(
-            priv->main_dbus_connection,
-            NULL,
+        _emit_signal(
+            self,
             obj->internal.path,
             "org.freedesktop.DBus.Properties",
             "PropertiesChanged",
-            g_variant_new("(s@a{sv}as)", interface_info->parent.name, args, &invalidated_builder),
-            NULL);
+            g_variant_new("(s@a{sv}as)", interface_info->parent.name, args, &invalidated_builder));
+        priv->n_properties_changed_emitted++;
     }
 
     if (G_UNLIKELY(device_statistics_args)) {
         /* this is a special interface: it has a legacy PropertiesChanged signal,
          * however, contrary to other interfaces with ~regular~ legacy signals,
          * we only notify about properties that actually belong to this interface. */
-        g_dbus_connection_emit_signal(priv->main_dbus_connection,
-                                      NULL,
-                                      obj->internal.path,
-                                      nm_interface_info_device_statistics.parent.name,
-                                      "PropertiesChanged",
-                                      g_variant_new("(@a{sv})", device_statistics_args),
-                                      NULL);
+        _emit_signal(self,
+                     obj->internal.path,
+                     nm_interface_info_device_statistics.parent.name,
+                     "PropertiesChanged",
+                     g_variant_new("(@a{sv})", device_statistics_args));
         g_variant_unref(device_statistics_args);
     }
 
@@ -1279,16 +1452,113 @@ _nm_dbus_manager_obj_notify(NMDBusObject *obj, guint n_pspecs, const GParamSpec
                 _reg_data_get_interface_info(reg_data);
 
             if (interface_info->legacy_property_changed) {
-                g_dbus_connection_emit_signal(priv->main_dbus_connection,
-                                              NULL,
-                                              obj->internal.path,
-                                              interface_info->parent.name,
-                                              "PropertiesChanged",
-                                              args,
-                                              NULL);
+                _emit_signal(self,
+                             obj->internal.path,
+                             interface_info->parent.name,
+                             "PropertiesChanged",
+                             args);
+            }
+        }
+    }
+}
+
+static void
+_obj_flush_properties_changed(NMDBusManager *self)
+{
+    NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
+    NMDBusObject *        obj;
+    guint                 n_objects = 0;
+
+    nm_clear_g_source(&priv->dirty_idle_id);
+
+    while ((obj = c_list_first_entry(&priv->dirty_lst_head, NMDBusObject, internal.dirty_lst))) {
+        c_list_unlink(&obj->internal.dirty_lst);
+        _obj_emit_properties_changed(self, obj);
+        n_objects++;
+    }
+
+    if (n_objects > 0) {
+        _LOGT("properties-changed: flushed %u objects (%" G_GUINT64_FORMAT
+              " signals emitted, %" G_GUINT64_FORMAT " notifications coalesced in total)",
+              n_objects,
+              priv->n_properties_changed_emitted,
+              priv->n_properties_changed_coalesced);
+    }
+}
+
+static gboolean
+_obj_flush_properties_changed_cb(gpointer user_data)
+{
+    NMDBusManager *       self = user_data;
+    NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
+
+    priv->dirty_idle_id = 0;
+    _obj_flush_properties_changed(self);
+    return G_SOURCE_REMOVE;
+}
+
+void
+_nm_dbus_manager_obj_notify(NMDBusObject *obj, guint n_pspecs, const GParamSpec *const *pspecs)
+{
+    NMDBusManager *       self;
+    NMDBusManagerPrivate *priv;
+    RegistrationData *    reg_data;
+    guint                 p;
+    gboolean              any_dirty = FALSE;
+
+    nm_assert(NM_IS_DBUS_OBJECT(obj));
+    nm_assert(obj->internal.path);
+    nm_assert(NM_IS_DBUS_MANAGER(obj->internal.bus_manager));
+    nm_assert(!c_list_is_empty(&obj->internal.objects_lst));
+
+    self = obj->internal.bus_manager;
+    priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
+
+    nm_assert(!priv->started || priv->objmgr_registration_id != 0);
+    nm_assert(priv->objmgr_registration_id == 0 || priv->main_dbus_connection);
+    nm_assert(c_list_is_empty(&obj->internal.registration_lst_head) != priv->started);
+
+    if (G_UNLIKELY(!priv->started))
+        return;
+
+    /* Only mark the properties as dirty. The PropertiesChanged signals are emitted
+     * once per main loop iteration, so that repeated changes of the same properties
+     * (possibly of many objects) are combined. */
+    c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
+        const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info(reg_data);
+
+        if (!interface_info->parent.properties)
+            continue;
+
+        for (p = 0; p < n_pspecs; p++) {
+            guint idx;
+
+            if (!nm_dbus_utils_property_index_lookup_by_pspec(reg_data->property_index,
+                                                              pspecs[p],
+                                                              &idx))
+                continue;
+
+            nm_clear_g_variant(&reg_data->properties_value);
+
+            if (reg_data->property_cache[idx].dirty) {
+                priv->n_properties_changed_coalesced++;
+                continue;
             }
+            reg_data->property_cache[idx].dirty = TRUE;
+            any_dirty                           = TRUE;
         }
     }
+
+    if (!any_dirty)
+        return;
+
+    if (c_list_is_empty(&obj->internal.dirty_lst))
+        c_list_link_tail(&priv->dirty_lst_head, &obj->internal.dirty_lst);
+
+    if (priv->dirty_idle_id == 0) {
+        priv->dirty_idle_id =
+            g_idle_add_full(G_PRIORITY_HIGH, _obj_flush_properties_changed_cb, self, NULL);
+    }
 }
 
 void
@@ -1313,26 +1583,28 @@ _nm_dbus_manager_obj_emit_signal(NMDBusObject *                     obj,
         return;
     }
 
-    g_dbus_connection_emit_signal(priv->main_dbus_connection,
-                                  NULL,
-                                  obj->internal.path,
-                                  interface_info->parent.name,
-                                  signal_info->name,
-                                  args,
-                                  NULL);
+    /* preserve the order of the signals. */
+    _obj_flush_properties_changed(self);
+
+    _emit_signal(self, obj->internal.path, interface_info->parent.name, signal_info->name, args);
 }
 
 /*****************************************************************************/
 
-static GVariantBuilder *
-_obj_collect_properties_per_interface(NMDBusObject *    obj,
-                                      RegistrationData *reg_data,
-                                      GVariantBuilder * builder)
+static GVariant *
+_obj_collect_properties_per_interface(NMDBusObject *obj, RegistrationData *reg_data)
 {
     const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info(reg_data);
+    GVariantBuilder                    builder;
     guint                              i;
 
-    g_variant_builder_init(builder, G_VARIANT_TYPE("a{sv}"));
+    /* Building the dictionary anew for every GetManagedObjects() call is expensive
+     * with many objects, hence it is cached until a property of the interface
+     * changes. */
+    if (reg_data->properties_value)
+        return g_variant_ref(reg_data->properties_value);
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
     if (interface_info->parent.properties) {
         for (i = 0; interface_info->parent.properties[i]; i++) {
             const NMDBusPropertyInfoExtended *property_info =
@@ -1340,10 +1612,12 @@ _obj_collect_properties_per_interface(NMDBusObject *    obj,
             gs_unref_variant GVariant *variant = NULL;
 
             variant = _obj_get_property(reg_data, i, FALSE);
-            g_variant_builder_add(builder, "{sv}", property_info->parent.name, variant);
+            g_variant_builder_add(&builder, "{sv}", property_info->parent.name, variant);
         }
     }
-    return builder;
+
+    reg_data->properties_value = g_variant_ref_sink(g_variant_builder_end(&builder));
+    return g_variant_ref(reg_data->properties_value);
 }
 
 static GVariantBuilder *
@@ -1354,13 +1628,13 @@ _obj_collect_properties_all(NMDBusObject *obj, GVariantBuilder *builder)
     g_variant_builder_init(builder, G_VARIANT_TYPE("a{sa{sv}}"));
 
     c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
-        GVariantBuilder properties_builder;
+        gs_unref_variant GVariant *properties = NULL;
 
-        g_variant_builder_add(
-            builder,
-            "{sa{sv}}",
-            _reg_data_get_interface_info(reg_data)->parent.name,
-            _obj_collect_properties_per_interface(obj, reg_data, &properties_builder));
+        properties = _obj_collect_properties_per_interface(obj, reg_data);
+        g_variant_builder_add(builder,
+                              "{s@a{sv}}",
+                              _reg_data_get_interface_info(reg_data)->parent.name,
+                              properties);
     }
 
     return builder;
@@ -1415,6 +1689,39 @@ dbus_vtable_objmgr_method_call(GDBusConnection *      connection,
 static const GDBusInterfaceVTable dbus_vtable_objmgr = {.method_call =
                                                             dbus_vtable_objmgr_method_call};
 
+static void
+_obj_mgr_data_export_all(NMDBusManager *self, ObjectMgrData *obj_mgr_data)
+{
+    NMDBusManagerPrivate *priv  = NM_DBUS_MANAGER_GET_PRIVATE(self);
+    gs_free_error GError *error = NULL;
+    NMDBusObject *        obj;
+    RegistrationData *    reg_data;
+
+    nm_assert(!obj_mgr_data->registrations);
+
+    obj_mgr_data->registrations = g_hash_table_new(nm_direct_hash, NULL);
+
+    obj_mgr_data->objmgr_registration_id = g_dbus_connection_register_object(
+        obj_mgr_data->connection,
+        OBJECT_MANAGER_SERVER_BASE_PATH,
+        NM_UNCONST_PTR(GDBusInterfaceInfo, &interface_info_objmgr),
+        &dbus_vtable_objmgr,
+        self,
+        NULL,
+        &error);
+    if (obj_mgr_data->objmgr_registration_id == 0)
+        _LOGW("failure to register object manager on private connection: %s", error->message);
+
+    /* before the manager is started, the objects are not yet registered. They
+     * get exported on the peer connection when they get registered. */
+    c_list_for_each_entry (obj, &priv->objects_lst_head, internal.objects_lst) {
+        c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst)
+            _obj_mgr_data_register(self, obj_mgr_data, reg_data);
+    }
+
+    c_list_link_tail(&priv->exported_peers_lst_head, &obj_mgr_data->exported_peers_lst);
+}
+
 static const GDBusSignalInfo signal_info_objmgr_interfaces_added = NM_DEFINE_GDBUS_SIGNAL_INFO_INIT(
     "InterfacesAdded",
     .args = NM_DEFINE_GDBUS_ARG_INFOS(
@@ -1585,12 +1892,20 @@ nm_dbus_manager_init(NMDBusManager *self)
     NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE(self);
 
     c_list_init(&priv->private_servers_lst_head);
+    c_list_init(&priv->exported_peers_lst_head);
     c_list_init(&priv->objects_lst_head);
+    c_list_init(&priv->dirty_lst_head);
 
     priv->objects_by_path =
         g_hash_table_new((GHashFunc) _objects_by_path_hash, (GEqualFunc) _objects_by_path_equal);
 
     c_list_init(&priv->caller_info_lst_head);
+
+    priv->property_indexes =
+        g_hash_table_new_full(nm_direct_hash,
+                              NULL,
+                              NULL,
+                              (GDestroyNotify) nm_dbus_utils_property_index_free);
 }
 
 static void
@@ -1608,6 +1923,12 @@ dispose(GObject *object)
 
     nm_clear_pointer(&priv->objects_by_path, g_hash_table_destroy);
 
+    /* the registrations of the objects referred to the indexes. */
+    nm_clear_pointer(&priv->property_indexes, g_hash_table_destroy);
+
+    nm_assert(c_list_is_empty(&priv->dirty_lst_head));
+    nm_clear_g_source(&priv->dirty_idle_id);
+
     c_list_for_each_entry_safe (s, s_safe, &priv->private_servers_lst_head, private_servers_lst)
         private_server_free(s);
 
@@ -82,8 +82,16 @@ gboolean nm_dbus_manager_get_caller_info_from_message(NMDBusManager *  self,
                                                       gulong *         out_uid,
                                                       gulong *         out_pid);
 
-void
-nm_dbus_manager_private_server_register(NMDBusManager *self, const char *path, const char *tag);
+void nm_dbus_manager_private_server_register_full(NMDBusManager *self,
+                                                  const char *   path,
+                                                  const char *   tag,
+                                                  gboolean       export_objects);
+
+static inline void
+nm_dbus_manager_private_server_register(NMDBusManager *self, const char *path, const char *tag)
+{
+    nm_dbus_manager_private_server_register_full(self, path, tag, FALSE);
+}
 
 NMAuthSubject *nm_dbus_manager_new_auth_subject_from_context(GDBusMethodInvocation *context);
 
@@ -75,6 +75,10 @@ struct _NMDBusObjectInternal {
     CList          objects_lst;
     CList          registration_lst_head;
 
+    /* linked in the manager's list of objects with pending PropertiesChanged
+     * signals. */
+    CList dirty_lst;
+
     /* we perform asynchronous operation on exported objects. For example, we receive
      * a Set property call, and asynchronously validate the operation. We must make
      * sure that when the authentication is complete, that we are still looking at
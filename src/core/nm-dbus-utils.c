@@ -15,30 +15,118 @@ const GDBusSignalInfo nm_signal_info_property_changed_legacy = NM_DEFINE_GDBUS_S
     "PropertiesChanged",
     .args = NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("properties", "a{sv}"), ), );
 
-GDBusPropertyInfo *
-nm_dbus_utils_interface_info_lookup_property(const GDBusInterfaceInfo *interface_info,
-                                             const char *              property_name,
-                                             guint *                   property_idx)
+struct _NMDBusPropertyIndex {
+    const NMDBusInterfaceInfoExtended *interface_info;
+
+    /* map the D-Bus property name to the property index (plus one). */
+    GHashTable *idx_by_name;
+
+    /* map the GObject property name to the property index (plus one). */
+    GHashTable *idx_by_property_name;
+};
+
+/**
+ * nm_dbus_utils_property_index_new:
+ * @interface_info: the interface info
+ *
+ * The interface infos are static, constant data, so they cannot carry
+ * lookup tables themselves. Instead, the user creates an index once per
+ * interface, and keeps it as long as it looks up properties of @interface_info.
+ *
+ * Returns: (transfer full): the index of the properties of @interface_info.
+ *   Free it with nm_dbus_utils_property_index_free().
+ */
+NMDBusPropertyIndex *
+nm_dbus_utils_property_index_new(const NMDBusInterfaceInfoExtended *interface_info)
 {
-    guint i;
+    NMDBusPropertyIndex *index;
+    guint                i;
 
     nm_assert(interface_info);
+
+    index  = g_slice_new(NMDBusPropertyIndex);
+    *index = (NMDBusPropertyIndex){
+        .interface_info       = interface_info,
+        .idx_by_name          = g_hash_table_new(nm_str_hash, g_str_equal),
+        .idx_by_property_name = g_hash_table_new(nm_str_hash, g_str_equal),
+    };
+
+    if (interface_info->parent.properties) {
+        for (i = 0; interface_info->parent.properties[i]; i++) {
+            const NMDBusPropertyInfoExtended *info =
+                (const NMDBusPropertyInfoExtended *) interface_info->parent.properties[i];
+
+            g_hash_table_insert(index->idx_by_name,
+                                (gpointer) info->parent.name,
+                                GUINT_TO_POINTER(i + 1u));
+            g_hash_table_insert(index->idx_by_property_name,
+                                (gpointer) info->property_name,
+                                GUINT_TO_POINTER(i + 1u));
+        }
+    }
+
+    return index;
+}
+
+void
+nm_dbus_utils_property_index_free(NMDBusPropertyIndex *index)
+{
+    if (!index)
+        return;
+
+    g_hash_table_unref(index->idx_by_name);
+    g_hash_table_unref(index->idx_by_property_name);
+    g_slice_free(NMDBusPropertyIndex, index);
+}
+
+GDBusPropertyInfo *
+nm_dbus_utils_property_index_lookup(const NMDBusPropertyIndex *index,
+                                    const char *               property_name,
+                                    guint *                    property_idx)
+{
+    guint idx;
+
+    nm_assert(index);
     nm_assert(property_name);
 
     /* there is also g_dbus_interface_info_lookup_property(), however that makes use
      * of a global cache. */
-    if (interface_info->properties) {
-        for (i = 0; interface_info->properties[i]; i++) {
-            GDBusPropertyInfo *info = interface_info->properties[i];
+    idx = GPOINTER_TO_UINT(g_hash_table_lookup(index->idx_by_name, property_name));
+    if (idx == 0)
+        return NULL;
+
+    idx--;
+    nm_assert(nm_streq(index->interface_info->parent.properties[idx]->name, property_name));
+    NM_SET_OUT(property_idx, idx);
+    return index->interface_info->parent.properties[idx];
+}
 
-            if (nm_streq(info->name, property_name)) {
-                NM_SET_OUT(property_idx, i);
-                return info;
-            }
-        }
-    }
+/**
+ * nm_dbus_utils_property_index_lookup_by_pspec:
+ * @index: the index of the interface info
+ * @pspec: the #GParamSpec of a GObject property
+ * @property_idx: (out) (allow-none): the index of the D-Bus property
+ *
+ * Returns: the D-Bus property of the interface that is backed by the
+ *   GObject property @pspec, or %NULL if there is no such property.
+ */
+const NMDBusPropertyInfoExtended *
+nm_dbus_utils_property_index_lookup_by_pspec(const NMDBusPropertyIndex *index,
+                                             const GParamSpec *         pspec,
+                                             guint *                    property_idx)
+{
+    guint idx;
 
-    return NULL;
+    nm_assert(index);
+    nm_assert(pspec);
+
+    idx = GPOINTER_TO_UINT(g_hash_table_lookup(index->idx_by_property_name, pspec->name));
+    if (idx == 0)
+        return NULL;
+
+    idx--;
+    NM_SET_OUT(property_idx, idx);
+    return (const NMDBusPropertyInfoExtended *) index->interface_info->parent.properties[idx];
 }
 
 GDBusMethodInfo *
@@ -167,10 +167,21 @@ extern const GDBusSignalInfo nm_signal_info_property_changed_legacy;
 
 /*****************************************************************************/
 
-GDBusPropertyInfo *
-nm_dbus_utils_interface_info_lookup_property(const GDBusInterfaceInfo *interface_info,
-                                             const char *              property_name,
-                                             guint *                   property_idx);
+typedef struct _NMDBusPropertyIndex NMDBusPropertyIndex;
+
+NMDBusPropertyIndex *
+nm_dbus_utils_property_index_new(const NMDBusInterfaceInfoExtended *interface_info);
+
+void nm_dbus_utils_property_index_free(NMDBusPropertyIndex *index);
+
+GDBusPropertyInfo *nm_dbus_utils_property_index_lookup(const NMDBusPropertyIndex *index,
+                                                       const char *               property_name,
+                                                       guint *                    property_idx);
+
+const NMDBusPropertyInfoExtended *
+nm_dbus_utils_property_index_lookup_by_pspec(const NMDBusPropertyIndex *index,
+                                             const GParamSpec *         pspec,
+                                             guint *                    property_idx);
 
 GDBusMethodInfo *
 nm_dbus_utils_interface_info_lookup_method(const GDBusInterfaceInfo *interface_info,
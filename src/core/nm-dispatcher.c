@@ -22,6 +22,7 @@
 #include "settings/nm-settings-connection.h"
 #include "platform/nm-platform.h"
 #include "nm-core-internal.h"
+#include "nm-config.h"
 
 #define CALL_TIMEOUT (1000 * 60 * 10) /* 10 minutes for all scripts */
 
@@ -58,6 +59,7 @@ struct NMDispatcherCallId {
     gpointer           user_data;
     const char *       log_ifname;
     const char *       log_con_uuid;
+    GVariant *         parameters;
     NMDispatcherAction action;
     guint              idle_id;
     guint32            request_id;
@@ -77,6 +79,7 @@ struct NMDispatcherCallId {
 static struct {
     GDBusConnection *dbus_connection;
     GHashTable *     requests;
+    GHashTable *     coalesce_table;
     guint            request_id_counter;
 } gl;
 
@@ -105,6 +108,7 @@ dispatcher_call_id_new(guint32            request_id,
     call_id->callback   = callback;
     call_id->user_data  = user_data;
     call_id->idle_id    = 0;
+    call_id->parameters = NULL;
 
     extra_strings = &call_id->extra_strings[0];
 
@@ -128,6 +132,7 @@ static void
 dispatcher_call_id_free(NMDispatcherCallId *call_id)
 {
     nm_clear_g_source(&call_id->idle_id);
+    nm_clear_pointer(&call_id->parameters, g_variant_unref);
     g_free(call_id);
 }
 
@@ -139,6 +144,7 @@ _init_dispatcher(void)
     if (G_UNLIKELY(gl.requests == NULL)) {
         gl.requests        = g_hash_table_new(nm_direct_hash, NULL);
         gl.dbus_connection = nm_g_object_ref(NM_MAIN_DBUS_CONNECTION_GET);
+        gl.coalesce_table  = nm_dispatcher_coalesce_table_new();
 
         if (!gl.dbus_connection)
             _LOGD("No D-Bus connection to talk with NetworkManager-dispatcher service");
@@ -396,32 +402,91 @@ dispatcher_results_process(guint32     request_id,
                            const char *log_con_uuid,
                            GVariant *  v_results)
 {
-    nm_auto_free_variant_iter GVariantIter *results = NULL;
-    const char *                            script, *err;
-    guint32                                 result;
+    gs_unref_variant GVariant *results = NULL;
+    gsize                      n;
+    gsize                      i;
 
-    g_variant_get(v_results, "(a(sus))", &results);
+    /* the results of "Action2" have a further dictionary with details about
+     * each script, those of "Action" not. */
+    results = g_variant_get_child_value(v_results, 0);
+    n       = g_variant_n_children(results);
 
-    if (g_variant_iter_n_children(results) == 0) {
+    if (n == 0) {
         _LOG2D(request_id, log_ifname, log_con_uuid, "succeeded but no scripts invoked");
         return;
     }
 
-    while (g_variant_iter_next(results, "(&su&s)", &script, &result, &err)) {
+    for (i = 0; i < n; i++) {
+        gs_unref_variant GVariant *result_v = g_variant_get_child_value(results, i);
+        const char *               script;
+        const char *               err;
+        guint32                    result;
+        guint32                    duration_msec;
+        char                       duration_buf[50];
+
+        g_variant_get_child(result_v, 0, "&s", &script);
+        g_variant_get_child(result_v, 1, "u", &result);
+        g_variant_get_child(result_v, 2, "&s", &err);
+
+        duration_buf[0] = '\0';
+        if (g_variant_n_children(result_v) > 3) {
+            gs_unref_variant GVariant *details = g_variant_get_child_value(result_v, 3);
+
+            if (g_variant_lookup(details, "duration-msec", "u", &duration_msec))
+                nm_sprintf_buf(duration_buf, " after %u msec", (guint) duration_msec);
+        }
+
         if (result == DISPATCH_RESULT_SUCCESS) {
-            _LOG2D(request_id, log_ifname, log_con_uuid, "%s succeeded", script);
+            _LOG2D(request_id, log_ifname, log_con_uuid, "%s succeeded%s", script, duration_buf);
         } else {
             _LOG2W(request_id,
                    log_ifname,
                    log_con_uuid,
-                   "%s failed (%s): %s",
+                   "%s failed%s (%s): %s",
                    script,
+                   duration_buf,
                    dispatch_result_to_string(result),
                    err);
         }
     }
 }
 
+/* Converts the parameters for "Action2" to those of the older "Action" method,
+ * which has a "debug" flag instead of the options dictionary. */
+static GVariant *
+_action2_parameters_to_legacy(GVariant *parameters)
+{
+    gs_unref_variant GVariant *options = NULL;
+    GVariantBuilder            builder;
+    gboolean                   debug = FALSE;
+    gsize                      n;
+    gsize                      i;
+
+    n = g_variant_n_children(parameters);
+    nm_assert(n > 0);
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE_TUPLE);
+    for (i = 0; i < n - 1; i++) {
+        gs_unref_variant GVariant *child = g_variant_get_child_value(parameters, i);
+
+        g_variant_builder_add_value(&builder, child);
+    }
+
+    options = g_variant_get_child_value(parameters, n - 1);
+    g_variant_lookup(options, "debug", "b", &debug);
+    g_variant_builder_add(&builder, "b", debug);
+
+    return g_variant_builder_end(&builder);
+}
+
+static gboolean
+_action2_unsupported(GError *error)
+{
+    /* a dispatcher service from before "Action2" was added is still running,
+     * for example during an upgrade. */
+    return g_error_matches(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD);
+}
+
 static void
 dispatcher_done_cb(GObject *source, GAsyncResult *result, gpointer user_data)
 {
@@ -432,6 +497,24 @@ dispatcher_done_cb(GObject *source, GAsyncResult *result, gpointer user_data)
     nm_assert((gpointer) source == gl.dbus_connection);
 
     ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), result, &error);
+    if (!ret && call_id->parameters && _action2_unsupported(error)) {
+        gs_unref_variant GVariant *parameters = g_steal_pointer(&call_id->parameters);
+
+        _LOG3D(call_id, "dispatcher service does not support Action2, retry with Action");
+        g_dbus_connection_call(gl.dbus_connection,
+                               NM_DISPATCHER_DBUS_SERVICE,
+                               NM_DISPATCHER_DBUS_PATH,
+                               NM_DISPATCHER_DBUS_INTERFACE,
+                               "Action",
+                               _action2_parameters_to_legacy(parameters),
+                               G_VARIANT_TYPE("(a(sus))"),
+                               G_DBUS_CALL_FLAGS_NONE,
+                               CALL_TIMEOUT,
+                               NULL,
+                               dispatcher_done_cb,
+                               call_id);
+        return;
+    }
     if (!ret) {
         if (_nm_dbus_error_has_name(error, "org.freedesktop.systemd1.LoadFailed")) {
             g_dbus_error_strip_remote_error(error);
@@ -476,6 +559,162 @@ action_to_string(NMDispatcherAction action)
     return action_table[(gsize) action];
 }
 
+/*****************************************************************************/
+
+static gboolean
+_coalesce_enabled(NMDispatcherAction action)
+{
+    if (!NM_IN_SET(action,
+                   NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+                   NM_DISPATCHER_ACTION_DHCP6_CHANGE,
+                   NM_DISPATCHER_ACTION_CONNECTIVITY_CHANGE))
+        return FALSE;
+
+    return nm_config_data_get_value_boolean(nm_config_get_data(nm_config_get()),
+                                            NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                            NM_CONFIG_KEYFILE_KEY_MAIN_DISPATCHER_COALESCE,
+                                            FALSE);
+}
+
+static guint32
+_max_parallel_get(void)
+{
+    return nm_config_data_get_value_int64(nm_config_get_data(nm_config_get()),
+                                          NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                          NM_CONFIG_KEYFILE_KEY_MAIN_DISPATCHER_MAX_PARALLEL,
+                                          10,
+                                          1,
+                                          G_MAXINT32,
+                                          1);
+}
+
+static guint
+_coalesce_data_hash(gconstpointer ptr)
+{
+    const NMDispatcherCoalesceData *data = ptr;
+    NMHashState                     h;
+
+    nm_hash_init(&h, 1734593181u);
+    nm_hash_update_val(&h, data->device);
+    nm_hash_update_val(&h, data->action);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_coalesce_data_equal(gconstpointer a, gconstpointer b)
+{
+    const NMDispatcherCoalesceData *data_a = a;
+    const NMDispatcherCoalesceData *data_b = b;
+
+    return data_a->device == data_b->device && data_a->action == data_b->action;
+}
+
+GHashTable *
+nm_dispatcher_coalesce_table_new(void)
+{
+    return g_hash_table_new(_coalesce_data_hash, _coalesce_data_equal);
+}
+
+/**
+ * nm_dispatcher_coalesce_begin:
+ * @table: the table of the calls in flight
+ * @device: (allow-none): the #GObject of the device
+ * @action: the action of the event
+ * @connectivity_state: the connectivity state of the event
+ *
+ * Returns: a new entry if the caller shall send a call for the event.
+ *   It stays in @table until nm_dispatcher_coalesce_end(). If there is already
+ *   a call for @device and @action in flight, the event is merged into its
+ *   entry and %NULL is returned.
+ */
+NMDispatcherCoalesceData *
+nm_dispatcher_coalesce_begin(GHashTable *        table,
+                             gpointer            device,
+                             NMDispatcherAction  action,
+                             NMConnectivityState connectivity_state)
+{
+    const NMDispatcherCoalesceData needle = {
+        .device = device,
+        .action = action,
+    };
+    NMDispatcherCoalesceData *     data;
+
+    data = g_hash_table_lookup(table, &needle);
+    if (data) {
+        data->pending            = TRUE;
+        data->connectivity_state = connectivity_state;
+        return NULL;
+    }
+
+    data  = g_slice_new(NMDispatcherCoalesceData);
+    *data = (NMDispatcherCoalesceData){
+        .device             = nm_g_object_ref(device),
+        .action             = action,
+        .connectivity_state = connectivity_state,
+        .pending            = FALSE,
+    };
+    g_hash_table_add(table, data);
+    return data;
+}
+
+/**
+ * nm_dispatcher_coalesce_end:
+ * @table: the table of the calls in flight
+ * @data: the entry of the call that completed
+ *
+ * Removes @data from @table, so that further events start a new call.
+ * The caller frees @data with nm_dispatcher_coalesce_data_free().
+ *
+ * Returns: whether events were merged while the call was in flight. In
+ *   that case, the caller sends one more call.
+ */
+gboolean
+nm_dispatcher_coalesce_end(GHashTable *table, NMDispatcherCoalesceData *data)
+{
+    if (!g_hash_table_remove(table, data))
+        g_return_val_if_reached(FALSE);
+    return data->pending;
+}
+
+void
+nm_dispatcher_coalesce_data_free(NMDispatcherCoalesceData *data)
+{
+    nm_g_object_unref(data->device);
+    g_slice_free(NMDispatcherCoalesceData, data);
+}
+
+static void
+_coalesce_done_cb(NMDispatcherCallId *call_id, gpointer user_data)
+{
+    NMDispatcherCoalesceData *data = user_data;
+
+    /* Remove the entry first, so that the new call below is not merged into
+     * the one that just completed. */
+    if (!nm_dispatcher_coalesce_end(gl.coalesce_table, data))
+        goto out;
+
+    if (data->action == NM_DISPATCHER_ACTION_CONNECTIVITY_CHANGE) {
+        _LOG3D(call_id, "dispatching coalesced connectivity-change events");
+        nm_dispatcher_call_connectivity(data->connectivity_state, NULL, NULL, NULL);
+        goto out;
+    }
+
+    if (nm_device_get_state(data->device) > NM_DEVICE_STATE_ACTIVATED) {
+        _LOG3D(call_id,
+               "drop coalesced '%s' events as the device is going down",
+               action_to_string(data->action));
+        goto out;
+    }
+
+    _LOG3D(call_id, "dispatching coalesced '%s' events", action_to_string(data->action));
+    nm_dispatcher_call_device(data->action, data->device, NULL, NULL, NULL, NULL);
+
+out:
+    nm_dispatcher_coalesce_data_free(data);
+}
+
+/*****************************************************************************/
+
 static gboolean
 _dispatcher_call(NMDispatcherAction    action,
                  gboolean              blocking,
@@ -498,12 +737,13 @@ _dispatcher_call(NMDispatcherAction    action,
     GVariantBuilder  device_proxy_props;
     GVariantBuilder  device_ip4_props;
     GVariantBuilder  device_ip6_props;
-    gs_unref_variant GVariant *parameters_floating = NULL;
-    gs_unref_variant GVariant *device_dhcp4_props  = NULL;
-    gs_unref_variant GVariant *device_dhcp6_props  = NULL;
+    gs_unref_variant GVariant *parameters         = NULL;
+    gs_unref_variant GVariant *device_dhcp4_props = NULL;
+    gs_unref_variant GVariant *device_dhcp6_props = NULL;
     GVariantBuilder            vpn_proxy_props;
     GVariantBuilder            vpn_ip4_props;
     GVariantBuilder            vpn_ip6_props;
+    GVariantBuilder            options;
     NMDispatcherCallId *       call_id;
     guint                      request_id;
     const char *               connectivity_state_string = "UNKNOWN";
@@ -548,6 +788,24 @@ _dispatcher_call(NMDispatcherAction    action,
                blocking ? " (blocking)" : (callback ? " (with callback)" : ""));
     }
 
+    if (!blocking && !callback && !out_call_id && _coalesce_enabled(action)) {
+        NMDispatcherCoalesceData *coalesce_data;
+
+        /* If there is already a call for the same event in flight, don't send
+         * another one, but remember to send one more (with the state at that
+         * time) once the current call completes. This merges any number of
+         * events in between into one. */
+        coalesce_data =
+            nm_dispatcher_coalesce_begin(gl.coalesce_table, device, action, connectivity_state);
+        if (!coalesce_data) {
+            _LOG2D(request_id, log_ifname, log_con_uuid, "coalesced with pending action");
+            return TRUE;
+        }
+
+        callback  = _coalesce_done_cb;
+        user_data = coalesce_data;
+    }
+
     if (applied_connection)
         connection_dict =
             nm_connection_to_dbus(applied_connection, NM_CONNECTION_SERIALIZE_NO_SECRETS);
@@ -611,8 +869,19 @@ _dispatcher_call(NMDispatcherAction    action,
 
     connectivity_state_string = nm_connectivity_state_to_string(connectivity_state);
 
-    parameters_floating =
-        g_variant_new("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}a{sv}b)",
+    g_variant_builder_init(&options, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add(
+        &options,
+        "{sv}",
+        "debug",
+        g_variant_new_boolean(nm_logging_output_enabled(LOGL_DEBUG, LOGD_DISPATCH)));
+    g_variant_builder_add(&options,
+                          "{sv}",
+                          "max-parallel",
+                          g_variant_new_uint32(_max_parallel_get()));
+
+    parameters =
+        g_variant_new("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}a{sv}a{sv})",
                       action_to_string(action),
                       connection_dict,
                       &connection_props,
@@ -627,7 +896,8 @@ _dispatcher_call(NMDispatcherAction    action,
                       &vpn_proxy_props,
                       &vpn_ip4_props,
                       &vpn_ip6_props,
-                      nm_logging_enabled(LOGL_DEBUG, LOGD_DISPATCH));
+                      &options);
+    g_variant_ref_sink(parameters);
 
     /* Send the action to the dispatcher */
     if (blocking) {
@@ -638,13 +908,27 @@ _dispatcher_call(NMDispatcherAction    action,
                                           NM_DISPATCHER_DBUS_SERVICE,
                                           NM_DISPATCHER_DBUS_PATH,
                                           NM_DISPATCHER_DBUS_INTERFACE,
-                                          "Action",
-                                          g_steal_pointer(&parameters_floating),
-                                          G_VARIANT_TYPE("(a(sus))"),
+                                          "Action2",
+                                          parameters,
+                                          G_VARIANT_TYPE("(a(susa{sv}))"),
                                           G_DBUS_CALL_FLAGS_NONE,
                                           CALL_TIMEOUT,
                                           NULL,
                                           &error);
+        if (!ret && _action2_unsupported(error)) {
+            g_clear_error(&error);
+            ret = g_dbus_connection_call_sync(gl.dbus_connection,
+                                              NM_DISPATCHER_DBUS_SERVICE,
+                                              NM_DISPATCHER_DBUS_PATH,
+                                              NM_DISPATCHER_DBUS_INTERFACE,
+                                              "Action",
+                                              _action2_parameters_to_legacy(parameters),
+                                              G_VARIANT_TYPE("(a(sus))"),
+                                              G_DBUS_CALL_FLAGS_NONE,
+                                              CALL_TIMEOUT,
+                                              NULL,
+                                              &error);
+        }
         if (!ret) {
             g_dbus_error_strip_remote_error(error);
             _LOG2W(request_id, log_ifname, log_con_uuid, "failed: %s", error->message);
@@ -657,13 +941,16 @@ _dispatcher_call(NMDispatcherAction    action,
     call_id =
         dispatcher_call_id_new(request_id, action, callback, user_data, log_ifname, log_con_uuid);
 
+    /* keep the parameters, in case we need to fall back to "Action". */
+    call_id->parameters = g_variant_ref(parameters);
+
     g_dbus_connection_call(gl.dbus_connection,
                            NM_DISPATCHER_DBUS_SERVICE,
                            NM_DISPATCHER_DBUS_PATH,
                            NM_DISPATCHER_DBUS_INTERFACE,
-                           "Action",
-                           g_steal_pointer(&parameters_floating),
-                           G_VARIANT_TYPE("(a(sus))"),
+                           "Action2",
+                           parameters,
+                           G_VARIANT_TYPE("(a(susa{sv}))"),
                            G_DBUS_CALL_FLAGS_NONE,
                            CALL_TIMEOUT,
                            NULL,
@@ -71,4 +71,29 @@ gboolean nm_dispatcher_call_connectivity(NMConnectivityState  state,
 
 void nm_dispatcher_call_cancel(NMDispatcherCallId *call_id);
 
+/*****************************************************************************/
+
+/* Coalescable events for which a call is in flight, at most one per device
+ * and action. */
+
+typedef struct {
+    gpointer            device;
+    NMDispatcherAction  action;
+    NMConnectivityState connectivity_state;
+
+    /* whether further events were merged while the call is in flight. */
+    bool pending : 1;
+} NMDispatcherCoalesceData;
+
+GHashTable *nm_dispatcher_coalesce_table_new(void);
+
+NMDispatcherCoalesceData *nm_dispatcher_coalesce_begin(GHashTable *        table,
+                                                       gpointer            device,
+                                                       NMDispatcherAction  action,
+                                                       NMConnectivityState connectivity_state);
+
+gboolean nm_dispatcher_coalesce_end(GHashTable *table, NMDispatcherCoalesceData *data);
+
+void nm_dispatcher_coalesce_data_free(NMDispatcherCoalesceData *data);
+
 #endif /* __NM_DISPATCHER_H__ */
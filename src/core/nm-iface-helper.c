@@ -663,6 +663,7 @@ main(int argc, char *argv[])
                                                  nm_platform_get_multi_idx(NM_PLATFORM_GET),
                                                  global_opt.ifname,
                                                  gl.ifindex,
+                                                 0,
                                                  hwaddr,
                                                  bcast_hwaddr,
                                                  global_opt.uuid,
@@ -724,6 +725,7 @@ main(int argc, char *argv[])
                                   global_opt.addr_gen_mode,
                                   NM_NDISC_NODE_TYPE_HOST,
                                   max_addresses,
+                                  0,
                                   router_solicitations,
                                   router_solicitation_interval,
                                   default_ra_timeout,
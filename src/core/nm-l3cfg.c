@@ -221,6 +221,7 @@ typedef struct _NML3CfgPrivate {
     bool acd_is_pending : 1;
 
     bool nacd_acd_not_supported : 1;
+    bool nacd_shared_socket : 1;
     bool acd_ipv4_addresses_on_link_has : 1;
 
     bool changed_configs_configs : 1;
@@ -1101,20 +1102,9 @@ _l3_acd_nacd_event_down_timeout_cb(gpointer user_data)
 }
 
 static gboolean
-_l3_acd_nacd_event(int fd, GIOCondition condition, gpointer user_data)
+_l3_acd_nacd_pop_events(NML3Cfg *self)
 {
-    NML3Cfg *self    = user_data;
-    gboolean success = FALSE;
-    int      r;
-
-    nm_assert(NM_IS_L3CFG(self));
-    nm_assert(self->priv.p->nacd);
-
-    r = n_acd_dispatch(self->priv.p->nacd);
-    if (!NM_IN_SET(r, 0, N_ACD_E_PREEMPTED)) {
-        _LOGT("acd: dispatch failed with error %d", r);
-        goto out;
-    }
+    int r;
 
     while (TRUE) {
         NMEtherAddr        sender_addr_data;
@@ -1125,12 +1115,10 @@ _l3_acd_nacd_event(int fd, GIOCondition condition, gpointer user_data)
         r = n_acd_pop_event(self->priv.p->nacd, &event);
         if (r) {
             _LOGT("acd: pop-event failed with error %d", r);
-            goto out;
-        }
-        if (!event) {
-            success = TRUE;
-            goto out;
+            return FALSE;
         }
+        if (!event)
+            return TRUE;
 
         switch (event->event) {
         case N_ACD_EVENT_READY:
@@ -1210,17 +1198,53 @@ _l3_acd_nacd_event(int fd, GIOCondition condition, gpointer user_data)
          * each event emit all queued AcdEvent signals. */
         _nm_l3cfg_emit_signal_notify_acd_event_all(self);
     }
+}
 
-    nm_assert_not_reached();
+static gboolean
+_l3_acd_nacd_event(int fd, GIOCondition condition, gpointer user_data)
+{
+    NML3Cfg *self = user_data;
+    int      r;
 
-out:
-    if (!success) {
-        /* Something is seriously wrong with our nacd instance. We handle that by resetting the
-         * ACD instance. */
-        _l3_acd_nacd_instance_reset(self, NM_TERNARY_TRUE, TRUE);
+    nm_assert(NM_IS_L3CFG(self));
+    nm_assert(self->priv.p->nacd);
+
+    r = n_acd_dispatch(self->priv.p->nacd);
+    if (!NM_IN_SET(r, 0, N_ACD_E_PREEMPTED)) {
+        _LOGT("acd: dispatch failed with error %d", r);
+        goto fail;
     }
 
+    if (!_l3_acd_nacd_pop_events(self))
+        goto fail;
+
     return G_SOURCE_CONTINUE;
+
+fail:
+    /* Something is seriously wrong with our nacd instance. We handle that by resetting the
+     * ACD instance. */
+    _l3_acd_nacd_instance_reset(self, NM_TERNARY_TRUE, TRUE);
+    return G_SOURCE_CONTINUE;
+}
+
+/* Called by NMNetns for instances on the shared socket. @nacd is %NULL, if the
+ * shared socket itself failed. */
+void
+_nm_l3cfg_notify_acd_shared_socket(NML3Cfg *self, NAcd *nacd, gboolean dispatch_failed)
+{
+    nm_assert(NM_IS_L3CFG(self));
+
+    if (!self->priv.p->nacd_shared_socket || (nacd && nacd != self->priv.p->nacd))
+        return;
+
+    if (dispatch_failed) {
+        _LOGT("acd: dispatch of shared socket failed");
+        _l3_acd_nacd_instance_reset(self, NM_TERNARY_TRUE, TRUE);
+        return;
+    }
+
+    if (!_l3_acd_nacd_pop_events(self))
+        _l3_acd_nacd_instance_reset(self, NM_TERNARY_TRUE, TRUE);
 }
 
 static gboolean
@@ -1242,6 +1266,12 @@ _l3_acd_nacd_instance_reset(NML3Cfg *self, NMTernary start_timer, gboolean acd_d
 
     if (self->priv.p->nacd) {
         _LOGT("acd: clear nacd instance");
+        if (self->priv.p->nacd_shared_socket) {
+            /* probes may keep the instance alive for a while. */
+            n_acd_set_userdata(self->priv.p->nacd, NULL);
+            self->priv.p->nacd_shared_socket = FALSE;
+            nm_netns_acd_shared_socket_release(self->priv.netns);
+        }
         self->priv.p->nacd = n_acd_unref(self->priv.p->nacd);
     }
     nm_clear_g_source_inst(&self->priv.p->nacd_source);
@@ -1287,6 +1317,7 @@ _l3_acd_nacd_instance_ensure(NML3Cfg *self, gboolean *out_acd_not_supported)
 {
     nm_auto(n_acd_config_freep) NAcdConfig *config = NULL;
     nm_auto(n_acd_unrefp) NAcd *            nacd   = NULL;
+    NAcdSharedSocket *                      shared_socket;
     const guint8 *                          addr_bin;
     gboolean                                acd_not_supported;
     gboolean                                valid;
@@ -1323,12 +1354,27 @@ again:
     n_acd_config_set_transport(config, N_ACD_TRANSPORT_ETHERNET);
     n_acd_config_set_mac(config, addr_bin, ACD_SUPPORTED_ETH_ALEN);
 
+    shared_socket = nm_netns_acd_shared_socket_acquire(self->priv.netns);
+    if (shared_socket)
+        n_acd_config_set_shared_socket(config, shared_socket);
+
     r = n_acd_new(&nacd, config);
-    if (r)
+    if (r) {
+        if (shared_socket)
+            nm_netns_acd_shared_socket_release(self->priv.netns);
         goto failed_create_acd;
+    }
 
     self->priv.p->nacd = g_steal_pointer(&nacd);
 
+    if (shared_socket) {
+        /* NMNetns dispatches the shared socket and calls us back. */
+        self->priv.p->nacd_shared_socket = TRUE;
+        n_acd_set_userdata(self->priv.p->nacd, self);
+        NM_SET_OUT(out_acd_not_supported, FALSE);
+        return self->priv.p->nacd;
+    }
+
     n_acd_get_fd(self->priv.p->nacd, &fd);
 
     self->priv.p->nacd_source =
@@ -3033,7 +3079,9 @@ out:
               commited_changed ? '>' : '=',
               NM_HASH_OBFUSCATE_PTR_STR(self->priv.p->combined_l3cd_commited, sbuf30));
 
-        if (merged_changed) {
+        /* Dumping the whole configuration is expensive. Skip it, if only
+         * the flight recorder would record it. */
+        if (merged_changed && nm_logging_output_enabled(LOGL_TRACE, _NMLOG_DOMAIN)) {
             nm_l3_config_data_log(self->priv.p->combined_l3cd_merged,
                                   NULL,
                                   nm_sprintf_buf(sbuf256,
@@ -3734,6 +3782,10 @@ finalize(GObject *object)
     nm_assert(nm_g_hash_table_size(self->priv.p->acd_lst_hash) == 0);
 
     nm_clear_pointer(&self->priv.p->acd_lst_hash, g_hash_table_unref);
+    if (self->priv.p->nacd_shared_socket) {
+        n_acd_set_userdata(self->priv.p->nacd, NULL);
+        nm_netns_acd_shared_socket_release(self->priv.netns);
+    }
     nm_clear_pointer(&self->priv.p->nacd, n_acd_unref);
     nm_clear_g_source_inst(&self->priv.p->nacd_source);
     nm_clear_g_source_inst(&self->priv.p->nacd_instance_ensure_retry);
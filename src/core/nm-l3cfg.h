@@ -164,6 +164,10 @@ void _nm_l3cfg_notify_platform_change(NML3Cfg *                  self,
                                       NMPlatformSignalChangeType change_type,
                                       const NMPObject *          obj);
 
+struct NAcd;
+
+void _nm_l3cfg_notify_acd_shared_socket(NML3Cfg *self, struct NAcd *nacd, gboolean dispatch_failed);
+
 /*****************************************************************************/
 
 struct _NMDedupMultiIndex;
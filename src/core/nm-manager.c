@@ -6617,6 +6617,43 @@ impl_manager_get_logging(NMDBusObject *                     obj,
         g_variant_new("(ss)", nm_logging_level_to_string(), nm_logging_domains_to_string()));
 }
 
+/* D-Bus brokers limit the size of messages (dbus-daemon to 32 MiB on the
+ * system bus by default). Stay well below that. */
+#define DUMP_LOGGING_MAX_LEN ((gsize) (8 * 1024 * 1024))
+
+static void
+impl_manager_dump_logging(NMDBusObject *                     obj,
+                          const NMDBusInterfaceInfoExtended *interface_info,
+                          const NMDBusMethodInfoExtended *   method_info,
+                          GDBusConnection *                  connection,
+                          const char *                       sender,
+                          GDBusMethodInvocation *            invocation,
+                          GVariant *                         parameters)
+{
+    NMManager *   self     = NM_MANAGER(obj);
+    gs_free char *messages = NULL;
+
+    /* the recorded messages may contain sensitive data. Like SetLogging(),
+     * this is restricted to root by the D-Bus policy. */
+    if (!nm_dbus_manager_ensure_uid(nm_dbus_object_get_manager(NM_DBUS_OBJECT(self)),
+                                    invocation,
+                                    G_MAXULONG,
+                                    NM_MANAGER_ERROR,
+                                    NM_MANAGER_ERROR_PERMISSION_DENIED))
+        return;
+
+    messages = nm_logging_flight_recorder_dump(DUMP_LOGGING_MAX_LEN);
+    if (!messages) {
+        g_dbus_method_invocation_return_error_literal(invocation,
+                                                      NM_MANAGER_ERROR,
+                                                      NM_MANAGER_ERROR_FAILED,
+                                                      "The flight recorder is disabled");
+        return;
+    }
+
+    g_dbus_method_invocation_return_value(invocation, g_variant_new("(s)", messages));
+}
+
 typedef struct {
     NMManager *            self;
     GDBusMethodInvocation *context;
@@ -8255,6 +8292,12 @@ static const NMDBusInterfaceInfoExtended interface_info_manager = {
                                                      NM_DEFINE_GDBUS_ARG_INFO("level", "s"),
                                                      NM_DEFINE_GDBUS_ARG_INFO("domains", "s"), ), ),
                 .handle = impl_manager_get_logging, ),
+            NM_DEFINE_DBUS_METHOD_INFO_EXTENDED(
+                NM_DEFINE_GDBUS_METHOD_INFO_INIT(
+                    "DumpLogging",
+                    .out_args = NM_DEFINE_GDBUS_ARG_INFOS(
+                        NM_DEFINE_GDBUS_ARG_INFO("messages", "s"), ), ),
+                .handle = impl_manager_dump_logging, ),
             NM_DEFINE_DBUS_METHOD_INFO_EXTENDED(
                 NM_DEFINE_GDBUS_METHOD_INFO_INIT(
                     "CheckConnectivity",
@@ -16,20 +16,25 @@
 #include "platform/nm-platform.h"
 #include "nm-platform/nmp-netns.h"
 #include "platform/nmp-rules-manager.h"
+#include "n-acd/src/n-acd.h"
 
 /*****************************************************************************/
 
 NM_GOBJECT_PROPERTIES_DEFINE_BASE(PROP_PLATFORM, );
 
 typedef struct {
-    NMNetns *        _self_signal_user_data;
-    NMPlatform *     platform;
-    NMPNetns *       platform_netns;
-    NMPRulesManager *rules_manager;
-    GHashTable *     l3cfgs;
-    GHashTable *     shared_ips;
-    CList            l3cfg_signal_pending_lst_head;
-    guint            signal_pending_idle_id;
+    NMNetns *         _self_signal_user_data;
+    NMPlatform *      platform;
+    NMPNetns *        platform_netns;
+    NMPRulesManager * rules_manager;
+    GHashTable *      l3cfgs;
+    GHashTable *      shared_ips;
+    CList             l3cfg_signal_pending_lst_head;
+    NAcdSharedSocket *acd_shared_socket;
+    GSource *         acd_shared_source;
+    guint             acd_shared_users;
+    guint             signal_pending_idle_id;
+    bool              acd_shared_socket_enabled : 1;
 } NMNetnsPrivate;
 
 struct _NMNetns {
@@ -352,6 +357,139 @@ nm_netns_shared_ip_release(NMNetnsSharedIPHandle *handle)
 
 /*****************************************************************************/
 
+void
+nm_netns_set_acd_shared_socket_enabled(NMNetns *self, gboolean enabled)
+{
+    g_return_if_fail(NM_IS_NETNS(self));
+
+    NM_NETNS_GET_PRIVATE(self)->acd_shared_socket_enabled = enabled;
+}
+
+static gboolean
+_acd_shared_socket_event_cb(int fd, GIOCondition condition, gpointer user_data)
+{
+    gs_unref_object NMNetns *self = g_object_ref(NM_NETNS(user_data));
+    NMNetnsPrivate *         priv = NM_NETNS_GET_PRIVATE(self);
+    NAcdSharedSocket *       shared_socket;
+    NAcd *                   nacd;
+    int                      r;
+
+    /* handling the events may release the last user of the socket. */
+    shared_socket = n_acd_shared_socket_ref(priv->acd_shared_socket);
+
+    /* A failure of a single context is reported by n_acd_pop_event() of that
+     * context. An error here means that the socket itself is broken. */
+    r = n_acd_shared_socket_dispatch(shared_socket);
+    if (!NM_IN_SET(r, 0, N_ACD_E_PREEMPTED)) {
+        gs_unref_ptrarray GPtrArray *l3cfgs = NULL;
+        L3CfgData *                  l3cfg_data;
+        GHashTableIter               iter;
+        guint                        i;
+
+        _LOGT("acd: dispatch of shared socket failed with error %d", r);
+
+        /* All users reset their instance and the last one releases the socket. */
+        l3cfgs = g_ptr_array_new_with_free_func(g_object_unref);
+        g_hash_table_iter_init(&iter, priv->l3cfgs);
+        while (g_hash_table_iter_next(&iter, (gpointer *) &l3cfg_data, NULL))
+            g_ptr_array_add(l3cfgs, g_object_ref(l3cfg_data->l3cfg));
+        for (i = 0; i < l3cfgs->len; i++)
+            _nm_l3cfg_notify_acd_shared_socket(l3cfgs->pdata[i], NULL, TRUE);
+    }
+
+    while (TRUE) {
+        gs_unref_object NML3Cfg *l3cfg = NULL;
+        NAcdEvent *              event;
+
+        n_acd_shared_socket_pop_context(shared_socket, &nacd);
+        if (!nacd)
+            break;
+
+        n_acd_get_userdata(nacd, (void **) &l3cfg);
+        if (!l3cfg) {
+            /* The instance was already abandoned by its NML3Cfg. */
+            do {
+                r = n_acd_pop_event(nacd, &event);
+            } while (r == 0 && event);
+            continue;
+        }
+
+        g_object_ref(l3cfg);
+        _nm_l3cfg_notify_acd_shared_socket(l3cfg, nacd, FALSE);
+    }
+
+    n_acd_shared_socket_unref(shared_socket);
+    return G_SOURCE_CONTINUE;
+}
+
+/* Returns the ACD socket shared by all NML3Cfg of the namespace, or %NULL, if
+ * that is disabled or it cannot be created. Every successful call must be
+ * paired with nm_netns_acd_shared_socket_release(). */
+NAcdSharedSocket *
+nm_netns_acd_shared_socket_acquire(NMNetns *self)
+{
+    NMNetnsPrivate *priv;
+    int             fd;
+    int             r;
+
+    g_return_val_if_fail(NM_IS_NETNS(self), NULL);
+
+    priv = NM_NETNS_GET_PRIVATE(self);
+
+    if (!priv->acd_shared_socket_enabled)
+        return NULL;
+
+    if (!priv->acd_shared_socket) {
+        nm_auto_pop_netns NMPNetns *netns = NULL;
+
+        if (!nm_platform_netns_push(priv->platform, &netns))
+            return NULL;
+
+        r = n_acd_shared_socket_new(&priv->acd_shared_socket);
+        if (r) {
+            _LOGW("acd: failure to create shared socket (error %d)", r);
+            return NULL;
+        }
+
+        n_acd_shared_socket_get_fd(priv->acd_shared_socket, &fd);
+        priv->acd_shared_source = nm_g_unix_fd_source_new(fd,
+                                                          G_IO_IN,
+                                                          G_PRIORITY_DEFAULT,
+                                                          _acd_shared_socket_event_cb,
+                                                          self,
+                                                          NULL);
+        g_source_attach(priv->acd_shared_source, NULL);
+        g_object_ref(self);
+        _LOGD("acd: created shared socket");
+    }
+
+    priv->acd_shared_users++;
+    return priv->acd_shared_socket;
+}
+
+void
+nm_netns_acd_shared_socket_release(NMNetns *self)
+{
+    NMNetnsPrivate *priv;
+
+    g_return_if_fail(NM_IS_NETNS(self));
+
+    priv = NM_NETNS_GET_PRIVATE(self);
+
+    nm_assert(priv->acd_shared_socket);
+    nm_assert(priv->acd_shared_users > 0);
+
+    if (--priv->acd_shared_users > 0)
+        return;
+
+    _LOGD("acd: release shared socket");
+    nm_clear_g_source_inst(&priv->acd_shared_source);
+    priv->acd_shared_socket = n_acd_shared_socket_unref(priv->acd_shared_socket);
+    g_object_unref(self);
+}
+
+/*****************************************************************************/
+
 static void
 set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec)
 {
@@ -459,6 +597,7 @@ dispose(GObject *object)
     nm_assert(nm_g_hash_table_size(priv->l3cfgs) == 0);
     nm_assert(c_list_is_empty(&priv->l3cfg_signal_pending_lst_head));
     nm_assert(!priv->shared_ips);
+    nm_assert(!priv->acd_shared_socket);
 
     nm_clear_g_source(&priv->signal_pending_idle_id);
 
@@ -39,6 +39,16 @@ NML3Cfg *nm_netns_access_l3cfg(NMNetns *netns, int ifindex);
 
 /*****************************************************************************/
 
+struct NAcdSharedSocket;
+
+void nm_netns_set_acd_shared_socket_enabled(NMNetns *self, gboolean enabled);
+
+struct NAcdSharedSocket *nm_netns_acd_shared_socket_acquire(NMNetns *self);
+
+void nm_netns_acd_shared_socket_release(NMNetns *self);
+
+/*****************************************************************************/
+
 typedef struct {
     in_addr_t addr;
     int       _ref_count;
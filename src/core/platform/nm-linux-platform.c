@@ -5140,7 +5140,7 @@ _log_dbg_sysctl_set_impl(NMPlatform *platform,
 #define _log_dbg_sysctl_set(platform, pathid, dirfd, path, value)           \
     G_STMT_START                                                            \
     {                                                                       \
-        if (_LOGD_ENABLED()) {                                              \
+        if (nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN)) {         \
             _log_dbg_sysctl_set_impl(platform, pathid, dirfd, path, value); \
         }                                                                   \
     }                                                                       \
@@ -5542,7 +5542,7 @@ _log_dbg_sysctl_get_impl(NMPlatform *platform, const char *pathid, const char *c
 #define _log_dbg_sysctl_get(platform, pathid, contents)           \
     G_STMT_START                                                  \
     {                                                             \
-        if (_LOGD_ENABLED())                                      \
+        if (nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN)) \
             _log_dbg_sysctl_get_impl(platform, pathid, contents); \
     }                                                             \
     G_STMT_END
@@ -6224,20 +6224,33 @@ cache_on_change(NMPlatform *     platform,
 
     klass = obj_old ? NMP_OBJECT_GET_CLASS(obj_old) : NMP_OBJECT_GET_CLASS(obj_new);
 
-    _LOGt(
-        "update-cache-%s: %s: %s%s%s",
-        klass->obj_type_name,
-        (cache_op == NMP_CACHE_OPS_UPDATED ? "UPDATE"
-                                           : (cache_op == NMP_CACHE_OPS_REMOVED   ? "REMOVE"
-                                              : (cache_op == NMP_CACHE_OPS_ADDED) ? "ADD"
-                                                                                  : "???")),
-        (cache_op != NMP_CACHE_OPS_ADDED
-             ? nmp_object_to_string(obj_old, NMP_OBJECT_TO_STRING_ALL, str_buf2, sizeof(str_buf2))
-             : nmp_object_to_string(obj_new, NMP_OBJECT_TO_STRING_ALL, str_buf2, sizeof(str_buf2))),
-        (cache_op == NMP_CACHE_OPS_UPDATED) ? " -> " : "",
-        (cache_op == NMP_CACHE_OPS_UPDATED
-             ? nmp_object_to_string(obj_new, NMP_OBJECT_TO_STRING_ALL, str_buf, sizeof(str_buf))
-             : ""));
+    /* This runs for every netlink message. Don't format the objects, if only
+     * the flight recorder would record them. */
+    if (_LOGt_ENABLED() && nm_logging_output_enabled(LOGL_TRACE, _NMLOG_DOMAIN)) {
+        _LOGt("update-cache-%s: %s: %s%s%s",
+              klass->obj_type_name,
+              (cache_op == NMP_CACHE_OPS_UPDATED
+                   ? "UPDATE"
+                   : (cache_op == NMP_CACHE_OPS_REMOVED
+                          ? "REMOVE"
+                          : (cache_op == NMP_CACHE_OPS_ADDED) ? "ADD" : "???")),
+              (cache_op != NMP_CACHE_OPS_ADDED
+                   ? nmp_object_to_string(obj_old,
+                                          NMP_OBJECT_TO_STRING_ALL,
+                                          str_buf2,
+                                          sizeof(str_buf2))
+                   : nmp_object_to_string(obj_new,
+                                          NMP_OBJECT_TO_STRING_ALL,
+                                          str_buf2,
+                                          sizeof(str_buf2))),
+              (cache_op == NMP_CACHE_OPS_UPDATED) ? " -> " : "",
+              (cache_op == NMP_CACHE_OPS_UPDATED
+                   ? nmp_object_to_string(obj_new,
+                                          NMP_OBJECT_TO_STRING_ALL,
+                                          str_buf,
+                                          sizeof(str_buf))
+                   : ""));
+    }
 
     switch (klass->obj_type) {
     case NMP_OBJECT_TYPE_LINK:
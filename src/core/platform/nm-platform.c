@@ -2416,7 +2416,7 @@ nm_platform_link_wireguard_change(NMPlatform *                              self
 
     nm_assert(klass->link_wireguard_change);
 
-    if (_LOGD_ENABLED()) {
+    if (nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN)) {
         char buf_lnk[256];
         char buf_peers[512];
         char buf_change_flags[100];
@@ -2702,7 +2702,7 @@ nm_platform_link_vlan_change(NMPlatform *            self,
 
     flags_set &= flags_mask;
 
-    if (_LOGD_ENABLED()) {
+    if (nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN)) {
         char  buf[512];
         char *b = buf;
         gsize len, i;
@@ -3535,7 +3535,7 @@ nm_platform_ip4_address_add(NMPlatform *self,
     g_return_val_if_fail(!label || strlen(label) < sizeof(((NMPlatformIP4Address *) NULL)->label),
                          FALSE);
 
-    if (_LOGD_ENABLED()) {
+    if (nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN)) {
         NMPlatformIP4Address addr;
 
         addr = (NMPlatformIP4Address){
@@ -3585,7 +3585,7 @@ nm_platform_ip6_address_add(NMPlatform *    self,
     g_return_val_if_fail(lifetime > 0, FALSE);
     g_return_val_if_fail(preferred <= lifetime, FALSE);
 
-    if (_LOGD_ENABLED()) {
+    if (nm_logging_output_enabled(LOGL_DEBUG, _NMLOG_DOMAIN)) {
         NMPlatformIP6Address addr = {0};
 
         addr.ifindex      = ifindex;
@@ -449,6 +449,17 @@ agent_manager_register_with_capabilities(NMAgentManager *       self,
     GError *                       error      = NULL;
     NMSecretAgent *                agent;
 
+    if (!g_dbus_connection_get_unique_name(g_dbus_method_invocation_get_connection(context))) {
+        /* a peer connection on the private client socket. Agents are tracked
+         * by their bus name, which the peer doesn't have. */
+        error = g_error_new_literal(NM_AGENT_MANAGER_ERROR,
+                                    NM_AGENT_MANAGER_ERROR_FAILED,
+                                    "Secret agents must register via the D-Bus message bus, "
+                                    "not via a private connection.");
+        g_dbus_method_invocation_take_error(context, error);
+        return;
+    }
+
     subject = nm_dbus_manager_new_auth_subject_from_context(context);
     if (!subject) {
         error = g_error_new_literal(NM_AGENT_MANAGER_ERROR,
@@ -23,6 +23,7 @@
 #include "nm-core-internal.h"
 #include "nm-audit-manager.h"
 #include "nm-settings.h"
+#include "nm-settings-utils.h"
 #include "nm-dbus-manager.h"
 #include "settings/plugins/keyfile/nms-keyfile-storage.h"
 
@@ -100,6 +101,11 @@ typedef struct _NMSettingsConnectionPrivate {
      */
     GVariant *agent_secrets;
 
+    /* The serialized settings as returned by GetSettings() and GetSecrets().
+     * Built lazily for the current connection, and dropped whenever the
+     * timestamp or the seen BSSIDs change. */
+    NMSettUtilDBusCache dbus_cache;
+
     GHashTable *seen_bssids; /* Up-to-date BSSIDs that's been seen for the connection */
 
     guint64 timestamp; /* Up-to-date timestamp of connection use */
@@ -256,6 +262,12 @@ _seen_bssids_hash_new(void)
 
 /*****************************************************************************/
 
+static void
+_dbus_settings_invalidate(NMSettingsConnection *self)
+{
+    nm_sett_util_dbus_cache_clear(&NM_SETTINGS_CONNECTION_GET_PRIVATE(self)->dbus_cache);
+}
+
 NMConnection *
 nm_settings_connection_get_connection(NMSettingsConnection *self)
 {
@@ -287,6 +299,14 @@ _nm_settings_connection_set_connection(NMSettingsConnection *           self,
         priv->connection = g_object_ref(new_connection);
         nmtst_connection_assert_unchanging(priv->connection);
 
+        /* the profile is immutable and gets compared against on every update.
+         * Keep its content hash, so that nm_connection_compare() can short-cut
+         * the common case of an update without changes. */
+        _nm_connection_cache_content_hash(priv->connection);
+        _nm_connection_get_content_hash(priv->connection, TRUE);
+
+        _dbus_settings_invalidate(self);
+
         /* note that we only return @connection_old if the new connection actually differs from
          * before.
          *
@@ -1318,21 +1338,30 @@ auth_start(NMSettingsConnection * self,
 
 /**** DBus method handlers ************************************/
 
-static void
-get_settings_auth_cb(NMSettingsConnection * self,
-                     GDBusMethodInvocation *context,
-                     NMAuthSubject *        subject,
-                     GError *               error,
-                     gpointer               data)
+/**
+ * nm_settings_connection_get_dbus_settings:
+ * @self: the #NMSettingsConnection
+ *
+ * Returns the settings of @self as returned by the GetSettings() D-Bus
+ * method. The result is cached until the connection, its timestamp or
+ * its seen BSSIDs change, so repeated calls are cheap.
+ *
+ * Returns: (transfer none): the a{sa{sv}} settings dictionary without
+ *   secrets.
+ */
+GVariant *
+nm_settings_connection_get_dbus_settings(NMSettingsConnection *self)
 {
+    NMSettingsConnectionPrivate *    priv;
     gs_free const char **            seen_bssids = NULL;
     NMConnectionSerializationOptions options     = {};
-    GVariant *                       settings;
 
-    if (error) {
-        g_dbus_method_invocation_return_gerror(context, error);
-        return;
-    }
+    g_return_val_if_fail(NM_IS_SETTINGS_CONNECTION(self), NULL);
+
+    priv = NM_SETTINGS_CONNECTION_GET_PRIVATE(self);
+
+    if (priv->dbus_cache.connection == priv->connection && priv->dbus_cache.no_secrets)
+        return priv->dbus_cache.no_secrets;
 
     /* Timestamp is not updated in connection's 'timestamp' property,
      * because it would force updating the connection and in turn
@@ -1354,10 +1383,27 @@ get_settings_auth_cb(NMSettingsConnection * self,
      * get returned by the GetSecrets method which can be better
      * protected against leakage of secrets to unprivileged callers.
      */
-    settings = nm_connection_to_dbus_full(nm_settings_connection_get_connection(self),
-                                          NM_CONNECTION_SERIALIZE_NO_SECRETS,
-                                          &options);
-    g_dbus_method_invocation_return_value(context, g_variant_new("(@a{sa{sv}})", settings));
+    return nm_sett_util_dbus_cache_get(&priv->dbus_cache,
+                                       priv->connection,
+                                       NM_CONNECTION_SERIALIZE_NO_SECRETS,
+                                       &options);
+}
+
+static void
+get_settings_auth_cb(NMSettingsConnection * self,
+                     GDBusMethodInvocation *context,
+                     NMAuthSubject *        subject,
+                     GError *               error,
+                     gpointer               data)
+{
+    if (error) {
+        g_dbus_method_invocation_return_gerror(context, error);
+        return;
+    }
+
+    g_dbus_method_invocation_return_value(
+        context,
+        g_variant_new("(@a{sa{sv}})", nm_settings_connection_get_dbus_settings(self)));
 }
 
 static void
@@ -1877,7 +1923,6 @@ dbus_get_agent_secrets_cb(NMSettingsConnection *      self,
                           gpointer                    user_data)
 {
     GDBusMethodInvocation *context = user_data;
-    GVariant *             dict;
 
     if (error)
         g_dbus_method_invocation_return_gerror(context, error);
@@ -1887,11 +1932,14 @@ dbus_get_agent_secrets_cb(NMSettingsConnection *      self,
          * secrets from backing storage and those returned from the agent
          * by the time we get here.
          */
-        dict = nm_connection_to_dbus(nm_settings_connection_get_connection(self),
-                                     NM_CONNECTION_SERIALIZE_ONLY_SECRETS);
-        if (!dict)
-            dict = g_variant_new_array(G_VARIANT_TYPE("{sa{sv}}"), NULL, 0);
-        g_dbus_method_invocation_return_value(context, g_variant_new("(@a{sa{sv}})", dict));
+        g_dbus_method_invocation_return_value(
+            context,
+            g_variant_new("(@a{sa{sv}})",
+                          nm_sett_util_dbus_cache_get(
+                              &NM_SETTINGS_CONNECTION_GET_PRIVATE(self)->dbus_cache,
+                              nm_settings_connection_get_connection(self),
+                              NM_CONNECTION_SERIALIZE_ONLY_SECRETS,
+                              NULL)));
     }
 }
 
@@ -2241,6 +2289,8 @@ nm_settings_connection_update_timestamp(NMSettingsConnection *self, guint64 time
     priv->timestamp     = timestamp;
     priv->timestamp_set = TRUE;
 
+    _dbus_settings_invalidate(self);
+
     _LOGT("timestamp: set timestamp %" G_GUINT64_FORMAT, timestamp);
 
     if (!priv->kf_db_timestamps)
@@ -2270,6 +2320,9 @@ _nm_settings_connection_register_kf_dbs(NMSettingsConnection *self,
 
     connection_uuid = nm_settings_connection_get_uuid(self);
 
+    if (priv->kf_db_timestamps != kf_db_timestamps || priv->kf_db_seen_bssids != kf_db_seen_bssids)
+        _dbus_settings_invalidate(self);
+
     if (priv->kf_db_timestamps != kf_db_timestamps) {
         gs_free char *tmp_str = NULL;
         guint64       timestamp;
@@ -2398,7 +2451,8 @@ nm_settings_connection_add_seen_bssid(NMSettingsConnection *self, const char *se
     if (!priv->seen_bssids)
         priv->seen_bssids = _seen_bssids_hash_new();
 
-    g_hash_table_add(priv->seen_bssids, g_strdup(seen_bssid));
+    if (g_hash_table_add(priv->seen_bssids, g_strdup(seen_bssid)))
+        _dbus_settings_invalidate(self);
 
     if (!priv->kf_db_seen_bssids)
         return;
@@ -2661,6 +2715,7 @@ dispose(GObject *object)
 
     nm_clear_pointer(&priv->system_secrets, g_variant_unref);
     nm_clear_pointer(&priv->agent_secrets, g_variant_unref);
+    nm_sett_util_dbus_cache_clear(&priv->dbus_cache);
 
     nm_clear_pointer(&priv->seen_bssids, g_hash_table_destroy);
 
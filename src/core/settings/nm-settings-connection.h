@@ -216,6 +216,8 @@ NMSettingsConnection *nm_settings_connection_new(void);
 
 NMConnection *nm_settings_connection_get_connection(NMSettingsConnection *self);
 
+GVariant *nm_settings_connection_get_dbus_settings(NMSettingsConnection *self);
+
 void _nm_settings_connection_set_connection(NMSettingsConnection *           self,
                                             NMConnection *                   new_connection,
                                             NMConnection **                  out_old_connection,
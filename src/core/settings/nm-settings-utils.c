@@ -159,3 +159,61 @@ nm_sett_util_storages_steal(NMSettUtilStorages *storages,
 
     return storage;
 }
+
+/*****************************************************************************/
+
+void
+nm_sett_util_dbus_cache_clear(NMSettUtilDBusCache *cache)
+{
+    nm_clear_pointer(&cache->no_secrets, g_variant_unref);
+    nm_clear_pointer(&cache->only_secrets, g_variant_unref);
+    g_clear_object(&cache->connection);
+}
+
+/**
+ * nm_sett_util_dbus_cache_get:
+ * @cache: the #NMSettUtilDBusCache
+ * @connection: the profile to serialize
+ * @flags: either %NM_CONNECTION_SERIALIZE_NO_SECRETS or
+ *   %NM_CONNECTION_SERIALIZE_ONLY_SECRETS
+ * @options: (allow-none): the serialization options. They are only used when
+ *   the variant is built, so the caller must clear @cache when they change.
+ *
+ * Returns the serialization of @connection. If @cache holds one for the same
+ * connection instance, that is returned. Otherwise, @cache is reset to
+ * @connection.
+ *
+ * Returns: (transfer none): the a{sa{sv}} settings dictionary. It is
+ *   empty if there is nothing to serialize.
+ */
+GVariant *
+nm_sett_util_dbus_cache_get(NMSettUtilDBusCache *                   cache,
+                            NMConnection *                          connection,
+                            NMConnectionSerializationFlags          flags,
+                            const NMConnectionSerializationOptions *options)
+{
+    GVariant **p_variant;
+    GVariant * variant;
+
+    nm_assert(NM_IS_CONNECTION(connection));
+    nm_assert(NM_IN_SET(flags,
+                        NM_CONNECTION_SERIALIZE_NO_SECRETS,
+                        NM_CONNECTION_SERIALIZE_ONLY_SECRETS));
+
+    if (cache->connection != connection) {
+        nm_sett_util_dbus_cache_clear(cache);
+        cache->connection = g_object_ref(connection);
+    }
+
+    p_variant = flags == NM_CONNECTION_SERIALIZE_NO_SECRETS ? &cache->no_secrets
+                                                            : &cache->only_secrets;
+    if (*p_variant)
+        return *p_variant;
+
+    variant = nm_connection_to_dbus_full(connection, flags, options);
+    if (!variant)
+        variant = g_variant_new_array(G_VARIANT_TYPE("{sa{sv}}"), NULL, 0);
+
+    *p_variant = g_variant_ref_sink(variant);
+    return *p_variant;
+}
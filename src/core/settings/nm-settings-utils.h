@@ -6,6 +6,7 @@
 #ifndef __NM_SETTINGS_UTILS_H__
 #define __NM_SETTINGS_UTILS_H__
 
+#include "nm-core-internal.h"
 #include "nm-settings-storage.h"
 
 /*****************************************************************************/
@@ -88,4 +89,22 @@ typedef struct {
 
 gboolean nm_sett_util_allow_filename_cb(const char *filename, gpointer user_data);
 
+/*****************************************************************************/
+
+/* Caches the D-Bus serialization of a profile, without secrets and with only
+ * the secrets. The profile is immutable, so the cache is only valid for the
+ * connection instance it was built from. */
+typedef struct {
+    NMConnection *connection;
+    GVariant *    no_secrets;
+    GVariant *    only_secrets;
+} NMSettUtilDBusCache;
+
+void nm_sett_util_dbus_cache_clear(NMSettUtilDBusCache *cache);
+
+GVariant *nm_sett_util_dbus_cache_get(NMSettUtilDBusCache *                   cache,
+                                      NMConnection *                          connection,
+                                      NMConnectionSerializationFlags          flags,
+                                      const NMConnectionSerializationOptions *options);
+
 #endif /* __NM_SETTINGS_UTILS_H__ */
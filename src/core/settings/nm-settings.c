@@ -2912,6 +2912,67 @@ impl_settings_list_connections(NMDBusObject *                     obj,
     g_dbus_method_invocation_return_value(invocation, g_variant_new("(^ao)", strv));
 }
 
+static void
+_get_all_settings_add(GVariantBuilder *     builder,
+                      NMAuthSubject *       subject,
+                      NMSettingsConnection *sett_conn)
+{
+    if (!nm_auth_is_subject_in_acl(nm_settings_connection_get_connection(sett_conn), subject, NULL))
+        return;
+
+    g_variant_builder_add(builder,
+                          "{o@a{sa{sv}}}",
+                          nm_dbus_object_get_path(NM_DBUS_OBJECT(sett_conn)),
+                          nm_settings_connection_get_dbus_settings(sett_conn));
+}
+
+static void
+impl_settings_get_all_settings(NMDBusObject *                     obj,
+                               const NMDBusInterfaceInfoExtended *interface_info,
+                               const NMDBusMethodInfoExtended *   method_info,
+                               GDBusConnection *                  dbus_connection,
+                               const char *                       sender,
+                               GDBusMethodInvocation *            invocation,
+                               GVariant *                         parameters)
+{
+    NMSettings *          self = NM_SETTINGS(obj);
+    NMSettingsPrivate *   priv = NM_SETTINGS_GET_PRIVATE(self);
+    NMSettingsConnection *sett_conn;
+    gs_unref_object NMAuthSubject *subject = NULL;
+    gs_free const char **          paths   = NULL;
+    GVariantBuilder                builder;
+    gsize                          i;
+
+    g_variant_get(parameters, "(^a&o)", &paths);
+
+    subject = nm_dbus_manager_new_auth_subject_from_context(invocation);
+    if (!subject) {
+        g_dbus_method_invocation_return_error_literal(invocation,
+                                                      NM_SETTINGS_ERROR,
+                                                      NM_SETTINGS_ERROR_PERMISSION_DENIED,
+                                                      NM_UTILS_ERROR_MSG_REQ_UID_UKNOWN);
+        return;
+    }
+
+    /* This is the same as calling GetSettings() on each of the requested connections
+     * (or on all connections, if @paths is empty), but in one round trip. Connections
+     * that don't exist or that are not visible to the caller are omitted. */
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{oa{sa{sv}}}"));
+    if (paths[0]) {
+        for (i = 0; paths[i]; i++) {
+            sett_conn = nm_settings_get_connection_by_path(self, paths[i]);
+            if (sett_conn)
+                _get_all_settings_add(&builder, subject, sett_conn);
+        }
+    } else {
+        c_list_for_each_entry (sett_conn, &priv->connections_lst_head, _connections_lst)
+            _get_all_settings_add(&builder, subject, sett_conn);
+    }
+
+    g_dbus_method_invocation_return_value(invocation,
+                                          g_variant_new("(a{oa{sa{sv}}})", &builder));
+}
+
 NMSettingsConnection *
 nm_settings_get_connection_by_uuid(NMSettings *self, const char *uuid)
 {
@@ -3973,6 +4034,14 @@ static const NMDBusInterfaceInfoExtended interface_info_settings = {
                     .out_args = NM_DEFINE_GDBUS_ARG_INFOS(
                         NM_DEFINE_GDBUS_ARG_INFO("connections", "ao"), ), ),
                 .handle = impl_settings_list_connections, ),
+            NM_DEFINE_DBUS_METHOD_INFO_EXTENDED(
+                NM_DEFINE_GDBUS_METHOD_INFO_INIT(
+                    "GetAllSettings",
+                    .in_args =
+                        NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("connections", "ao"), ),
+                    .out_args = NM_DEFINE_GDBUS_ARG_INFOS(
+                        NM_DEFINE_GDBUS_ARG_INFO("settings", "a{oa{sa{sv}}}"), ), ),
+                .handle = impl_settings_get_all_settings, ),
             NM_DEFINE_DBUS_METHOD_INFO_EXTENDED(
                 NM_DEFINE_GDBUS_METHOD_INFO_INIT(
                     "GetConnectionByUuid",
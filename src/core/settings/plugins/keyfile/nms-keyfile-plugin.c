@@ -308,6 +308,7 @@ _load_file(NMSKeyfilePlugin *    self,
     gs_free char *                shadowed_storage = NULL;
     gs_free_error GError *local                    = NULL;
     gs_free char *        full_filename            = NULL;
+    NMSKeyfileStorage *   storage;
     struct stat           st;
 
     if (_ignore_filename(storage_type, filename)) {
@@ -389,16 +390,18 @@ _load_file(NMSKeyfilePlugin *    self,
         return NULL;
     }
 
-    return nms_keyfile_storage_new_connection(self,
-                                              g_steal_pointer(&connection),
-                                              full_filename,
-                                              storage_type,
-                                              is_nm_generated_opt,
-                                              is_volatile_opt,
-                                              is_external_opt,
-                                              shadowed_storage,
-                                              shadowed_owned_opt,
-                                              &st.st_mtim);
+    storage = nms_keyfile_storage_new_connection(self,
+                                                 g_steal_pointer(&connection),
+                                                 full_filename,
+                                                 storage_type,
+                                                 is_nm_generated_opt,
+                                                 is_volatile_opt,
+                                                 is_external_opt,
+                                                 shadowed_storage,
+                                                 shadowed_owned_opt,
+                                                 &st.st_mtim);
+    nms_keyfile_storage_set_stat(storage, &st);
+    return storage;
 }
 
 static NMSKeyfileStorage *
@@ -419,11 +422,60 @@ _load_file_from_path(NMSKeyfilePlugin *    self,
     return _load_file(self, f_dirname, f_filename, storage_type, error);
 }
 
+static void
+_storage_update_stat(NMSKeyfileStorage *storage, const char *full_filename)
+{
+    struct stat st;
+
+    /* this also sets the mtime of the storage. */
+    if (stat(full_filename, &st) == 0) {
+        nms_keyfile_storage_set_stat(storage, &st);
+        return;
+    }
+
+    /* like nm_sett_util_stat_mtime(), fall back to the current time. */
+    nm_sett_util_stat_mtime(NULL, FALSE, &storage->u.conn_data.stat_mtime);
+    nms_keyfile_storage_set_stat(storage, NULL);
+}
+
+static NMSKeyfileStorage *
+_load_dir_lookup_unchanged(NMSKeyfilePlugin *    self,
+                           NMSKeyfileStorageType storage_type,
+                           const char *          dirname,
+                           const char *          filename)
+{
+    NMSKeyfilePluginPrivate *priv          = NMS_KEYFILE_PLUGIN_GET_PRIVATE(self);
+    gs_free char *           full_filename = NULL;
+    NMSKeyfileStorage *      storage;
+    struct stat              st;
+
+    if (_ignore_filename(storage_type, filename)) {
+        /* nmmeta files are cheap to read. Always reload them. */
+        return NULL;
+    }
+
+    full_filename = g_build_filename(dirname, filename, NULL);
+
+    storage = nm_sett_util_storages_lookup_by_filename(&priv->storages, full_filename);
+    if (!storage || storage->is_meta_data || storage->storage_type != storage_type
+        || !storage->u.conn_data.stat_valid)
+        return NULL;
+
+    if (stat(full_filename, &st) != 0)
+        return NULL;
+
+    if (!nms_keyfile_storage_stat_unchanged(storage, &st))
+        return NULL;
+
+    return storage;
+}
+
 static void
 _load_dir(NMSKeyfilePlugin *    self,
           NMSKeyfileStorageType storage_type,
           const char *          dirname,
-          NMSettUtilStorages *  storages)
+          NMSettUtilStorages *  storages,
+          GHashTable *          storages_unchanged)
 {
     const char *       filename;
     GDir *             dir;
@@ -442,6 +494,16 @@ _load_dir(NMSKeyfilePlugin *    self,
         if (!g_hash_table_add(dupl_filenames, (char *) filename))
             continue;
 
+        if (storages_unchanged) {
+            NMSKeyfileStorage *storage_old;
+
+            storage_old = _load_dir_lookup_unchanged(self, storage_type, dirname, filename);
+            if (storage_old) {
+                g_hash_table_add(storages_unchanged, storage_old);
+                continue;
+            }
+        }
+
         storage = _load_file(self, dirname, filename, storage_type, NULL);
         if (!storage)
             continue;
@@ -468,6 +530,7 @@ _storages_consolidate(NMSKeyfilePlugin *                     self,
                       NMSettUtilStorages *                   storages_new,
                       gboolean                               replace_all,
                       GHashTable *                           storages_replaced,
+                      GHashTable *                           storages_unchanged,
                       NMSettingsPluginConnectionLoadCallback callback,
                       gpointer                               user_data)
 {
@@ -484,8 +547,12 @@ _storages_consolidate(NMSKeyfilePlugin *                     self,
     storages_modified = g_ptr_array_new_with_free_func(g_object_unref);
     c_list_init(&storages_deleted);
 
-    c_list_for_each_entry (storage_old, &priv->storages._storage_lst_head, parent._storage_lst)
-        storage_old->is_dirty = TRUE;
+    /* storages that were found unchanged on disk are kept as they are. We
+     * don't re-emit them, NMSettings already knows their content. */
+    c_list_for_each_entry (storage_old, &priv->storages._storage_lst_head, parent._storage_lst) {
+        storage_old->is_dirty =
+            !storages_unchanged || !g_hash_table_contains(storages_unchanged, storage_old);
+    }
 
     c_list_for_each_entry_safe (storage_new,
                                 storage_safe,
@@ -583,15 +650,44 @@ reload_connections(NMSettingsPlugin *                     plugin,
     NMSKeyfilePluginPrivate *                           priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE(self);
     nm_auto_clear_sett_util_storages NMSettUtilStorages storages_new =
         NM_SETT_UTIL_STORAGES_INIT(storages_new, nms_keyfile_storage_destroy);
-    int i;
+    gs_unref_hashtable GHashTable *storages_unchanged = NULL;
+    int                            i;
 
-    _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_RUN, priv->dirname_run, &storages_new);
-    if (priv->dirname_etc)
-        _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_ETC, priv->dirname_etc, &storages_new);
-    for (i = 0; priv->dirname_libs[i]; i++)
-        _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_LIB(i), priv->dirname_libs[i], &storages_new);
+    /* With incremental reload, we only re-read keyfiles whose stat identity
+     * changed since they were last read or written. */
+    if (nm_config_data_get_value_boolean(nm_config_get_data(priv->config),
+                                         NM_CONFIG_KEYFILE_GROUP_KEYFILE,
+                                         NM_CONFIG_KEYFILE_KEY_KEYFILE_RELOAD_INCREMENTAL,
+                                         FALSE))
+        storages_unchanged = g_hash_table_new(nm_direct_hash, NULL);
+
+    _load_dir(self,
+              NMS_KEYFILE_STORAGE_TYPE_RUN,
+              priv->dirname_run,
+              &storages_new,
+              storages_unchanged);
+    if (priv->dirname_etc) {
+        _load_dir(self,
+                  NMS_KEYFILE_STORAGE_TYPE_ETC,
+                  priv->dirname_etc,
+                  &storages_new,
+                  storages_unchanged);
+    }
+    for (i = 0; priv->dirname_libs[i]; i++) {
+        _load_dir(self,
+                  NMS_KEYFILE_STORAGE_TYPE_LIB(i),
+                  priv->dirname_libs[i],
+                  &storages_new,
+                  storages_unchanged);
+    }
+
+    if (storages_unchanged) {
+        _LOGT("reload: %u keyfiles unchanged, %u keyfiles (re)loaded",
+              g_hash_table_size(storages_unchanged),
+              (guint) c_list_length(&storages_new._storage_lst_head));
+    }
 
-    _storages_consolidate(self, &storages_new, TRUE, NULL, callback, user_data);
+    _storages_consolidate(self, &storages_new, TRUE, NULL, storages_unchanged, callback, user_data);
 }
 
 static void
@@ -739,7 +835,7 @@ load_connections(NMSettingsPlugin *                     plugin,
     nm_clear_pointer(&loaded_uuids, g_hash_table_destroy);
     nm_clear_pointer(&dupl_filenames, g_hash_table_destroy);
 
-    _storages_consolidate(self, &storages_new, FALSE, storages_replaced, callback, user_data);
+    _storages_consolidate(self, &storages_new, FALSE, storages_replaced, NULL, callback, user_data);
 }
 
 gboolean
@@ -763,7 +859,6 @@ nms_keyfile_plugin_add_connection(NMSKeyfilePlugin *  self,
     GError *                           local   = NULL;
     const char *                       uuid;
     gboolean                           reread_same;
-    struct timespec                    mtime;
     char                               strbuf[100];
 
     nm_assert(NM_IS_CONNECTION(connection));
@@ -837,7 +932,8 @@ nms_keyfile_plugin_add_connection(NMSKeyfilePlugin *  self,
                                            is_external ? NM_TERNARY_TRUE : NM_TERNARY_FALSE,
                                            shadowed_storage,
                                            shadowed_owned ? NM_TERNARY_TRUE : NM_TERNARY_FALSE,
-                                           nm_sett_util_stat_mtime(full_filename, FALSE, &mtime));
+                                           NULL);
+    _storage_update_stat(storage, full_filename);
 
     nm_sett_util_storages_add_take(&priv->storages, g_object_ref(storage));
 
@@ -887,7 +983,6 @@ nms_keyfile_plugin_update_connection(NMSKeyfilePlugin *  self,
     gs_unref_object NMConnection *reread           = NULL;
     gs_free char *                full_filename    = NULL;
     gs_free_error GError *local                    = NULL;
-    struct timespec       mtime;
     const char *          previous_filename;
     gboolean              reread_same;
     const char *          uuid;
@@ -961,8 +1056,8 @@ nms_keyfile_plugin_update_connection(NMSKeyfilePlugin *  self,
     storage->u.conn_data.is_nm_generated = is_nm_generated;
     storage->u.conn_data.is_volatile     = is_volatile;
     storage->u.conn_data.is_external     = is_external;
-    storage->u.conn_data.stat_mtime      = *nm_sett_util_stat_mtime(full_filename, FALSE, &mtime);
     storage->u.conn_data.shadowed_owned  = shadowed_owned;
+    _storage_update_stat(storage, full_filename);
 
     *out_storage    = g_object_ref(NM_SETTINGS_STORAGE(storage));
     *out_connection = g_steal_pointer(&reread);
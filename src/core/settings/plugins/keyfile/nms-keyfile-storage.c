@@ -7,6 +7,8 @@
 
 #include "nms-keyfile-storage.h"
 
+#include <sys/stat.h>
+
 #include "nm-utils.h"
 #include "nm-core-internal.h"
 #include "nms-keyfile-plugin.h"
@@ -59,6 +61,44 @@ nms_keyfile_storage_steal_connection(NMSKeyfileStorage *self)
     return self->is_meta_data ? NULL : g_steal_pointer(&self->u.conn_data.connection);
 }
 
+void
+nms_keyfile_storage_set_stat(NMSKeyfileStorage *self, const struct stat *st)
+{
+    nm_assert(NMS_IS_KEYFILE_STORAGE(self));
+    nm_assert(!self->is_meta_data);
+
+    if (!st) {
+        self->u.conn_data.stat_valid = FALSE;
+        return;
+    }
+
+    self->u.conn_data.stat_mtime = st->st_mtim;
+    self->u.conn_data.stat_ctime = st->st_ctim;
+    self->u.conn_data.stat_dev   = st->st_dev;
+    self->u.conn_data.stat_ino   = st->st_ino;
+    self->u.conn_data.stat_size  = st->st_size;
+    self->u.conn_data.stat_valid = TRUE;
+}
+
+gboolean
+nms_keyfile_storage_stat_unchanged(const NMSKeyfileStorage *self, const struct stat *st)
+{
+    nm_assert(NMS_IS_KEYFILE_STORAGE(self));
+    nm_assert(st);
+
+    if (self->is_meta_data || !self->u.conn_data.stat_valid)
+        return FALSE;
+
+    /* the ctime also changes on chmod/chown, which matters because the
+     * reader rejects files with insecure permissions. */
+    return self->u.conn_data.stat_dev == st->st_dev && self->u.conn_data.stat_ino == st->st_ino
+           && self->u.conn_data.stat_size == st->st_size
+           && self->u.conn_data.stat_mtime.tv_sec == st->st_mtim.tv_sec
+           && self->u.conn_data.stat_mtime.tv_nsec == st->st_mtim.tv_nsec
+           && self->u.conn_data.stat_ctime.tv_sec == st->st_ctim.tv_sec
+           && self->u.conn_data.stat_ctime.tv_nsec == st->st_ctim.tv_nsec;
+}
+
 /*****************************************************************************/
 
 static int
@@ -60,6 +60,15 @@ typedef struct {
              * multiple files with the same UUID, then the newer file gets preferred. */
             struct timespec stat_mtime;
 
+            /* the identity of the keyfile on disk at the time we last read or wrote
+             * it. This is used by incremental reload to skip re-reading files that
+             * did not change. If stat_valid is FALSE, the file is always re-read. */
+            struct timespec stat_ctime;
+            dev_t           stat_dev;
+            ino_t           stat_ino;
+            off_t           stat_size;
+            bool            stat_valid : 1;
+
             /* these flags are only relevant for storages with %NMS_KEYFILE_STORAGE_TYPE_RUN
              * (and non-metadata). This is to persist and reload these settings flags to
              * /run.
@@ -131,6 +140,12 @@ void nms_keyfile_storage_copy_content(NMSKeyfileStorage *dst, const NMSKeyfileSt
 
 NMConnection *nms_keyfile_storage_steal_connection(NMSKeyfileStorage *storage);
 
+struct stat;
+
+void nms_keyfile_storage_set_stat(NMSKeyfileStorage *self, const struct stat *st);
+
+gboolean nms_keyfile_storage_stat_unchanged(const NMSKeyfileStorage *self, const struct stat *st);
+
 /*****************************************************************************/
 
 static inline const char *
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -16,7 +17,10 @@
 #include <linux/if_infiniband.h>
 
 #include "nm-core-internal.h"
+#include "nm-keyfile-utils.h"
 
+#include "nm-config.h"
+#include "settings/plugins/keyfile/nms-keyfile-plugin.h"
 #include "settings/plugins/keyfile/nms-keyfile-reader.h"
 #include "settings/plugins/keyfile/nms-keyfile-writer.h"
 #include "settings/plugins/keyfile/nms-keyfile-utils.h"
@@ -2817,6 +2821,318 @@ test_nmmeta(void)
 
 /*****************************************************************************/
 
+#define TEST_RELOAD_DIR TEST_SCRATCH_DIR "/reload"
+
+typedef struct {
+    GHashTable *loaded;
+    GHashTable *deleted;
+} ReloadData;
+
+static void
+_reload_cb(NMSettingsPlugin * plugin,
+           NMSettingsStorage *storage,
+           NMConnection *     connection,
+           gpointer           user_data)
+{
+    ReloadData *data     = user_data;
+    const char *filename = nm_settings_storage_get_filename(storage);
+
+    /* the plugin also reads the system directories for /run and /usr/lib. */
+    if (!g_str_has_prefix(filename, TEST_RELOAD_DIR "/"))
+        return;
+
+    if (connection) {
+        g_assert(!g_hash_table_contains(data->loaded, filename));
+        g_hash_table_insert(data->loaded,
+                            g_path_get_basename(filename),
+                            g_strdup(nm_connection_get_id(connection)));
+    } else
+        g_hash_table_add(data->deleted, g_path_get_basename(filename));
+}
+
+static void
+_reload_write(const char *name, const char *id, const char *uuid)
+{
+    gs_free char *filename = g_build_filename(TEST_RELOAD_DIR, name, NULL);
+    gs_free char *contents = NULL;
+
+    contents = g_strdup_printf("[connection]\n"
+                               "id=%s\n"
+                               "uuid=%s\n"
+                               "type=ethernet\n",
+                               id,
+                               uuid);
+    if (!g_file_set_contents(filename, contents, -1, NULL))
+        g_assert_not_reached();
+    g_assert_cmpint(chmod(filename, 0600), ==, 0);
+}
+
+static void
+_reload_assert(NMSettingsPlugin *plugin,
+               guint             n_loaded,
+               const char *      loaded,
+               const char *      id,
+               const char *      deleted)
+{
+    gs_unref_hashtable GHashTable *loaded_hash =
+        g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, g_free);
+    gs_unref_hashtable GHashTable *deleted_hash =
+        g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, NULL);
+    ReloadData data = {
+        .loaded  = loaded_hash,
+        .deleted = deleted_hash,
+    };
+
+    nm_settings_plugin_reload_connections(plugin, _reload_cb, &data);
+
+    g_assert_cmpint(g_hash_table_size(loaded_hash), ==, n_loaded);
+    if (loaded)
+        g_assert_cmpstr(g_hash_table_lookup(loaded_hash, loaded), ==, id);
+
+    if (deleted) {
+        g_assert_cmpint(g_hash_table_size(deleted_hash), ==, 1);
+        g_assert(g_hash_table_contains(deleted_hash, deleted));
+    } else
+        g_assert_cmpint(g_hash_table_size(deleted_hash), ==, 0);
+}
+
+static gboolean
+_dir_has_entries(const char *dirname)
+{
+    GDir *   dir;
+    gboolean has_entries;
+
+    dir = g_dir_open(dirname, 0, NULL);
+    if (!dir)
+        return FALSE;
+    has_entries = !!g_dir_read_name(dir);
+    g_dir_close(dir);
+    return has_entries;
+}
+
+static void
+test_reload_incremental(void)
+{
+    gs_unref_object NMSettingsPlugin *plugin = NULL;
+
+    if (_dir_has_entries(NM_KEYFILE_PATH_NAME_RUN) || _dir_has_entries(NM_KEYFILE_PATH_NAME_LIB)) {
+        g_test_skip("the system keyfile directories are not empty");
+        return;
+    }
+
+    _reload_write("a", "profile-a", "3a5f2b2e-6f44-4b7e-9a5e-2a0e7b1c4d01");
+    _reload_write("b", "profile-b", "3a5f2b2e-6f44-4b7e-9a5e-2a0e7b1c4d02");
+    _reload_write("c", "profile-c", "3a5f2b2e-6f44-4b7e-9a5e-2a0e7b1c4d03");
+
+    plugin = NM_SETTINGS_PLUGIN(nms_keyfile_plugin_new());
+
+    /* the first reload reads everything, the next one nothing. */
+    _reload_assert(plugin, 3, "a", "profile-a", NULL);
+    _reload_assert(plugin, 0, NULL, NULL, NULL);
+
+    _reload_write("b", "profile-b-changed", "3a5f2b2e-6f44-4b7e-9a5e-2a0e7b1c4d02");
+    _reload_assert(plugin, 1, "b", "profile-b-changed", NULL);
+
+    _reload_write("d", "profile-d", "3a5f2b2e-6f44-4b7e-9a5e-2a0e7b1c4d04");
+    _reload_assert(plugin, 1, "d", "profile-d", NULL);
+
+    g_assert_cmpint(unlink(TEST_RELOAD_DIR "/c"), ==, 0);
+    _reload_assert(plugin, 0, NULL, NULL, "c");
+
+    _reload_assert(plugin, 0, NULL, NULL, NULL);
+
+    (void) unlink(TEST_RELOAD_DIR "/a");
+    (void) unlink(TEST_RELOAD_DIR "/b");
+    (void) unlink(TEST_RELOAD_DIR "/d");
+}
+
+static void
+_config_setup(void)
+{
+    const char *            config_file = TEST_SCRATCH_DIR "/NetworkManager.conf";
+    gs_free_error GError *  error       = NULL;
+    NMConfigCmdLineOptions *cli;
+    GOptionContext *        context;
+    char *                  argv_data[] = {
+        "test-keyfile-settings",
+        "--config",
+        (char *) config_file,
+        "--intern-config",
+        "",
+        "--config-dir",
+        "/no/such/dir",
+        "--system-config-dir",
+        "",
+        NULL,
+    };
+    char **argv = argv_data;
+    int    argc = G_N_ELEMENTS(argv_data) - 1;
+
+    /* the keyfile plugin takes its directory and options from NMConfig. */
+    if (!g_file_set_contents(config_file,
+                             "[keyfile]\n"
+                             "path=" TEST_RELOAD_DIR "\n"
+                             "reload-incremental=true\n",
+                             -1,
+                             NULL))
+        g_assert_not_reached();
+
+    cli     = nm_config_cmd_line_options_new(FALSE);
+    context = g_option_context_new(NULL);
+    nm_config_cmd_line_options_add_to_entries(cli, context);
+    if (!g_option_context_parse(context, &argc, &argv, NULL))
+        g_assert_not_reached();
+    g_option_context_free(context);
+
+    if (!nm_config_setup(cli, NULL, &error))
+        g_assert_not_reached();
+    g_assert_no_error(error);
+    nm_config_cmd_line_options_free(cli);
+}
+
+/*****************************************************************************/
+
+/* copies @kf, but names the groups that have an alias by the other name. So
+ * "[ethernet]" becomes "[802-3-ethernet]" and vice versa. */
+static GKeyFile *
+_keyfile_swap_group_names(GKeyFile *kf)
+{
+    nm_auto_free_gstring GString *str    = g_string_new(NULL);
+    gs_strfreev char **           groups = NULL;
+    GKeyFile *                    kf2;
+    guint                         i, j;
+
+    groups = g_key_file_get_groups(kf, NULL);
+    for (i = 0; groups[i]; i++) {
+        gs_strfreev char **keys  = g_key_file_get_keys(kf, groups[i], NULL, NULL);
+        const char *       group = groups[i];
+        const char *       other;
+
+        other = nm_keyfile_plugin_get_alias_for_setting_name(group)
+                    ?: nm_keyfile_plugin_get_setting_name_for_alias(group);
+        if (other && !g_key_file_has_group(kf, other))
+            group = other;
+
+        g_string_append_printf(str, "[%s]\n", group);
+        for (j = 0; keys[j]; j++) {
+            gs_free char *value = g_key_file_get_value(kf, groups[i], keys[j], NULL);
+
+            g_string_append_printf(str, "%s=%s\n", keys[j], value);
+        }
+    }
+
+    kf2 = g_key_file_new();
+    if (!g_key_file_load_from_data(kf2, str->str, str->len, G_KEY_FILE_NONE, NULL))
+        g_assert_not_reached();
+    return kf2;
+}
+
+/* loads the profiles in TEST_KEYFILES_DIR, with the group names as they are,
+ * and with the aliased group names swapped. */
+static void
+_keyfile_load_corpus(GPtrArray **out_names, GPtrArray **out_kfs, GPtrArray **out_kfs_swapped)
+{
+    gs_free_error GError *error = NULL;
+    GDir *                dir;
+    const char *          name;
+
+    *out_names       = g_ptr_array_new_with_free_func(g_free);
+    *out_kfs         = g_ptr_array_new_with_free_func((GDestroyNotify) g_key_file_unref);
+    *out_kfs_swapped = g_ptr_array_new_with_free_func((GDestroyNotify) g_key_file_unref);
+
+    dir = g_dir_open(TEST_KEYFILES_DIR, 0, &error);
+    nmtst_assert_success(dir, error);
+
+    while ((name = g_dir_read_name(dir))) {
+        gs_free char *full_filename = NULL;
+        GKeyFile *    kf;
+
+        if (g_str_has_suffix(name, ".pem"))
+            continue;
+
+        full_filename = g_build_filename(TEST_KEYFILES_DIR, name, NULL);
+        kf            = g_key_file_new();
+        if (!g_key_file_load_from_file(kf, full_filename, G_KEY_FILE_NONE, NULL))
+            g_assert_not_reached();
+
+        g_ptr_array_add(*out_names, g_strdup(name));
+        g_ptr_array_add(*out_kfs, kf);
+        g_ptr_array_add(*out_kfs_swapped, _keyfile_swap_group_names(kf));
+    }
+    g_dir_close(dir);
+
+    g_assert_cmpint((*out_names)->len, >, 10);
+}
+
+static NMConnection *
+_keyfile_read_corpus_entry(GKeyFile *kf, const char *name)
+{
+    return nms_keyfile_reader_from_keyfile(kf, name, TEST_KEYFILES_DIR, NULL, FALSE, NULL);
+}
+
+static void
+test_read_corpus_group_names(void)
+{
+    gs_unref_ptrarray GPtrArray *names       = NULL;
+    gs_unref_ptrarray GPtrArray *kfs         = NULL;
+    gs_unref_ptrarray GPtrArray *kfs_swapped = NULL;
+    guint                        i;
+
+    /* the keyfile reader looks up each setting by its name, and falls back to
+     * the alias. Both names give the same profile. */
+    _keyfile_load_corpus(&names, &kfs, &kfs_swapped);
+
+    for (i = 0; i < names->len; i++) {
+        gs_unref_object NMConnection *con         = NULL;
+        gs_unref_object NMConnection *con_swapped = NULL;
+
+        con         = _keyfile_read_corpus_entry(kfs->pdata[i], names->pdata[i]);
+        con_swapped = _keyfile_read_corpus_entry(kfs_swapped->pdata[i], names->pdata[i]);
+
+        g_assert_cmpint(!con, ==, !con_swapped);
+        if (con)
+            nmtst_assert_connection_equals(con, FALSE, con_swapped, FALSE);
+    }
+}
+
+static void
+test_read_corpus_bench(void)
+{
+    gs_unref_ptrarray GPtrArray *names       = NULL;
+    gs_unref_ptrarray GPtrArray *kfs         = NULL;
+    gs_unref_ptrarray GPtrArray *kfs_swapped = NULL;
+    const guint                  n_rounds    = 200;
+    gint64                       t[2];
+    guint                        k;
+    guint                        i, j;
+
+    _keyfile_load_corpus(&names, &kfs, &kfs_swapped);
+
+    for (k = 0; k < 2; k++) {
+        GPtrArray *arr = k == 0 ? kfs : kfs_swapped;
+
+        t[k] = g_get_monotonic_time();
+        for (j = 0; j < n_rounds; j++) {
+            for (i = 0; i < names->len; i++) {
+                gs_unref_object NMConnection *con = NULL;
+
+                con = _keyfile_read_corpus_entry(arr->pdata[i], names->pdata[i]);
+            }
+        }
+        t[k] = g_get_monotonic_time() - t[k];
+    }
+
+    g_test_message("reading %u profiles %u times: %" G_GINT64_FORMAT
+                   " usec with the group names as written, %" G_GINT64_FORMAT
+                   " usec with swapped aliases",
+                   names->len,
+                   n_rounds,
+                   t[0],
+                   t[1]);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -2835,6 +3151,15 @@ main(int argc, char **argv)
                 nm_strerror_native(errsv));
     }
 
+    if (g_mkdir_with_parents(TEST_RELOAD_DIR, 0755) != 0) {
+        errsv = errno;
+        g_error("failure to create test directory \"%s\": %s",
+                TEST_RELOAD_DIR,
+                nm_strerror_native(errsv));
+    }
+
+    _config_setup();
+
     /* The tests */
     g_test_add_func("/keyfile/test_read_valid_wired_connection", test_read_valid_wired_connection);
     g_test_add_func("/keyfile/test_write_wired_connection", test_write_wired_connection);
@@ -2918,6 +3243,10 @@ main(int argc, char **argv)
                     test_nm_keyfile_plugin_utils_escape_filename);
 
     g_test_add_func("/keyfile/test_nmmeta", test_nmmeta);
+    g_test_add_func("/keyfile/test_reload_incremental", test_reload_incremental);
+    g_test_add_func("/keyfile/test_read_corpus_group_names", test_read_corpus_group_names);
+    if (g_test_perf())
+        g_test_add_func("/keyfile/test_read_corpus_bench", test_read_corpus_bench);
 
     return g_test_run();
 }
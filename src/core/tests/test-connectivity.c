@@ -0,0 +1,618 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include <fcntl.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "nm-config.h"
+#include "nm-connectivity.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+/* A minimal HTTP server on 127.0.0.1, running in its own thread. It answers
+ * each request with the default connectivity check response, and keeps the
+ * connection open unless the client asks to close it. With hold_tail, it
+ * sends more data after the expected response, but only after the test
+ * released it with _server_release_tail(). */
+
+#define SERVER_MAX_CLIENTS 16
+
+#define SERVER_RESPONSE_TAIL "0123456789abcdef0123456789abcdef"
+
+typedef struct {
+    GThread *thread;
+    int      fd_listen;
+    int      fd_stop[2];
+    int      fd_tail[2];
+    guint16  port;
+
+    /* accessed with atomic operations. */
+    int n_accepted;
+    int n_requests;
+    int n_open_max;
+    int n_tails_sent;
+    int hold_tail;
+} Server;
+
+typedef struct {
+    int   fd;
+    gsize len;
+    char  buf[4096];
+} ServerClient;
+
+static void
+_server_client_close(ServerClient *client)
+{
+    nm_close(client->fd);
+    client->fd  = -1;
+    client->len = 0;
+}
+
+static void
+_server_client_send(ServerClient *client, const char *buf, gsize len)
+{
+    g_assert_cmpint(send(client->fd, buf, len, MSG_NOSIGNAL), ==, len);
+}
+
+static void
+_server_client_handle(Server *server, ServerClient *client)
+{
+    static const char response[]      = "HTTP/1.1 200 OK\r\n"
+                                        "Content-Type: text/plain\r\n"
+                                        "Content-Length: 24\r\n"
+                                        "\r\n" NM_CONFIG_DEFAULT_CONNECTIVITY_RESPONSE;
+    static const char response_long[] = "HTTP/1.1 200 OK\r\n"
+                                        "Content-Type: text/plain\r\n"
+                                        "Content-Length: 56\r\n"
+                                        "\r\n" NM_CONFIG_DEFAULT_CONNECTIVITY_RESPONSE;
+    ssize_t           n;
+    char *            end;
+
+    n = recv(client->fd, &client->buf[client->len], sizeof(client->buf) - 1 - client->len, 0);
+    if (n <= 0) {
+        _server_client_close(client);
+        return;
+    }
+    client->len += n;
+    client->buf[client->len] = '\0';
+
+    while ((end = strstr(client->buf, "\r\n\r\n"))) {
+        gboolean close_conn;
+        char     c;
+
+        *end       = '\0';
+        close_conn = !!strcasestr(client->buf, "\r\nConnection: close");
+
+        g_atomic_int_inc(&server->n_requests);
+
+        if (g_atomic_int_get(&server->hold_tail)) {
+            _server_client_send(client, response_long, sizeof(response_long) - 1);
+            g_assert_cmpint(read(server->fd_tail[0], &c, 1), ==, 1);
+            _server_client_send(client, SERVER_RESPONSE_TAIL, sizeof(SERVER_RESPONSE_TAIL) - 1);
+            g_atomic_int_inc(&server->n_tails_sent);
+        } else
+            _server_client_send(client, response, sizeof(response) - 1);
+
+        if (close_conn) {
+            _server_client_close(client);
+            return;
+        }
+
+        client->len -= (end + 4) - client->buf;
+        memmove(client->buf, end + 4, client->len + 1);
+    }
+
+    if (client->len >= sizeof(client->buf) - 1)
+        _server_client_close(client);
+}
+
+static gpointer
+_server_thread(gpointer user_data)
+{
+    Server *     server = user_data;
+    ServerClient clients[SERVER_MAX_CLIENTS];
+    guint        i;
+
+    for (i = 0; i < G_N_ELEMENTS(clients); i++)
+        clients[i] = (ServerClient){.fd = -1};
+
+    for (;;) {
+        struct pollfd pfds[2 + SERVER_MAX_CLIENTS];
+        guint         n_open = 0;
+
+        pfds[0] = (struct pollfd){.fd = server->fd_stop[0], .events = POLLIN};
+        pfds[1] = (struct pollfd){.fd = server->fd_listen, .events = POLLIN};
+        for (i = 0; i < G_N_ELEMENTS(clients); i++) {
+            pfds[2 + i] = (struct pollfd){.fd = clients[i].fd, .events = POLLIN};
+            if (clients[i].fd >= 0)
+                n_open++;
+        }
+
+        if (n_open > (guint) g_atomic_int_get(&server->n_open_max))
+            g_atomic_int_set(&server->n_open_max, n_open);
+
+        g_assert_cmpint(poll(pfds, G_N_ELEMENTS(pfds), -1), >, 0);
+
+        if (pfds[0].revents)
+            break;
+
+        for (i = 0; i < G_N_ELEMENTS(clients); i++) {
+            if (pfds[2 + i].revents)
+                _server_client_handle(server, &clients[i]);
+        }
+
+        if (pfds[1].revents) {
+            int fd;
+
+            fd = accept4(server->fd_listen, NULL, NULL, SOCK_CLOEXEC);
+            g_assert_cmpint(fd, >=, 0);
+            g_atomic_int_inc(&server->n_accepted);
+
+            for (i = 0; i < G_N_ELEMENTS(clients); i++) {
+                if (clients[i].fd < 0) {
+                    clients[i].fd = fd;
+                    break;
+                }
+            }
+            g_assert_cmpint(i, <, G_N_ELEMENTS(clients));
+        }
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(clients); i++) {
+        if (clients[i].fd >= 0)
+            _server_client_close(&clients[i]);
+    }
+    return NULL;
+}
+
+static void
+_server_start(Server *server)
+{
+    struct sockaddr_in addr = {
+        .sin_family      = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+
+    *server = (Server){};
+
+    server->fd_listen = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    g_assert_cmpint(server->fd_listen, >=, 0);
+    g_assert_cmpint(bind(server->fd_listen, (struct sockaddr *) &addr, sizeof(addr)), ==, 0);
+    g_assert_cmpint(listen(server->fd_listen, SERVER_MAX_CLIENTS), ==, 0);
+    g_assert_cmpint(getsockname(server->fd_listen, (struct sockaddr *) &addr, &addr_len), ==, 0);
+    server->port = ntohs(addr.sin_port);
+
+    g_assert_cmpint(pipe2(server->fd_stop, O_CLOEXEC), ==, 0);
+    g_assert_cmpint(pipe2(server->fd_tail, O_CLOEXEC), ==, 0);
+
+    server->thread = g_thread_new("test-connectivity-server", _server_thread, server);
+}
+
+static void
+_server_stop(Server *server)
+{
+    g_assert_cmpint(write(server->fd_stop[1], "x", 1), ==, 1);
+    g_thread_join(server->thread);
+
+    nm_close(server->fd_stop[0]);
+    nm_close(server->fd_stop[1]);
+    nm_close(server->fd_tail[0]);
+    nm_close(server->fd_tail[1]);
+    nm_close(server->fd_listen);
+}
+
+static void
+_server_release_tail(Server *server)
+{
+    g_assert_cmpint(write(server->fd_tail[1], "x", 1), ==, 1);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GMainLoop *loop;
+    guint      n_pending;
+    guint      n_full;
+} CheckData;
+
+static void
+_check_cb(NMConnectivity *           self,
+          NMConnectivityCheckHandle *handle,
+          NMConnectivityState        state,
+          gpointer                   user_data)
+{
+    CheckData *check_data = user_data;
+
+    g_assert_cmpint(state, ==, NM_CONNECTIVITY_FULL);
+    check_data->n_full++;
+
+    g_assert_cmpint(check_data->n_pending, >, 0);
+    if (--check_data->n_pending == 0)
+        g_main_loop_quit(check_data->loop);
+}
+
+static void
+_check_run(NMConnectivity *self, guint n_checks, gboolean is_periodic)
+{
+    nm_auto_unref_gmainloop GMainLoop *loop       = g_main_loop_new(NULL, FALSE);
+    CheckData                          check_data = {
+        .loop      = loop,
+        .n_pending = n_checks,
+    };
+    guint i;
+
+    for (i = 0; i < n_checks; i++) {
+        g_assert(nm_connectivity_check_start(self,
+                                             AF_INET,
+                                             NULL,
+                                             if_nametoindex("lo"),
+                                             "lo",
+                                             is_periodic,
+                                             _check_cb,
+                                             &check_data));
+    }
+
+    nmtst_main_loop_run_assert(loop, 10000);
+    g_assert_cmpint(check_data.n_full, ==, n_checks);
+}
+
+static char *config_filename;
+
+static void
+_config_setup(void)
+{
+    gs_free_error GError *  error = NULL;
+    NMConfigCmdLineOptions *cli;
+    GOptionContext *        context;
+    NMConfig *              config;
+    char *                  argv_data[] = {
+        "test-connectivity",
+        "--config",
+        config_filename,
+        "--intern-config",
+        "",
+        "--config-dir",
+        "/no/such/dir",
+        "--system-config-dir",
+        "",
+        NULL,
+    };
+    char **argv = argv_data;
+    int    argc = G_N_ELEMENTS(argv_data) - 1;
+
+    cli     = nm_config_cmd_line_options_new(FALSE);
+    context = g_option_context_new(NULL);
+    nm_config_cmd_line_options_add_to_entries(cli, context);
+    if (!g_option_context_parse(context, &argc, &argv, NULL))
+        g_assert_not_reached();
+    g_option_context_free(context);
+
+    config = nm_config_setup(cli, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(config);
+    nm_config_cmd_line_options_free(cli);
+}
+
+/* writes the configuration for @server, and loads it. NMConfig is a
+ * singleton, so the tests share it, and reload it. */
+static void
+_config_load(const Server *server, const char *extra)
+{
+    gs_free char *contents = NULL;
+    gboolean      is_setup = FALSE;
+    int           fd;
+
+    if (!config_filename) {
+        fd = g_file_open_tmp("test-connectivity-XXXXXX.conf", &config_filename, NULL);
+        g_assert_cmpint(fd, >=, 0);
+        nm_close(fd);
+        is_setup = TRUE;
+    }
+
+    contents = g_strdup_printf("[connectivity]\n"
+                               "uri=http://127.0.0.1:%u/\n"
+                               "%s",
+                               (guint) server->port,
+                               extra);
+    if (!g_file_set_contents(config_filename, contents, -1, NULL))
+        g_assert_not_reached();
+
+    if (is_setup)
+        _config_setup();
+    else
+        nm_config_reload(nm_config_get(), NM_CONFIG_CHANGE_CAUSE_SIGHUP, FALSE);
+}
+
+static void
+test_concheck_reuse(void)
+{
+    gs_unref_object NMConnectivity *self = NULL;
+    Server                          server;
+
+    if (!WITH_CONCHECK) {
+        g_test_skip("connectivity checking is disabled");
+        return;
+    }
+
+    _server_start(&server);
+
+    /* without reuse, each check opens its own connection. The periodic checks
+     * run one after the other. */
+    _config_load(&server, "max-parallel=1\n");
+
+    self = g_object_new(NM_TYPE_CONNECTIVITY, NULL);
+    g_assert(nm_connectivity_check_enabled(self));
+
+    _check_run(self, 4, TRUE);
+    g_assert_cmpint(g_atomic_int_get(&server.n_requests), ==, 4);
+    g_assert_cmpint(g_atomic_int_get(&server.n_accepted), ==, 4);
+    g_assert_cmpint(g_atomic_int_get(&server.n_open_max), ==, 1);
+
+    /* with reuse, consecutive checks share one connection. */
+    _config_load(&server, "reuse-connections=true\n");
+
+    _check_run(self, 1, FALSE);
+    _check_run(self, 1, TRUE);
+    _check_run(self, 1, FALSE);
+    g_assert_cmpint(g_atomic_int_get(&server.n_requests), ==, 7);
+    g_assert_cmpint(g_atomic_int_get(&server.n_accepted), ==, 5);
+
+    g_clear_object(&self);
+    _server_stop(&server);
+}
+
+static void
+test_concheck_drain(void)
+{
+    gs_unref_object NMConnectivity *self = NULL;
+    Server                          server;
+
+    if (!WITH_CONCHECK) {
+        g_test_skip("connectivity checking is disabled");
+        return;
+    }
+
+    _server_start(&server);
+    g_atomic_int_set(&server.hold_tail, TRUE);
+
+    _config_load(&server, "reuse-connections=true\n");
+    self = g_object_new(NM_TYPE_CONNECTIVITY, NULL);
+
+    /* the check completes with the expected response, while the server still
+     * holds back the rest of the data. */
+    _check_run(self, 1, FALSE);
+    g_assert_cmpint(g_atomic_int_get(&server.n_requests), ==, 1);
+    g_assert_cmpint(g_atomic_int_get(&server.n_tails_sent), ==, 0);
+
+    /* the rest is read in the background... */
+    g_atomic_int_set(&server.hold_tail, FALSE);
+    _server_release_tail(&server);
+    nmtst_main_context_iterate_until_assert_full(NULL,
+                                                 5000,
+                                                 10,
+                                                 g_atomic_int_get(&server.n_tails_sent) == 1);
+    while (g_main_context_iteration(NULL, FALSE)) {}
+
+    /* ... and the connection is reused. */
+    _check_run(self, 1, FALSE);
+    g_assert_cmpint(g_atomic_int_get(&server.n_requests), ==, 2);
+    g_assert_cmpint(g_atomic_int_get(&server.n_accepted), ==, 1);
+
+    g_clear_object(&self);
+    _server_stop(&server);
+}
+
+static void
+_check_any_cb(NMConnectivity *           self,
+              NMConnectivityCheckHandle *handle,
+              NMConnectivityState        state,
+              gpointer                   user_data)
+{
+    NMConnectivityCheckHandle **p_handle = user_data;
+
+    g_assert(*p_handle == handle);
+    *p_handle = NULL;
+}
+
+static void
+test_concheck_jitter(void)
+{
+    gs_unref_object NMConnectivity *self = NULL;
+    NMConnectivityCheckHandle *     handle;
+    Server                          server;
+
+    if (!WITH_CONCHECK) {
+        g_test_skip("connectivity checking is disabled");
+        return;
+    }
+
+    _server_start(&server);
+
+    _config_load(&server, "start-jitter=1000\n");
+    self = g_object_new(NM_TYPE_CONNECTIVITY, NULL);
+
+    _check_run(self, 8, TRUE);
+    g_assert_cmpint(g_atomic_int_get(&server.n_requests), ==, 8);
+
+    /* other checks are not delayed. With a jitter of an hour, a periodic
+     * check is still queued when the other check completes. */
+    _config_load(&server, "start-jitter=3600000\n");
+
+    handle = nm_connectivity_check_start(self,
+                                         AF_INET,
+                                         NULL,
+                                         if_nametoindex("lo"),
+                                         "lo",
+                                         TRUE,
+                                         _check_any_cb,
+                                         &handle);
+    g_assert(handle);
+    _check_run(self, 1, FALSE);
+    if (handle)
+        nm_connectivity_check_cancel(handle);
+    g_assert(!handle);
+
+    g_clear_object(&self);
+    _server_stop(&server);
+}
+
+/*****************************************************************************/
+
+static void
+test_start_queue(void)
+{
+    NMConnectivityStartQueueEntry  entries[64];
+    NMConnectivityStartQueueEntry *entry;
+    CList                          start_lst_head = C_LIST_INIT(start_lst_head);
+    const gint64                   now_msec       = 1000000;
+    const guint                    jitter_msec    = 1000;
+    gint64                         ready_msec;
+    guint                          i;
+
+    g_assert(!nm_connectivity_start_queue_peek(&start_lst_head, now_msec));
+    g_assert_cmpint(nm_connectivity_start_queue_get_timeout_msec(&start_lst_head, now_msec),
+                    ==,
+                    -1);
+
+    /* without jitter, the entries are ready right away, in order. */
+    for (i = 0; i < 3; i++) {
+        c_list_init(&entries[i].start_lst);
+        nm_connectivity_start_queue_add(&start_lst_head, &entries[i], 0, now_msec);
+    }
+    g_assert_cmpint(nm_connectivity_start_queue_get_timeout_msec(&start_lst_head, now_msec),
+                    ==,
+                    0);
+    for (i = 0; i < 3; i++) {
+        entry = nm_connectivity_start_queue_peek(&start_lst_head, now_msec);
+        g_assert(entry == &entries[i]);
+        c_list_unlink(&entry->start_lst);
+    }
+    g_assert(c_list_is_empty(&start_lst_head));
+
+    /* each entry gets its own delay, and the queue stays sorted by it. */
+    for (i = 0; i < G_N_ELEMENTS(entries); i++) {
+        c_list_init(&entries[i].start_lst);
+        nm_connectivity_start_queue_add(&start_lst_head, &entries[i], jitter_msec, now_msec + i);
+        g_assert_cmpint(entries[i].ready_msec, >=, now_msec + i);
+        g_assert_cmpint(entries[i].ready_msec, <=, now_msec + i + jitter_msec);
+    }
+
+    ready_msec = now_msec;
+    c_list_for_each_entry (entry, &start_lst_head, start_lst) {
+        g_assert_cmpint(entry->ready_msec, >=, ready_msec);
+        ready_msec = entry->ready_msec;
+    }
+
+    entry = c_list_first_entry(&start_lst_head, NMConnectivityStartQueueEntry, start_lst);
+    g_assert_cmpint(nm_connectivity_start_queue_get_timeout_msec(&start_lst_head, now_msec),
+                    ==,
+                    entry->ready_msec - now_msec);
+    g_assert(!nm_connectivity_start_queue_peek(&start_lst_head, entry->ready_msec - 1));
+
+    /* once the longest delay passed, all entries are ready. */
+    for (i = 0; i < G_N_ELEMENTS(entries); i++) {
+        entry = nm_connectivity_start_queue_peek(&start_lst_head,
+                                                 now_msec + G_N_ELEMENTS(entries) + jitter_msec);
+        g_assert(entry);
+        c_list_unlink(&entry->start_lst);
+    }
+    g_assert(c_list_is_empty(&start_lst_head));
+}
+
+/*****************************************************************************/
+
+static void
+test_resolve_cache(void)
+{
+    static const NMConnectivityState states_failed[] = {
+        NM_CONNECTIVITY_ERROR,
+        NM_CONNECTIVITY_LIMITED,
+        NM_CONNECTIVITY_PORTAL,
+    };
+    NMConnectivityResolveCache cache = {};
+    const char *const *        entries;
+    const gint64               now_msec = 1000000;
+    guint                      i;
+
+    g_assert(!nm_connectivity_resolve_cache_lookup(&cache, "example.com:80", now_msec));
+
+    nm_connectivity_resolve_cache_set(
+        &cache,
+        "example.com:80",
+        g_strdupv((char *[]){"example.com:80:192.0.2.1", "example.com:80:192.0.2.2", NULL}),
+        now_msec);
+
+    entries = nm_connectivity_resolve_cache_lookup(&cache, "example.com:80", now_msec + 1);
+    g_assert(entries);
+    g_assert_cmpstr(entries[0], ==, "example.com:80:192.0.2.1");
+    g_assert_cmpstr(entries[1], ==, "example.com:80:192.0.2.2");
+    g_assert(!entries[2]);
+
+    /* only for the same host and port. */
+    g_assert(!nm_connectivity_resolve_cache_lookup(&cache, "example.com:8080", now_msec));
+    g_assert(!nm_connectivity_resolve_cache_lookup(&cache, "example.org:80", now_msec));
+
+    /* checks that succeed, or that did not get a result, keep the entries. */
+    nm_connectivity_resolve_cache_check_completed(&cache, NM_CONNECTIVITY_FULL);
+    nm_connectivity_resolve_cache_check_completed(&cache, NM_CONNECTIVITY_CANCELLED);
+    g_assert(nm_connectivity_resolve_cache_lookup(&cache, "example.com:80", now_msec));
+
+    /* the entries expire. */
+    g_assert(nm_connectivity_resolve_cache_lookup(&cache,
+                                                  "example.com:80",
+                                                  now_msec + NM_CONNECTIVITY_RESOLVE_CACHE_MSEC
+                                                      - 1));
+    g_assert(!nm_connectivity_resolve_cache_lookup(&cache,
+                                                   "example.com:80",
+                                                   now_msec + NM_CONNECTIVITY_RESOLVE_CACHE_MSEC));
+    g_assert(!cache.entries);
+    g_assert(!cache.host_port);
+
+    /* failed checks drop them. */
+    for (i = 0; i < G_N_ELEMENTS(states_failed); i++) {
+        nm_connectivity_resolve_cache_set(&cache,
+                                          "example.com:80",
+                                          g_strdupv((char *[]){"example.com:80:192.0.2.1", NULL}),
+                                          now_msec);
+        g_assert(nm_connectivity_resolve_cache_lookup(&cache, "example.com:80", now_msec));
+
+        nm_connectivity_resolve_cache_check_completed(&cache, states_failed[i]);
+        g_assert(!nm_connectivity_resolve_cache_lookup(&cache, "example.com:80", now_msec));
+        g_assert(!cache.entries);
+    }
+
+    nm_connectivity_resolve_cache_clear(&cache);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE();
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    nmtst_init_with_logging(&argc, &argv, NULL, "ALL");
+
+    g_test_add_func("/connectivity/concheck-reuse", test_concheck_reuse);
+    g_test_add_func("/connectivity/concheck-drain", test_concheck_drain);
+    g_test_add_func("/connectivity/concheck-jitter", test_concheck_jitter);
+    g_test_add_func("/connectivity/start-queue", test_start_queue);
+    g_test_add_func("/connectivity/resolve-cache", test_resolve_cache);
+
+    ret = g_test_run();
+
+    if (config_filename) {
+        unlink(config_filename);
+        nm_clear_g_free(&config_filename);
+    }
+    return ret;
+}
@@ -18,6 +18,9 @@
 
 #include "dns/nm-dns-manager.h"
 #include "nm-connectivity.h"
+#include "nm-dbus-utils.h"
+#include "nm-dispatcher.h"
+#include "settings/nm-settings-utils.h"
 
 #include "nm-test-utils-core.h"
 
@@ -130,6 +133,106 @@ test_logging_error(void)
 
 /*****************************************************************************/
 
+static void
+test_logging_flight_recorder(void)
+{
+    gs_free char *dump = NULL;
+    guint         i;
+
+    g_assert(!nm_logging_flight_recorder_dump(G_MAXSIZE));
+
+    nm_logging_flight_recorder_setup(4096);
+    g_assert(nm_logging_enabled(LOGL_TRACE, LOGD_CORE));
+
+    nm_log_trace(LOGD_CORE, "fr-test: int %d, uint %u, hex 0x%04x", -5, 7u, 0xabc);
+    nm_log_dbg(LOGD_DEVICE,
+               "fr-test: str '%s', null %s, width '%-*s', prec '%.3s'",
+               "foo",
+               (const char *) NULL,
+               5,
+               "ab",
+               "abcdef");
+    nm_log_dbg(LOGD_CORE,
+               "fr-test: long %" G_GINT64_FORMAT ", size %zu, char %c, dbl %.2f%%",
+               G_MININT64,
+               (gsize) 42,
+               'x',
+               1.5);
+
+    dump = nm_logging_flight_recorder_dump(G_MAXSIZE);
+    g_assert(dump);
+    g_assert(strstr(dump, "<trace> ["));
+    g_assert(strstr(dump, "] fr-test: int -5, uint 7, hex 0x0abc\n"));
+    g_assert(strstr(dump, "] fr-test: str 'foo', null (null), width 'ab   ', prec 'abc'\n"));
+    g_assert(strstr(dump, "] fr-test: long -9223372036854775808, size 42, char x, dbl 1.50%\n"));
+    g_assert(!strstr(dump, "older messages were overwritten"));
+    nm_clear_g_free(&dump);
+
+    /* the ring buffer only keeps the most recent messages. */
+    for (i = 0; i < 1000; i++)
+        nm_log_trace(LOGD_CORE, "fr-test: message #%u", i);
+
+    dump = nm_logging_flight_recorder_dump(G_MAXSIZE);
+    g_assert(strstr(dump, "older messages were overwritten"));
+    g_assert(strstr(dump, "] fr-test: message #999\n"));
+    g_assert(!strstr(dump, "] fr-test: message #0\n"));
+    g_assert(!strstr(dump, "] fr-test: int -5"));
+    g_assert(!strstr(dump, "left out of the dump"));
+    nm_clear_g_free(&dump);
+
+    /* a limited dump keeps the newest lines, and tells how many it left out. */
+    dump = nm_logging_flight_recorder_dump(1024);
+    g_assert_cmpint(strlen(dump), <=, 1024);
+    g_assert(g_str_has_prefix(dump, "<info>  ["));
+    g_assert(strstr(dump, " older lines were left out of the dump\n"));
+    g_assert(g_str_has_suffix(dump, "] fr-test: message #999\n"));
+    g_assert(!strstr(dump, "older messages were overwritten"));
+    nm_clear_g_free(&dump);
+
+    dump = nm_logging_flight_recorder_dump(0);
+    g_assert_cmpstr(dump, ==, "");
+    nm_clear_g_free(&dump);
+
+    nm_logging_flight_recorder_setup(0);
+    g_assert(!nm_logging_flight_recorder_dump(G_MAXSIZE));
+    g_assert(nm_logging_enabled(LOGL_TRACE, LOGD_CORE)
+             == nm_logging_output_enabled(LOGL_TRACE, LOGD_CORE));
+}
+
+static void
+test_logging_flight_recorder_bench(void)
+{
+    const guint N = 200000;
+    gint64      t_start;
+    gint64      t_recorded;
+    guint       i;
+
+    if (nm_logging_output_enabled(LOGL_TRACE, LOGD_CORE)) {
+        g_test_skip("trace logging is enabled");
+        return;
+    }
+
+    t_start = g_get_monotonic_time();
+    for (i = 0; i < N; i++)
+        nm_log_trace(LOGD_CORE, "fr-bench: message #%u on %s (%d)", i, "eth0", -1);
+    t_recorded = g_get_monotonic_time() - t_start;
+    g_test_message("flight recorder disabled: %.1f nsec per message",
+                   (double) t_recorded * 1000 / N);
+
+    nm_logging_flight_recorder_setup(1024 * 1024);
+
+    t_start = g_get_monotonic_time();
+    for (i = 0; i < N; i++)
+        nm_log_trace(LOGD_CORE, "fr-bench: message #%u on %s (%d)", i, "eth0", -1);
+    t_recorded = g_get_monotonic_time() - t_start;
+    g_test_message("flight recorder enabled: %.1f nsec per message",
+                   (double) t_recorded * 1000 / N);
+
+    nm_logging_flight_recorder_setup(0);
+}
+
+/*****************************************************************************/
+
 static void
 _test_same_prefix(const char *a1, const char *a2, guint8 plen)
 {
@@ -2506,6 +2609,237 @@ test_kernel_cmdline_match_check(void)
 
 /*****************************************************************************/
 
+static void
+test_dispatcher_coalesce(void)
+{
+    gs_unref_hashtable GHashTable *table   = nm_dispatcher_coalesce_table_new();
+    gs_unref_object GObject *      device1 = g_object_new(G_TYPE_OBJECT, NULL);
+    gs_unref_object GObject *      device2 = g_object_new(G_TYPE_OBJECT, NULL);
+    NMDispatcherCoalesceData *     data1;
+    NMDispatcherCoalesceData *     data2;
+    NMDispatcherCoalesceData *     data3;
+    NMDispatcherCoalesceData *     data4;
+
+    /* the first event of each device and action starts a call. */
+    data1 = nm_dispatcher_coalesce_begin(table,
+                                         device1,
+                                         NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+                                         NM_CONNECTIVITY_UNKNOWN);
+    data2 = nm_dispatcher_coalesce_begin(table,
+                                         device1,
+                                         NM_DISPATCHER_ACTION_DHCP6_CHANGE,
+                                         NM_CONNECTIVITY_UNKNOWN);
+    data3 = nm_dispatcher_coalesce_begin(table,
+                                         device2,
+                                         NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+                                         NM_CONNECTIVITY_UNKNOWN);
+    data4 = nm_dispatcher_coalesce_begin(table,
+                                         NULL,
+                                         NM_DISPATCHER_ACTION_CONNECTIVITY_CHANGE,
+                                         NM_CONNECTIVITY_LIMITED);
+    g_assert(data1);
+    g_assert(data2);
+    g_assert(data3);
+    g_assert(data4);
+    g_assert(data1->device == device1);
+    g_assert(!data4->device);
+    g_assert_cmpint(g_hash_table_size(table), ==, 4);
+
+    /* further events are merged into the call in flight. The last
+     * connectivity state wins. */
+    g_assert(!nm_dispatcher_coalesce_begin(table,
+                                           device1,
+                                           NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+                                           NM_CONNECTIVITY_UNKNOWN));
+    g_assert(!nm_dispatcher_coalesce_begin(table,
+                                           device1,
+                                           NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+                                           NM_CONNECTIVITY_UNKNOWN));
+    g_assert(!nm_dispatcher_coalesce_begin(table,
+                                           NULL,
+                                           NM_DISPATCHER_ACTION_CONNECTIVITY_CHANGE,
+                                           NM_CONNECTIVITY_PORTAL));
+    g_assert(!nm_dispatcher_coalesce_begin(table,
+                                           NULL,
+                                           NM_DISPATCHER_ACTION_CONNECTIVITY_CHANGE,
+                                           NM_CONNECTIVITY_FULL));
+    g_assert_cmpint(g_hash_table_size(table), ==, 4);
+    g_assert(data1->pending);
+    g_assert(!data2->pending);
+    g_assert(!data3->pending);
+    g_assert(data4->pending);
+    g_assert_cmpint(data4->connectivity_state, ==, NM_CONNECTIVITY_FULL);
+
+    /* a completed call without merged events needs no follow-up. */
+    g_assert(!nm_dispatcher_coalesce_end(table, data2));
+    nm_dispatcher_coalesce_data_free(data2);
+    g_assert_cmpint(g_hash_table_size(table), ==, 3);
+
+    /* after the call completed, the next event starts a new call, also when it
+     * happens while the follow-up for the merged events is sent. */
+    g_assert(nm_dispatcher_coalesce_end(table, data1));
+    data2 = nm_dispatcher_coalesce_begin(table,
+                                         device1,
+                                         NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+                                         NM_CONNECTIVITY_UNKNOWN);
+    g_assert(data2);
+    g_assert(data2 != data1);
+    g_assert(!data2->pending);
+    nm_dispatcher_coalesce_data_free(data1);
+
+    /* the entries keep a reference to the device. */
+    g_object_add_weak_pointer(device2, (gpointer *) &device2);
+    g_object_unref(device2);
+    g_assert(device2);
+    g_assert(!nm_dispatcher_coalesce_end(table, data3));
+    nm_dispatcher_coalesce_data_free(data3);
+    g_assert(!device2);
+
+    g_assert(nm_dispatcher_coalesce_end(table, data4));
+    nm_dispatcher_coalesce_data_free(data4);
+    g_assert(!nm_dispatcher_coalesce_end(table, data2));
+    nm_dispatcher_coalesce_data_free(data2);
+    g_assert_cmpint(g_hash_table_size(table), ==, 0);
+}
+
+/*****************************************************************************/
+
+static void
+_dbus_cache_assert_str(GVariant *  settings,
+                       const char *setting_name,
+                       const char *key,
+                       const char *expected)
+{
+    gs_unref_variant GVariant *setting_dict = NULL;
+    const char *               str          = NULL;
+
+    setting_dict = g_variant_lookup_value(settings, setting_name, NM_VARIANT_TYPE_SETTING);
+    if (setting_dict)
+        g_variant_lookup(setting_dict, key, "&s", &str);
+    g_assert_cmpstr(str, ==, expected);
+}
+
+static guint64
+_dbus_cache_lookup_timestamp(GVariant *settings)
+{
+    gs_unref_variant GVariant *setting_dict = NULL;
+    guint64                    timestamp;
+
+    setting_dict = g_variant_lookup_value(settings, "connection", NM_VARIANT_TYPE_SETTING);
+    g_assert(setting_dict);
+    if (!g_variant_lookup(setting_dict, "timestamp", "t", &timestamp))
+        g_assert_not_reached();
+    return timestamp;
+}
+
+static void
+test_sett_util_dbus_cache(void)
+{
+    gs_unref_object NMConnection *   con1    = NULL;
+    gs_unref_object NMConnection *   con2    = NULL;
+    gs_unref_object NMConnection *   con3    = NULL;
+    NMSettUtilDBusCache              cache   = {};
+    NMConnectionSerializationOptions options = {};
+    NMSetting *                      s_8021x;
+    GVariant *                       no_secrets;
+    GVariant *                       only_secrets;
+    GVariant *                       v;
+
+    con1    = nmtst_create_minimal_connection("test", NULL, NM_SETTING_WIRED_SETTING_NAME, NULL);
+    s_8021x = nm_setting_802_1x_new();
+    g_object_set(s_8021x,
+                 NM_SETTING_802_1X_EAP,
+                 NM_MAKE_STRV("peap"),
+                 NM_SETTING_802_1X_IDENTITY,
+                 "user",
+                 NM_SETTING_802_1X_PHASE2_AUTH,
+                 "mschapv2",
+                 NM_SETTING_802_1X_PASSWORD,
+                 "secret1",
+                 NULL);
+    nm_connection_add_setting(con1, s_8021x);
+
+    options.timestamp.has = TRUE;
+    options.timestamp.val = 42;
+
+    /* both variants are built once, and then returned from the cache. */
+    no_secrets =
+        nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_NO_SECRETS, &options);
+    g_assert(cache.connection == con1);
+    _dbus_cache_assert_str(no_secrets, "802-1x", "identity", "user");
+    _dbus_cache_assert_str(no_secrets, "802-1x", "password", NULL);
+    g_assert_cmpint(_dbus_cache_lookup_timestamp(no_secrets), ==, 42);
+    v = nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_NO_SECRETS, &options);
+    g_assert(v == no_secrets);
+
+    only_secrets =
+        nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_ONLY_SECRETS, NULL);
+    g_assert(only_secrets != no_secrets);
+    _dbus_cache_assert_str(only_secrets, "802-1x", "password", "secret1");
+    _dbus_cache_assert_str(only_secrets, "802-1x", "identity", NULL);
+    v = nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_ONLY_SECRETS, NULL);
+    g_assert(v == only_secrets);
+    v = nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_NO_SECRETS, &options);
+    g_assert(v == no_secrets);
+
+    /* the options are only used when building the variant. The caller clears
+     * the cache when they change, like for a new timestamp. */
+    options.timestamp.val = 43;
+    v = nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_NO_SECRETS, &options);
+    g_assert(v == no_secrets);
+
+    nm_sett_util_dbus_cache_clear(&cache);
+    g_assert(!cache.connection);
+    g_assert(!cache.no_secrets);
+    g_assert(!cache.only_secrets);
+    no_secrets =
+        nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_NO_SECRETS, &options);
+    g_assert_cmpint(_dbus_cache_lookup_timestamp(no_secrets), ==, 43);
+    only_secrets =
+        nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_ONLY_SECRETS, NULL);
+
+    /* an update or new secrets replace the immutable profile. Both variants
+     * get built again for it. */
+    con2 = nm_simple_connection_new_clone(con1);
+    g_object_set(nm_connection_get_setting_802_1x(con2),
+                 NM_SETTING_802_1X_PASSWORD,
+                 "secret2",
+                 NULL);
+
+    v = nm_sett_util_dbus_cache_get(&cache, con2, NM_CONNECTION_SERIALIZE_ONLY_SECRETS, NULL);
+    g_assert(cache.connection == con2);
+    g_assert(!cache.no_secrets);
+    g_assert(v != only_secrets);
+    _dbus_cache_assert_str(v, "802-1x", "password", "secret2");
+    only_secrets = v;
+
+    v = nm_sett_util_dbus_cache_get(&cache, con2, NM_CONNECTION_SERIALIZE_NO_SECRETS, &options);
+    g_assert(v != no_secrets);
+    _dbus_cache_assert_str(v, "802-1x", "identity", "user");
+    _dbus_cache_assert_str(v, "802-1x", "password", NULL);
+
+    /* going back to the previous profile does not return the variants of the
+     * current one. */
+    v = nm_sett_util_dbus_cache_get(&cache, con1, NM_CONNECTION_SERIALIZE_ONLY_SECRETS, NULL);
+    g_assert(v != only_secrets);
+    _dbus_cache_assert_str(v, "802-1x", "password", "secret1");
+
+    /* without secrets, the result is an empty dictionary. */
+    con3 = nmtst_create_minimal_connection("test", NULL, NM_SETTING_WIRED_SETTING_NAME, NULL);
+    v    = nm_sett_util_dbus_cache_get(&cache, con3, NM_CONNECTION_SERIALIZE_ONLY_SECRETS, NULL);
+    g_assert(g_variant_is_of_type(v, NM_VARIANT_TYPE_CONNECTION));
+    g_assert_cmpint(g_variant_n_children(v), ==, 0);
+    g_assert(v
+             == nm_sett_util_dbus_cache_get(&cache,
+                                            con3,
+                                            NM_CONNECTION_SERIALIZE_ONLY_SECRETS,
+                                            NULL));
+
+    nm_sett_util_dbus_cache_clear(&cache);
+}
+
+/*****************************************************************************/
+
 static void
 test_connectivity_state_cmp(void)
 {
@@ -2562,6 +2896,277 @@ test_connectivity_state_cmp(void)
 
 /*****************************************************************************/
 
+static const NMDBusInterfaceInfoExtended test_interface_info = {
+    .parent = NM_DEFINE_GDBUS_INTERFACE_INFO_INIT(
+        "org.freedesktop.NetworkManager.Test",
+        .properties = NM_DEFINE_GDBUS_PROPERTY_INFOS(
+            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Interface", "s", "interface"),
+            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("IpInterface", "s", "ip-interface"),
+            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("State", "u", "state"),
+            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L("HwAddress", "s", "hw-address"), ), ),
+};
+
+static const NMDBusInterfaceInfoExtended test_interface_info_empty = {
+    .parent = NM_DEFINE_GDBUS_INTERFACE_INFO_INIT("org.freedesktop.NetworkManager.TestEmpty", ),
+};
+
+static void
+test_dbus_utils_lookup_property(void)
+{
+    const NMDBusInterfaceInfoExtended *info  = &test_interface_info;
+    GDBusPropertyInfo *const *         props = info->parent.properties;
+    NMDBusPropertyIndex *              index;
+    GParamSpec *                       pspec;
+    guint                              i;
+    guint                              idx;
+
+    index = nm_dbus_utils_property_index_new(info);
+
+    for (i = 0; props[i]; i++) {
+        const NMDBusPropertyInfoExtended *property_info =
+            (const NMDBusPropertyInfoExtended *) props[i];
+
+        pspec = g_param_spec_ref_sink(
+            g_param_spec_string(property_info->property_name, "", "", NULL, G_PARAM_READABLE));
+
+        idx = G_MAXUINT;
+        g_assert(nm_dbus_utils_property_index_lookup(index, props[i]->name, &idx) == props[i]);
+        g_assert_cmpint(idx, ==, i);
+
+        idx = G_MAXUINT;
+        g_assert(nm_dbus_utils_property_index_lookup_by_pspec(index, pspec, &idx)
+                 == property_info);
+        g_assert_cmpint(idx, ==, i);
+
+        g_param_spec_unref(pspec);
+    }
+
+    /* the D-Bus name and the GObject property name are not interchangeable. */
+    g_assert(!nm_dbus_utils_property_index_lookup(index, "interface", NULL));
+    g_assert(!nm_dbus_utils_property_index_lookup(index, "NoSuchProperty", NULL));
+
+    pspec = g_param_spec_ref_sink(g_param_spec_string("Interface", "", "", NULL, G_PARAM_READABLE));
+    idx   = G_MAXUINT;
+    g_assert(!nm_dbus_utils_property_index_lookup_by_pspec(index, pspec, &idx));
+    g_assert_cmpint(idx, ==, G_MAXUINT);
+    nm_dbus_utils_property_index_free(index);
+
+    /* an interface without properties has an empty index. */
+    index = nm_dbus_utils_property_index_new(&test_interface_info_empty);
+    g_assert(!nm_dbus_utils_property_index_lookup(index, "Interface", NULL));
+    g_assert(!nm_dbus_utils_property_index_lookup_by_pspec(index, pspec, NULL));
+    nm_dbus_utils_property_index_free(index);
+
+    g_param_spec_unref(pspec);
+}
+
+/* A GObject that implements the properties of @test_interface_info, to
+ * fetch their values like the D-Bus manager does for exported objects. */
+
+#define NMTST_TYPE_DBUS_OBJ (nmtst_dbus_obj_get_type())
+
+enum {
+    PROP_0,
+    PROP_INTERFACE,
+    PROP_IP_INTERFACE,
+    PROP_STATE,
+    PROP_HW_ADDRESS,
+};
+
+typedef struct {
+    GObject parent;
+    guint   n;
+} NMTstDBusObj;
+
+typedef struct {
+    GObjectClass parent;
+} NMTstDBusObjClass;
+
+GType nmtst_dbus_obj_get_type(void);
+
+G_DEFINE_TYPE(NMTstDBusObj, nmtst_dbus_obj, G_TYPE_OBJECT)
+
+static void
+nmtst_dbus_obj_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+    NMTstDBusObj *self = (NMTstDBusObj *) object;
+
+    switch (prop_id) {
+    case PROP_INTERFACE:
+    case PROP_IP_INTERFACE:
+        g_value_take_string(value, g_strdup_printf("eth%u", self->n));
+        break;
+    case PROP_STATE:
+        g_value_set_uint(value, self->n);
+        break;
+    case PROP_HW_ADDRESS:
+        g_value_take_string(value,
+                            g_strdup_printf("02:00:00:00:%02X:%02X",
+                                            (self->n >> 8) & 0xFF,
+                                            self->n & 0xFF));
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+nmtst_dbus_obj_init(NMTstDBusObj *self)
+{}
+
+static void
+nmtst_dbus_obj_class_init(NMTstDBusObjClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->get_property = nmtst_dbus_obj_get_property;
+
+    g_object_class_install_property(
+        object_class,
+        PROP_INTERFACE,
+        g_param_spec_string("interface", "", "", NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(object_class,
+                                    PROP_IP_INTERFACE,
+                                    g_param_spec_string("ip-interface",
+                                                        "",
+                                                        "",
+                                                        NULL,
+                                                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(object_class,
+                                    PROP_STATE,
+                                    g_param_spec_uint("state",
+                                                      "",
+                                                      "",
+                                                      0,
+                                                      G_MAXUINT32,
+                                                      0,
+                                                      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(
+        object_class,
+        PROP_HW_ADDRESS,
+        g_param_spec_string("hw-address", "", "", NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+}
+
+/* Collect all properties of @obj into an a{sv} dictionary, like a GetAll() call,
+ * for which GDBus asks for each property by its name. With @index, the properties
+ * are resolved via the index. Otherwise via a linear scan, like before the index
+ * existed. */
+static GVariant *
+_dbus_obj_get_all(GObject *obj, const NMDBusPropertyIndex *index)
+{
+    const NMDBusInterfaceInfoExtended *info  = &test_interface_info;
+    GDBusPropertyInfo *const *         props = info->parent.properties;
+    GVariantBuilder                    builder;
+    guint                              i, j;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    for (i = 0; props[i]; i++) {
+        gs_unref_variant GVariant *       value     = NULL;
+        GDBusPropertyInfo *               dbus_info = NULL;
+        const NMDBusPropertyInfoExtended *property_info;
+
+        if (index)
+            dbus_info = nm_dbus_utils_property_index_lookup(index, props[i]->name, NULL);
+        else {
+            for (j = 0; props[j]; j++) {
+                if (nm_streq(props[j]->name, props[i]->name)) {
+                    dbus_info = props[j];
+                    break;
+                }
+            }
+        }
+        g_assert(dbus_info);
+
+        property_info = (const NMDBusPropertyInfoExtended *) dbus_info;
+        value         = nm_dbus_utils_get_property(obj,
+                                           property_info->parent.signature,
+                                           property_info->property_name);
+        g_variant_builder_add(&builder, "{sv}", property_info->parent.name, value);
+    }
+    return g_variant_ref_sink(g_variant_builder_end(&builder));
+}
+
+static void
+test_dbus_utils_lookup_property_bench(void)
+{
+    const NMDBusInterfaceInfoExtended *info = &test_interface_info;
+    gs_unref_ptrarray GPtrArray *objs       = NULL;
+    gs_unref_ptrarray GPtrArray *values     = NULL;
+    gs_free GParamSpec **        pspecs     = NULL;
+    NMDBusPropertyIndex *        index;
+    const guint                  n_objects  = 10000;
+    gint64                       t_linear;
+    gint64                       t_index;
+    guint                        n_pspecs;
+    guint                        i, j;
+
+    objs   = g_ptr_array_new_with_free_func(g_object_unref);
+    values = g_ptr_array_new_with_free_func((GDestroyNotify) g_variant_unref);
+    for (i = 0; i < n_objects; i++) {
+        NMTstDBusObj *obj = g_object_new(NMTST_TYPE_DBUS_OBJ, NULL);
+
+        obj->n = i;
+        g_ptr_array_add(objs, obj);
+    }
+
+    /* GetAll() on each object, resolving the properties by a linear scan. */
+    t_linear = g_get_monotonic_time();
+    for (i = 0; i < n_objects; i++)
+        g_ptr_array_add(values, _dbus_obj_get_all(objs->pdata[i], NULL));
+    t_linear = g_get_monotonic_time() - t_linear;
+
+    /* and the same via the index, which must give the same result. */
+    index   = nm_dbus_utils_property_index_new(info);
+    t_index = g_get_monotonic_time();
+    for (i = 0; i < n_objects; i++) {
+        gs_unref_variant GVariant *value = _dbus_obj_get_all(objs->pdata[i], index);
+
+        if (!g_variant_equal(value, values->pdata[i]))
+            g_assert_not_reached();
+    }
+    t_index = g_get_monotonic_time() - t_index;
+
+    g_test_message("GetAll() on %u objects: %" G_GINT64_FORMAT
+                   " usec with linear scan, %" G_GINT64_FORMAT " usec with index",
+                   n_objects,
+                   t_linear,
+                   t_index);
+
+    for (i = 0; i < n_objects; i += n_objects / 10) {
+        gs_free char *iface = g_strdup_printf("eth%u", i);
+        const char *  s;
+        guint32       u;
+
+        g_assert(g_variant_lookup(values->pdata[i], "Interface", "&s", &s));
+        g_assert_cmpstr(s, ==, iface);
+        g_assert(g_variant_lookup(values->pdata[i], "State", "u", &u));
+        g_assert_cmpint(u, ==, i);
+        g_assert_cmpint(g_variant_n_children(values->pdata[i]), ==, 4);
+    }
+
+    /* a notification of all properties of each object, resolved by their pspec. */
+    pspecs = g_object_class_list_properties(G_OBJECT_GET_CLASS(objs->pdata[0]), &n_pspecs);
+    g_assert_cmpint(n_pspecs, ==, 4);
+    t_index = g_get_monotonic_time();
+    for (i = 0; i < n_objects; i++) {
+        for (j = 0; j < n_pspecs; j++) {
+            const NMDBusPropertyInfoExtended *property_info;
+
+            property_info = nm_dbus_utils_property_index_lookup_by_pspec(index, pspecs[j], NULL);
+            if (!property_info || !nm_streq(property_info->property_name, pspecs[j]->name))
+                g_assert_not_reached();
+        }
+    }
+    g_test_message("notify on %u objects: %" G_GINT64_FORMAT " usec with index",
+                   n_objects,
+                   g_get_monotonic_time() - t_index);
+
+    nm_dbus_utils_property_index_free(index);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -2571,6 +3176,11 @@ main(int argc, char **argv)
 
     g_test_add_func("/general/test_logging_domains", test_logging_domains);
     g_test_add_func("/general/test_logging_error", test_logging_error);
+    g_test_add_func("/general/test_logging_flight_recorder", test_logging_flight_recorder);
+    if (g_test_perf()) {
+        g_test_add_func("/general/test_logging_flight_recorder_bench",
+                        test_logging_flight_recorder_bench);
+    }
 
     g_test_add_func("/general/nm_utils_strbuf_append", test_nm_utils_strbuf_append);
 
@@ -2631,9 +3241,17 @@ main(int argc, char **argv)
                          GINT_TO_POINTER(1),
                          test_nm_utils_dhcp_client_id_systemd_node_specific);
 
+    g_test_add_func("/core/general/test_dispatcher_coalesce", test_dispatcher_coalesce);
+    g_test_add_func("/core/general/test_sett_util_dbus_cache", test_sett_util_dbus_cache);
     g_test_add_func("/core/general/test_connectivity_state_cmp", test_connectivity_state_cmp);
     g_test_add_func("/core/general/test_kernel_cmdline_match_check",
                     test_kernel_cmdline_match_check);
+    g_test_add_func("/core/general/test_dbus_utils_lookup_property",
+                    test_dbus_utils_lookup_property);
+    if (g_test_perf()) {
+        g_test_add_func("/core/general/test_dbus_utils_lookup_property_bench",
+                        test_dbus_utils_lookup_property_bench);
+    }
 
     return g_test_run();
 }
@@ -0,0 +1,251 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include <unistd.h>
+
+#include "nm-dbus-manager.h"
+#include "nm-dbus-object.h"
+#include "nm-dhcp-config.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    GMainLoop *      loop;
+    GDBusConnection *peer;
+    GDBusConnection *bus;
+    GVariant *       ret;
+    guint            n_changed_peer;
+    guint            n_changed_bus;
+    guint            n_removed_peer;
+} TestData;
+
+static void
+_peer_new_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    TestData *td                = user_data;
+    gs_free_error GError *error = NULL;
+
+    td->peer = g_dbus_connection_new_for_address_finish(result, &error);
+    g_assert_no_error(error);
+    g_main_loop_quit(td->loop);
+}
+
+static void
+_call_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    TestData *td                = user_data;
+    gs_free_error GError *error = NULL;
+
+    td->ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), result, &error);
+    g_assert_no_error(error);
+    g_main_loop_quit(td->loop);
+}
+
+static void
+_signal_cb(GDBusConnection *connection,
+           const char *     sender_name,
+           const char *     object_path,
+           const char *     interface_name,
+           const char *     signal_name,
+           GVariant *       parameters,
+           gpointer         user_data)
+{
+    TestData *td = user_data;
+
+    if (connection == td->peer) {
+        /* on the peer connection, there is no sender. */
+        g_assert(!sender_name);
+        if (nm_streq(signal_name, "PropertiesChanged"))
+            td->n_changed_peer++;
+        else if (nm_streq(signal_name, "InterfacesRemoved"))
+            td->n_removed_peer++;
+    } else {
+        g_assert(connection == td->bus);
+        if (nm_streq(signal_name, "PropertiesChanged"))
+            td->n_changed_bus++;
+    }
+    g_main_loop_quit(td->loop);
+}
+
+static void
+_wait_for(TestData *td, const guint *counter)
+{
+    guint i;
+
+    for (i = 0; *counter == 0; i++) {
+        g_assert_cmpint(i, <, 50);
+        nmtst_main_loop_run(td->loop, 100);
+    }
+}
+
+static void
+test_private_socket_export(void)
+{
+    gs_unref_object GTestDBus *test_bus    = NULL;
+    gs_unref_object NMDhcpConfig *config   = NULL;
+    gs_unref_hashtable GHashTable *options = NULL;
+    gs_unref_variant GVariant *objects     = NULL;
+    gs_unref_variant GVariant *interfaces  = NULL;
+    gs_free char *             dbus_daemon = NULL;
+    gs_free char *             socket_path = NULL;
+    gs_free char *             socket_addr = NULL;
+    gs_free_error GError *error            = NULL;
+    NMDBusManager *       manager;
+    TestData              td = {};
+    const char *          path;
+    guint                 id_peer_changed;
+    guint                 id_peer_removed;
+    guint                 id_bus_changed;
+
+    dbus_daemon = g_find_program_in_path("dbus-daemon");
+    if (!dbus_daemon) {
+        g_test_skip("dbus-daemon is not available");
+        return;
+    }
+
+    /* NetworkManager connects to the system bus. Let it use a private test bus
+     * instead. */
+    test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+    g_test_dbus_up(test_bus);
+    g_setenv("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address(test_bus), TRUE);
+
+    manager = nm_dbus_manager_get();
+    g_assert(nm_dbus_manager_acquire_bus(manager, TRUE));
+    nm_dbus_manager_start(manager, NULL, NULL);
+
+    socket_path = g_strdup_printf("%s/test-dbus-manager-%d.socket", g_get_tmp_dir(), getpid());
+    socket_addr = g_strdup_printf("unix:path=%s", socket_path);
+    nm_dbus_manager_private_server_register_full(manager, socket_path, "test", TRUE);
+
+    td.loop = g_main_loop_new(NULL, FALSE);
+
+    td.bus = g_dbus_connection_new_for_address_sync(
+        g_test_dbus_get_bus_address(test_bus),
+        G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT
+            | G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+        NULL,
+        NULL,
+        &error);
+    g_assert_no_error(error);
+
+    g_dbus_connection_new_for_address(socket_addr,
+                                      G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                      NULL,
+                                      NULL,
+                                      _peer_new_cb,
+                                      &td);
+    nmtst_main_loop_run_assert(td.loop, 5000);
+    g_assert(td.peer);
+    g_assert(!g_dbus_connection_get_unique_name(td.peer));
+
+    /* an object exported afterwards is also visible on the existing peer connection. */
+    config = nm_dhcp_config_new(AF_INET);
+    path   = nm_dbus_object_export(config);
+    g_assert(path);
+
+    g_dbus_connection_call(td.peer,
+                           NULL,
+                           "/org/freedesktop",
+                           DBUS_INTERFACE_OBJECT_MANAGER,
+                           "GetManagedObjects",
+                           NULL,
+                           G_VARIANT_TYPE("(a{oa{sa{sv}}})"),
+                           G_DBUS_CALL_FLAGS_NONE,
+                           -1,
+                           NULL,
+                           _call_cb,
+                           &td);
+    nmtst_main_loop_run_assert(td.loop, 5000);
+    objects = g_variant_get_child_value(td.ret, 0);
+    nm_clear_pointer(&td.ret, g_variant_unref);
+    interfaces = g_variant_lookup_value(objects, path, G_VARIANT_TYPE("a{sa{sv}}"));
+    g_assert(interfaces);
+    g_assert(g_variant_lookup(interfaces, NM_DBUS_INTERFACE_DHCP4_CONFIG, "@a{sv}", NULL));
+
+    /* property changes are sent to the bus and to the peer. */
+    id_peer_changed = g_dbus_connection_signal_subscribe(td.peer,
+                                                         NULL,
+                                                         DBUS_INTERFACE_PROPERTIES,
+                                                         "PropertiesChanged",
+                                                         path,
+                                                         NULL,
+                                                         G_DBUS_SIGNAL_FLAGS_NONE,
+                                                         _signal_cb,
+                                                         &td,
+                                                         NULL);
+    id_bus_changed = g_dbus_connection_signal_subscribe(td.bus,
+                                                       NM_DBUS_SERVICE,
+                                                       DBUS_INTERFACE_PROPERTIES,
+                                                       "PropertiesChanged",
+                                                       path,
+                                                       NULL,
+                                                       G_DBUS_SIGNAL_FLAGS_NONE,
+                                                       _signal_cb,
+                                                       &td,
+                                                       NULL);
+    id_peer_removed = g_dbus_connection_signal_subscribe(td.peer,
+                                                         NULL,
+                                                         DBUS_INTERFACE_OBJECT_MANAGER,
+                                                         "InterfacesRemoved",
+                                                         "/org/freedesktop",
+                                                         NULL,
+                                                         G_DBUS_SIGNAL_FLAGS_NONE,
+                                                         _signal_cb,
+                                                         &td,
+                                                         NULL);
+
+    /* a round trip to the bus, so that the match rule is in place. */
+    nm_g_variant_unref(g_dbus_connection_call_sync(td.bus,
+                                                   DBUS_SERVICE_DBUS,
+                                                   DBUS_PATH_DBUS,
+                                                   DBUS_INTERFACE_DBUS,
+                                                   "GetId",
+                                                   NULL,
+                                                   G_VARIANT_TYPE("(s)"),
+                                                   G_DBUS_CALL_FLAGS_NONE,
+                                                   -1,
+                                                   NULL,
+                                                   &error));
+    g_assert_no_error(error);
+
+    options = g_hash_table_new(nm_str_hash, g_str_equal);
+    g_hash_table_insert(options, "ip_address", "192.0.2.1");
+    nm_dhcp_config_set_options(config, options);
+
+    _wait_for(&td, &td.n_changed_peer);
+    _wait_for(&td, &td.n_changed_bus);
+    g_assert_cmpint(td.n_removed_peer, ==, 0);
+
+    nm_dbus_object_unexport(config);
+    _wait_for(&td, &td.n_removed_peer);
+
+    g_dbus_connection_signal_unsubscribe(td.peer, id_peer_changed);
+    g_dbus_connection_signal_unsubscribe(td.peer, id_peer_removed);
+    g_dbus_connection_signal_unsubscribe(td.bus, id_bus_changed);
+
+    g_dbus_connection_close_sync(td.peer, NULL, NULL);
+    g_dbus_connection_close_sync(td.bus, NULL, NULL);
+    g_clear_object(&td.peer);
+    g_clear_object(&td.bus);
+    g_main_loop_unref(td.loop);
+
+    g_test_dbus_down(test_bus);
+    unlink(socket_path);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE();
+
+int
+main(int argc, char **argv)
+{
+    nmtst_init_with_logging(&argc, &argv, NULL, "ALL");
+
+    g_test_add_func("/dbus-manager/private-socket-export", test_private_socket_export);
+
+    return g_test_run();
+}
@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include "nm-test-utils-core.h"
+
+/* Asynchronous logging cannot be turned off again, so it gets its own test
+ * program. Without nm_logging_init(), the logging thread passes the messages
+ * on with g_log(). We collect them with a log handler, which can also block
+ * the logging thread. */
+
+/*****************************************************************************/
+
+static struct {
+    GMutex     mutex;
+    GCond      cond;
+    GPtrArray *messages;
+    gboolean   blocked;
+} gl;
+
+static void
+_log_handler(const char *   log_domain,
+             GLogLevelFlags log_level,
+             const char *   message,
+             gpointer       user_data)
+{
+    const char *s;
+
+    /* only keep the text of the message, after "<warn>  [timestamp] ". */
+    s = strstr(message, "] ");
+    s = s ? &s[2] : message;
+
+    g_mutex_lock(&gl.mutex);
+    g_ptr_array_add(gl.messages, g_strdup(s));
+    g_cond_broadcast(&gl.cond);
+    while (gl.blocked)
+        g_cond_wait(&gl.cond, &gl.mutex);
+    g_mutex_unlock(&gl.mutex);
+}
+
+/* takes the messages that were passed on so far. */
+static GPtrArray *
+_messages_steal(void)
+{
+    GPtrArray *messages;
+
+    g_mutex_lock(&gl.mutex);
+    messages    = gl.messages;
+    gl.messages = g_ptr_array_new_with_free_func(g_free);
+    g_mutex_unlock(&gl.mutex);
+    return messages;
+}
+
+static void
+_messages_assert_sequence(GPtrArray *messages, guint *idx, const char *prefix, guint n)
+{
+    guint i;
+
+    for (i = 0; i < n; i++) {
+        gs_free char *expected = g_strdup_printf("%s #%u", prefix, i);
+
+        g_assert_cmpint(*idx, <, messages->len);
+        g_assert_cmpstr(messages->pdata[*idx], ==, expected);
+        (*idx)++;
+    }
+}
+
+/*****************************************************************************/
+
+static void
+test_async_flush(void)
+{
+    gs_unref_ptrarray GPtrArray *messages = NULL;
+    guint                        idx      = 0;
+    guint                        i;
+
+    /* nothing pending. */
+    nm_logging_flush();
+    messages = _messages_steal();
+    g_assert_cmpint(messages->len, ==, 0);
+    nm_clear_pointer(&messages, g_ptr_array_unref);
+
+    /* after flushing, all earlier messages were passed on, in order. */
+    for (i = 0; i < 500; i++)
+        nm_log_warn(LOGD_CORE, "async-test: flush #%u", i);
+    nm_logging_flush();
+
+    messages = _messages_steal();
+    _messages_assert_sequence(messages, &idx, "async-test: flush", 500);
+    g_assert_cmpint(idx, ==, messages->len);
+}
+
+/*****************************************************************************/
+
+#define N_THREADS             4
+#define N_MESSAGES_PER_THREAD 200
+
+static gpointer
+_producer_thread(gpointer user_data)
+{
+    const guint n = GPOINTER_TO_UINT(user_data);
+    guint       i;
+
+    for (i = 0; i < N_MESSAGES_PER_THREAD; i++)
+        _nm_log_mt(TRUE, LOGL_WARN, LOGD_CORE, 0, NULL, NULL, "async-test: thread%u #%u", n, i);
+    return NULL;
+}
+
+static void
+test_async_order(void)
+{
+    gs_unref_ptrarray GPtrArray *messages = NULL;
+    GThread *                    threads[N_THREADS];
+    guint                        counters[N_THREADS] = {};
+    guint                        i;
+
+    /* several threads log at the same time. The messages of each thread
+     * keep their order, and none gets lost. */
+    for (i = 0; i < N_THREADS; i++)
+        threads[i] = g_thread_new("producer", _producer_thread, GUINT_TO_POINTER(i));
+    for (i = 0; i < N_THREADS; i++)
+        g_thread_join(threads[i]);
+    nm_logging_flush();
+
+    messages = _messages_steal();
+    g_assert_cmpint(messages->len, ==, N_THREADS * N_MESSAGES_PER_THREAD);
+
+    for (i = 0; i < messages->len; i++) {
+        guint n;
+        guint k;
+
+        if (sscanf(messages->pdata[i], "async-test: thread%u #%u", &n, &k) != 2)
+            g_assert_not_reached();
+        g_assert_cmpint(n, <, N_THREADS);
+        g_assert_cmpint(k, ==, counters[n]);
+        counters[n]++;
+    }
+}
+
+/*****************************************************************************/
+
+static void
+test_async_heap(void)
+{
+    gs_unref_ptrarray GPtrArray *messages = NULL;
+    gs_free char *               long_msg = NULL;
+    gs_free char *               fit_msg  = NULL;
+    gs_free char *               ifname   = NULL;
+    gs_free char *               expected = NULL;
+
+    /* a message that does not fit into a slot, and one that only fits without
+     * the interface name and the connection UUID. */
+    long_msg = g_strnfill(5000, 'x');
+    fit_msg  = g_strnfill(1000, 'y');
+    ifname   = g_strnfill(100, 'i');
+
+    nm_log_warn(LOGD_CORE, "async-test: heap %s end", long_msg);
+    nm_log(LOGL_WARN,
+           LOGD_CORE,
+           ifname,
+           "a8e5c63e-3d45-4fc5-9e8f-4a2f3c5b3c0e",
+           "async-test: fit %s end",
+           fit_msg);
+    nm_log_warn(LOGD_CORE, "async-test: small");
+    nm_logging_flush();
+
+    messages = _messages_steal();
+    g_assert_cmpint(messages->len, ==, 3);
+
+    expected = g_strdup_printf("async-test: heap %s end", long_msg);
+    g_assert_cmpstr(messages->pdata[0], ==, expected);
+    nm_clear_g_free(&expected);
+
+    expected = g_strdup_printf("async-test: fit %s end", fit_msg);
+    g_assert_cmpstr(messages->pdata[1], ==, expected);
+
+    /* the slots are reused afterwards. */
+    g_assert_cmpstr(messages->pdata[2], ==, "async-test: small");
+}
+
+/*****************************************************************************/
+
+static void
+test_async_dropped(void)
+{
+    const guint                  N        = 5000;
+    gs_unref_ptrarray GPtrArray *messages = NULL;
+    guint                        n_dropped;
+    guint                        idx = 0;
+    guint                        i;
+
+    /* block the logging thread on a first message. */
+    g_mutex_lock(&gl.mutex);
+    gl.blocked = TRUE;
+    g_mutex_unlock(&gl.mutex);
+
+    nm_log_warn(LOGD_CORE, "async-test: block");
+
+    g_mutex_lock(&gl.mutex);
+    while (gl.messages->len == 0)
+        g_cond_wait(&gl.cond, &gl.mutex);
+    g_mutex_unlock(&gl.mutex);
+
+    /* more messages than the queue holds. The others get dropped. */
+    for (i = 0; i < N; i++)
+        nm_log_warn(LOGD_CORE, "async-test: queued #%u", i);
+
+    g_mutex_lock(&gl.mutex);
+    gl.blocked = FALSE;
+    g_cond_broadcast(&gl.cond);
+    g_mutex_unlock(&gl.mutex);
+
+    /* the number of dropped messages is reported before flushing returns. */
+    nm_logging_flush();
+    messages = _messages_steal();
+
+    g_assert_cmpint(messages->len, >, 2);
+    g_assert_cmpstr(messages->pdata[0], ==, "async-test: block");
+    idx = 1;
+    _messages_assert_sequence(messages, &idx, "async-test: queued", messages->len - 2);
+
+    if (sscanf(messages->pdata[idx], "logging: %u messages dropped", &n_dropped) != 1)
+        g_assert_not_reached();
+    g_assert_cmpint(n_dropped, >, 0);
+    g_assert_cmpint((messages->len - 2) + n_dropped, ==, N);
+
+    /* the count starts again from zero. */
+    nm_clear_pointer(&messages, g_ptr_array_unref);
+    nm_log_warn(LOGD_CORE, "async-test: after");
+    nm_logging_flush();
+    messages = _messages_steal();
+    g_assert_cmpint(messages->len, ==, 1);
+    g_assert_cmpstr(messages->pdata[0], ==, "async-test: after");
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE();
+
+int
+main(int argc, char **argv)
+{
+    nmtst_init_with_logging(&argc, &argv, "WARN", "CORE");
+
+    gl.messages = g_ptr_array_new_with_free_func(g_free);
+    g_log_set_handler(G_LOG_DOMAIN, G_LOG_LEVEL_MASK, _log_handler, NULL);
+
+    nm_logging_init_async();
+
+    g_test_add_func("/logging/async/flush", test_async_flush);
+    g_test_add_func("/logging/async/order", test_async_order);
+    g_test_add_func("/logging/async/heap", test_async_heap);
+    g_test_add_func("/logging/async/dropped", test_async_dropped);
+
+    return g_test_run();
+}
@@ -416,6 +416,11 @@ class BusErr:
             self._dbus_error_name = "{}.UnknownProperty".format(IFACE_DBUS)
             dbus.DBusException.__init__(self, *args, **kwargs)
 
+    class UnknownMethodException(dbus.DBusException):
+        def __init__(self, *args, **kwargs):
+            self._dbus_error_name = "{}.Error.UnknownMethod".format(IFACE_DBUS)
+            dbus.DBusException.__init__(self, *args, **kwargs)
+
     class InvalidPropertyException(dbus.DBusException):
         def __init__(self, *args, **kwargs):
             self._dbus_error_name = "{}.InvalidProperty".format(IFACE_CONNECTION)
@@ -1959,6 +1964,14 @@ class NetworkManager(ExportedObj):
     def AutoRemoveNextConnection(self):
         gl.settings.auto_remove_next_connection()
 
+    @dbus.service.method(IFACE_TEST, in_signature="b", out_signature="")
+    def SetGetAllSettingsSupported(self, supported):
+        gl.settings.get_all_settings_supported = bool(supported)
+
+    @dbus.service.method(IFACE_TEST, in_signature="", out_signature="uu")
+    def GetSettingsCallCounts(self):
+        return (gl.settings.get_settings_calls, gl.settings.get_all_settings_calls)
+
     @dbus.service.method(
         dbus_interface=IFACE_TEST, in_signature="a{sa{sv}}b", out_signature="o"
     )
@@ -2112,6 +2125,7 @@ class Connection(ExportedObj):
         dbus_interface=IFACE_CONNECTION, in_signature="", out_signature="a{sa{sv}}"
     )
     def GetSettings(self):
+        gl.settings.get_settings_calls += 1
         if hasattr(self, "_remove_next_connection_cb"):
             self._remove_next_connection_cb()
             raise BusErr.UnknownConnectionException("Connection not found")
@@ -2170,6 +2184,9 @@ class Settings(ExportedObj):
         self.connections = {}
         self.c_counter = 0
         self.remove_next_connection = False
+        self.get_all_settings_supported = True
+        self.get_settings_calls = 0
+        self.get_all_settings_calls = 0
 
         props = {
             PRP_SETTINGS_HOSTNAME: "foobar.baz",
@@ -2216,6 +2233,25 @@ class Settings(ExportedObj):
     def ListConnections(self):
         return self.get_connection_paths()
 
+    @dbus.service.method(
+        dbus_interface=IFACE_SETTINGS, in_signature="ao", out_signature="a{oa{sa{sv}}}"
+    )
+    def GetAllSettings(self, paths):
+        self.get_all_settings_calls += 1
+        if not self.get_all_settings_supported:
+            raise BusErr.UnknownMethodException("No such method 'GetAllSettings'")
+        result = {}
+        for c in self.get_connections():
+            if paths and c.path not in paths:
+                continue
+            if hasattr(c, "_remove_next_connection_cb"):
+                c._remove_next_connection_cb()
+                continue
+            if not c.visible:
+                continue
+            result[c.path] = c.con_hash
+        return dbus.Dictionary(result, signature="oa{sa{sv}}")
+
     @dbus.service.method(
         dbus_interface=IFACE_SETTINGS, in_signature="a{sa{sv}}", out_signature="o"
     )